@@ -0,0 +1,22 @@
+# googletest library (unit tests only)
+#
+# The project consists of libraries that can be independently
+# added as dependencies:
+#  - gtest
+#  - gtest_main
+
+include(FetchContent)
+set(FETCHCONTENT_QUIET OFF)
+
+set(BUILD_SHARED_LIBS OFF)
+set(INSTALL_GTEST OFF CACHE BOOL "" FORCE)
+set(BUILD_GMOCK OFF CACHE BOOL "" FORCE)
+FetchContent_Declare(
+        googletest
+        GIT_REPOSITORY "https://github.com/google/googletest.git"
+        GIT_TAG "release-1.12.1"
+        GIT_SHALLOW ON
+)
+
+FetchContent_MakeAvailable(googletest)
+set(BUILD_SHARED_LIBS ON)
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 #include "clickhouse.h"
 
@@ -17,4 +19,5 @@ struct Block {
     std::vector<std::shared_ptr<clickhouse::Column>> columns;
     clickhouse::Block block;
     unsigned int rows = 0;
+    std::optional<uint64_t> spill_seq; // The spilled segment the rows have been loaded from
 };
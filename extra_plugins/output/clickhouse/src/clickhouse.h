@@ -11,4 +11,6 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 #include <clickhouse/client.h>
+#include <clickhouse/base/compressed.h>
+#include <clickhouse/base/wire_format.h>
 #pragma GCC diagnostic pop
@@ -35,12 +35,15 @@ enum {
     SOURCE,
     NULLABLE,
     INSERTER_THREADS,
+    CONVERTER_THREADS,
     BLOCKS,
     BLOCK_INSERT_THRESHOLD,
     BLOCK_INSERT_MAX_DELAY_SECS,
     SPLIT_BIFLOW,
     BIFLOW_EMPTY_AUTOIGNORE,
     NONBLOCKING,
+    SPILL_DIRECTORY,
+    SPILL_MAX_SIZE,
 };
 
 
@@ -80,12 +83,15 @@ static const struct fds_xml_args root[] = {
     FDS_OPTS_ROOT  ("params"),
     FDS_OPTS_NESTED(CONNECTION,                  "connection",              connection,        0),
     FDS_OPTS_ELEM  (INSERTER_THREADS,            "inserterThreads",         FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (CONVERTER_THREADS,           "converterThreads",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (BLOCKS,                      "blocks",                  FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (BLOCK_INSERT_THRESHOLD,      "blockInsertThreshold",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (BLOCK_INSERT_MAX_DELAY_SECS, "blockInsertMaxDelaySecs", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (SPLIT_BIFLOW,                "splitBiflow",             FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (BIFLOW_EMPTY_AUTOIGNORE,     "biflowEmptyAutoignore",   FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (NONBLOCKING,                 "nonblocking",             FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPILL_DIRECTORY,             "spillDirectory",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (SPILL_MAX_SIZE,              "spillMaxSize",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(COLUMNS,                     "columns",                 columns,           0),
     FDS_OPTS_END,
 };
@@ -226,6 +232,9 @@ static void parse_root(fds_xml_ctx_t *root_ctx, const fds_iemgr_t *iemgr, Config
         } else if (content->id == args::INSERTER_THREADS) {
             config.inserter_threads = content->val_uint;
 
+        } else if (content->id == args::CONVERTER_THREADS) {
+            config.converter_threads = content->val_uint;
+
         } else if (content->id == args::BLOCK_INSERT_THRESHOLD) {
             config.block_insert_threshold = content->val_uint;
 
@@ -241,6 +250,12 @@ static void parse_root(fds_xml_ctx_t *root_ctx, const fds_iemgr_t *iemgr, Config
         } else if (content->id == args::NONBLOCKING) {
             config.nonblocking = content->val_bool;
 
+        } else if (content->id == args::SPILL_DIRECTORY) {
+            config.spill_directory = content->ptr_string;
+
+        } else if (content->id == args::SPILL_MAX_SIZE) {
+            config.spill_max_size_mb = content->val_uint;
+
         }
     }
 }
@@ -267,5 +282,17 @@ Config parse_config(const char *xml_string, const fds_iemgr_t *iemgr)
 
     parse_root(root_ctx, iemgr, config);
 
+    if (config.converter_threads == 0) {
+        throw std::runtime_error("converterThreads must be at least 1");
+    }
+    if (config.blocks < config.converter_threads) {
+        // Each converter can hold a partially filled block
+        throw std::runtime_error("blocks must be at least converterThreads ("
+                                 + std::to_string(config.converter_threads) + ")");
+    }
+    if (!config.spill_directory.empty() && config.spill_max_size_mb == 0) {
+        throw std::runtime_error("spillMaxSize must be at least 1");
+    }
+
     return config;
 }
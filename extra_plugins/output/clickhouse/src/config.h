@@ -49,12 +49,15 @@ struct Config {
     Connection connection;
     std::vector<Config::Column> columns;
     uint64_t inserter_threads = 8;
+    uint64_t converter_threads = 1;
     uint64_t blocks = 64;
     uint64_t block_insert_threshold = 100000;
     uint64_t block_insert_max_delay_secs = 10;
     bool split_biflow = true;
     bool biflow_empty_autoignore = true;
     bool nonblocking = true;
+    std::string spill_directory; // Empty if spilling is disabled
+    uint64_t spill_max_size_mb = 1024;
 };
 
 /**
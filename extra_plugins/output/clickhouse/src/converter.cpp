@@ -0,0 +1,247 @@
+/**
+ * @file
+ * @brief Converter class for converting flow records to ClickHouse blocks
+ * @date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "converter.h"
+
+#include <utility>
+
+Converter::Converter(
+        int id,
+        Logger logger,
+        const Config &config,
+        const std::vector<Column> &columns,
+        SyncQueue<Block *> &avail_blocks,
+        SyncQueue<Block *> &filled_blocks,
+        Stats &stats,
+        SpillQueue *spill)
+    : m_id(id)
+    , m_logger(logger)
+    , m_config(config)
+    , m_columns(columns)
+    , m_avail_blocks(avail_blocks)
+    , m_filled_blocks(filled_blocks)
+    , m_stats(stats)
+    , m_spill(spill)
+    , m_rec_parsers(columns, config.biflow_empty_autoignore)
+{}
+
+void Converter::extract_values(RecParser &parser, Block &block, bool rev)
+{
+    std::size_t n_columns = m_columns.size();
+
+    for (std::size_t i = 0; i < n_columns; i++) {
+        if (!parser.append_column(i, *block.columns[i], rev)) {
+            m_logger.error("[Converter %d] Field conversion failed (field #%zu, \"%s\")", m_id, i,
+                           m_columns[i].name.c_str());
+        }
+    }
+    block.rows++;
+}
+
+int
+Converter::process_record(fds_drec &rec, Block &block)
+{
+    int ret = 0;
+    RecParser &parser = m_rec_parsers.get_parser(rec.tmplt);
+    parser.parse_record(rec);
+
+    if (!parser.skip_fwd()) {
+        extract_values(parser, block, false);
+        ret++;
+    }
+
+    if (!parser.skip_rev()) {
+        extract_values(parser, block, true);
+        ret++;
+    }
+
+    return ret;
+}
+
+void
+Converter::process_session_msg(ipx_msg_session_t *msg)
+{
+    if (ipx_msg_session_get_event(msg) == IPX_MSG_SESSION_CLOSE) {
+        const ipx_session *sess = ipx_msg_session_get_session(msg);
+        m_rec_parsers.delete_session(sess);
+    }
+}
+
+Block *
+Converter::spill_filled_block()
+{
+    // Take over the oldest block waiting for insertion and move its rows to the disk instead
+    std::optional<Block *> maybe_block = m_filled_blocks.try_get();
+    if (!maybe_block.has_value()) {
+        return nullptr;
+    }
+
+    Block *block = maybe_block.value();
+    if (!m_spill->store(*block)) {
+        m_filled_blocks.put(block);
+        return nullptr;
+    }
+
+    for (auto &column : block->columns) {
+        column->Clear();
+    }
+    block->rows = 0;
+    block->spill_seq.reset();
+    return block;
+}
+
+void
+Converter::process_ipfix_msg(ipx_msg_ipfix_t *msg)
+{
+    // get new block if we don't have one
+    if (m_current_block == nullptr) {
+        std::optional<Block *> maybe_block = m_avail_blocks.try_get();
+        if (maybe_block.has_value()) {
+            m_current_block = maybe_block.value();
+        } else if (m_spill) {
+            m_current_block = spill_filled_block();
+        }
+    }
+    if (m_current_block == nullptr) {
+        if (m_config.nonblocking) {
+            // no available blocks and we are in a non-blocking mode, drop the message
+            uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+            m_stats.add_dropped(drec_cnt);
+            return;
+        } else {
+            m_current_block = m_avail_blocks.get();
+        }
+    }
+
+    // setup rec parser
+    const ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    if (msg_ctx->session->type == FDS_SESSION_SCTP) {
+        throw std::runtime_error("SCTP is not supported at this time");
+    }
+    m_rec_parsers.select_session(msg_ctx->session);
+    m_rec_parsers.select_odid(msg_ctx->odid);
+
+    // go through all the records
+    uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    uint32_t rows_count = 0;
+    for (uint32_t idx = 0; idx < drec_cnt; idx++) {
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, idx);
+        uint32_t rows_inserted = process_record(rec->rec, *m_current_block);
+        rows_count += rows_inserted;
+    }
+
+    m_stats.add_recs(drec_cnt);
+    m_stats.add_rows(rows_count);
+}
+
+void
+Converter::check_block(std::time_t now)
+{
+    // Send the block for insertion if it is sufficiently full or a block hasn't been sent in a long enough time
+    if (m_current_block) {
+        bool nonempty = m_current_block->rows > 0;
+        bool thresh_reached = m_current_block->rows >= m_config.block_insert_threshold;
+        bool timeout_reached = uint64_t(now - m_last_insert_time) >= m_config.block_insert_max_delay_secs;
+
+        if (nonempty && (thresh_reached || timeout_reached)) {
+            m_filled_blocks.put(m_current_block);
+            m_current_block = nullptr;
+            m_last_insert_time = now;
+        }
+    }
+}
+
+void
+Converter::process(ipx_msg_t *msg)
+{
+    if (ipx_msg_get_type(msg) == IPX_MSG_SESSION) {
+        process_session_msg(ipx_msg_base2session(msg));
+
+    } else if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+        process_ipfix_msg(ipx_msg_base2ipfix(msg));
+    }
+
+    check_block(std::time(nullptr));
+}
+
+void Converter::post(std::vector<ipx_msg_t *> &msgs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+
+    m_posted.clear();
+    std::swap(m_posted, msgs);
+    m_busy = true;
+    m_cv.notify_all();
+}
+
+void Converter::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return !m_busy; });
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void Converter::stop()
+{
+    {
+        // Set the signal under the lock so that the thread cannot miss it
+        std::lock_guard<std::mutex> lock(m_mutex);
+        request_stop();
+    }
+    m_cv.notify_all();
+    join();
+}
+
+void Converter::flush()
+{
+    if (m_current_block && m_current_block->rows > 0) {
+        m_filled_blocks.put(m_current_block);
+        m_current_block = nullptr;
+    }
+}
+
+void Converter::run()
+{
+    std::vector<ipx_msg_t *> msgs;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_busy || stop_requested(); });
+            if (!m_busy) {
+                break;
+            }
+            std::swap(msgs, m_posted);
+        }
+
+        std::exception_ptr error = nullptr;
+        try {
+            for (ipx_msg_t *msg : msgs) {
+                process(msg);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        msgs.clear();
+
+        // The messages must not be touched once the waiting thread is notified
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy = false;
+        m_error = error;
+        m_cv.notify_all();
+        if (m_error) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * @brief Converter class for converting flow records to ClickHouse blocks
+ * @date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "block.h"
+#include "column.h"
+#include "config.h"
+#include "recparser.h"
+#include "spill.h"
+#include "stats.h"
+#include "syncqueue.h"
+#include "worker.h"
+
+#include <condition_variable>
+#include <ctime>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class Converter
+ * @brief A worker class responsible for converting flow records into rows of blocks.
+ *
+ * The converter owns the block that is currently being filled and the record parsers of the
+ * sessions assigned to it. Messages can be either processed directly on the calling thread or
+ * posted to the converter thread. In the latter case, the caller must wait until the posted
+ * messages are processed before they are released by the collector.
+ */
+class Converter : public Worker {
+public:
+    /**
+     * @brief Constructor for the Converter class.
+     * @param id Unique identifier for the converter.
+     * @param logger Logger instance for logging operations.
+     * @param config Reference to the plugin configuration.
+     * @param columns Reference to the vector of columns defining the table schema.
+     * @param avail_blocks Reference to the queue of available blocks to be filled.
+     * @param filled_blocks Reference to the queue of filled blocks to be inserted.
+     * @param stats Reference to the plugin statistics.
+     * @param spill The spill queue to spill filled blocks to when no block is available, or nullptr.
+     */
+    Converter(
+        int id,
+        Logger logger,
+        const Config &config,
+        const std::vector<Column> &columns,
+        SyncQueue<Block *> &avail_blocks,
+        SyncQueue<Block *> &filled_blocks,
+        Stats &stats,
+        SpillQueue *spill);
+
+    /**
+     * @brief Process a collector message on the calling thread.
+     *
+     * IPFIX messages are converted into rows of the current block and session messages update
+     * the record parsers. The current block is sent for insertion afterwards if it is
+     * sufficiently full or a block hasn't been sent in a long enough time.
+     *
+     * @param msg The collector message
+     */
+    void process(ipx_msg_t *msg);
+
+    /**
+     * @brief Hand over messages to the converter thread.
+     *
+     * The vector is swapped with an empty one.
+     *
+     * @param msgs The collector messages
+     * @throws The exception captured during processing of previous messages, if any.
+     */
+    void post(std::vector<ipx_msg_t *> &msgs);
+
+    /**
+     * @brief Wait till the converter thread processes all the posted messages.
+     *
+     * @throws The exception captured during processing of the messages, if any.
+     */
+    void wait();
+
+    /**
+     * @brief Stop the converter thread (if running) and wait for it to finish.
+     */
+    void stop();
+
+    /**
+     * @brief Send the current block for insertion if it is not empty.
+     *
+     * Must not be called while the converter thread is running.
+     */
+    void flush();
+
+private:
+    int m_id; ///< Unique identifier for the converter.
+    Logger m_logger; ///< Logger instance for logging operations.
+    const Config &m_config; ///< Reference to the plugin configuration.
+    const std::vector<Column> &m_columns; ///< Reference to the vector of columns defining the table schema.
+    SyncQueue<Block *> &m_avail_blocks; ///< Reference to the queue of available blocks to be filled.
+    SyncQueue<Block *> &m_filled_blocks; ///< Reference to the queue of filled blocks to be inserted.
+    Stats &m_stats; ///< Reference to the plugin statistics.
+    SpillQueue *m_spill; ///< The spill queue, nullptr if spilling is disabled.
+
+    RecParserManager m_rec_parsers; ///< Record parsers of the sessions assigned to the converter.
+    Block *m_current_block = nullptr; ///< The block that is currently being filled.
+    std::time_t m_last_insert_time = 0; ///< When was the last block sent for insertion.
+
+    std::mutex m_mutex; ///< Mutex protecting the members below.
+    std::condition_variable m_cv; ///< Signals posted messages, processed messages and stop requests.
+    std::vector<ipx_msg_t *> m_posted; ///< Messages posted to the converter thread.
+    bool m_busy = false; ///< Whether the posted messages haven't been processed yet.
+    std::exception_ptr m_error = nullptr; ///< Exception thrown during processing of the messages.
+
+    void run() override;
+
+    void process_ipfix_msg(ipx_msg_ipfix_t *msg);
+
+    Block *spill_filled_block();
+
+    void process_session_msg(ipx_msg_session_t *msg);
+
+    int process_record(fds_drec &rec, Block &block);
+
+    void extract_values(RecParser &parser, Block &block, bool rev);
+
+    void check_block(std::time_t now);
+};
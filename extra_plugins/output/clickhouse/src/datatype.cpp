@@ -110,52 +110,40 @@ DataType find_common_type(const fds_iemgr_alias &alias)
 namespace getters {
 
 template <typename UIntType>
-static UIntType get_uint(fds_drec_field field)
+static bool get_uint(const uint8_t *data, uint16_t size, UIntType &value)
 {
-    uint64_t value = 0;
-    int ret = fds_get_uint_be(field.data, field.size, &value);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_uint_be() has failed: {}", ret);
+    uint64_t tmp;
+    if (fds_get_uint_be(data, size, &tmp) != FDS_OK) {
+        return false;
     }
-    return static_cast<UIntType>(value);
+    value = static_cast<UIntType>(tmp);
+    return true;
 }
 
 template <typename IntType>
-static IntType get_int(fds_drec_field field)
+static bool get_int(const uint8_t *data, uint16_t size, IntType &value)
 {
-    int64_t value = 0;
-    int ret = fds_get_int_be(field.data, field.size, &value);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_int_be() has failed: {}", ret);
+    int64_t tmp;
+    if (fds_get_int_be(data, size, &tmp) != FDS_OK) {
+        return false;
     }
-    return static_cast<IntType>(value);
+    value = static_cast<IntType>(tmp);
+    return true;
 }
 
-static IP4Addr get_ipv4(fds_drec_field field)
+static bool get_ipv4(const uint8_t *data, uint16_t size, IP4Addr &value)
 {
-    IP4Addr value;
-    int ret = fds_get_ip(field.data, field.size, &value.s_addr);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_ip() has failed: {}", ret);
-    }
-    return value;
+    return fds_get_ip(data, size, &value.s_addr) == FDS_OK;
 }
 
-static IP6Addr get_ipv6(fds_drec_field field)
+static bool get_ipv6(const uint8_t *data, uint16_t size, IP6Addr &value)
 {
-    IP6Addr value;
-    int ret = fds_get_ip(field.data, field.size, &value.s6_addr);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_ip() has failed: {}", ret);
-    }
-    return value;
+    return fds_get_ip(data, size, &value.s6_addr) == FDS_OK;
 }
 
-static IP6Addr get_ip(fds_drec_field field)
+static bool get_ip(const uint8_t *data, uint16_t size, IP6Addr &value)
 {
-    IP6Addr value;
-    int ret;
-    if (field.size == 4) {
+    if (size == 4) {
         static constexpr uint8_t IPV4_MAPPED_IPV6_PREFIX[]{
             0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00,
@@ -164,66 +152,54 @@ static IP6Addr get_ip(fds_drec_field field)
             reinterpret_cast<uint8_t *>(&value.s6_addr),
             IPV4_MAPPED_IPV6_PREFIX,
             sizeof(IPV4_MAPPED_IPV6_PREFIX));
-        ret = fds_get_ip(field.data, field.size, &reinterpret_cast<uint8_t *>(&value.s6_addr)[12]);
-    } else {
-        ret = fds_get_ip(field.data, field.size, &value.s6_addr);
+        return fds_get_ip(data, size, &reinterpret_cast<uint8_t *>(&value.s6_addr)[12]) == FDS_OK;
     }
-    if (ret != FDS_OK) {
-        throw Error("fds_get_ip() has failed: {}", ret);
-    }
-    return value;
-}
-
-static std::string_view get_string(fds_drec_field field)
-{
-    return std::string_view(reinterpret_cast<const char *>(field.data), field.size);
+    return fds_get_ip(data, size, &value.s6_addr) == FDS_OK;
 }
 
-static std::string_view get_octetarray(fds_drec_field field)
+static bool get_string(const uint8_t *data, uint16_t size, std::string_view &value)
 {
-    return std::string_view(reinterpret_cast<const char *>(field.data), field.size);
+    value = std::string_view(reinterpret_cast<const char *>(data), size);
+    return true;
 }
 
-static uint64_t get_datetime(fds_drec_field field)
+template <fds_iemgr_element_type Source>
+static bool get_datetime(const uint8_t *data, uint16_t size, uint64_t &value)
 {
-    uint64_t value = 0;
-    int ret = fds_get_datetime_lp_be(field.data, field.size, field.info->def->data_type, &value);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_datetime_lp_be() has failed: {}", ret);
+    uint64_t tmp;
+    if (fds_get_datetime_lp_be(data, size, Source, &tmp) != FDS_OK) {
+        return false;
     }
-    value /= 1000;
-    return value;
+    value = tmp / 1000;
+    return true;
 }
 
-template <int64_t Divisor = 1>
-static int64_t get_datetime64(fds_drec_field field)
+template <fds_iemgr_element_type Source, int64_t Divisor = 1>
+static bool get_datetime64(const uint8_t *data, uint16_t size, int64_t &value)
 {
-    int64_t value = 0;
     timespec ts;
-    int ret = fds_get_datetime_hp_be(field.data, field.size, field.info->def->data_type, &ts);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_datetime_hp_be() has failed: {}", ret);
+    if (fds_get_datetime_hp_be(data, size, Source, &ts) != FDS_OK) {
+        return false;
     }
     value = (static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<int64_t>(ts.tv_nsec)) / Divisor;
-    return value;
+    return true;
 }
 
-static uint64_t get_mac(fds_drec_field field)
+static bool get_mac(const uint8_t *data, uint16_t size, uint64_t &value)
 {
-    uint64_t value = 0;
-    fds_get_mac(field.data, field.size, reinterpret_cast<uint8_t *>(&value));
-    return value;
+    value = 0;
+    return fds_get_mac(data, size, reinterpret_cast<uint8_t *>(&value)) == FDS_OK;
 }
 
 template <typename FloatType>
-static FloatType get_float(fds_drec_field field)
+static bool get_float(const uint8_t *data, uint16_t size, FloatType &value)
 {
-    double value = 0;
-    int ret = fds_get_float_be(field.data, field.size, &value);
-    if (ret != FDS_OK) {
-        throw Error("fds_get_float_be() has failed: {}", ret);
+    double tmp;
+    if (fds_get_float_be(data, size, &tmp) != FDS_OK) {
+        return false;
     }
-    return static_cast<FloatType>(value);
+    value = static_cast<FloatType>(tmp);
+    return true;
 }
 }
 
@@ -315,99 +291,103 @@ std::shared_ptr<clickhouse::Column> make_column(DataType type, bool nullable)
     throw std::logic_error("unexpected datatype value");
 }
 
-ValueVariant get_value(DataType type, fds_drec_field& field)
+namespace appenders {
+
+template <typename ValueT>
+using Getter = bool (*)(const uint8_t *data, uint16_t size, ValueT &value);
+
+template <typename ColumnT, typename ValueT, Getter<ValueT> Get>
+static bool append(clickhouse::Column &column, const uint8_t *data, uint16_t size)
 {
-    switch (type) {
-    case DataType::UInt8:             return getters::get_uint<uint8_t>(field);
-    case DataType::UInt16:            return getters::get_uint<uint16_t>(field);
-    case DataType::UInt32:            return getters::get_uint<uint32_t>(field);
-    case DataType::UInt64:            return getters::get_uint<uint64_t>(field);
-    case DataType::Int8:              return getters::get_int<int8_t>(field);
-    case DataType::Int16:             return getters::get_int<int16_t>(field);
-    case DataType::Int32:             return getters::get_int<int32_t>(field);
-    case DataType::Int64:             return getters::get_int<int64_t>(field);
-    case DataType::IP:                return getters::get_ip(field);
-    case DataType::IPv4:              return getters::get_ipv4(field);
-    case DataType::IPv6:              return getters::get_ipv6(field);
-    case DataType::String:            return getters::get_string(field);
-    case DataType::DatetimeSecs:      return getters::get_datetime(field);
-    case DataType::DatetimeMillisecs: return getters::get_datetime64<1'000'000>(field);
-    case DataType::DatetimeMicrosecs: return getters::get_datetime64<1'000>(field);
-    case DataType::DatetimeNanosecs:  return getters::get_datetime64<1>(field);
-    case DataType::Mac:               return getters::get_mac(field);
-    case DataType::Float32:           return getters::get_float<float>(field);
-    case DataType::Float64:           return getters::get_float<double>(field);
-    case DataType::OctetArray:        return getters::get_octetarray(field);
-    case DataType::Invalid:           throw std::logic_error("invalid data type");
+    ValueT value{};
+    bool ok = (data == nullptr) || Get(data, size, value);
+    static_cast<ColumnT &>(column).Append(ok ? value : ValueT{});
+    return ok;
+}
+
+template <typename ColumnT, typename ValueT, Getter<ValueT> Get>
+static bool append_nullable(clickhouse::Column &column, const uint8_t *data, uint16_t size)
+{
+    auto &concrete_col = static_cast<clickhouse::ColumnNullableT<ColumnT> &>(column);
+    ValueT value{};
+    if (data != nullptr && Get(data, size, value)) {
+        concrete_col.Append(std::optional<ValueT>{value});
+        return true;
     }
+    concrete_col.Append(std::nullopt);
+    return data == nullptr;
+}
 
-    throw std::logic_error("unexpected datatype value");
+template <typename ColumnT, typename ValueT, Getter<ValueT> Get>
+static ColumnAppender make(bool nullable)
+{
+    return nullable ? &append_nullable<ColumnT, ValueT, Get> : &append<ColumnT, ValueT, Get>;
 }
 
-template <typename ColumnT, typename ValueT>
-static inline void column_append_nullable(clickhouse::Column& column, ValueVariant* value)
+template <typename ColumnT>
+static ColumnAppender make_datetime(bool nullable, fds_iemgr_element_type source)
 {
-    auto *concrete_col = reinterpret_cast<clickhouse::ColumnNullableT<ColumnT> *>(&column);
-    concrete_col->Append(value ? std::optional<ValueT>{std::get<ValueT>(*value)} : std::nullopt);
+    using getters::get_datetime;
+
+    switch (source) {
+    case FDS_ET_DATE_TIME_SECONDS:      return make<ColumnT, uint64_t, get_datetime<FDS_ET_DATE_TIME_SECONDS>>(nullable);
+    case FDS_ET_DATE_TIME_MILLISECONDS: return make<ColumnT, uint64_t, get_datetime<FDS_ET_DATE_TIME_MILLISECONDS>>(nullable);
+    case FDS_ET_DATE_TIME_MICROSECONDS: return make<ColumnT, uint64_t, get_datetime<FDS_ET_DATE_TIME_MICROSECONDS>>(nullable);
+    case FDS_ET_DATE_TIME_NANOSECONDS:  return make<ColumnT, uint64_t, get_datetime<FDS_ET_DATE_TIME_NANOSECONDS>>(nullable);
+    default:                            throw Error("cannot convert IPFIX data type {} to a datetime", source);
+    }
 }
 
-template <typename ColumnT, typename ValueT>
-static inline void column_append(clickhouse::Column& column, ValueVariant* value)
+template <typename ColumnT, int64_t Divisor>
+static ColumnAppender make_datetime64(bool nullable, fds_iemgr_element_type source)
 {
-    auto *concrete_col = reinterpret_cast<ColumnT *>(&column);
-    concrete_col->Append(value ? std::get<ValueT>(*value) : ValueT{});
+    using getters::get_datetime64;
+
+    switch (source) {
+    case FDS_ET_DATE_TIME_SECONDS:      return make<ColumnT, int64_t, get_datetime64<FDS_ET_DATE_TIME_SECONDS, Divisor>>(nullable);
+    case FDS_ET_DATE_TIME_MILLISECONDS: return make<ColumnT, int64_t, get_datetime64<FDS_ET_DATE_TIME_MILLISECONDS, Divisor>>(nullable);
+    case FDS_ET_DATE_TIME_MICROSECONDS: return make<ColumnT, int64_t, get_datetime64<FDS_ET_DATE_TIME_MICROSECONDS, Divisor>>(nullable);
+    case FDS_ET_DATE_TIME_NANOSECONDS:  return make<ColumnT, int64_t, get_datetime64<FDS_ET_DATE_TIME_NANOSECONDS, Divisor>>(nullable);
+    default:                            throw Error("cannot convert IPFIX data type {} to a datetime", source);
+    }
 }
 
-void write_to_column(DataType type, bool nullable, clickhouse::Column& column, ValueVariant* value)
+static ColumnAppender make_ip(bool nullable, fds_iemgr_element_type source)
 {
-    if (nullable) {
-        switch (type) {
-        case DataType::UInt8:             column_append_nullable<clickhouse::ColumnUInt8, uint8_t>(column, value); return;
-        case DataType::UInt16:            column_append_nullable<clickhouse::ColumnUInt16, uint16_t>(column, value); return;
-        case DataType::UInt32:            column_append_nullable<clickhouse::ColumnUInt32, uint32_t>(column, value); return;
-        case DataType::UInt64:            column_append_nullable<clickhouse::ColumnUInt64, uint64_t>(column, value); return;
-        case DataType::Int8:              column_append_nullable<clickhouse::ColumnInt8, int8_t>(column, value); return;
-        case DataType::Int16:             column_append_nullable<clickhouse::ColumnInt16, int16_t>(column, value); return;
-        case DataType::Int32:             column_append_nullable<clickhouse::ColumnInt32, int32_t>(column, value); return;
-        case DataType::Int64:             column_append_nullable<clickhouse::ColumnInt64, int64_t>(column, value); return;
-        case DataType::IP:                column_append_nullable<clickhouse::ColumnIPv6, IP6Addr>(column, value); return;
-        case DataType::IPv4:              column_append_nullable<clickhouse::ColumnIPv4, IP4Addr>(column, value); return;
-        case DataType::IPv6:              column_append_nullable<clickhouse::ColumnIPv6, IP6Addr>(column, value); return;
-        case DataType::String:            column_append_nullable<clickhouse::ColumnString, std::string_view>(column, value); return;
-        case DataType::DatetimeSecs:      column_append_nullable<clickhouse::ColumnDateTime, uint64_t>(column, value); return;
-        case DataType::DatetimeMillisecs: column_append_nullable<ColumnDateTime64<3>, int64_t>(column, value); return;
-        case DataType::DatetimeMicrosecs: column_append_nullable<ColumnDateTime64<6>, int64_t>(column, value); return;
-        case DataType::DatetimeNanosecs:  column_append_nullable<ColumnDateTime64<9>, int64_t>(column, value); return;
-        case DataType::Mac:               column_append_nullable<clickhouse::ColumnUInt64, uint64_t>(column, value); return;
-        case DataType::Float32:           column_append_nullable<clickhouse::ColumnFloat32, float>(column, value); return;
-        case DataType::Float64:           column_append_nullable<clickhouse::ColumnFloat64, double>(column, value); return;
-        case DataType::OctetArray:        column_append_nullable<clickhouse::ColumnString, std::string_view>(column, value); return;
-        case DataType::Invalid:           throw std::logic_error("invalid data type");
-        }
-    } else {
-        switch (type) {
-        case DataType::UInt8:             column_append<clickhouse::ColumnUInt8, uint8_t>(column, value); return;
-        case DataType::UInt16:            column_append<clickhouse::ColumnUInt16, uint16_t>(column, value); return;
-        case DataType::UInt32:            column_append<clickhouse::ColumnUInt32, uint32_t>(column, value); return;
-        case DataType::UInt64:            column_append<clickhouse::ColumnUInt64, uint64_t>(column, value); return;
-        case DataType::Int8:              column_append<clickhouse::ColumnInt8, int8_t>(column, value); return;
-        case DataType::Int16:             column_append<clickhouse::ColumnInt16, int16_t>(column, value); return;
-        case DataType::Int32:             column_append<clickhouse::ColumnInt32, int32_t>(column, value); return;
-        case DataType::Int64:             column_append<clickhouse::ColumnInt64, int64_t>(column, value); return;
-        case DataType::IP:                column_append<clickhouse::ColumnIPv6, IP6Addr>(column, value); return;
-        case DataType::IPv4:              column_append<clickhouse::ColumnIPv4, IP4Addr>(column, value); return;
-        case DataType::IPv6:              column_append<clickhouse::ColumnIPv6, IP6Addr>(column, value); return;
-        case DataType::String:            column_append<clickhouse::ColumnString, std::string_view>(column, value); return;
-        case DataType::DatetimeSecs:      column_append<clickhouse::ColumnDateTime, uint64_t>(column, value); return;
-        case DataType::DatetimeMillisecs: column_append<ColumnDateTime64<3>, int64_t>(column, value); return;
-        case DataType::DatetimeMicrosecs: column_append<ColumnDateTime64<6>, int64_t>(column, value); return;
-        case DataType::DatetimeNanosecs:  column_append<ColumnDateTime64<9>, int64_t>(column, value); return;
-        case DataType::Mac:               column_append<clickhouse::ColumnUInt64, uint64_t>(column, value); return;
-        case DataType::Float32:           column_append<clickhouse::ColumnFloat32, float>(column, value); return;
-        case DataType::Float64:           column_append<clickhouse::ColumnFloat64, double>(column, value); return;
-        case DataType::OctetArray:        column_append<clickhouse::ColumnString, std::string_view>(column, value); return;
-        case DataType::Invalid:           throw std::logic_error("invalid data type");
-        }
+    switch (source) {
+    case FDS_ET_IPV6_ADDRESS: return make<clickhouse::ColumnIPv6, IP6Addr, getters::get_ipv6>(nullable);
+    default:                  return make<clickhouse::ColumnIPv6, IP6Addr, getters::get_ip>(nullable);
+    }
+}
+}
+
+ColumnAppender make_appender(DataType type, bool nullable, fds_iemgr_element_type source)
+{
+    using namespace getters;
+    using appenders::make;
+
+    switch (type) {
+    case DataType::UInt8:             return make<clickhouse::ColumnUInt8, uint8_t, get_uint<uint8_t>>(nullable);
+    case DataType::UInt16:            return make<clickhouse::ColumnUInt16, uint16_t, get_uint<uint16_t>>(nullable);
+    case DataType::UInt32:            return make<clickhouse::ColumnUInt32, uint32_t, get_uint<uint32_t>>(nullable);
+    case DataType::UInt64:            return make<clickhouse::ColumnUInt64, uint64_t, get_uint<uint64_t>>(nullable);
+    case DataType::Int8:              return make<clickhouse::ColumnInt8, int8_t, get_int<int8_t>>(nullable);
+    case DataType::Int16:             return make<clickhouse::ColumnInt16, int16_t, get_int<int16_t>>(nullable);
+    case DataType::Int32:             return make<clickhouse::ColumnInt32, int32_t, get_int<int32_t>>(nullable);
+    case DataType::Int64:             return make<clickhouse::ColumnInt64, int64_t, get_int<int64_t>>(nullable);
+    case DataType::IP:                return appenders::make_ip(nullable, source);
+    case DataType::IPv4:              return make<clickhouse::ColumnIPv4, IP4Addr, get_ipv4>(nullable);
+    case DataType::IPv6:              return make<clickhouse::ColumnIPv6, IP6Addr, get_ipv6>(nullable);
+    case DataType::String:            return make<clickhouse::ColumnString, std::string_view, get_string>(nullable);
+    case DataType::DatetimeSecs:      return appenders::make_datetime<clickhouse::ColumnDateTime>(nullable, source);
+    case DataType::DatetimeMillisecs: return appenders::make_datetime64<ColumnDateTime64<3>, 1'000'000>(nullable, source);
+    case DataType::DatetimeMicrosecs: return appenders::make_datetime64<ColumnDateTime64<6>, 1'000>(nullable, source);
+    case DataType::DatetimeNanosecs:  return appenders::make_datetime64<ColumnDateTime64<9>, 1>(nullable, source);
+    case DataType::Mac:               return make<clickhouse::ColumnUInt64, uint64_t, get_mac>(nullable);
+    case DataType::Float32:           return make<clickhouse::ColumnFloat32, float, get_float<float>>(nullable);
+    case DataType::Float64:           return make<clickhouse::ColumnFloat64, double, get_float<double>>(nullable);
+    case DataType::OctetArray:        return make<clickhouse::ColumnString, std::string_view, get_string>(nullable);
+    case DataType::Invalid:           throw std::logic_error("invalid data type");
     }
 
     throw std::logic_error("unexpected datatype value");
@@ -17,7 +17,6 @@
 
 #include <stdexcept>
 #include <string>
-#include <variant>
 
 
 /** An intermediary data type used for conversions between IPFIX and ClickHouse types */
@@ -164,23 +163,6 @@ std::string type_to_clickhouse(DataType type, bool nullable);
 DataType find_common_type(const fds_iemgr_alias &alias);
 
 
-using ValueVariant = std::variant<
-    std::monostate,
-    uint8_t,
-    uint16_t,
-    uint32_t,
-    uint64_t,
-    int8_t,
-    int16_t,
-    int32_t,
-    int64_t,
-    IP4Addr,
-    IP6Addr,
-    float,
-    double,
-    std::string_view
->;
-
 /**
  * @brief Make a ClickHouse column that is able to store values of the supplied data type
  *
@@ -191,30 +173,28 @@ using ValueVariant = std::variant<
 std::shared_ptr<clickhouse::Column> make_column(DataType type, bool nullable);
 
 /**
- * @brief An error thrown when the conversion from IPFIX to ClickHouse representation fails.
- */
-class ConversionError : public std::runtime_error {
-public:
-    using std::runtime_error::runtime_error;
-};
-
-/**
- * Retrieves the value of a specific data type from the given field.
+ * @brief A function converting a field value and appending it to a ClickHouse column.
  *
- * @param type The data type to retrieve.
- * @param field The field from which the value is extracted.
- * @return A variant containing the value of the specified data type.
+ * The appender is bound to the concrete type of the column, i.e. the column must be the one
+ * created by make_column() with the same data type and nullability.
  *
- * @throws ConversionError if the conversion fails.
+ * @param column The ClickHouse column to which the value is written.
+ * @param data The field value or nullptr if the field is not present in the record.
+ * @param size The size of the field value.
+ * @return False if the conversion failed and a default value (or NULL) has been appended
+ *         instead, otherwise true.
  */
-ValueVariant get_value(DataType type, fds_drec_field& field);
+using ColumnAppender = bool (*)(clickhouse::Column &column, const uint8_t *data, uint16_t size);
 
 /**
- * Writes a value to a ClickHouse column.
+ * @brief Make an appender converting values of an IPFIX element to the supplied data type
  *
- * @param type The data type of the value.
- * @param nullable Indicates whether the column allows null values.
- * @param column The ClickHouse column to which the value is written.
- * @param value A pointer to the value to be written.
+ * The appender is meant to be resolved once per template so that no dispatch on the data type
+ * is performed for each value.
+ *
+ * @param type The data type of the column
+ * @param nullable Whether the column is nullable or not
+ * @param source The IPFIX type of the element providing the values
+ * @return The appender
  */
-void write_to_column(DataType type, bool nullable, clickhouse::Column& column, ValueVariant* value);
+ColumnAppender make_appender(DataType type, bool nullable, fds_iemgr_element_type source);
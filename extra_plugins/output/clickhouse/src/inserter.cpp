@@ -87,7 +87,8 @@ Inserter::Inserter(
         std::string table_name,
         const std::vector<Column> &columns,
         SyncQueue<Block *> &input_blocks,
-        SyncQueue<Block *> &avail_blocks)
+        SyncQueue<Block *> &avail_blocks,
+        SpillQueue *spill)
     : m_id(id)
     , m_logger(logger)
     , m_client_opts(client_opts)
@@ -95,6 +96,7 @@ Inserter::Inserter(
     , m_columns(columns)
     , m_input_blocks(input_blocks)
     , m_avail_blocks(avail_blocks)
+    , m_spill(spill)
 {}
 
 bool Inserter::insert(clickhouse::Block &block)
@@ -158,6 +160,11 @@ void Inserter::run()
             break;
         }
 
+        if (m_spill) {
+            // The rows are in the database now, the segment they were replayed from is not needed
+            m_spill->commit(*block);
+        }
+
         for (auto &column : block->columns) {
             column->Clear();
         }
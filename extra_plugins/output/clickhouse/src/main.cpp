@@ -63,11 +63,11 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *priv)
 }
 
 int
-ipx_plugin_process(ipx_ctx_t *ctx, void *priv, ipx_msg_t *msg)
+ipx_plugin_process_batch(ipx_ctx_t *ctx, void *priv, ipx_msg_t **msgs, size_t cnt)
 {
     Plugin *plugin = reinterpret_cast<Plugin *>(priv);
     try {
-        plugin->process(msg);
+        plugin->process_batch(msgs, cnt);
     } catch (const std::exception &ex) {
         IPX_CTX_ERROR(ctx, "An unexpected exception has occured: %s", ex.what());
         return IPX_ERR_DENIED;
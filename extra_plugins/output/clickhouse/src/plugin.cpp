@@ -70,7 +70,6 @@ Plugin::Plugin(ipx_ctx_t *ctx, const char *xml_config)
     }
 
     m_columns = prepare_columns(m_config.columns);
-    m_rec_parsers = std::make_unique<RecParserManager>(m_columns, m_config.biflow_empty_autoignore);
 
     // Prepare blocks
     for (unsigned int i = 0; i < m_config.blocks; i++) {
@@ -83,6 +82,20 @@ Plugin::Plugin(ipx_ctx_t *ctx, const char *xml_config)
         m_avail_blocks.put(m_blocks.back().get());
     }
 
+    // Prepare spill queue
+    if (!m_config.spill_directory.empty()) {
+        m_spill = std::make_unique<SpillQueue>(
+            m_logger,
+            m_config.spill_directory,
+            m_config.spill_max_size_mb * 1024 * 1024,
+            m_columns,
+            m_avail_blocks,
+            m_filled_blocks,
+            m_config.converter_threads,
+            m_config.inserter_threads,
+            m_stats);
+    }
+
     // Prepare inserters
     for (unsigned int i = 0; i < m_config.inserter_threads; i++) {
         clickhouse::ClientOptions client_opts = clickhouse::ClientOptions()
@@ -97,162 +110,150 @@ Plugin::Plugin(ipx_ctx_t *ctx, const char *xml_config)
             m_config.connection.table,
             m_columns,
             m_filled_blocks,
-            m_avail_blocks);
+            m_avail_blocks,
+            m_spill.get());
 
         m_inserters.emplace_back(std::move(ins));
     }
 
+    // Prepare converters
+    for (unsigned int i = 0; i < m_config.converter_threads; i++) {
+        std::unique_ptr<Converter> conv = std::make_unique<Converter>(
+            i,
+            m_logger,
+            m_config,
+            m_columns,
+            m_avail_blocks,
+            m_filled_blocks,
+            m_stats,
+            m_spill.get());
+
+        m_converters.emplace_back(std::move(conv));
+    }
+    m_converter_msgs.resize(m_converters.size());
+    m_converter_sessions.resize(m_converters.size(), 0);
+
     m_logger.info("Starting inserters");
     for (auto &ins : m_inserters) {
         ins->start();
     }
 
-
-    m_logger.info("ClickHouse plugin is ready");
-}
-
-void Plugin::extract_values(ipx_msg_ipfix_t *msg, RecParser &parser, Block &block, bool rev)
-{
-    std::size_t n_columns = m_columns.size();
-    bool has_value;
-    ValueVariant value;
-
-    for (std::size_t i = 0; i < n_columns; i++) {
-        has_value = false;
-
-        if (m_columns[i].special == SpecialField::ODID) {
-            value = ipx_msg_ipfix_get_ctx(msg)->odid;
-            has_value = true;
-
-        } else {
-            fds_drec_field &field = parser.get_column(i, rev);
-            if (field.data != nullptr) {
-                try {
-                    value = get_value(m_columns[i].datatype, field);
-                    has_value = true;
-                } catch (const ConversionError& err) {
-                    m_logger.error("Field conversion failed (field #%d, \"%s\"): %s", i, m_columns[i].name, err.what());
-                }
-            }
-        }
-
-        write_to_column(m_columns[i].datatype, m_columns[i].nullable, *block.columns[i].get(), has_value ? &value : nullptr);
+    if (m_spill) {
+        m_logger.info("Starting spill replay");
+        m_spill->start();
     }
-    block.rows++;
-}
 
-int
-Plugin::process_record(ipx_msg_ipfix_t *msg, fds_drec &rec, Block &block)
-{
-    int ret = 0;
-    RecParser &parser = m_rec_parsers->get_parser(rec.tmplt);
-    parser.parse_record(rec);
-
-    if (!parser.skip_fwd()) {
-        extract_values(msg, parser, block, false);
-        ret++;
+    if (m_converters.size() > 1) {
+        // With a single converter, records are converted directly on the plugin thread
+        m_logger.info("Starting converters");
+        for (auto &conv : m_converters) {
+            conv->start();
+        }
     }
 
-    if (!parser.skip_rev()) {
-        extract_values(msg, parser, block, true);
-        ret++;
-    }
 
-    return ret;
+    m_logger.info("ClickHouse plugin is ready");
 }
 
-void
-Plugin::process_session_msg(ipx_msg_session_t *msg)
+std::size_t
+Plugin::session_owner(const ipx_session *sess)
 {
-    if (ipx_msg_session_get_event(msg) == IPX_MSG_SESSION_CLOSE) {
-        const ipx_session *sess = ipx_msg_session_get_session(msg);
-        m_rec_parsers->delete_session(sess);
+    auto it = m_session_owners.find(sess);
+    if (it != m_session_owners.end()) {
+        return it->second;
     }
+
+    // Assign the session to the converter with the least sessions
+    std::size_t owner = 0;
+    for (std::size_t i = 1; i < m_converter_sessions.size(); i++) {
+        if (m_converter_sessions[i] < m_converter_sessions[owner]) {
+            owner = i;
+        }
+    }
+    m_converter_sessions[owner]++;
+    m_session_owners.emplace(sess, owner);
+    m_logger.debug("Session \"%s\" assigned to converter %zu", sess->ident, owner);
+    return owner;
 }
 
 void
-Plugin::process_ipfix_msg(ipx_msg_ipfix_t *msg)
+Plugin::dispatch_batch(ipx_msg_t **msgs, std::size_t cnt)
 {
-    // get new block if we don't have one
-    if (m_current_block == nullptr) {
-        if (m_config.nonblocking) {
-            std::optional<Block *> maybe_block = m_avail_blocks.try_get();
-            if (maybe_block.has_value()) {
-                m_current_block = maybe_block.value();
-            } else {
-                // no available blocks and we are in a non-blocking mode, drop the message
-                uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
-                m_stats.add_dropped(drec_cnt);
-                return;
+    for (std::size_t i = 0; i < cnt; i++) {
+        ipx_msg_t *msg = msgs[i];
+
+        if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+            const ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg));
+            m_converter_msgs[session_owner(msg_ctx->session)].push_back(msg);
+
+        } else if (ipx_msg_get_type(msg) == IPX_MSG_SESSION) {
+            ipx_msg_session_t *session_msg = ipx_msg_base2session(msg);
+            const ipx_session *sess = ipx_msg_session_get_session(session_msg);
+            std::size_t owner = session_owner(sess);
+            m_converter_msgs[owner].push_back(msg);
+
+            if (ipx_msg_session_get_event(session_msg) == IPX_MSG_SESSION_CLOSE) {
+                m_session_owners.erase(sess);
+                m_converter_sessions[owner]--;
             }
+
         } else {
-            m_current_block = m_avail_blocks.get();
+            // Periodic messages let all converters send their blocks on timeout
+            for (auto &conv_msgs : m_converter_msgs) {
+                conv_msgs.push_back(msg);
+            }
         }
     }
 
-    // setup rec parser
-    const ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
-    if (msg_ctx->session->type == FDS_SESSION_SCTP) {
-        throw std::runtime_error("SCTP is not supported at this time");
+    // The messages must not be referenced after return, so wait for all the converters
+    for (std::size_t i = 0; i < m_converters.size(); i++) {
+        if (!m_converter_msgs[i].empty()) {
+            m_converters[i]->post(m_converter_msgs[i]);
+        }
     }
-    m_rec_parsers->select_session(msg_ctx->session);
-    m_rec_parsers->select_odid(msg_ctx->odid);
-
-    // go through all the records
-    uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
-    uint32_t rows_count = 0;
-    for (uint32_t idx = 0; idx < drec_cnt; idx++) {
-        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, idx);
-        uint32_t rows_inserted = process_record(msg, rec->rec, *m_current_block);
-        rows_count += rows_inserted;
+    for (auto &conv : m_converters) {
+        conv->wait();
     }
-
-    m_stats.add_recs(drec_cnt);
-    m_stats.add_rows(rows_count);
 }
 
 void
-Plugin::process(ipx_msg_t *msg)
+Plugin::process_batch(ipx_msg_t **msgs, std::size_t cnt)
 {
-    if (ipx_msg_get_type(msg) == IPX_MSG_SESSION) {
-        process_session_msg(ipx_msg_base2session(msg));
-
-    } else if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
-        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
-        process_ipfix_msg(ipfix_msg);
-    }
-
-    time_t now = std::time(nullptr);
-
-    // Send the block for insertion if it is sufficiently full or a block hasn't been sent in a long enough time
-    if (m_current_block) {
-        bool nonempty = m_current_block->rows > 0;
-        bool thresh_reached = m_current_block->rows >= m_config.block_insert_threshold;
-        bool timeout_reached = uint64_t(now - m_last_insert_time) >= m_config.block_insert_max_delay_secs;
-
-        if (nonempty && (thresh_reached || timeout_reached)) {
-            m_filled_blocks.put(m_current_block);
-            m_current_block = nullptr;
-            m_last_insert_time = now;
+    if (m_converters.size() == 1) {
+        for (std::size_t i = 0; i < cnt; i++) {
+            m_converters[0]->process(msgs[i]);
         }
+    } else {
+        dispatch_batch(msgs, cnt);
     }
 
     // Print stats
+    time_t now = std::time(nullptr);
     m_stats.print_stats_throttled(now);
 
     // Check for any exceptions thrown by workers
     for (auto &ins : m_inserters) {
         ins->check_error();
     }
-
+    if (m_spill) {
+        m_spill->check_error();
+    }
 }
 
 void Plugin::stop()
 {
-    // Export what's left in the last block
-    if (m_current_block && m_current_block->rows > 0) {
-        m_filled_blocks.put(m_current_block);
-        m_current_block = nullptr;
+    // Stop the converters and export what's left in their last blocks
+    for (auto &conv : m_converters) {
+        conv->stop();
+    }
+    for (auto &conv : m_converters) {
+        conv->flush();
+    }
+
+    // Segments that are not replayed by now stay on the disk for the next run
+    if (m_spill) {
+        m_spill->request_stop();
+        m_spill->join();
     }
 
     // Stop all the threads and wait for them to finish
@@ -273,6 +274,9 @@ void Plugin::stop()
 
     std::size_t drop_count = 0;
     for (const auto& block : m_blocks) {
+        if (block->rows > 0 && m_spill && m_spill->store(*block)) {
+            continue;
+        }
         drop_count += block->rows;
     }
     m_logger.warning("%zu rows could not have been inserted and have been dropped due to termination timeout",
@@ -15,13 +15,17 @@
 #include "column.h"
 #include "common.h"
 #include "config.h"
+#include "converter.h"
 #include "inserter.h"
 #include "recparser.h"
+#include "spill.h"
 #include "stats.h"
 
 #include <ipfixcol2.h>
 #include <libfds.h>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 
 /**
@@ -39,11 +43,15 @@ public:
     Plugin(ipx_ctx_t *ctx, const char *xml_config);
 
     /**
-     * @brief Process a collector message
+     * @brief Process a batch of collector messages
      *
-     * @param msg The collector message
+     * The records are converted by the converters and the messages are not referenced anymore
+     * once the function returns.
+     *
+     * @param msgs The collector messages
+     * @param cnt The number of messages
      */
-    void process(ipx_msg_t *msg);
+    void process_batch(ipx_msg_t **msgs, std::size_t cnt);
 
     /**
      * @brief Stop the plugin and wait till it is stopped (blocking)
@@ -64,23 +72,18 @@ private:
     SyncQueue<Block *> m_avail_blocks;
     SyncQueue<Block *> m_filled_blocks;
 
-    Block *m_current_block = nullptr;
-
     Stats m_stats;
 
-    std::time_t m_last_insert_time = 0;
-
-    std::unique_ptr<RecParserManager> m_rec_parsers;
+    std::unique_ptr<SpillQueue> m_spill;
 
-    void
-    process_ipfix_msg(ipx_msg_ipfix_t *msg);
-
-    void
-    process_session_msg(ipx_msg_session_t *msg);
+    std::vector<std::unique_ptr<Converter>> m_converters;
+    std::vector<std::vector<ipx_msg_t *>> m_converter_msgs;
+    std::unordered_map<const ipx_session *, std::size_t> m_session_owners;
+    std::vector<std::size_t> m_converter_sessions;
 
-    int
-    process_record(ipx_msg_ipfix_t *msg, fds_drec &rec, Block &block);
+    std::size_t
+    session_owner(const ipx_session *sess);
 
     void
-    extract_values(ipx_msg_ipfix_t *msg, RecParser &parser, Block &block, bool rev);
+    dispatch_batch(ipx_msg_t **msgs, std::size_t cnt);
 };
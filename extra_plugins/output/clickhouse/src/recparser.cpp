@@ -10,7 +10,9 @@
 
 #include "recparser.h"
 
+#include <arpa/inet.h>
 #include <cassert>
+#include <cstring>
 
 static int index_of_elem(const fds_iemgr_elem &elem, const fds_template &tmplt, bool rev)
 {
@@ -42,26 +44,49 @@ static int index_of_alias(const fds_iemgr_alias &alias, const fds_template &tmpl
     return -1;
 }
 
+static constexpr uint32_t IANA_EN = 0;
+static constexpr uint32_t IANA_EN_REVERSE = 29305;
+static constexpr uint16_t IANA_OCTET_DELTA_COUNT_ID = 1;
+static constexpr uint16_t IANA_PACKET_DELTA_COUNT_ID = 2;
+
+static bool is_skip_field(const fds_tfield &field, bool rev)
+{
+    uint32_t en = !rev ? IANA_EN : IANA_EN_REVERSE;
+    return field.en == en && (field.id == IANA_OCTET_DELTA_COUNT_ID || field.id == IANA_PACKET_DELTA_COUNT_ID);
+}
+
+static bool is_zero(const uint8_t *data, uint16_t size)
+{
+    uint64_t value;
+    return fds_get_uint_be(data, size, &value) == FDS_OK && value == 0;
+}
+
 static bool is_skip(fds_drec_field &field, bool rev)
 {
-    static constexpr uint32_t IANA_EN = 0;
-    static constexpr uint32_t IANA_EN_REVERSE = 29305;
-    static constexpr uint16_t IANA_OCTET_DELTA_COUNT_ID = 1;
-    static constexpr uint16_t IANA_PACKET_DELTA_COUNT_ID = 2;
+    return is_skip_field(*field.info, rev) && is_zero(field.data, field.size);
+}
 
-    uint32_t en = !rev ? IANA_EN : IANA_EN_REVERSE;
-    if (field.info->en == en &&
-            (field.info->id == IANA_OCTET_DELTA_COUNT_ID || field.info->id == IANA_PACKET_DELTA_COUNT_ID)
-    ) {
-        uint64_t value;
-        if (fds_get_uint_be(field.data, field.size, &value) == FDS_OK && value == 0) {
-            return true;
+static fds_iemgr_element_type source_type(const Column &column, const fds_tfield *field)
+{
+    if (column.special == SpecialField::ODID) {
+        return FDS_ET_UNSIGNED_32;
+    }
+    if (column.elem) {
+        return column.elem->data_type;
+    }
+
+    // Find the alias source the field belongs to
+    const fds_iemgr_alias &alias = *column.alias;
+    for (std::size_t i = 0; field && i < alias.sources_cnt; i++) {
+        if (field->en == alias.sources[i]->scope->pen && field->id == alias.sources[i]->id) {
+            return alias.sources[i]->data_type;
         }
     }
-    return false;
+    return alias.sources[0]->data_type;
 }
 
-RecParser::RecParser(const std::vector<Column> &columns, const fds_template *tmplt, bool biflow_autoignore)
+RecParser::RecParser(const std::vector<Column> &columns, const fds_template *tmplt, uint32_t odid,
+                     bool biflow_autoignore)
 {
     m_tmplt.reset(fds_template_copy(tmplt));
     if (!m_tmplt) {
@@ -70,9 +95,15 @@ RecParser::RecParser(const std::vector<Column> &columns, const fds_template *tmp
 
     m_biflow = tmplt->flags & FDS_TEMPLATE_BIFLOW;
     m_biflow_autoignore = biflow_autoignore;
+    m_dynamic = tmplt->flags & FDS_TEMPLATE_DYNAMIC;
+
+    uint32_t odid_be = htonl(odid);
+    std::memcpy(m_odid, &odid_be, sizeof(m_odid));
 
     m_fields.resize(columns.size(), fds_drec_field{nullptr, 0, nullptr});
     m_fields_rev.resize(columns.size(), fds_drec_field{nullptr, 0, nullptr});
+    m_appenders.resize(columns.size(), nullptr);
+    m_appenders_rev.resize(columns.size(), nullptr);
     m_mapping.resize(tmplt->fields_cnt_total, -1);
     m_mapping_rev.resize(tmplt->fields_cnt_total, -1);
 
@@ -88,6 +119,8 @@ RecParser::RecParser(const std::vector<Column> &columns, const fds_template *tmp
         } else if (column.alias) {
             field_idx = index_of_alias(*column.alias, *tmplt, false);
             rev_field_idx = index_of_alias(*column.alias, *tmplt, true);
+        } else if (column.special == SpecialField::ODID) {
+            m_odid_columns.push_back(column_idx);
         }
 
         if (field_idx != -1) {
@@ -106,8 +139,34 @@ RecParser::RecParser(const std::vector<Column> &columns, const fds_template *tmp
             }
         }
 
+        const fds_tfield *field = (field_idx != -1) ? &tmplt->fields[field_idx] : nullptr;
+        const fds_tfield *rev_field = (rev_field_idx != -1) ? &tmplt->fields_rev[rev_field_idx] : nullptr;
+        m_appenders[column_idx] = make_appender(column.datatype, column.nullable, source_type(column, field));
+        m_appenders_rev[column_idx] = make_appender(column.datatype, column.nullable, source_type(column, rev_field));
+
         column_idx++;
     }
+
+    if (!m_dynamic) {
+        // All fields are at fixed offsets, so there is no need to iterate over the records
+        m_offset_fields.resize(columns.size(), -1);
+        m_offset_fields_rev.resize(columns.size(), -1);
+
+        for (std::size_t i = 0; i < tmplt->fields_cnt_total; i++) {
+            if (m_mapping[i] != -1) {
+                m_offset_fields[m_mapping[i]] = i;
+            }
+            if (m_mapping_rev[i] != -1) {
+                m_offset_fields_rev[m_mapping_rev[i]] = i;
+            }
+            if (is_skip_field(tmplt->fields[i], false)) {
+                m_skip_fields_fwd.push_back(i);
+            }
+            if (is_skip_field(tmplt->fields[i], true)) {
+                m_skip_fields_rev.push_back(i);
+            }
+        }
+    }
 }
 
 const fds_template *RecParser::tmplt() const
@@ -124,6 +183,59 @@ void RecParser::parse_record(fds_drec &rec)
         m_skip_flag_rev = true;
     }
 
+    if (m_dynamic) {
+        parse_dynamic(rec);
+    } else {
+        parse_fixed(rec);
+    }
+
+    for (std::size_t idx : m_odid_columns) {
+        m_fields[idx] = fds_drec_field{m_odid, sizeof(m_odid), nullptr};
+        m_fields_rev[idx] = fds_drec_field{m_odid, sizeof(m_odid), nullptr};
+    }
+}
+
+void RecParser::parse_fixed(fds_drec &rec)
+{
+    const fds_template *tmplt = m_tmplt.get();
+    std::size_t n_columns = m_fields.size();
+
+    for (std::size_t i = 0; i < n_columns; i++) {
+        int idx = m_offset_fields[i];
+        if (idx != -1) {
+            const fds_tfield &tfield = tmplt->fields[idx];
+            m_fields[i] = fds_drec_field{rec.data + tfield.offset, tfield.length, &tfield};
+        } else {
+            m_fields[i] = fds_drec_field{nullptr, 0, nullptr};
+        }
+    }
+
+    if (!m_biflow) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < n_columns; i++) {
+        int idx = m_offset_fields_rev[i];
+        if (idx != -1) {
+            const fds_tfield &tfield = tmplt->fields_rev[idx];
+            m_fields_rev[i] = fds_drec_field{rec.data + tfield.offset, tfield.length, &tfield};
+        } else {
+            m_fields_rev[i] = fds_drec_field{nullptr, 0, nullptr};
+        }
+    }
+
+    if (m_biflow_autoignore) {
+        for (int idx : m_skip_fields_fwd) {
+            m_skip_flag_fwd |= is_zero(rec.data + tmplt->fields[idx].offset, tmplt->fields[idx].length);
+        }
+        for (int idx : m_skip_fields_rev) {
+            m_skip_flag_rev |= is_zero(rec.data + tmplt->fields[idx].offset, tmplt->fields[idx].length);
+        }
+    }
+}
+
+void RecParser::parse_dynamic(fds_drec &rec)
+{
     for (fds_drec_field &field : m_fields) {
         field = fds_drec_field{nullptr, 0, nullptr};
     }
@@ -152,13 +264,6 @@ void RecParser::parse_record(fds_drec &rec)
     }
 }
 
-fds_drec_field &RecParser::get_column(std::size_t idx, bool rev)
-{
-    assert((!rev && idx < m_fields.size()) || (rev && idx < m_fields_rev.size()));
-    assert(!rev || m_biflow);
-    return rev ? m_fields_rev[idx] : m_fields[idx];
-}
-
 bool RecParser::skip_fwd() const
 {
     return m_skip_flag_fwd;
@@ -183,6 +288,7 @@ void RecParserManager::select_odid(uint32_t odid)
 {
     assert(m_active_session != nullptr);
     m_active_odid = &(*m_active_session)[odid];
+    m_odid = odid;
 }
 
 void RecParserManager::delete_session(const ipx_session *sess)
@@ -197,7 +303,7 @@ RecParser &RecParserManager::get_parser(const fds_template *tmplt)
     assert(m_active_session != nullptr && m_active_odid != nullptr);
     auto it = m_active_odid->find(tmplt->id);
     if (it == m_active_odid->end() || fds_template_cmp(it->second.tmplt(), tmplt) != 0) {
-        auto [it, _] = m_active_odid->insert_or_assign(tmplt->id, RecParser(m_columns, tmplt, m_biflow_autoignore));
+        auto [it, _] = m_active_odid->insert_or_assign(tmplt->id, RecParser(m_columns, tmplt, m_odid, m_biflow_autoignore));
         return it->second;
     }
     return it->second;
@@ -11,6 +11,8 @@
 #pragma once
 
 #include "column.h"
+#include "datatype.h"
+#include <cassert>
 #include <ipfixcol2.h>
 #include <libfds.h>
 #include <vector>
@@ -28,11 +30,16 @@ public:
     /**
      * @brief Constructs a RecParser instance.
      *
+     * Column appenders are bound to the fields of the template here, so that no dispatch on the
+     * data types is required when records are processed.
+     *
      * @param columns A vector of Column objects.
      * @param tmplt A pointer to the template used for parsing.
+     * @param odid The ODID of the records (value of the ODID special field).
      * @param biflow_autoignore Whether to automatically ignore empty biflow records.
      */
-    RecParser(const std::vector<Column>& columns, const fds_template *tmplt, bool biflow_autoignore);
+    RecParser(const std::vector<Column>& columns, const fds_template *tmplt, uint32_t odid,
+              bool biflow_autoignore);
 
     /**
      * @brief Parses a data record and maps its fields to columns.
@@ -42,18 +49,24 @@ public:
     void parse_record(fds_drec &rec);
 
     /**
-     * @brief Retrieves the field corresponding to a specific column.
+     * @brief Appends the value of a specific column of the parsed record to a ClickHouse column.
      *
-     * If the field was not found in the record, the returned field points to
-     * NULL and has size of 0.
+     * If the field was not found in the record, a default value (or NULL) is appended.
      *
      * If the provided index is outside of bounds, the behavior is undefined.
      *
      * @param idx The index of the column.
-     * @param rev Whether to retrieve the reverse field (for biflow templates).
-     * @return A reference to the corresponding field.
+     * @param column The ClickHouse column made for the column configuration.
+     * @param rev Whether to append the reverse field (for biflow templates).
+     * @return False if the conversion of the value failed, otherwise true.
      */
-    fds_drec_field& get_column(std::size_t idx, bool rev = false);
+    bool append_column(std::size_t idx, clickhouse::Column &column, bool rev = false) const
+    {
+        assert(!rev || m_biflow);
+        const fds_drec_field &field = rev ? m_fields_rev[idx] : m_fields[idx];
+        ColumnAppender append = rev ? m_appenders_rev[idx] : m_appenders[idx];
+        return append(column, field.data, field.size);
+    }
 
     /**
      * @brief Checks whether the forward direction of a biflow should be skipped.
@@ -83,6 +96,20 @@ private:
     std::vector<int> m_mapping_rev; // Index of field in drec -> index of field in the reverse field vec.
     std::vector<fds_drec_field> m_fields; // Field for the nth column.
     std::vector<fds_drec_field> m_fields_rev; // Reverse field for the nth column.
+    std::vector<ColumnAppender> m_appenders; // Appender for the nth column.
+    std::vector<ColumnAppender> m_appenders_rev; // Reverse appender for the nth column.
+
+    bool m_dynamic; // Indicates whether the template has variable-length fields.
+    std::vector<int> m_offset_fields; // Index of column -> index of field in drec (fixed offsets only).
+    std::vector<int> m_offset_fields_rev; // Index of column -> index of reverse field in drec (fixed offsets only).
+    std::vector<int> m_skip_fields_fwd; // Fields checked by the fwd skip check (fixed offsets only).
+    std::vector<int> m_skip_fields_rev; // Fields checked by the rev skip check (fixed offsets only).
+
+    uint8_t m_odid[4]; // ODID in network byte order, the source of the ODID special field.
+    std::vector<std::size_t> m_odid_columns; // Indices of the ODID special columns.
+
+    void parse_fixed(fds_drec &rec);
+    void parse_dynamic(fds_drec &rec);
 };
 
 /**
@@ -141,6 +168,7 @@ private:
     bool m_biflow_autoignore; ///< Whether to automatically ignore biflow records.
 
     TemplateMap *m_active_odid = nullptr; ///< Pointer to the active TemplateMap.
+    uint32_t m_odid = 0; ///< The active ODID.
     OdidMap *m_active_session = nullptr; ///< Pointer to the active OdidMap.
     SessionMap m_sessions; ///< Map of sessions to their associated ODID maps.
 };
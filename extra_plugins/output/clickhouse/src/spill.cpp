@@ -0,0 +1,321 @@
+/**
+ * @file
+ * @brief On-disk queue of blocks that could not have been inserted in time
+ * @date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "spill.h"
+#include "datatype.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+static constexpr int REPLAY_POLL_INTERVAL_MS = 100;
+static constexpr char SEGMENT_MAGIC[8] = {'I', 'P', 'X', 'C', 'H', 'S', '0', '1'};
+static constexpr const char *SEGMENT_EXTENSION = ".seg";
+static constexpr const char *SEGMENT_TMP_EXTENSION = ".tmp";
+static constexpr const char *SEGMENT_INVALID_EXTENSION = ".invalid";
+
+SpillQueue::SpillQueue(
+        Logger logger,
+        std::string directory,
+        uint64_t max_bytes,
+        const std::vector<Column> &columns,
+        SyncQueue<Block *> &avail_blocks,
+        SyncQueue<Block *> &filled_blocks,
+        std::size_t reserved_blocks,
+        std::size_t max_queued_blocks,
+        Stats &stats)
+    : m_logger(logger)
+    , m_directory(directory)
+    , m_max_bytes(max_bytes)
+    , m_columns(columns)
+    , m_avail_blocks(avail_blocks)
+    , m_filled_blocks(filled_blocks)
+    , m_reserved_blocks(reserved_blocks)
+    , m_max_queued_blocks(max_queued_blocks)
+    , m_stats(stats)
+{
+    scan_directory();
+}
+
+std::filesystem::path SpillQueue::segment_path(uint64_t seq) const
+{
+    return m_directory / fmt::format("{:020}{}", seq, SEGMENT_EXTENSION);
+}
+
+void SpillQueue::scan_directory()
+{
+    std::filesystem::create_directories(m_directory);
+
+    for (const auto &entry : std::filesystem::directory_iterator(m_directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        const std::filesystem::path &path = entry.path();
+        if (path.extension() == SEGMENT_TMP_EXTENSION) {
+            // Incomplete segment, e.g. the collector has been killed while writing it
+            std::filesystem::remove(path);
+            continue;
+        }
+        if (path.extension() != SEGMENT_EXTENSION) {
+            continue;
+        }
+
+        uint64_t seq;
+        try {
+            seq = std::stoull(path.stem().string());
+        } catch (const std::exception &) {
+            continue;
+        }
+
+        uint64_t bytes = entry.file_size();
+        m_segments.emplace(seq, bytes);
+        m_bytes += bytes;
+        m_next_seq = std::max(m_next_seq, seq + 1);
+    }
+
+    if (!m_segments.empty()) {
+        m_logger.info("Found %zu spilled segments (%" PRIu64 " bytes) in \"%s\", they will be inserted",
+                      m_segments.size(), m_bytes, m_directory.c_str());
+    }
+}
+
+void SpillQueue::serialize(const std::vector<Column> &columns, const Block &block, std::vector<uint8_t> &buffer)
+{
+    buffer.insert(buffer.end(), std::begin(SEGMENT_MAGIC), std::end(SEGMENT_MAGIC));
+
+    // Data block in the ClickHouse Native format
+    clickhouse::BufferOutput output(&buffer);
+    clickhouse::CompressedOutput compressed(&output);
+
+    clickhouse::WireFormat::WriteVarint64(compressed, block.columns.size());
+    clickhouse::WireFormat::WriteVarint64(compressed, block.rows);
+    for (std::size_t i = 0; i < block.columns.size(); i++) {
+        clickhouse::WireFormat::WriteString(compressed, columns[i].name);
+        clickhouse::WireFormat::WriteString(compressed, type_to_clickhouse(columns[i].datatype, columns[i].nullable));
+        block.columns[i]->Save(&compressed);
+    }
+    compressed.Flush();
+}
+
+void SpillQueue::deserialize(const std::vector<Column> &columns, const std::vector<uint8_t> &buffer, Block &block)
+{
+    if (buffer.size() < sizeof(SEGMENT_MAGIC) || std::memcmp(buffer.data(), SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        throw Error("not a spilled segment");
+    }
+
+    clickhouse::ArrayInput input(buffer.data() + sizeof(SEGMENT_MAGIC), buffer.size() - sizeof(SEGMENT_MAGIC));
+    clickhouse::CompressedInput compressed(&input);
+
+    uint64_t n_columns;
+    uint64_t n_rows;
+    if (!clickhouse::WireFormat::ReadVarint64(compressed, &n_columns)
+            || !clickhouse::WireFormat::ReadVarint64(compressed, &n_rows)) {
+        throw Error("truncated block header");
+    }
+    if (n_columns != columns.size()) {
+        throw Error("segment has {} columns but {} are expected", n_columns, columns.size());
+    }
+
+    for (std::size_t i = 0; i < n_columns; i++) {
+        const auto &expected_name = columns[i].name;
+        const auto &expected_type = type_to_clickhouse(columns[i].datatype, columns[i].nullable);
+        std::string name;
+        std::string type;
+
+        if (!clickhouse::WireFormat::ReadString(compressed, &name)
+                || !clickhouse::WireFormat::ReadString(compressed, &type)) {
+            throw Error("truncated header of column #{}", i);
+        }
+        if (name != expected_name || type != expected_type) {
+            throw Error("expected column #{} to be \"{}\" of type \"{}\" but it is \"{}\" of type \"{}\"",
+                        i, expected_name, expected_type, name, type);
+        }
+        if (!block.columns[i]->Load(&compressed, n_rows)) {
+            throw Error("failed to load data of column #{} (\"{}\")", i, name);
+        }
+    }
+    block.rows = n_rows;
+}
+
+bool SpillQueue::store(const Block &block)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (block.spill_seq.has_value()) {
+            // The rows are still on the disk, just replay the segment again later
+            auto replayed = m_replayed.find(block.spill_seq.value());
+            if (replayed != m_replayed.end()) {
+                m_segments.insert(*replayed);
+                m_replayed.erase(replayed);
+                return true;
+            }
+        }
+        if (m_bytes >= m_max_bytes) {
+            return false;
+        }
+    }
+
+    std::vector<uint8_t> buffer;
+    serialize(m_columns, block, buffer);
+    uint64_t bytes = buffer.size();
+
+    uint64_t seq;
+    {
+        // Reserve the space, the segment is not visible to the replay until it is written
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_bytes + bytes > m_max_bytes) {
+            return false;
+        }
+        m_bytes += bytes;
+        seq = m_next_seq++;
+    }
+
+    std::filesystem::path path = segment_path(seq);
+    std::filesystem::path tmp_path = path;
+    tmp_path += SEGMENT_TMP_EXTENSION;
+
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    file.close();
+
+    std::error_code ec;
+    if (file) {
+        std::filesystem::rename(tmp_path, path, ec);
+    }
+    if (!file || ec) {
+        m_logger.error("Failed to write spilled segment \"%s\"", tmp_path.c_str());
+        std::filesystem::remove(tmp_path, ec);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bytes -= bytes;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_segments.emplace(seq, bytes);
+    }
+    m_stats.add_spilled(block.rows);
+    m_logger.debug("Spilled %u rows into segment \"%s\"", block.rows, path.c_str());
+    return true;
+}
+
+bool SpillQueue::load(Block &block)
+{
+    uint64_t seq;
+    uint64_t bytes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_segments.empty()) {
+            return false;
+        }
+        auto oldest = m_segments.begin();
+        seq = oldest->first;
+        bytes = oldest->second;
+        m_segments.erase(oldest);
+    }
+
+    std::filesystem::path path = segment_path(seq);
+    try {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw Error("cannot open the file");
+        }
+        std::vector<uint8_t> buffer{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        deserialize(m_columns, buffer, block);
+
+    } catch (const std::exception &ex) {
+        m_logger.error("Failed to load spilled segment \"%s\": %s", path.c_str(), ex.what());
+        for (auto &column : block.columns) {
+            column->Clear();
+        }
+        block.rows = 0;
+
+        // Keep the data for manual inspection, but never try to load it again
+        std::error_code ec;
+        std::filesystem::path invalid_path = path;
+        invalid_path += SEGMENT_INVALID_EXTENSION;
+        std::filesystem::rename(path, invalid_path, ec);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bytes -= bytes;
+        return false;
+    }
+
+    // The segment is removed once the block is inserted (see commit())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_replayed.emplace(seq, bytes);
+    }
+    block.spill_seq = seq;
+    m_stats.add_replayed(block.rows);
+    m_logger.debug("Replayed %u rows from segment \"%s\"", block.rows, path.c_str());
+    return true;
+}
+
+void SpillQueue::commit(Block &block)
+{
+    if (!block.spill_seq.has_value()) {
+        return;
+    }
+
+    uint64_t seq = block.spill_seq.value();
+    block.spill_seq.reset();
+
+    uint64_t bytes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto replayed = m_replayed.find(seq);
+        if (replayed == m_replayed.end()) {
+            return;
+        }
+        bytes = replayed->second;
+        m_replayed.erase(replayed);
+    }
+
+    std::filesystem::path path = segment_path(seq);
+    std::error_code ec;
+    if (!std::filesystem::remove(path, ec)) {
+        m_logger.error("Failed to remove inserted spilled segment \"%s\"", path.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytes -= bytes;
+}
+
+void SpillQueue::run()
+{
+    while (!stop_requested()) {
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            pending = !m_segments.empty();
+        }
+
+        // Replay only when the inserters keep up and the converters have enough blocks to fill
+        if (pending
+                && m_filled_blocks.size() < m_max_queued_blocks
+                && m_avail_blocks.size() > m_reserved_blocks) {
+            std::optional<Block *> block = m_avail_blocks.try_get();
+            if (block.has_value()) {
+                if (load(*block.value())) {
+                    m_filled_blocks.put(block.value());
+                } else {
+                    m_avail_blocks.put(block.value());
+                }
+                continue;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(REPLAY_POLL_INTERVAL_MS));
+    }
+}
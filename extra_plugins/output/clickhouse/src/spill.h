@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief On-disk queue of blocks that could not have been inserted in time
+ * @date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "block.h"
+#include "column.h"
+#include "stats.h"
+#include "syncqueue.h"
+#include "worker.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class SpillQueue
+ * @brief A bounded on-disk queue of blocks with a worker thread replaying them.
+ *
+ * When there is no available block to be filled, the converters can spill a filled block that
+ * is still waiting for insertion to the disk and reuse it. Each spilled block is stored into a
+ * separate segment file in the ClickHouse Native format compressed by LZ4. The worker thread
+ * loads the segments back, oldest first, once the inserters catch up.
+ *
+ * A segment is removed only after the block loaded from it has been inserted (see `commit`),
+ * i.e. the rows of a segment are inserted at least once. Segments left in the directory by
+ * a previous run are replayed too.
+ */
+class SpillQueue : public Worker {
+public:
+    /**
+     * @brief Constructor for the SpillQueue class.
+     * @param logger Logger instance for logging operations.
+     * @param directory The directory where the segments are stored (created if missing).
+     * @param max_bytes The maximum total size of all the segments.
+     * @param columns Reference to the vector of columns defining the table schema.
+     * @param avail_blocks Reference to the queue of available blocks to load segments into.
+     * @param filled_blocks Reference to the queue of filled blocks to pass loaded blocks to.
+     * @param reserved_blocks Number of available blocks that are never used for replaying.
+     * @param max_queued_blocks Replay only if less filled blocks are waiting for insertion.
+     * @param stats Reference to the plugin statistics.
+     */
+    SpillQueue(
+        Logger logger,
+        std::string directory,
+        uint64_t max_bytes,
+        const std::vector<Column> &columns,
+        SyncQueue<Block *> &avail_blocks,
+        SyncQueue<Block *> &filled_blocks,
+        std::size_t reserved_blocks,
+        std::size_t max_queued_blocks,
+        Stats &stats);
+
+    /**
+     * @brief Store a block into a new segment (thread-safe).
+     *
+     * The block is left untouched. If the block has been loaded from a segment that is still on
+     * the disk, the segment is queued for replaying again instead.
+     *
+     * @param block The block
+     * @return False if there is not enough space left or the segment could not have been written.
+     */
+    bool store(const Block &block);
+
+    /**
+     * @brief Remove the segment a block has been loaded from after the block has been inserted
+     *        (thread-safe).
+     *
+     * Does nothing if the block has not been loaded from a segment.
+     *
+     * @param block The inserted block
+     */
+    void commit(Block &block);
+
+    /**
+     * @brief Serialize a block into the content of a segment.
+     * @param columns The columns defining the table schema.
+     * @param block The block
+     * @param buffer The buffer to append the segment to
+     */
+    static void serialize(const std::vector<Column> &columns, const Block &block, std::vector<uint8_t> &buffer);
+
+    /**
+     * @brief Deserialize the content of a segment into an empty block.
+     * @param columns The columns defining the table schema.
+     * @param buffer The content of the segment
+     * @param block The block
+     * @throws Error if the segment is invalid or it has been created for different columns
+     */
+    static void deserialize(const std::vector<Column> &columns, const std::vector<uint8_t> &buffer, Block &block);
+
+private:
+    Logger m_logger; ///< Logger instance for logging operations.
+    std::filesystem::path m_directory; ///< The directory where the segments are stored.
+    uint64_t m_max_bytes; ///< The maximum total size of all the segments.
+    const std::vector<Column> &m_columns; ///< Reference to the vector of columns defining the table schema.
+    SyncQueue<Block *> &m_avail_blocks; ///< Reference to the queue of available blocks.
+    SyncQueue<Block *> &m_filled_blocks; ///< Reference to the queue of filled blocks.
+    std::size_t m_reserved_blocks; ///< Number of available blocks that are never used for replaying.
+    std::size_t m_max_queued_blocks; ///< Replay only if less filled blocks are waiting for insertion.
+    Stats &m_stats; ///< Reference to the plugin statistics.
+
+    std::mutex m_mutex; ///< Mutex protecting the members below.
+    std::map<uint64_t, uint64_t> m_segments; ///< Sequence number of a segment -> its size in bytes.
+    std::map<uint64_t, uint64_t> m_replayed; ///< Segments loaded into blocks that have not been inserted yet.
+    uint64_t m_bytes = 0; ///< Total size of the segments (including the ones being written).
+    uint64_t m_next_seq = 0; ///< Sequence number of the next segment.
+
+    void run() override;
+
+    bool load(Block &block);
+
+    std::filesystem::path segment_path(uint64_t seq) const;
+
+    void scan_directory();
+};
@@ -31,6 +31,16 @@ void Stats::add_dropped(uint64_t count)
     m_recs_dropped_total += count;
 }
 
+void Stats::add_spilled(uint64_t count)
+{
+    m_rows_spilled_total += count;
+}
+
+void Stats::add_replayed(uint64_t count)
+{
+    m_rows_replayed_total += count;
+}
+
 void Stats::print_stats_throttled(time_t now)
 {
     if (m_start_time == 0) {
@@ -38,18 +48,20 @@ void Stats::print_stats_throttled(time_t now)
     }
 
     if ((now - m_last_stats_print_time) > STATS_PRINT_INTERVAL_SECS) {
+        uint64_t recs_processed_since_last = m_recs_processed_since_last.exchange(0);
         double total_rps = m_recs_processed_total / std::max<double>(1, now - m_start_time);
-        double immediate_rps = m_recs_processed_since_last / std::max<double>(1, now - m_last_stats_print_time);
-        m_logger.info("STATS - RECS: %lu (%lu dropped), ROWS: %lu, AVG: %.2f recs/sec, AVG_IMMEDIATE: %.2f recs/sec, BLK_AVAIL_Q: %lu, BLK_FILL_Q: %lu",
-                      m_recs_processed_total,
-                      m_recs_dropped_total,
-                      m_rows_written_total,
+        double immediate_rps = recs_processed_since_last / std::max<double>(1, now - m_last_stats_print_time);
+        m_logger.info("STATS - RECS: %lu (%lu dropped), ROWS: %lu (%lu spilled, %lu replayed), AVG: %.2f recs/sec, AVG_IMMEDIATE: %.2f recs/sec, BLK_AVAIL_Q: %lu, BLK_FILL_Q: %lu",
+                      m_recs_processed_total.load(),
+                      m_recs_dropped_total.load(),
+                      m_rows_written_total.load(),
+                      m_rows_spilled_total.load(),
+                      m_rows_replayed_total.load(),
                       total_rps,
                       immediate_rps,
                       m_plugin.m_avail_blocks.size(),
                       m_plugin.m_filled_blocks.size()
                       );
-        m_recs_processed_since_last = 0;
         m_last_stats_print_time = now;
     }
 }
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "common.h"
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 
@@ -55,6 +56,20 @@ public:
      */
     void add_dropped(uint64_t count);
 
+    /**
+     * @brief Adds a specified number of rows to the spilled count.
+     *
+     * @param count The number of rows to add.
+     */
+    void add_spilled(uint64_t count);
+
+    /**
+     * @brief Adds a specified number of rows to the replayed count.
+     *
+     * @param count The number of rows to add.
+     */
+    void add_replayed(uint64_t count);
+
     /**
      * @brief Prints the statistics if sufficient time has passed since the last print.
      */
@@ -63,10 +78,12 @@ public:
 private:
     Logger m_logger; ///< Logger instance for logging statistics.
     Plugin &m_plugin; ///< Reference to the associated Plugin instance.
-    uint64_t m_rows_written_total = 0; ///< Total number of rows written.
-    uint64_t m_recs_processed_total = 0; ///< Total number of records processed.
-    uint64_t m_recs_processed_since_last = 0; ///< Records processed since the last statistics print.
-    uint64_t m_recs_dropped_total = 0; ///< Total number of records dropped.
+    std::atomic<uint64_t> m_rows_written_total = 0; ///< Total number of rows written.
+    std::atomic<uint64_t> m_recs_processed_total = 0; ///< Total number of records processed.
+    std::atomic<uint64_t> m_recs_processed_since_last = 0; ///< Records processed since the last statistics print.
+    std::atomic<uint64_t> m_recs_dropped_total = 0; ///< Total number of records dropped.
+    std::atomic<uint64_t> m_rows_spilled_total = 0; ///< Total number of rows spilled to the disk.
+    std::atomic<uint64_t> m_rows_replayed_total = 0; ///< Total number of rows loaded back from the disk.
     time_t m_start_time = 0; ///< Start time of the statistics tracking.
     time_t m_last_stats_print_time = 0; ///< Time of the last statistics print.
 };
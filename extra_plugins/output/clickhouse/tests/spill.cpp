@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "datatype.h"
+#include "spill.h"
+
+// The plugin is tested without the collector, i.e. there is nothing to log to
+extern "C" {
+enum ipx_verb_level
+ipx_ctx_verb_get(const ipx_ctx_t *ctx)
+{
+    (void) ctx;
+    return IPX_VERB_NONE;
+}
+
+void
+ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *fmt, ...)
+{
+    (void) level;
+    (void) ctx;
+    (void) fmt;
+}
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using bytes = std::vector<uint8_t>;
+
+/** Values of an IPFIX type converted to a data type */
+struct Sample {
+    DataType type;
+    fds_iemgr_element_type source;
+    std::vector<bytes> values;
+};
+
+/** Samples of all the data types (values are in the network byte order) */
+static const std::vector<Sample> samples = {
+    {DataType::Int8, FDS_ET_SIGNED_8, {{0x00}, {0x7F}, {0x80}, {0xFF}}},
+    {DataType::Int16, FDS_ET_SIGNED_16, {{0x00, 0x00}, {0x7F, 0xFF}, {0x80, 0x00}, {0xFF, 0xFE}}},
+    {DataType::Int32, FDS_ET_SIGNED_32, {{0x00, 0x00, 0x00, 0x01}, {0x80, 0x00, 0x00, 0x00},
+        {0xFF, 0xFF, 0xFF, 0xFF}}},
+    {DataType::Int64, FDS_ET_SIGNED_64, {{0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+        {0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00}}},
+    {DataType::UInt8, FDS_ET_UNSIGNED_8, {{0x00}, {0x7F}, {0xFF}}},
+    {DataType::UInt16, FDS_ET_UNSIGNED_16, {{0x00, 0x00}, {0x12, 0x34}, {0xFF, 0xFF}}},
+    {DataType::UInt32, FDS_ET_UNSIGNED_32, {{0x00, 0x00, 0x00, 0x00}, {0x12, 0x34, 0x56, 0x78},
+        {0xFF, 0xFF, 0xFF, 0xFF}}},
+    {DataType::UInt64, FDS_ET_UNSIGNED_64, {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01},
+        {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}}},
+    {DataType::Float32, FDS_ET_FLOAT_32, {{0x3F, 0xC0, 0x00, 0x00}, {0xC2, 0x28, 0x00, 0x00},
+        {0x7F, 0x80, 0x00, 0x00}}},
+    {DataType::Float64, FDS_ET_FLOAT_64, {{0x3F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+        {0xC0, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0xFF, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}},
+    {DataType::IP, FDS_ET_IPV4_ADDRESS, {{192, 168, 0, 1}, {10, 0, 0, 255}}},
+    {DataType::IPv4, FDS_ET_IPV4_ADDRESS, {{192, 168, 0, 1}, {255, 255, 255, 255}, {0, 0, 0, 0}}},
+    {DataType::IPv6, FDS_ET_IPV6_ADDRESS, {
+        {0x20, 0x01, 0x0D, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01},
+        {0xFE, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x11, 0x22, 0xFF, 0xFE, 0x33, 0x44, 0x55}}},
+    {DataType::String, FDS_ET_STRING, {{'f', 'l', 'o', 'w'}, {}, {'I', 'P', 'F', 'I', 'X', 'c', 'o', 'l'}}},
+    {DataType::OctetArray, FDS_ET_OCTET_ARRAY, {{0x00, 0xFF, 0x10}, {}, {0x01}}},
+    {DataType::DatetimeSecs, FDS_ET_DATE_TIME_SECONDS, {{0x60, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00}}},
+    {DataType::DatetimeMillisecs, FDS_ET_DATE_TIME_MILLISECONDS, {
+        {0x00, 0x00, 0x01, 0x8C, 0x12, 0x34, 0x56, 0x78}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xE8}}},
+    {DataType::DatetimeMicrosecs, FDS_ET_DATE_TIME_MICROSECONDS, {
+        {0xE9, 0x12, 0x34, 0x56, 0x80, 0x00, 0x00, 0x00}, {0xE9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00}}},
+    {DataType::DatetimeNanosecs, FDS_ET_DATE_TIME_NANOSECONDS, {
+        {0xE9, 0x12, 0x34, 0x56, 0x80, 0x00, 0x00, 0x01}, {0xE9, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF}}},
+    {DataType::Mac, FDS_ET_MAC_ADDRESS, {{0x00, 0x11, 0x22, 0x33, 0x44, 0x55}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}}},
+};
+
+/** Number of rows of the tested blocks */
+static constexpr unsigned int ROWS = 10;
+
+class Spill : public ::testing::Test {
+protected:
+    std::vector<Column> columns;
+
+    /** Add a column of the sample to the schema */
+    void add_column(const Sample &sample, bool nullable) {
+        Column column;
+        column.name = fmt::format("{}{}", sample.type, nullable ? "Nullable" : "");
+        column.datatype = sample.type;
+        column.nullable = nullable;
+        columns.push_back(column);
+    }
+
+    /** Create an empty block of the schema */
+    Block empty_block() const {
+        Block block;
+        for (const auto &column : columns) {
+            block.columns.emplace_back(make_column(column.datatype, column.nullable));
+            block.block.AppendColumn(column.name, block.columns.back());
+        }
+        return block;
+    }
+
+    /** Create a block of the schema filled with values of the samples (every third value of
+     *  a nullable column is NULL) */
+    Block filled_block(const std::vector<const Sample *> &column_samples) const {
+        Block block = empty_block();
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            const Sample &sample = *column_samples[i];
+            ColumnAppender append = make_appender(sample.type, columns[i].nullable, sample.source);
+
+            for (unsigned int row = 0; row < ROWS; row++) {
+                const bytes &value = sample.values[row % sample.values.size()];
+                if (columns[i].nullable && row % 3 == 0) {
+                    EXPECT_TRUE(append(*block.columns[i], nullptr, 0));
+                } else {
+                    // An empty value is not a missing field, i.e. it must not be nullptr
+                    static const uint8_t empty = 0;
+                    const uint8_t *data = value.empty() ? &empty : value.data();
+                    EXPECT_TRUE(append(*block.columns[i], data, uint16_t(value.size())));
+                }
+            }
+        }
+        block.rows = ROWS;
+        return block;
+    }
+
+    /** Serialize a column in the ClickHouse Native format */
+    static bytes save(clickhouse::Column &column) {
+        bytes result;
+        clickhouse::BufferOutput output(&result);
+        column.Save(&output);
+        output.Flush();
+        return result;
+    }
+
+    /** Serialize the block, deserialize it and compare the result with the original */
+    void round_trip(const Block &block) {
+        bytes segment;
+        SpillQueue::serialize(columns, block, segment);
+
+        Block result = empty_block();
+        ASSERT_NO_THROW(SpillQueue::deserialize(columns, segment, result));
+        ASSERT_EQ(result.rows, block.rows);
+        ASSERT_EQ(result.columns.size(), block.columns.size());
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            EXPECT_EQ(result.columns[i]->Size(), block.rows) << "column " << columns[i].name;
+            EXPECT_EQ(save(*result.columns[i]), save(*block.columns[i])) << "column " << columns[i].name;
+        }
+    }
+};
+
+// Each data type in a separate block
+TEST_F(Spill, eachType)
+{
+    for (const auto &sample : samples) {
+        for (bool nullable : {false, true}) {
+            SCOPED_TRACE(fmt::format("{} (nullable: {})", sample.type, nullable));
+            columns.clear();
+            add_column(sample, nullable);
+            round_trip(filled_block({&sample}));
+        }
+    }
+}
+
+// All the data types in one block
+TEST_F(Spill, allTypes)
+{
+    std::vector<const Sample *> column_samples;
+    for (const auto &sample : samples) {
+        for (bool nullable : {false, true}) {
+            add_column(sample, nullable);
+            column_samples.push_back(&sample);
+        }
+    }
+
+    round_trip(filled_block(column_samples));
+}
+
+// A block without rows
+TEST_F(Spill, emptyBlock)
+{
+    for (const auto &sample : samples) {
+        add_column(sample, true);
+    }
+
+    round_trip(empty_block());
+}
+
+// Segments that do not match the schema or are damaged are refused
+TEST_F(Spill, invalidSegment)
+{
+    add_column(samples[0], false);
+    add_column(samples[1], true);
+    Block block = filled_block({&samples[0], &samples[1]});
+
+    bytes segment;
+    SpillQueue::serialize(columns, block, segment);
+
+    // Not a segment at all
+    bytes garbage = segment;
+    garbage[0] ^= 0xFF;
+    Block result = empty_block();
+    EXPECT_THROW(SpillQueue::deserialize(columns, garbage, result), Error);
+
+    // Truncated segment
+    bytes truncated(segment.begin(), segment.begin() + segment.size() / 2);
+    result = empty_block();
+    EXPECT_ANY_THROW(SpillQueue::deserialize(columns, truncated, result));
+
+    // Different nullability of a column
+    std::vector<Column> other = columns;
+    other[1].nullable = false;
+    result = empty_block();
+    EXPECT_THROW(SpillQueue::deserialize(other, segment, result), Error);
+
+    // Different number of columns
+    other = columns;
+    other.pop_back();
+    result = empty_block();
+    EXPECT_THROW(SpillQueue::deserialize(other, segment, result), Error);
+}
@@ -64,6 +64,8 @@
 
 #include <ipfixcol2/plugins.h>
 #include <ipfixcol2/session.h>
+#include <ipfixcol2/stats.h>
+#include <ipfixcol2/tmplt_cache.h>
 #include <ipfixcol2/utils.h>
 #include <ipfixcol2/verbose.h>
 
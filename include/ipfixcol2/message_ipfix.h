@@ -127,13 +127,42 @@ IPX_API ipx_msg_ipfix_t *
 ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
     uint8_t *msg_data, uint16_t msg_size);
 
+/**
+ * \brief Callback function for releasing a raw packet of an IPFIX Message
+ * \param[in] data User defined data (see ipx_msg_ipfix_set_release())
+ * \param[in] pkt  Raw packet to release
+ */
+typedef void (*ipx_msg_ipfix_release_cb)(void *data, uint8_t *pkt);
+
 /**
  * \brief Destroy a message wrapper with a parsed IPFIX packet
+ *
+ * The raw packet is freed using free() unless a different release function has been set
+ * by ipx_msg_ipfix_set_release().
  * \param[out] msg Pointer to the message
  */
 IPX_API void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg);
 
+/**
+ * \brief Set a custom release function of the raw packet
+ *
+ * By default, the raw packet passed to ipx_msg_ipfix_create() is expected to be allocated using
+ * malloc() and it is freed together with the wrapper. This function allows producers to use
+ * their own memory management (e.g. a pool of preallocated buffers). The callback is called
+ * exactly once when the raw packet is not needed anymore. Keep in mind that it can be called
+ * from any thread (typically from the last output instance that processed the message) and even
+ * after the producer instance has been destroyed.
+ *
+ * \note If the wrapped packet is replaced by the collector (e.g. after NetFlow to IPFIX
+ *   conversion), the original packet is released and the default behaviour is restored.
+ * \param[in] msg  IPFIX Message wrapper
+ * \param[in] cb   Release function (NULL to restore the default behaviour)
+ * \param[in] data User defined data passed to the release function
+ */
+IPX_API void
+ipx_msg_ipfix_set_release(ipx_msg_ipfix_t *msg, ipx_msg_ipfix_release_cb cb, void *data);
+
 /**
  * \brief Get a pointer to the raw message
  *
@@ -150,6 +150,22 @@ typedef struct ipx_ctx_ext ipx_ctx_ext_t;
  */
 #define IPX_PF_DEEPBIND 1U
 
+/**
+ * \def IPX_PF_OUTPUT_WORKERS
+ * \brief Output plugin can be processed by multiple worker threads
+ *
+ * If the flag is set, the user can configure an output instance to be processed by multiple
+ * threads. In this case, the collector creates an independent instance of the plugin (i.e.
+ * plugin_init() is called multiple times with the same parameters) for each thread and
+ * distributes IPFIX Messages among them based on their Transport Session and ODID. In other
+ * words, all messages of the same combination are always processed by the same instance in the
+ * correct order. Other messages (e.g. Transport Session, periodic) are passed to all instances.
+ *
+ * Set only if the instances of the plugin don't share any resources (files, sockets, etc.)
+ * or can handle concurrent access to them. See ipx_ctx_worker_get().
+ */
+#define IPX_PF_OUTPUT_WORKERS 2U
+
 /**
  * \brief Identification of a plugin
  *
@@ -285,6 +301,34 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg);
 IPX_API int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Process a batch of messages from the IPFIXcol core (Intermediate and Output plugins ONLY)
+ *
+ * This function is optional. If the plugin implements it, the IPFIXcol core passes messages the
+ * instance subscribes to in batches (i.e. all messages taken at once from the input ring buffer)
+ * instead of calling ipx_plugin_process() for each of them. This allows the plugin to amortize
+ * per-message overhead (locking, system calls, etc.). Messages in the batch are in the same order
+ * as they have been received by the instance. The plugin MUST process all messages of the batch
+ * and the same rules as for ipx_plugin_process() apply to each of them.
+ *
+ * If the plugin implements only this function, ipx_plugin_process() can be omitted.
+ *
+ * \warning
+ *   This interface is only for Intermediate and Output plugins! In case of the other types,
+ *   the IPFIXcol core ignores this function.
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Private data of the instance prepared by initialization function
+ * \param[in] msgs Array of messages to process
+ * \param[in] cnt  Number of messages in the array (always at least one)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if a fatal memory allocation error has occurred and/or the plugin cannot
+ *   continue to work properly (the collector will exit).
+ * \return #IPX_ERR_EOF if the plugin has reached expected goal (e.g. number of processed records).
+ *   This function will not be called anymore and the collector will shut down.
+ */
+IPX_API int
+ipx_plugin_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
 /**
  * \brief Request to close a Transport Session (Input plugins only!)
  *
@@ -350,6 +394,19 @@ ipx_ctx_verb_get(const ipx_ctx_t *ctx);
 IPX_API const char *
 ipx_ctx_name_get(const ipx_ctx_t *ctx);
 
+/**
+ * \brief Get identification of a worker of an output instance
+ *
+ * If an output instance is processed by multiple workers (see #IPX_PF_OUTPUT_WORKERS), each
+ * worker has its own context and private data. The function can be used, for example, to
+ * generate unique names of files or other resources of the worker.
+ * \param[in]  ctx Current plugin context
+ * \param[out] id  Index of the worker (starting from 0, can be NULL)
+ * \param[out] cnt Total number of workers of the instance (can be NULL)
+ */
+IPX_API void
+ipx_ctx_worker_get(const ipx_ctx_t *ctx, unsigned int *id, unsigned int *cnt);
+
 /**
  * \brief Pass a message to a successor of the plugin (only Input and Intermediate plugins ONLY!)
  *
@@ -372,6 +429,27 @@ ipx_ctx_name_get(const ipx_ctx_t *ctx);
 IPX_API int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg);
 
+/**
+ * \brief Allow passing of messages from multiple threads of the instance
+ *
+ * By default, ipx_ctx_msg_pass() can be called only from the thread of the instance (i.e. from
+ * the getter or processing function). If the plugin creates its own threads that pass messages
+ * concurrently, this function MUST be called during the instance initialization, so the output
+ * queue of the instance is switched to multi-writer mode. Keep in mind that all messages
+ * related to a particular Transport Session MUST be still passed in the correct order, i.e.,
+ * usually by the same thread.
+ *
+ * \warning
+ *   This interface is only for Input and Intermediate plugins and it can be called only
+ *   during initialization of the instance (see ipx_plugin_init()).
+ * \param[in] ctx Current plugin context
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the plugin is not allowed to pass messages or the function is called
+ *   outside of the instance initialization.
+ */
+IPX_API int
+ipx_ctx_msg_pass_mt(ipx_ctx_t *ctx);
+
 /**
  * \brief Change message subscription (Intermediate and Output plugins ONLY!)
  *
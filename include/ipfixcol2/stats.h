@@ -0,0 +1,208 @@
+/**
+ * \file include/ipfixcol2/stats.h
+ * \brief Runtime statistics of plugin instances (public API)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef IPX_STATS_H
+#define IPX_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <ipfixcol2/api.h>
+#include <ipfixcol2/plugins.h>
+
+/**
+ * \defgroup ipxStats Runtime statistics
+ * \ingroup publicAPIs
+ * \brief Counters of processed messages, processing time, latency and ring buffer occupancy
+ *
+ * Statistics help to find a bottleneck of the collector pipeline. Counters of messages,
+ * records and processing time are collected only if statistics of the instance are enabled
+ * (see the \<stats\> section of the pipeline configuration). Otherwise, they are always zero.
+ * Ring buffer statistics and CPU time of the instance thread are always available.
+ *
+ * All counters are monotonic since the start of the instance. Rates (e.g. messages per second
+ * or the load of an instance) can be calculated as a difference of two snapshots.
+ * @{
+ */
+
+/** Runtime statistics of a plugin instance                                                   */
+struct ipx_ctx_stats {
+    /** Messages received by the instance (i.e. passed to its processing function)           */
+    uint64_t msg_in;
+    /**
+     * Messages passed by the instance to the successor (see ipx_ctx_msg_pass()), including
+     * messages not selected for processing that are forwarded automatically
+     * \note Always zero for output instances and the output manager.
+     */
+    uint64_t msg_out;
+    /** Data Records of IPFIX Messages received by the instance                              */
+    uint64_t rec_in;
+    /** Data Records of IPFIX Messages passed by the instance to the successor               */
+    uint64_t rec_out;
+
+    /** Number of calls of the getter (input) or the processing function (others)            */
+    uint64_t cb_calls;
+    /** Total wall-clock time spent in the getter or the processing function, including time
+     *  the plugin was blocked (e.g. by a full output or I/O) (in nanoseconds)              */
+    uint64_t cb_wall;
+    /** CPU time consumed by the instance thread (in nanoseconds). Threads created by the
+     *  plugin itself (e.g. parser threads of an input plugin) are not included.            */
+    uint64_t cpu_time;
+
+    /** Size of the input ring buffer of the instance (0 == input instance, no buffer)       */
+    uint32_t ring_size;
+    /** Current number of messages in the input ring buffer                                  */
+    uint32_t ring_fill;
+    /** Total time writers waited for free space in the input ring buffer (in nanoseconds)   */
+    uint64_t ring_stall_time;
+    /** Number of times writers had to wait for free space in the input ring buffer          */
+    uint64_t ring_stall_cnt;
+};
+
+/**
+ * \brief Get runtime statistics of a plugin instance
+ *
+ * The function can be called by any thread at any time. However, the counters are not
+ * a consistent snapshot, i.e. each counter is read independently.
+ * \param[in]  ctx   Plugin context
+ * \param[out] stats Statistics to fill
+ */
+IPX_API void
+ipx_ctx_stats_get(const ipx_ctx_t *ctx, struct ipx_ctx_stats *stats);
+
+/**
+ * \brief Summary of latencies of an instance (in nanoseconds)
+ *
+ * Latencies are measured using periodic messages (see ipx_msg_periodic_t) that are
+ * regularly generated by the collector and pass through all instances of the pipeline
+ * similarly to other messages. A growing latency of an instance usually indicates
+ * a building backpressure, even before ring buffers are full.
+ */
+struct ipx_ctx_latency {
+    /** Number of measured messages                                                         */
+    uint64_t cnt;
+    /** Median                                                                              */
+    uint64_t p50;
+    /** 99th percentile                                                                     */
+    uint64_t p99;
+    /** 99.9th percentile                                                                   */
+    uint64_t p999;
+    /** The highest latency                                                                 */
+    uint64_t max;
+};
+
+/**
+ * \brief Get latencies of a plugin instance
+ *
+ * Two latencies are measured when a periodic message arrives to the instance (i.e. before
+ * it is processed by the plugin):
+ *  - \p total is the time from creation of the message (i.e. end-to-end latency of
+ *    the pipeline up to this instance),
+ *  - \p stage is the time from the previous instance (i.e. time spent in the input ring
+ *    buffer and processing of preceding messages by the previous instance).
+ *
+ * Latencies are always collected (the overhead is negligible). Percentiles are calculated
+ * from all measurements since the start of the instance with relative error less than 2 %.
+ * \param[in]  ctx   Plugin context
+ * \param[out] total Latency from creation of the message
+ * \param[out] stage Latency from the previous instance
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_ctx_latency_get(const ipx_ctx_t *ctx, struct ipx_ctx_latency *total,
+    struct ipx_ctx_latency *stage);
+
+/** Maximal number of plugin-specific counters of an instance                               */
+#define IPX_CTX_STATS_PLUGIN_MAX 8U
+
+/**
+ * \brief Register a plugin-specific counter
+ *
+ * Plugins can expose internal state (e.g. fill level of internal queues) among other
+ * statistics of the instance. Each counter is identified by its name and its value is
+ * always available (i.e. independently of the \<stats\> section of the configuration).
+ * \note The function can be called only during initialization of the instance.
+ * \param[in]  ctx  Plugin context
+ * \param[in]  name Name of the counter (a copy is created)
+ * \param[out] idx  Index of the counter (for ipx_ctx_stats_plugin_set())
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the instance is already running or the name is empty
+ * \return #IPX_ERR_LIMIT if the maximum number of counters has been reached
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_ctx_stats_plugin_add(ipx_ctx_t *ctx, const char *name, unsigned int *idx);
+
+/**
+ * \brief Set the value of a plugin-specific counter
+ *
+ * The function can be called by any thread of the plugin.
+ * \param[in] ctx   Plugin context
+ * \param[in] idx   Index of the counter (see ipx_ctx_stats_plugin_add())
+ * \param[in] value New value
+ */
+IPX_API void
+ipx_ctx_stats_plugin_set(ipx_ctx_t *ctx, unsigned int idx, uint64_t value);
+
+/**
+ * \brief Get the name and the value of a plugin-specific counter
+ *
+ * The function can be called by any thread at any time.
+ * \param[in]  ctx   Plugin context
+ * \param[in]  idx   Index of the counter
+ * \param[out] name  Name of the counter
+ * \param[out] value Current value
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the counter doesn't exist
+ */
+IPX_API int
+ipx_ctx_stats_plugin_get(const ipx_ctx_t *ctx, unsigned int idx, const char **name,
+    uint64_t *value);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_STATS_H
@@ -0,0 +1,164 @@
+/**
+ * \file include/ipfixcol2/tmplt_cache.h
+ * \brief Identification of templates in per-template caches (public API)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_TMPLT_CACHE_H
+#define IPX_TMPLT_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libfds.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxTmpltCache Per-template caches
+ * \ingroup publicAPIs
+ * \brief Identification of templates in caches of plugins
+ *
+ * Plugins often prepare something for each (Options) Template (e.g. positions of fields) and
+ * keep it in a cache keyed by the address of the template. However, the address alone is not
+ * a reliable identification:
+ * - the template might be freed (e.g. withdrawn or redefined) and another template might be
+ *   later allocated at the same address,
+ * - the template might be redefined with the same content but different definitions of
+ *   Information Elements (e.g. after an update of the manager of Information Elements).
+ *
+ * Therefore, a record of the cache is valid only if the address of the template, the address
+ * of the snapshot it belongs to, and the content of the raw template are the same as when the
+ * record was created. A new snapshot is created whenever any template of the Transport Session
+ * and ODID changes, so records are prepared again only after a template change.
+ *
+ * @{
+ */
+
+/** Identification of a template of a cache record */
+struct ipx_tmplt_id {
+    /** Template (NULL if the record is unused)                     */
+    const struct fds_template *tmplt;
+    /** Snapshot of the template                                    */
+    const fds_tsnapshot_t *snap;
+    /** Copy of the raw template                                    */
+    uint8_t *raw;
+    /** Size of the raw template                                    */
+    uint16_t raw_len;
+};
+
+/**
+ * \brief Get a hash of a template address
+ *
+ * Use it to select a record of a direct-mapped cache, e.g.
+ * <tt>ipx_tmplt_id_hash(tmplt) & (CACHE_SIZE - 1)</tt>, where CACHE_SIZE is a power of two.
+ * \param[in] tmplt Template
+ * \return Hash value
+ */
+static inline uint64_t
+ipx_tmplt_id_hash(const struct fds_template *tmplt)
+{
+    // Templates are allocated by malloc(), therefore, the lowest bits are always zero
+    const uint64_t key = (uint64_t) (uintptr_t) tmplt;
+    return (key >> 4) ^ (key >> 12) ^ (key >> 20);
+}
+
+/**
+ * \brief Check if a cache record belongs to a template
+ * \param[in] id    Identification of the cache record
+ * \param[in] tmplt Template
+ * \param[in] snap  Snapshot of the template (e.g. fds_drec::snap)
+ * \return True if the record has been created for the template
+ */
+static inline bool
+ipx_tmplt_id_match(const struct ipx_tmplt_id *id, const struct fds_template *tmplt,
+    const fds_tsnapshot_t *snap)
+{
+    return id->tmplt == tmplt && id->snap == snap && id->raw_len == tmplt->raw.length
+        && memcmp(id->raw, tmplt->raw.data, id->raw_len) == 0;
+}
+
+/**
+ * \brief Assign a template to a cache record
+ *
+ * On failure, the record is cleared (see ipx_tmplt_id_clear()).
+ * \param[in] id    Identification of the cache record
+ * \param[in] tmplt Template
+ * \param[in] snap  Snapshot of the template (e.g. fds_drec::snap)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on memory allocation error
+ */
+static inline int
+ipx_tmplt_id_set(struct ipx_tmplt_id *id, const struct fds_template *tmplt,
+    const fds_tsnapshot_t *snap)
+{
+    uint8_t *raw = (uint8_t *) realloc(id->raw, tmplt->raw.length);
+    if (!raw) {
+        free(id->raw);
+        memset(id, 0, sizeof(*id));
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(raw, tmplt->raw.data, tmplt->raw.length);
+    id->tmplt = tmplt;
+    id->snap = snap;
+    id->raw = raw;
+    id->raw_len = tmplt->raw.length;
+    return IPX_OK;
+}
+
+/**
+ * \brief Mark a cache record as unused and free its resources
+ * \param[in] id Identification of the cache record
+ */
+static inline void
+ipx_tmplt_id_clear(struct ipx_tmplt_id *id)
+{
+    free(id->raw);
+    memset(id, 0, sizeof(*id));
+}
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_TMPLT_CACHE_H
@@ -221,6 +221,24 @@ ipx_configurator::verbosity_str2level(const std::string &verb)
     }
 }
 
+/**
+ * \brief Convert a string to corresponding type of ring buffers
+ * \param[in] type String
+ * \return Type of ring buffers
+ */
+enum ipx_ring_type
+ipx_configurator::ringtype_str2type(const std::string &type)
+{
+    if (type.empty() || strcasecmp(type.c_str(), "default") == 0
+            || strcasecmp(type.c_str(), "locked") == 0) {
+        return IPX_RING_TYPE_LOCKED;
+    } else if (strcasecmp(type.c_str(), "lockfree") == 0) {
+        return IPX_RING_TYPE_LOCKFREE;
+    } else {
+        throw std::invalid_argument("Invalid type of ring buffers!");
+    }
+}
+
 void
 ipx_configurator::iemgr_set_dir(const std::string &path)
 {
@@ -248,6 +266,15 @@ ipx_configurator::startup(const ipx_config_model &model)
     IPX_INFO(comp_str, "Information Elements have been successfully loaded from '%s'.",
         m_iemgr_dir.c_str());
 
+    enum ipx_ring_type ring_type = ringtype_str2type(model.pipeline.ring_type);
+    if (ring_type == IPX_RING_TYPE_LOCKFREE) {
+        IPX_INFO(comp_str, "Lock-free ring buffers are used in the pipeline.", '\0');
+    }
+    if (model.pipeline.parser_threads > 1) {
+        IPX_INFO(comp_str, "IPFIX Messages of each input are parsed by %u threads.",
+            model.pipeline.parser_threads);
+    }
+
     // In case of an exception, smart pointers make sure that all instances are destroyed
     std::vector<std::unique_ptr<ipx_instance_output> > outputs;
     std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
@@ -256,21 +283,28 @@ ipx_configurator::startup(const ipx_config_model &model)
     // Phase 1. Create all instances (i.e. find plugins)
     for (const auto &output : model.outputs) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_OUTPUT, output.plugin);
-        outputs.emplace_back(new ipx_instance_output(output.name, ref, m_ring_size));
+        outputs.emplace_back(new ipx_instance_output(output.name, ref, m_ring_size, ring_type,
+            output.threads));
+        if (output.threads > 1) {
+            IPX_INFO(comp_str, "Output instance '%s' is processed by %u threads.",
+                output.name.c_str(), output.threads);
+        }
     }
 
     for (const auto &inter : model.inters) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
-        inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size));
+        inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size,
+            ring_type));
     }
 
     for (const auto &input : model.inputs) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INPUT, input.plugin);
-        inputs.emplace_back(new ipx_instance_input(input.name, ref, m_ring_size));
+        inputs.emplace_back(new ipx_instance_input(input.name, ref, m_ring_size, ring_type,
+            model.pipeline.parser_threads));
     }
 
     // Insert the output manager as the last intermediate plugin
-    ipx_instance_outmgr *output_manager = new ipx_instance_outmgr(m_ring_size);
+    ipx_instance_outmgr *output_manager = new ipx_instance_outmgr(m_ring_size, ring_type);
     inters.emplace_back(output_manager);
 
     IPX_DEBUG(comp_str, "All plugins have been successfully loaded.", '\0');
@@ -342,6 +376,35 @@ ipx_configurator::startup(const ipx_config_model &model)
     ext_mgr.resolve();
     ext_mgr.list_extensions();
 
+    // Enable collection of runtime statistics (in the order of the pipeline)
+    std::unique_ptr<ipx_stats_dump> stats;
+    if (model.pipeline.stats.enabled) {
+        stats.reset(new ipx_stats_dump(model.pipeline.stats));
+        std::vector<const ipx_ctx_t *> ctxs;
+
+        for (auto &input : inputs) {
+            input->set_stats(true);
+            input->get_contexts(ctxs);
+        }
+        for (auto &inter : inters) {
+            inter->set_stats(true);
+            inter->get_contexts(ctxs);
+        }
+        for (auto &output : outputs) {
+            output->set_stats(true);
+            output->get_contexts(ctxs);
+        }
+
+        for (const ipx_ctx_t *ctx : ctxs) {
+            stats->add(ctx);
+        }
+
+        const struct ipx_stats_cfg &cfg = model.pipeline.stats;
+        IPX_INFO(comp_str, "Runtime statistics are dumped every %u second(s) to %s '%s'.",
+            cfg.interval, cfg.file.empty() ? "socket" : "file",
+            cfg.file.empty() ? cfg.socket.c_str() : cfg.file.c_str());
+    }
+
     // Phase 5. Start threads of all plugins and update definitions of extensions
     for (auto &output : outputs) {
         output->extensions_resolve(&ext_mgr);
@@ -362,10 +425,17 @@ ipx_configurator::startup(const ipx_config_model &model)
     m_running_inputs = std::move(inputs);
     m_running_inter = std::move(inters);
     m_running_outputs = std::move(outputs);
+    m_stats = std::move(stats);
 }
 
 void ipx_configurator::cleanup()
 {
+    // Statistics refer to contexts of the instances (dump final values first)
+    if (m_stats) {
+        m_stats->flush();
+    }
+    m_stats.reset();
+
     // Wait for termination (destructor of smart pointers will call instance destructor)
     m_running_inputs.clear();
     m_running_inter.clear();
@@ -632,6 +702,9 @@ ipx_configurator::run(ipx_controller *ctrl)
             break;
         case IPX_CPIPE_TYPE_PERIODIC:
             periodic_send_msg(&periodic_message_sequence);
+            if (m_stats) {
+                m_stats->tick();
+            }
             break;
         default:
             IPX_ERROR(comp_str, "Ignoring unknown configuration request!", '\0');
@@ -53,6 +53,7 @@
 #include "instance_output.hpp"
 #include "plugin_mgr.hpp"
 #include "controller.hpp"
+#include "stats.hpp"
 
 extern "C" {
 #include <ipfixcol2.h>
@@ -131,6 +132,8 @@ private:
     std::vector<std::unique_ptr<ipx_instance_output> > m_running_outputs;
     /** Number of sent termination messages */
     size_t m_term_sent = 0;
+    /** Periodic dump of runtime statistics (nullptr == disabled)                              */
+    std::unique_ptr<ipx_stats_dump> m_stats;
 
     // Internal functions
     void
@@ -139,6 +142,8 @@ private:
     iemgr_load(const std::string dir);
     enum ipx_verb_level
     verbosity_str2level(const std::string &verb);
+    enum ipx_ring_type
+    ringtype_str2type(const std::string &type);
 
     void
     startup(const ipx_config_model &model);
@@ -22,6 +22,14 @@ enum file_xml_nodes {
     LIST_INPUTS = 1,
     LIST_INTER,
     LIST_OUTPUT,
+    // Pipeline configuration
+    PIPELINE,
+    PIPELINE_RING_TYPE,
+    PIPELINE_PARSER_THREADS,
+    PIPELINE_STATS,
+    STATS_FILE,
+    STATS_SOCKET,
+    STATS_INTERVAL,
     // Instances
     INSTANCE_INPUT,
     INSTANCE_INTER,
@@ -43,6 +51,7 @@ enum file_xml_nodes {
     OUT_PLUGIN_VERBOSITY,
     OUT_PLUGIN_ODID_ONLY,
     OUT_PLUGIN_ODID_EXCEPT,
+    OUT_PLUGIN_THREADS,
 };
 
 /**
@@ -94,6 +103,7 @@ static const struct fds_xml_args args_instance_output[] = {
     FDS_OPTS_ELEM(OUT_PLUGIN_VERBOSITY,   "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_EXCEPT, "odidExcept", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_ONLY,   "odidOnly",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_THREADS,     "threads",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( OUT_PLUGIN_PARAMS,      "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -107,6 +117,25 @@ static const struct fds_xml_args args_list_output[] = {
     FDS_OPTS_END
 };
 
+/**
+ * \brief Definition of the \<stats\> node
+ * \note Presence of exactly one output is checked during building of the model
+ */
+static const struct fds_xml_args args_stats[] = {
+    FDS_OPTS_ELEM(STATS_FILE,     "file",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(STATS_SOCKET,   "socket",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(STATS_INTERVAL, "interval", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<pipeline\> node                                                         */
+static const struct fds_xml_args args_pipeline[] = {
+    FDS_OPTS_ELEM(PIPELINE_RING_TYPE,      "ringType",      FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PIPELINE_PARSER_THREADS, "parserThreads", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(PIPELINE_STATS,        "stats",         args_stats,        FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 /**
  * \brief Definition of the main \<ipfixcol2\> node
  * \note
@@ -118,6 +147,7 @@ static const struct fds_xml_args args_main[] = {
     FDS_OPTS_NESTED(LIST_INPUTS, "inputPlugins",        args_list_inputs, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(LIST_INTER,  "intermediatePlugins", args_list_inter,  FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(LIST_OUTPUT, "outputPlugins",       args_list_output, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(PIPELINE,    "pipeline",            args_pipeline,    FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -202,6 +232,9 @@ ipx_controller_file::parse_file(const std::string &path)
         case LIST_OUTPUT:
             parse_list_output(content->ptr_ctx, model);
             break;
+        case PIPELINE:
+            parse_pipeline(content->ptr_ctx, model);
+            break;
         default:
             // Unexpected XML node within startup <ipfixcol2>!
             assert(false);
@@ -288,6 +321,83 @@ ipx_controller_file::parse_list_output(fds_xml_ctx_t *ctx, ipx_config_model &mod
     }
 }
 
+/**
+ * \brief Parse \<pipeline\> node and add the parsed configuration to the model
+ * \param[in] ctx   Parsed XML node
+ * \param[in] model Configuration model
+ * \throw ipx_controller::error if the parameters are not valid
+ */
+void
+ipx_controller_file::parse_pipeline(fds_xml_ctx_t *ctx, ipx_config_model &model)
+{
+    struct ipx_pipeline_cfg pipeline;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case PIPELINE_RING_TYPE:
+            pipeline.ring_type = content->ptr_string;
+            break;
+        case PIPELINE_PARSER_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > ipx_pipeline_cfg::PARSER_THREADS_MAX) {
+                throw ipx_controller::error("Number of parser threads ('<parserThreads>') is "
+                    "too high!");
+            }
+            pipeline.parser_threads = static_cast<unsigned int>(content->val_uint);
+            break;
+        case PIPELINE_STATS:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_stats(content->ptr_ctx, pipeline.stats);
+            break;
+        default:
+            // Unexpected XML node within <pipeline>!
+            assert(false);
+        }
+    }
+
+    try {
+        model.set_pipeline(pipeline);
+    } catch (std::exception &ex) {
+        throw ipx_controller::error("Failed to parse the configuration of the pipeline ("
+            + std::string(ex.what()) + ")");
+    }
+}
+
+/**
+ * \brief Parse \<stats\> node of the pipeline configuration
+ * \param[in]  ctx   Parsed XML node
+ * \param[out] stats Configuration of statistics
+ * \throw ipx_controller::error if the parameters are not valid
+ */
+void
+ipx_controller_file::parse_stats(fds_xml_ctx_t *ctx, struct ipx_stats_cfg &stats)
+{
+    stats.enabled = true;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case STATS_FILE:
+            stats.file = content->ptr_string;
+            break;
+        case STATS_SOCKET:
+            stats.socket = content->ptr_string;
+            break;
+        case STATS_INTERVAL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > ipx_stats_cfg::INTERVAL_MAX) {
+                throw ipx_controller::error("Interval of statistics ('<interval>') is too long!");
+            }
+            stats.interval = static_cast<unsigned int>(content->val_uint);
+            break;
+        default:
+            // Unexpected XML node within <stats>!
+            assert(false);
+        }
+    }
+}
+
 /**
  * \brief Parse \<input\> node and add the parsed input instance to the model
  * \param[in] ctx   Parsed XML node
@@ -403,6 +513,14 @@ ipx_controller_file::parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model
                 break;
             }
             throw std::invalid_argument("Multiple definitions of <odidExcept>/<odidOnly>!");
+        case OUT_PLUGIN_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > ipx_plugin_output::THREADS_MAX) {
+                throw std::invalid_argument("Number of threads ('<threads>') of an output "
+                    "instance is too high!");
+            }
+            output.threads = static_cast<unsigned int>(content->val_uint);
+            break;
         default:
             // Unexpected XML node within <output>!
             assert(false);
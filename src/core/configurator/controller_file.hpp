@@ -52,6 +52,11 @@ private:
     static void
     parse_list_output(fds_xml_ctx_t *ctx, ipx_config_model &model);
 
+    static void
+    parse_pipeline(fds_xml_ctx_t *ctx, ipx_config_model &model);
+    static void
+    parse_stats(fds_xml_ctx_t *ctx, struct ipx_stats_cfg &stats);
+
     static void
     parse_instance_input(fds_xml_ctx_t *ctx, ipx_config_model &model);
     static void
@@ -46,6 +46,7 @@
 #include <string>
 #include <stdexcept>
 #include <memory>
+#include <vector>
 #include "plugin_mgr.hpp"
 #include "extensions.hpp"
 
@@ -157,6 +158,27 @@ public:
     set_processing(bool en) {
         ipx_ctx_processing_set(_ctx, en);
     }
+
+    /**
+     * \brief Enable/disable collection of runtime statistics
+     * \note By default, collection of statistics is disabled.
+     * \warning Must be called before start()
+     * \param[in] en Enable/disable statistics
+     */
+    virtual void
+    set_stats(bool en) {
+        ipx_ctx_stats_enable(_ctx, en);
+    }
+
+    /**
+     * \brief Get all contexts of the instance
+     * \note Some instances consist of multiple contexts (e.g. an input instance and its parser)
+     * \param[out] ctxs Vector to which the contexts are appended (in the order of the pipeline)
+     */
+    virtual void
+    get_contexts(std::vector<const ipx_ctx_t *> &ctxs) {
+        ctxs.push_back(_ctx);
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_H
@@ -56,11 +56,13 @@ static const struct ipx_ctx_callbacks parser_callbacks = {
     &ipx_plugin_parser_destroy,
     nullptr, // No getter
     &ipx_plugin_parser_process,
-    nullptr  // No feedback
+    nullptr, // No feedback
+    nullptr  // No batch processing
 };
 
 ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-    uint32_t bsize) : ipx_instance(name, ref)
+    uint32_t bsize, enum ipx_ring_type btype, unsigned int parser_threads)
+    : ipx_instance(name, ref)
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
@@ -70,7 +72,7 @@ ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::
     // Create all components
     std::string pname = name + " (parser)";
     unique_fpipe feedback(ipx_fpipe_create(), &ipx_fpipe_destroy);
-    unique_ring  ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+    unique_ring  ring_wrap(ipx_ring_init(bsize, false, btype), &ipx_ring_destroy);
     unique_ctx   input_wrap(ipx_ctx_create(name.c_str(), cbs), &ipx_ctx_destroy);
     unique_ctx   parser_wrap(ipx_ctx_create(pname.c_str(), &parser_callbacks), &ipx_ctx_destroy);
     if (!feedback || !ring_wrap || !parser_wrap || !input_wrap) {
@@ -88,6 +90,16 @@ ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::
         ipx_ctx_fpipe_set(parser_wrap.get(), feedback.get());
     }
 
+    if (parser_threads > 1) {
+        // IPFIX Messages are dispatched to multiple parser threads (see the parser plugin)
+        const char *ring_type = (btype == IPX_RING_TYPE_LOCKFREE) ? "lockfree" : "locked";
+        _parser_params = "<params>"
+            "<threads>" + std::to_string(parser_threads) + "</threads>"
+            "<ringSize>" + std::to_string(bsize) + "</ringSize>"
+            "<ringType>" + ring_type + "</ringType>"
+            "</params>";
+    }
+
     // Success
     _ctx = input_wrap.release();
     _input_feedback = feedback.release();
@@ -119,7 +131,8 @@ ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ip
     ipx_ctx_iemgr_set(_parser_ctx, iemgr);
 
     // Initialize
-    if (ipx_ctx_init(_parser_ctx, nullptr) != IPX_OK) {
+    const char *parser_params = _parser_params.empty() ? nullptr : _parser_params.c_str();
+    if (ipx_ctx_init(_parser_ctx, parser_params) != IPX_OK) {
         throw std::runtime_error("Failed to initialize the parser of IPFIX Messages!");
     }
 
@@ -190,4 +203,17 @@ void
 ipx_instance_input::set_parser_processing(bool en)
 {
     ipx_ctx_processing_set(_parser_ctx, en);
-}
\ No newline at end of file
+}
+void
+ipx_instance_input::set_stats(bool en)
+{
+    ipx_ctx_stats_enable(_ctx, en);
+    ipx_ctx_stats_enable(_parser_ctx, en);
+}
+
+void
+ipx_instance_input::get_contexts(std::vector<const ipx_ctx_t *> &ctxs)
+{
+    ctxs.push_back(_ctx);
+    ctxs.push_back(_parser_ctx);
+}
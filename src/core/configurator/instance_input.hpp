@@ -89,6 +89,8 @@ protected:
     ipx_ring_t  *_parser_buffer;
     /** Instance of the parser plugin (internal)                                                 */
     ipx_ctx_t   *_parser_ctx;
+    /** Parameters of the parser instance (empty == defaults)                                    */
+    std::string  _parser_params;
 
     // Disable copy constructors
     ipx_instance_input(const ipx_instance_input &) = delete;
@@ -105,8 +107,11 @@ public:
      * \param[in] name   Name of the instance
      * \param[in] ref    Reference to the plugin (will be automatically delete on destroy)
      * \param[in] bsize  Size of the ring buffer between the input instance and the parser instance
+     * \param[in] btype  Type of the ring buffer
+     * \param[in] parser_threads Number of parser threads (1 == parse in the parser instance thread)
      */
-    ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize);
+    ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize,
+        enum ipx_ring_type btype, unsigned int parser_threads = 1);
     /**
      * \brief Destroy the instance
      * \note
@@ -182,6 +187,20 @@ public:
      */
     void
     set_parser_processing(bool en);
+
+    /**
+     * \brief Enable/disable collection of runtime statistics of the plugin and the parser
+     * \param[in] en Enable/disable statistics
+     */
+    void
+    set_stats(bool en) override;
+
+    /**
+     * \brief Get contexts of the input plugin and the parser
+     * \param[out] ctxs Vector to which the contexts are appended
+     */
+    void
+    get_contexts(std::vector<const ipx_ctx_t *> &ctxs) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_INPUT_HPP
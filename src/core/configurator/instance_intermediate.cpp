@@ -47,12 +47,14 @@
  * The function prepares plugin context and input ring buffer to be prepared for start.
  * \param[in] cbs   Callback function
  * \param[in] bsize Size of the input ring buffer
+ * \param[in] btype Type of the input ring buffer
  * \throw runtime_error if any component fails to initialize
  */
 void
-ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize)
+ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize,
+    enum ipx_ring_type btype)
 {
-    unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+    unique_ring ring_wrap(ipx_ring_init(bsize, false, btype), &ipx_ring_destroy);
     unique_ctx  inter_wrap(ipx_ctx_create(_name.c_str(), cbs), &ipx_ctx_destroy);
     if (!ring_wrap || !inter_wrap) {
         throw std::runtime_error("Failed to create components of an intermediate instance!");
@@ -66,22 +68,22 @@ ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, u
 }
 
 ipx_instance_intermediate::ipx_instance_intermediate(const std::string &name,
-    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize)
+    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize, enum ipx_ring_type btype)
     : ipx_instance(name, ref) // The base class takes care of the plugin reference
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
     const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
     assert(cbs != nullptr && plugin->get_type() == IPX_PT_INTERMEDIATE);
-    internals_init(cbs, bsize);
+    internals_init(cbs, bsize, btype);
 }
 
 ipx_instance_intermediate::ipx_instance_intermediate(const std::string &name,
-    const ipx_ctx_callbacks *cbs, uint32_t bsize)
+    const ipx_ctx_callbacks *cbs, uint32_t bsize, enum ipx_ring_type btype)
     : ipx_instance(name, nullptr) // No plugin reference is passed to the base class
 {
     // Pass user defined callbacks
-    internals_init(cbs, bsize);
+    internals_init(cbs, bsize, btype);
 }
 
 ipx_instance_intermediate::~ipx_instance_intermediate()
@@ -69,7 +69,8 @@
  */
 class ipx_instance_intermediate : public ipx_instance {
 private:
-    void internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize);
+    void internals_init(const struct ipx_ctx_callbacks *cbs, uint32_t bsize,
+        enum ipx_ring_type btype);
 protected:
     /** Allow connector to enable multi-write mode                                               */
     friend void ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate);
@@ -89,9 +90,10 @@ public:
      * \param[in] name  Name of the instance
      * \param[in] ref   Reference to the plugin (will be automatically delete on destroy)
      * \param[in] bsize Size of the input ring buffer
+     * \param[in] btype Type of the input ring buffer
      */
     ipx_instance_intermediate(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-        uint32_t bsize);
+        uint32_t bsize, enum ipx_ring_type btype);
 
     /**
      * \brief Create an instance of an intermediate plugin (static internal plugins only)
@@ -102,9 +104,10 @@ public:
      * \param[in] name  Name of the instance
      * \param[in] cbs   Plugin callbacks
      * \param[in] bsize Size of the input ring buffer
+     * \param[in] btype Type of the input ring buffer
      */
     ipx_instance_intermediate(const std::string &name, const ipx_ctx_callbacks *cbs,
-        uint32_t bsize);
+        uint32_t bsize, enum ipx_ring_type btype);
 
     /**
      * \brief Destroy the instance
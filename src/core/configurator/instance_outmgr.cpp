@@ -55,11 +55,12 @@ static const struct ipx_ctx_callbacks output_mgr_callbacks = {
     &ipx_plugin_output_mgr_destroy,
     nullptr, // No getter
     &ipx_plugin_output_mgr_process,
-    nullptr  // No feedback
+    nullptr, // No feedback
+    &ipx_plugin_output_mgr_process_batch
 };
 
-ipx_instance_outmgr::ipx_instance_outmgr(uint32_t bsize)
-    : ipx_instance_intermediate("Output manager", &output_mgr_callbacks, bsize)
+ipx_instance_outmgr::ipx_instance_outmgr(uint32_t bsize, enum ipx_ring_type btype)
+    : ipx_instance_intermediate("Output manager", &output_mgr_callbacks, bsize, btype)
 {
     _list = ipx_output_mgr_list_create();
     if (!_list) {
@@ -104,11 +105,11 @@ ipx_instance_outmgr::connect_to(ipx_instance_output &output)
     assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
     auto connection = output.get_input();
 
-    ipx_ring_t *ring = std::get<0>(connection);
+    const std::vector<ipx_ring_t *> &rings = std::get<0>(connection);
     enum ipx_odid_filter_type filter_type = std::get<1>(connection);
     const ipx_orange_t *filter = std::get<2>(connection);
 
-    if (ipx_output_mgr_list_add(_list, ring, filter_type, filter) != IPX_OK) {
+    if (ipx_output_mgr_list_add(_list, rings.data(), rings.size(), filter_type, filter) != IPX_OK) {
         throw std::runtime_error("Failed to connect an output instance to the output manager!");
     }
 }
\ No newline at end of file
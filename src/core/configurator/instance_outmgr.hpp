@@ -82,8 +82,9 @@ public:
     /**
      * \brief Create an instance of the internal output manager plugin
      * \param[in] bsize  Size of the input ring buffer
+     * \param[in] btype  Type of the input ring buffer
      */
-    explicit ipx_instance_outmgr(uint32_t bsize);
+    ipx_instance_outmgr(uint32_t bsize, enum ipx_ring_type btype);
     /**
      * \brief Destroy the instance
      *   If the thread is running (start() has been called), the function blocks until the thread
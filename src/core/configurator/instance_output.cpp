@@ -43,35 +43,60 @@
 
 
 ipx_instance_output::ipx_instance_output(const std::string &name,
-    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize) : ipx_instance(name, ref)
+    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize, enum ipx_ring_type btype, unsigned int wcnt)
+    : ipx_instance(name, ref)
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
     const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
     assert(cbs != nullptr && plugin->get_type() == IPX_PT_OUTPUT);
+    assert(wcnt > 0);
 
-    unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
-    unique_ctx  output_wrap(ipx_ctx_create(name.c_str(), cbs), &ipx_ctx_destroy);
-    if (!ring_wrap || !output_wrap) {
-        throw std::runtime_error("Failed to create components of an output instance!");
+    if (wcnt > 1 && (cbs->info->flags & IPX_PF_OUTPUT_WORKERS) == 0) {
+        throw std::runtime_error("Output plugin '" + std::string(cbs->info->name) + "' of the "
+            "instance '" + name + "' doesn't support multiple threads!");
     }
 
-    // Configure the components (connect them)
-    ipx_ctx_ring_src_set(output_wrap.get(), ring_wrap.get());
-    _instance_buffer = ring_wrap.release();
-    _ctx = output_wrap.release();
-
     // Default parameters
     _type = IPX_ODID_FILTER_NONE;
     _filter = nullptr;
+
+    std::vector<unique_ring> rings;
+    std::vector<unique_ctx> workers;
+    for (unsigned int i = 0; i < wcnt; ++i) {
+        const std::string worker_name = (wcnt == 1)
+            ? name : name + " (worker " + std::to_string(i) + ")";
+
+        rings.emplace_back(ipx_ring_init(bsize, false, btype), &ipx_ring_destroy);
+        workers.emplace_back(ipx_ctx_create(worker_name.c_str(), cbs), &ipx_ctx_destroy);
+        if (!rings.back() || !workers.back()) {
+            throw std::runtime_error("Failed to create components of an output instance!");
+        }
+
+        // Configure the components (connect them)
+        ipx_ctx_ring_src_set(workers.back().get(), rings.back().get());
+        ipx_ctx_worker_set(workers.back().get(), i, wcnt);
+    }
+
+    _instance_buffers.reserve(wcnt);
+    _workers.reserve(wcnt);
+    for (unsigned int i = 0; i < wcnt; ++i) {
+        _instance_buffers.push_back(rings[i].release());
+        _workers.push_back(workers[i].release());
+    }
+    _ctx = _workers.front();
 }
 
 ipx_instance_output::~ipx_instance_output()
 {
-    // Destroy context (if running, wait for termination of threads)
-    ipx_ctx_destroy(_ctx);
+    // Destroy contexts (if running, wait for termination of threads)
+    for (ipx_ctx_t *worker : _workers) {
+        ipx_ctx_destroy(worker);
+    }
     // Now we can destroy buffers
-    ipx_ring_destroy(_instance_buffer);
+    for (ipx_ring_t *ring : _instance_buffers) {
+        ipx_ring_destroy(ring);
+    }
 
     if (_filter == nullptr) {
         return;
@@ -115,13 +140,15 @@ void ipx_instance_output::init(const std::string &params, const fds_iemgr_t *iem
     assert(_state == state::NEW); // Only not initialized instance can be initialized
     assert(iemgr != nullptr);
 
-    // Configure
-    ipx_ctx_verb_set(_ctx, level);
-    ipx_ctx_iemgr_set(_ctx, iemgr);
+    for (ipx_ctx_t *worker : _workers) {
+        // Configure
+        ipx_ctx_verb_set(worker, level);
+        ipx_ctx_iemgr_set(worker, iemgr);
 
-    // Initialize
-    if (ipx_ctx_init(_ctx, params.c_str()) != IPX_OK) {
-        throw std::runtime_error("Failed to initialize the instance of the output plugin!");
+        // Initialize
+        if (ipx_ctx_init(worker, params.c_str()) != IPX_OK) {
+            throw std::runtime_error("Failed to initialize the instance of the output plugin!");
+        }
     }
     _state = state::INITIALIZED;
 }
@@ -130,14 +157,54 @@ void
 ipx_instance_output::start()
 {
     assert(_state == state::INITIALIZED); // Only initialized instances can start
-    if (ipx_ctx_run(_ctx) != IPX_OK) {
-        throw std::runtime_error("Failed to start a thread of the output instance.");
+    for (ipx_ctx_t *worker : _workers) {
+        if (ipx_ctx_run(worker) != IPX_OK) {
+            throw std::runtime_error("Failed to start a thread of the output instance.");
+        }
     }
     _state = state::RUNNING;
 }
 
-std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
+std::tuple<const std::vector<ipx_ring_t *> &, enum ipx_odid_filter_type, const ipx_orange_t *>
 ipx_instance_output::get_input()
 {
-    return std::make_tuple(_instance_buffer, _type, _filter);
-}
\ No newline at end of file
+    return std::forward_as_tuple(_instance_buffers, _type, _filter);
+}
+
+void
+ipx_instance_output::extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos)
+{
+    for (ipx_ctx_t *worker : _workers) {
+        ext_mgr->register_instance(worker, pos);
+    }
+}
+
+void
+ipx_instance_output::extensions_resolve(ipx_cfg_extensions *ext_mgr)
+{
+    for (ipx_ctx_t *worker : _workers) {
+        ext_mgr->update_instance(worker);
+    }
+}
+
+void
+ipx_instance_output::set_processing(bool en)
+{
+    for (ipx_ctx_t *worker : _workers) {
+        ipx_ctx_processing_set(worker, en);
+    }
+}
+
+void
+ipx_instance_output::set_stats(bool en)
+{
+    for (ipx_ctx_t *worker : _workers) {
+        ipx_ctx_stats_enable(worker, en);
+    }
+}
+
+void
+ipx_instance_output::get_contexts(std::vector<const ipx_ctx_t *> &ctxs)
+{
+    ctxs.insert(ctxs.end(), _workers.begin(), _workers.end());
+}
@@ -43,6 +43,7 @@
 #define IPFIXCOL_INSTANCE_OUTPUT_HPP
 
 #include <memory>
+#include <vector>
 #include "instance.hpp"
 
 extern "C" {
@@ -56,22 +57,35 @@ using unique_orange = std::unique_ptr<ipx_orange_t, decltype(&ipx_orange_destroy
  * \brief Instance of the output plugin
  *
  * The class takes care of (i.e. initialize, configure and destroy):
- * - a plugin context of an output plugin
- * - an input ring buffer
+ * - plugin contexts of an output plugin (one per worker)
+ * - input ring buffers (one per worker)
  * - an ODID filter (only if configured)
  *
+ * By default, the instance consists of a single worker. If the plugin supports it (see
+ * #IPX_PF_OUTPUT_WORKERS), multiple workers can be created. Each of them is an independent
+ * instance of the plugin with its own thread and the output manager distributes IPFIX Messages
+ * among them.
+ *
  * \verbatim
- *              +--------+
- *              |        |
- *       +------> Output |
- *         ring |        |
- *              +--------+
+ *              +------------+
+ *              |            |
+ *       +------> Output #0  |
+ *         ring |            |
+ *              +------------+
+ *                   ...
+ *              +------------+
+ *              |            |
+ *       +------> Output #N  |
+ *         ring |            |
+ *              +------------+
  * \endverbatim
  */
 class ipx_instance_output : public ipx_instance {
 protected:
-    /** Input ring buffer                                                                        */
-    ipx_ring_t *_instance_buffer;
+    /** Input ring buffers of workers                                                            */
+    std::vector<ipx_ring_t *> _instance_buffers;
+    /** Contexts of workers (the first one is also available as _ctx)                            */
+    std::vector<ipx_ctx_t *> _workers;
 
     /** ODID filter type                                                                         */
     enum ipx_odid_filter_type _type;
@@ -88,9 +102,12 @@ public:
      * \param[in] name   Name of the instance
      * \param[in] ref    Reference to the plugin (will be automatically delete on destroy)
      * \param[in] bsize  Size of the input ring buffer
+     * \param[in] btype  Type of the input ring buffer
+     * \param[in] wcnt   Number of workers
+     * \throw runtime_error if the plugin doesn't support multiple workers and \p wcnt > 1
      */
     ipx_instance_output(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-        uint32_t bsize);
+        uint32_t bsize, enum ipx_ring_type btype, unsigned int wcnt = 1);
     /**
      * \brief Destroy the instance
      * \note
@@ -124,19 +141,56 @@ public:
     void init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level);
 
     /**
-     * \brief Start a thread of the instance
+     * \brief Start threads of all workers of the instance
      * \throw runtime_error if a thread fails to the start
      */
     void start();
 
     /**
-     * \brief Get the input ring buffer (for writing only)
+     * \brief Get the input ring buffers of all workers (for writing only)
      * \warning
      *   Do NOT use if there is already another active writer.
-     * \return Pointer to the ring buffer and the ODID filter.
+     * \return Pointers to the ring buffers and the ODID filter.
      */
-    std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
+    std::tuple<const std::vector<ipx_ring_t *> &, enum ipx_odid_filter_type, const ipx_orange_t *>
     get_input();
+
+
+    /**
+     * \brief Registered extensions and dependencies of all workers
+     * \param[in] ext_mgr Extension manager
+     */
+    void
+    extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos) override;
+
+    /**
+     * \brief Resolve definition of the extension/dependency definitions of all workers
+     * \param[in] ext_mgr Extension manager
+     */
+    void
+    extensions_resolve(ipx_cfg_extensions *ext_mgr) override;
+
+    /**
+     * \brief Enable/disable processing of data messages by all workers
+     * \see ipx_ctx_processing() for more details
+     * \param[in] en Enable/disable processing
+     */
+    void
+    set_processing(bool en) override;
+
+    /**
+     * \brief Enable/disable collection of runtime statistics of all workers
+     * \param[in] en Enable/disable statistics
+     */
+    void
+    set_stats(bool en) override;
+
+    /**
+     * \brief Get contexts of all workers
+     * \param[out] ctxs Vector to which the contexts are appended
+     */
+    void
+    get_contexts(std::vector<const ipx_ctx_t *> &ctxs) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTPUT_HPP
@@ -142,9 +142,45 @@ ipx_config_model::add_instance(struct ipx_plugin_output &instance)
             "output instance '" + instance.name + "' cannot be empty!");
     }
 
+    if (instance.threads < 1 || instance.threads > ipx_plugin_output::THREADS_MAX) {
+        throw std::invalid_argument("Number of threads ('<threads>') of the output instance '"
+            + instance.name + "' must be between 1 and "
+            + std::to_string(ipx_plugin_output::THREADS_MAX) + "!");
+    }
+
     outputs.push_back(instance);
 }
 
+void
+ipx_config_model::set_pipeline(struct ipx_pipeline_cfg &cfg)
+{
+    if (!cfg.ring_type.empty()
+        && strcasecmp(cfg.ring_type.c_str(), "default") != 0
+        && strcasecmp(cfg.ring_type.c_str(), "locked") != 0
+        && strcasecmp(cfg.ring_type.c_str(), "lockfree") != 0) {
+        throw std::invalid_argument("Ring buffer type ('<ringType>') '" + cfg.ring_type
+            + "' is not valid type!");
+    }
+
+    if (cfg.parser_threads < 1 || cfg.parser_threads > ipx_pipeline_cfg::PARSER_THREADS_MAX) {
+        throw std::invalid_argument("Number of parser threads ('<parserThreads>') must be "
+            "between 1 and " + std::to_string(ipx_pipeline_cfg::PARSER_THREADS_MAX) + "!");
+    }
+
+    if (cfg.stats.enabled) {
+        if (cfg.stats.file.empty() == cfg.stats.socket.empty()) {
+            throw std::invalid_argument("Exactly one output of statistics ('<file>' or "
+                "'<socket>') must be defined!");
+        }
+        if (cfg.stats.interval < 1 || cfg.stats.interval > ipx_stats_cfg::INTERVAL_MAX) {
+            throw std::invalid_argument("Interval of statistics ('<interval>') must be between "
+                "1 and " + std::to_string(ipx_stats_cfg::INTERVAL_MAX) + " seconds!");
+        }
+    }
+
+    pipeline = cfg;
+}
+
 void
 ipx_config_model::dump()
 {
@@ -69,10 +69,43 @@ struct ipx_plugin_inter  : ipx_plugin_base {};
 
 /** Configuration of an output plugin                                         */
 struct ipx_plugin_output : ipx_plugin_base {
+    /** Maximum number of worker threads                                      */
+    static constexpr unsigned int THREADS_MAX = 64;
+
     /** ODID filter type                                                      */
     enum ipx_odid_filter_type odid_type;
     /** ODID filter expression                                                */
     std::string odid_expression;
+    /** Number of worker threads                                              */
+    unsigned int threads = 1;
+};
+
+/** Configuration of runtime statistics of the pipeline                        */
+struct ipx_stats_cfg {
+    /** Maximum interval between dumps of statistics (in seconds)                 */
+    static constexpr unsigned int INTERVAL_MAX = 3600;
+
+    /** Collection of statistics enabled                                          */
+    bool enabled = false;
+    /** Output file of statistics (if empty, not used)                            */
+    std::string file;
+    /** Output UNIX datagram socket of statistics (if empty, not used)            */
+    std::string socket;
+    /** Interval between dumps of statistics (in seconds)                         */
+    unsigned int interval = 1;
+};
+
+/** Configuration of the internal pipeline                                    */
+struct ipx_pipeline_cfg {
+    /** Maximum number of IPFIX parser threads per input instance                 */
+    static constexpr unsigned int PARSER_THREADS_MAX = 64;
+
+    /** Implementation of ring buffers between instances (if empty, use default) */
+    std::string ring_type;
+    /** Number of IPFIX parser threads per input instance (1 == parse in the instance thread) */
+    unsigned int parser_threads = 1;
+    /** Runtime statistics of instances                                           */
+    struct ipx_stats_cfg stats;
 };
 
 /** Parsed configuration of the collector                                      */
@@ -85,6 +118,8 @@ private:
     std::vector<struct ipx_plugin_inter>  inters;
     /** List of instances of output plugins                                    */
     std::vector<struct ipx_plugin_output> outputs;
+    /** Configuration of the internal pipeline                                 */
+    struct ipx_pipeline_cfg pipeline;
 
     void check_common(struct ipx_plugin_base *base);
 public:
@@ -112,6 +147,12 @@ public:
      * \throw invalid_argument if there is any obvious configuration error
      */
     void add_instance(struct ipx_plugin_output &instance);
+    /**
+     * \brief Set configuration of the internal pipeline
+     * \param[in] cfg Configuration
+     * \throw invalid_argument if there is any obvious configuration error
+     */
+    void set_pipeline(struct ipx_pipeline_cfg &cfg);
 };
 
 #endif //IPFIXCOL_MODEL_H
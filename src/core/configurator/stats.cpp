@@ -0,0 +1,381 @@
+/**
+ * \file src/core/configurator/stats.cpp
+ * \brief Periodic dump of runtime statistics (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "stats.hpp"
+
+extern "C" {
+#include "../context.h"
+#include "../verbose.h"
+}
+
+/** Component identification (for log) */
+static const char *comp_str = "Statistics";
+
+/**
+ * \brief Get current time (in milliseconds)
+ * \param[in] clk Clock type
+ */
+static uint64_t
+time_ms(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000U + static_cast<uint64_t>(ts.tv_nsec) / 1000000U;
+}
+
+/**
+ * \brief Append a JSON string (with escaped characters) to the output
+ * \param[in,out] out Output string
+ * \param[in]     str String to append
+ */
+static void
+json_string(std::string &out, const char *str)
+{
+    out += '"';
+    for (const char *pos = str; *pos != '\0'; ++pos) {
+        const unsigned char c = static_cast<unsigned char>(*pos);
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                out += buffer;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * \brief Get a name of a plugin type
+ * \param[in] type Plugin type
+ */
+static const char *
+type2str(uint16_t type)
+{
+    switch (type) {
+    case IPX_PT_INPUT:        return "input";
+    case IPX_PT_INTERMEDIATE: return "intermediate";
+    case IPX_PT_OUTPUT:       return "output";
+    case IPX_PT_OUTPUT_MGR:   return "output manager";
+    default:                  return "unknown";
+    }
+}
+
+ipx_stats_dump::ipx_stats_dump(const struct ipx_stats_cfg &cfg)
+    : m_file(cfg.file), m_socket(cfg.socket)
+{
+    for (auto &hist : m_aux) {
+        hist.reset(new struct ipx_latency_hist);
+    }
+
+    m_interval = static_cast<uint64_t>(cfg.interval) * 1000U;
+    m_last = time_ms(CLOCK_MONOTONIC);
+
+    if (!m_file.empty()) {
+        m_file_tmp = m_file + ".tmp";
+        return;
+    }
+
+    struct sockaddr_un addr;
+    if (m_socket.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Path of the socket of statistics is too long!");
+    }
+
+    m_socket_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (m_socket_fd < 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        throw std::runtime_error("Failed to create a socket of statistics: "
+            + std::string(err_str));
+    }
+}
+
+ipx_stats_dump::~ipx_stats_dump()
+{
+    if (m_socket_fd >= 0) {
+        close(m_socket_fd);
+    }
+}
+
+void
+ipx_stats_dump::add(const ipx_ctx_t *ctx)
+{
+    struct ctx_rec rec;
+    rec.ctx = ctx;
+    rec.total.reset(new struct ipx_latency_hist);
+    rec.stage.reset(new struct ipx_latency_hist);
+    ipx_ctx_latency_hist_get(ctx, rec.total.get(), rec.stage.get());
+    m_ctxs.push_back(std::move(rec));
+}
+
+void
+ipx_stats_dump::tick()
+{
+    uint64_t now = time_ms(CLOCK_MONOTONIC);
+    if (now - m_last < m_interval) {
+        return;
+    }
+
+    m_last = now;
+    flush();
+}
+
+void
+ipx_stats_dump::flush()
+{
+    const std::string data = to_json();
+    if (m_socket_fd >= 0) {
+        write_socket(data);
+    } else {
+        write_file(data);
+    }
+}
+
+/**
+ * \brief Append plugin-specific counters of an instance to the output (if any)
+ * \param[in,out] out Output string
+ * \param[in]     ctx Instance context
+ */
+static void
+plugin_json(std::string &out, const ipx_ctx_t *ctx)
+{
+    const char *name;
+    uint64_t value;
+    unsigned int idx;
+
+    for (idx = 0; ipx_ctx_stats_plugin_get(ctx, idx, &name, &value) == IPX_OK; ++idx) {
+        out += (idx == 0) ? ",\"plugin\":{" : ",";
+        json_string(out, name);
+        out += ':' + std::to_string(value);
+    }
+
+    if (idx != 0) {
+        out += '}';
+    }
+}
+
+/**
+ * \brief Serialize statistics of all instances into a JSON document
+ * \return JSON document
+ */
+std::string
+ipx_stats_dump::to_json()
+{
+    std::string out;
+    out.reserve(256 * (m_ctxs.size() + 1));
+    out += "{\"time\":" + std::to_string(time_ms(CLOCK_REALTIME)) + ",\"instances\":[";
+
+    for (size_t i = 0; i < m_ctxs.size(); ++i) {
+        const ipx_ctx_t *ctx = m_ctxs[i].ctx;
+        const struct ipx_plugin_info *info = ipx_ctx_plugininfo_get(ctx);
+        struct ipx_ctx_stats stats;
+        ipx_ctx_stats_get(ctx, &stats);
+
+        if (i != 0) {
+            out += ',';
+        }
+        out += "{\"name\":";
+        json_string(out, ipx_ctx_name_get(ctx));
+        out += ",\"plugin\":";
+        json_string(out, info->name);
+        out += ",\"type\":";
+        json_string(out, type2str(info->type));
+
+        out += ",\"msg_in\":" + std::to_string(stats.msg_in);
+        out += ",\"msg_out\":" + std::to_string(stats.msg_out);
+        out += ",\"rec_in\":" + std::to_string(stats.rec_in);
+        out += ",\"rec_out\":" + std::to_string(stats.rec_out);
+        out += ",\"cb_calls\":" + std::to_string(stats.cb_calls);
+        out += ",\"cb_wall\":" + std::to_string(stats.cb_wall);
+        out += ",\"cpu_time\":" + std::to_string(stats.cpu_time);
+        out += ",\"ring_size\":" + std::to_string(stats.ring_size);
+        out += ",\"ring_fill\":" + std::to_string(stats.ring_fill);
+        out += ",\"ring_stall_time\":" + std::to_string(stats.ring_stall_time);
+        out += ",\"ring_stall_cnt\":" + std::to_string(stats.ring_stall_cnt);
+        plugin_json(out, ctx);
+        latency_json(out, m_ctxs[i]);
+        out += '}';
+    }
+
+    out += "]}\n";
+    return out;
+}
+
+/**
+ * \brief Append a summary of latency histogram to the output
+ * \param[in,out] out  Output string
+ * \param[in]     name Name of the JSON field
+ * \param[in]     hist Histogram
+ * \param[out]    sum  Summary of the histogram
+ */
+static void
+latency_summary(std::string &out, const char *name, const struct ipx_latency_hist *hist,
+    struct ipx_ctx_latency &sum)
+{
+    sum.cnt = hist->cnt;
+    sum.p50 = ipx_latency_hist_perc(hist, 50.0);
+    sum.p99 = ipx_latency_hist_perc(hist, 99.0);
+    sum.p999 = ipx_latency_hist_perc(hist, 99.9);
+    sum.max = hist->max;
+
+    out += '"';
+    out += name;
+    out += "\":{\"cnt\":" + std::to_string(sum.cnt);
+    out += ",\"p50\":" + std::to_string(sum.p50);
+    out += ",\"p99\":" + std::to_string(sum.p99);
+    out += ",\"p999\":" + std::to_string(sum.p999);
+    out += ",\"max\":" + std::to_string(sum.max);
+    out += '}';
+}
+
+/**
+ * \brief Append latencies of an instance since the previous dump to the output
+ *
+ * Snapshots of latency histograms of the instance are updated and the latencies are also
+ * reported to the log.
+ * \param[in,out] out Output string
+ * \param[in]     rec Registered instance
+ */
+void
+ipx_stats_dump::latency_json(std::string &out, struct ctx_rec &rec)
+{
+    std::unique_ptr<struct ipx_latency_hist> *prev[] = {&rec.total, &rec.stage};
+    std::unique_ptr<struct ipx_latency_hist> &tmp = m_aux[2];
+    const char *names[] = {"total", "stage"};
+    struct ipx_ctx_latency sum[2];
+
+    ipx_ctx_latency_hist_get(rec.ctx, m_aux[0].get(), m_aux[1].get());
+    out += ",\"latency\":{";
+    for (size_t i = 0; i < 2; ++i) {
+        struct ipx_latency_hist *hist = m_aux[i].get();
+
+        // Keep the current snapshot for the next time and get the difference from the previous
+        memcpy(tmp.get(), hist, sizeof(*hist));
+        ipx_latency_hist_sub(hist, prev[i]->get());
+        prev[i]->swap(tmp);
+
+        if (i != 0) {
+            out += ',';
+        }
+        latency_summary(out, names[i], hist, sum[i]);
+    }
+    out += '}';
+
+    IPX_DEBUG(comp_str, "Latency of '%s' (p50/p99/p999 in microseconds): "
+        "total %.1f/%.1f/%.1f, stage %.1f/%.1f/%.1f", ipx_ctx_name_get(rec.ctx),
+        sum[0].p50 / 1000.0, sum[0].p99 / 1000.0, sum[0].p999 / 1000.0,
+        sum[1].p50 / 1000.0, sum[1].p99 / 1000.0, sum[1].p999 / 1000.0);
+}
+
+/**
+ * \brief Replace the output file with new statistics
+ *
+ * The statistics are written to a temporary file first and then renamed, so readers never
+ * see a partially written document.
+ * \param[in] data JSON document
+ */
+void
+ipx_stats_dump::write_file(const std::string &data)
+{
+    const char *err_str;
+
+    FILE *file = fopen(m_file_tmp.c_str(), "w");
+    if (!file) {
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(comp_str, "Failed to open file '%s': %s", m_file_tmp.c_str(), err_str);
+        return;
+    }
+
+    bool ok = (fwrite(data.data(), 1, data.size(), file) == data.size());
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        IPX_WARNING(comp_str, "Failed to write statistics to file '%s'!", m_file_tmp.c_str());
+        unlink(m_file_tmp.c_str());
+        return;
+    }
+
+    if (rename(m_file_tmp.c_str(), m_file.c_str()) != 0) {
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(comp_str, "Failed to rename file '%s' to '%s': %s", m_file_tmp.c_str(),
+            m_file.c_str(), err_str);
+        unlink(m_file_tmp.c_str());
+    }
+}
+
+/**
+ * \brief Send statistics to the UNIX datagram socket
+ *
+ * The function never blocks. If nobody listens on the socket or the receiver is too slow,
+ * the statistics are silently dropped.
+ * \param[in] data JSON document
+ */
+void
+ipx_stats_dump::write_socket(const std::string &data)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_socket.c_str(), sizeof(addr.sun_path) - 1);
+
+    ssize_t ret = sendto(m_socket_fd, data.data(), data.size(), MSG_DONTWAIT,
+        reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    if (ret < 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_DEBUG(comp_str, "Failed to send statistics to socket '%s': %s", m_socket.c_str(),
+            err_str);
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * \file src/core/configurator/stats.hpp
+ * \brief Periodic dump of runtime statistics (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_STATS_HPP
+#define IPFIXCOL_STATS_HPP
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model.hpp"
+
+extern "C" {
+#include <ipfixcol2.h>
+#include "../latency.h"
+}
+
+/**
+ * \brief Periodic dump of runtime statistics of plugin instances
+ *
+ * Statistics of all registered instance contexts are serialized into a JSON document and
+ * written to a file or sent to a UNIX datagram socket. The document has the following format:
+ *
+ * \verbatim
+ * {
+ *   "time": <UNIX timestamp in milliseconds>,
+ *   "instances": [
+ *     {
+ *       "name": "<instance name>", "plugin": "<plugin name>", "type": "<plugin type>",
+ *       "msg_in": N, "msg_out": N, "rec_in": N, "rec_out": N, "cb_calls": N, "cb_wall": N,
+ *       "cpu_time": N,
+ *       "ring_size": N, "ring_fill": N, "ring_stall_time": N, "ring_stall_cnt": N,
+ *       "latency": {
+ *         "total": {"cnt": N, "p50": N, "p99": N, "p999": N, "max": N},
+ *         "stage": {"cnt": N, "p50": N, "p99": N, "p999": N, "max": N}
+ *       }
+ *     }, ...
+ *   ]
+ * }
+ * \endverbatim
+ *
+ * The instances are listed in the order of registration, i.e. in the order of the pipeline.
+ * All counters are monotonic, see ipx_ctx_stats_get() for more details. On the other hand,
+ * latencies (see ipx_ctx_latency_get()) are calculated only from measurements since
+ * the previous dump, so a change of latency is visible immediately. The latencies are also
+ * reported to the log as debug messages.
+ */
+class ipx_stats_dump {
+public:
+    /**
+     * \brief Create a dumper of statistics
+     * \param[in] cfg Configuration of statistics
+     * \throw runtime_error if the output cannot be prepared
+     */
+    explicit ipx_stats_dump(const struct ipx_stats_cfg &cfg);
+    /** \brief Destructor */
+    ~ipx_stats_dump();
+
+    // Disable copy constructors
+    ipx_stats_dump(const ipx_stats_dump &) = delete;
+    ipx_stats_dump &operator=(const ipx_stats_dump &) = delete;
+
+    /**
+     * \brief Register an instance context
+     * \warning The context MUST exist until this object is destroyed.
+     * \param[in] ctx Instance context
+     */
+    void
+    add(const ipx_ctx_t *ctx);
+
+    /**
+     * \brief Periodic update
+     *
+     * If the interval since the last dump has elapsed, statistics are dumped. Otherwise,
+     * nothing happens. Failures are reported to the log and never interrupt the collector.
+     */
+    void
+    tick();
+
+    /**
+     * \brief Dump statistics immediately (regardless of the interval)
+     *
+     * Typically used to provide final values of counters before termination.
+     */
+    void
+    flush();
+
+private:
+    /** Output file (if empty, not used)                                                      */
+    std::string m_file;
+    /** Temporary output file (the file is replaced atomically by renaming)                   */
+    std::string m_file_tmp;
+    /** Output UNIX datagram socket (if empty, not used)                                      */
+    std::string m_socket;
+    /** File descriptor of the local socket (-1 == not used)                                  */
+    int m_socket_fd = -1;
+    /** Interval between dumps (in milliseconds)                                               */
+    uint64_t m_interval;
+    /** Time of the last dump (monotonic time, in milliseconds)                                */
+    uint64_t m_last;
+    /** Registered instance context and the last snapshots of its latency histograms          */
+    struct ctx_rec {
+        /** Instance context                                                                   */
+        const ipx_ctx_t *ctx;
+        /** Histogram of latencies from creation of periodic messages                          */
+        std::unique_ptr<struct ipx_latency_hist> total;
+        /** Histogram of latencies from the previous instance                                  */
+        std::unique_ptr<struct ipx_latency_hist> stage;
+    };
+
+    /** Registered instance contexts                                                           */
+    std::vector<struct ctx_rec> m_ctxs;
+    /** Auxiliary histograms (the current snapshots and a temporary copy)                      */
+    std::unique_ptr<struct ipx_latency_hist> m_aux[3];
+
+    std::string
+    to_json();
+    void
+    latency_json(std::string &out, struct ctx_rec &rec);
+    void
+    write_file(const std::string &data);
+    void
+    write_socket(const std::string &data);
+};
+
+#endif // IPFIXCOL_STATS_HPP
@@ -46,6 +46,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <time.h>
 #if defined(__OpenBSD__) || defined(__FreeBSD__)
 #include <pthread_np.h>
 #else
@@ -60,6 +61,7 @@
 #include "ring.h"
 #include "message_ipfix.h"
 #include "message_periodic.h"
+#include "latency.h"
 #include "configurator/cpipe.h"
 
 /** Identification of this component (for log) */
@@ -150,6 +152,8 @@ struct ipx_ctx {
         const fds_iemgr_t *ie_mgr;
         /** Current size of IPFIX record (with registered extensions)                            */
         size_t rec_size;
+        /** Pool of IPFIX Message wrappers (only input and intermediate instances, can be NULL)  */
+        struct ipx_msg_ipfix_pool *ipfix_pool;
         /** Verbosity level of the plugin                                                        */
         uint8_t  vlevel;
         /**
@@ -160,6 +164,10 @@ struct ipx_ctx {
          * the input plugins MUST have the value corresponding to the number of input instances.
          */
         unsigned int term_msg_cnt;
+        /** Index of the worker of an output instance (see ipx_ctx_worker_get())                */
+        unsigned int worker_id;
+        /** Total number of workers of the output instance                                      */
+        unsigned int worker_cnt;
     } cfg_system; /**< System configuration                                                      */
 
     struct {
@@ -168,6 +176,53 @@ struct ipx_ctx {
         /** Size of extension definitions in the array                                           */
         size_t items_cnt;
     } cfg_extension; /**< Extension configuration                                                */
+
+    /**
+     * Runtime statistics (see ipx_ctx_stats_get())
+     * \note Counters are modified only by atomic operations as they can be read at any time.
+     */
+    struct {
+        /** Collection of counters enabled (cannot be changed after the thread is started)       */
+        bool enabled;
+        /** Messages passed to the processing function                                           */
+        uint64_t msg_in;
+        /** Messages passed to the successor                                                     */
+        uint64_t msg_out;
+        /** Data Records of IPFIX Messages passed to the processing function                     */
+        uint64_t rec_in;
+        /** Data Records of IPFIX Messages passed to the successor                               */
+        uint64_t rec_out;
+        /** Number of calls of the getter or processing function                                 */
+        uint64_t cb_calls;
+        /** Total wall-clock time spent in the getter or processing function (nanoseconds)       */
+        uint64_t cb_wall;
+        /** CPU time of the instance thread at its termination (nanoseconds, 0 == still running)  */
+        uint64_t cpu_time;
+    } stats;
+
+    /**
+     * Plugin-specific counters (see ipx_ctx_stats_plugin_add())
+     * \note Values are modified only by atomic operations as they can be read at any time.
+     */
+    struct {
+        /** Number of registered counters                                                        */
+        unsigned int cnt;
+        /** Names of the counters                                                                */
+        char *names[IPX_CTX_STATS_PLUGIN_MAX];
+        /** Values of the counters                                                               */
+        uint64_t values[IPX_CTX_STATS_PLUGIN_MAX];
+    } stats_plugin;
+
+    /**
+     * Latency of periodic messages (see ipx_ctx_latency_get())
+     * \note Histograms are modified only by the instance thread.
+     */
+    struct {
+        /** Time from creation of a periodic message to its arrival to the instance           */
+        struct ipx_latency_hist total;
+        /** Time from the previous instance to this instance (i.e. queueing and processing)   */
+        struct ipx_latency_hist stage;
+    } latency;
 };
 
 ipx_ctx_t *
@@ -195,6 +250,9 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
     ctx->cfg_system.msg_mask_selected = 0; // No messages to process selected
     ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION | IPX_MSG_PERIODIC;
     ctx->cfg_system.term_msg_cnt = 1; // By default, wait for 1 termination message
+    ctx->cfg_system.worker_id = 0;
+    ctx->cfg_system.worker_cnt = 1;
+    ctx->stats.enabled = false;
 
     ctx->cfg_extension.items = NULL;
     ctx->cfg_extension.items_cnt = 0;
@@ -244,6 +302,13 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
     }
     free(ctx->cfg_extension.items);
 
+    // Wrappers still in use will be freed later
+    ipx_msg_ipfix_pool_destroy(ctx->cfg_system.ipfix_pool);
+
+    for (unsigned int idx = 0; idx < ctx->stats_plugin.cnt; ++idx) {
+        free(ctx->stats_plugin.names[idx]);
+    }
+
     free(ctx->name);
     free(ctx);
 }
@@ -254,6 +319,12 @@ ipx_ctx_recsize_get(const ipx_ctx_t *ctx)
     return ctx->cfg_system.rec_size;
 }
 
+struct ipx_msg_ipfix_pool *
+ipx_ctx_ipfix_pool_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.ipfix_pool;
+}
+
 void
 ipx_ctx_recsize_set(ipx_ctx_t *ctx, size_t size)
 {
@@ -293,6 +364,37 @@ ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt)
     return IPX_OK;
 }
 
+void
+ipx_ctx_worker_set(ipx_ctx_t *ctx, unsigned int id, unsigned int cnt)
+{
+    assert(cnt > 0 && id < cnt);
+    ctx->cfg_system.worker_id = id;
+    ctx->cfg_system.worker_cnt = cnt;
+}
+
+void
+ipx_ctx_worker_get(const ipx_ctx_t *ctx, unsigned int *id, unsigned int *cnt)
+{
+    if (id != NULL) {
+        *id = ctx->cfg_system.worker_id;
+    }
+    if (cnt != NULL) {
+        *cnt = ctx->cfg_system.worker_cnt;
+    }
+}
+
+int
+ipx_ctx_subscribe_allow(ipx_ctx_t *ctx, ipx_msg_mask_t mask)
+{
+    if (ctx->state != IPX_CS_NEW) {
+        IPX_CTX_ERROR(ctx, "Called ipx_ctx_subscribe_allow() but it is not allowed!", '\0');
+        return IPX_ERR_ARG;
+    }
+
+    ctx->cfg_system.msg_mask_allowed |= mask;
+    return IPX_OK;
+}
+
 int
 ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t *mask_old)
 {
@@ -319,6 +421,263 @@ ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t
     return IPX_OK;
 }
 
+/**
+ * \brief Convert a timestamp to nanoseconds
+ */
+static inline uint64_t
+stats_ts2ns(const struct timespec *ts)
+{
+    return (uint64_t) ts->tv_sec * 1000000000ULL + (uint64_t) ts->tv_nsec;
+}
+
+/**
+ * \brief Get the current value of the monotonic clock (in nanoseconds)
+ */
+static inline uint64_t
+stats_time_get()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return stats_ts2ns(&ts);
+}
+
+/**
+ * \brief Store the final CPU time of the instance thread
+ *
+ * CPU time of a running thread is read by ipx_ctx_stats_get() using its CPU-time clock, which
+ * is not available after the thread has terminated.
+ * \note Must be called by the instance thread just before its termination.
+ * \param[in] ctx Instance context
+ */
+static void
+stats_cpu_final(ipx_ctx_t *ctx)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return;
+    }
+
+    // Zero is reserved for a running thread
+    const uint64_t value = stats_ts2ns(&ts);
+    __atomic_store_n(&ctx->stats.cpu_time, (value != 0) ? value : 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Get the number of Data Records in a message (IPFIX Messages only)
+ * \param[in] msg Message
+ * \return Number of records (zero for other types of messages)
+ */
+static inline uint64_t
+stats_rec_cnt(ipx_msg_t *msg)
+{
+    if (ipx_msg_get_type(msg) != IPX_MSG_IPFIX) {
+        return 0;
+    }
+
+    return ipx_msg_ipfix_get_drec_cnt(ipx_msg_base2ipfix(msg));
+}
+
+/**
+ * \brief Count a message passed to the successor
+ * \note Atomic operation, the function can be called by multiple threads (see
+ *   ipx_ctx_msg_pass_mt())
+ * \param[in] ctx Instance context
+ * \param[in] msg Message
+ */
+static inline void
+stats_msg_out(ipx_ctx_t *ctx, ipx_msg_t *msg)
+{
+    __atomic_fetch_add(&ctx->stats.msg_out, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->stats.rec_out, stats_rec_cnt(msg), __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Add a call of the getter/processing function
+ * \note Only the instance thread is allowed to modify the counters, therefore, it is not
+ *   necessary to use expensive atomic read-modify-write operations.
+ * \param[in] ctx    Instance context
+ * \param[in] start  Start of the call (see stats_time_get())
+ * \param[in] msg    Number of processed messages
+ * \param[in] rec    Number of processed Data Records
+ */
+static inline void
+stats_cb_add(ipx_ctx_t *ctx, uint64_t start, uint64_t msg, uint64_t rec)
+{
+    uint64_t duration = stats_time_get() - start;
+
+    __atomic_store_n(&ctx->stats.cb_calls, ctx->stats.cb_calls + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&ctx->stats.cb_wall, ctx->stats.cb_wall + duration, __ATOMIC_RELAXED);
+    __atomic_store_n(&ctx->stats.msg_in, ctx->stats.msg_in + msg, __ATOMIC_RELAXED);
+    __atomic_store_n(&ctx->stats.rec_in, ctx->stats.rec_in + rec, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Get difference between two timestamps (in nanoseconds)
+ * \param[in] end   Newer timestamp
+ * \param[in] start Older timestamp
+ * \return Difference (zero, if the older timestamp is actually newer)
+ */
+static inline uint64_t
+stats_ts_diff(const struct timespec *end, const struct timespec *start)
+{
+    int64_t diff = (int64_t) (end->tv_sec - start->tv_sec) * 1000000000LL
+        + (end->tv_nsec - start->tv_nsec);
+    return (diff > 0) ? (uint64_t) diff : 0;
+}
+
+/**
+ * \brief Record latency of a periodic message that has just arrived to the instance
+ *
+ * Periodic messages are generated with constant frequency and pass through all instances,
+ * therefore, their latency corresponds to the latency of other messages.
+ * \note Timestamp of the last processing is not modified here.
+ * \param[in] ctx Instance context
+ * \param[in] msg Periodic message
+ */
+static void
+stats_periodic(ipx_ctx_t *ctx, ipx_msg_periodic_t *msg)
+{
+    struct timespec now;
+    struct timespec created = ipx_msg_periodic_get_created(msg);
+    struct timespec last = ipx_msg_periodic_get_last_processed(msg);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    ipx_latency_hist_add(&ctx->latency.total, stats_ts_diff(&now, &created));
+    ipx_latency_hist_add(&ctx->latency.stage, stats_ts_diff(&now, &last));
+}
+
+/**
+ * \brief Summarize a latency histogram
+ * \param[in]  hist    Histogram
+ * \param[out] summary Summary
+ */
+static void
+stats_latency_summary(const struct ipx_latency_hist *hist, struct ipx_ctx_latency *summary)
+{
+    summary->cnt = hist->cnt;
+    summary->p50 = ipx_latency_hist_perc(hist, 50.0);
+    summary->p99 = ipx_latency_hist_perc(hist, 99.0);
+    summary->p999 = ipx_latency_hist_perc(hist, 99.9);
+    summary->max = hist->max;
+}
+
+void
+ipx_ctx_latency_hist_get(const ipx_ctx_t *ctx, struct ipx_latency_hist *total,
+    struct ipx_latency_hist *stage)
+{
+    ipx_latency_hist_snapshot(&ctx->latency.total, total);
+    ipx_latency_hist_snapshot(&ctx->latency.stage, stage);
+}
+
+int
+ipx_ctx_latency_get(const ipx_ctx_t *ctx, struct ipx_ctx_latency *total,
+    struct ipx_ctx_latency *stage)
+{
+    struct ipx_latency_hist *hist = malloc(sizeof(*hist));
+    if (!hist) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    ipx_latency_hist_snapshot(&ctx->latency.total, hist);
+    stats_latency_summary(hist, total);
+    ipx_latency_hist_snapshot(&ctx->latency.stage, hist);
+    stats_latency_summary(hist, stage);
+    free(hist);
+    return IPX_OK;
+}
+
+void
+ipx_ctx_stats_enable(ipx_ctx_t *ctx, bool en)
+{
+    if (ctx->state == IPX_CS_RUNNING) {
+        IPX_CTX_ERROR(ctx, "Unable to change collection of statistics of a running instance!",
+            '\0');
+        return;
+    }
+
+    ctx->stats.enabled = en;
+}
+
+void
+ipx_ctx_stats_get(const ipx_ctx_t *ctx, struct ipx_ctx_stats *stats)
+{
+    stats->msg_in = __atomic_load_n(&ctx->stats.msg_in, __ATOMIC_RELAXED);
+    stats->msg_out = __atomic_load_n(&ctx->stats.msg_out, __ATOMIC_RELAXED);
+    stats->rec_in = __atomic_load_n(&ctx->stats.rec_in, __ATOMIC_RELAXED);
+    stats->rec_out = __atomic_load_n(&ctx->stats.rec_out, __ATOMIC_RELAXED);
+    stats->cb_calls = __atomic_load_n(&ctx->stats.cb_calls, __ATOMIC_RELAXED);
+    stats->cb_wall = __atomic_load_n(&ctx->stats.cb_wall, __ATOMIC_RELAXED);
+
+    // CPU time of a running thread is read from its clock, the final value is stored by the thread
+    clockid_t clock;
+    struct timespec ts;
+    stats->cpu_time = __atomic_load_n(&ctx->stats.cpu_time, __ATOMIC_RELAXED);
+    if (stats->cpu_time == 0 && ctx->state == IPX_CS_RUNNING
+            && pthread_getcpuclockid(ctx->thread_id, &clock) == 0) {
+        if (clock_gettime(clock, &ts) == 0) {
+            stats->cpu_time = stats_ts2ns(&ts);
+        } else {
+            // The thread has just terminated
+            stats->cpu_time = __atomic_load_n(&ctx->stats.cpu_time, __ATOMIC_RELAXED);
+        }
+    }
+
+    struct ipx_ring_stats ring_stats = {0, 0, 0, 0};
+    if (ctx->pipeline.src != NULL) {
+        ipx_ring_stats_get(ctx->pipeline.src, &ring_stats);
+    }
+    stats->ring_size = ring_stats.size;
+    stats->ring_fill = ring_stats.fill;
+    stats->ring_stall_time = ring_stats.stall_time;
+    stats->ring_stall_cnt = ring_stats.stall_cnt;
+}
+
+int
+ipx_ctx_stats_plugin_add(ipx_ctx_t *ctx, const char *name, unsigned int *idx)
+{
+    if (ctx->state == IPX_CS_RUNNING || name == NULL || name[0] == '\0') {
+        return IPX_ERR_ARG;
+    }
+
+    const unsigned int cnt = ctx->stats_plugin.cnt;
+    if (cnt >= IPX_CTX_STATS_PLUGIN_MAX) {
+        return IPX_ERR_LIMIT;
+    }
+
+    char *name_cpy = strdup(name);
+    if (!name_cpy) {
+        return IPX_ERR_NOMEM;
+    }
+
+    ctx->stats_plugin.names[cnt] = name_cpy;
+    __atomic_store_n(&ctx->stats_plugin.values[cnt], 0, __ATOMIC_RELAXED);
+    // Make the name visible before the counter
+    __atomic_store_n(&ctx->stats_plugin.cnt, cnt + 1, __ATOMIC_RELEASE);
+    *idx = cnt;
+    return IPX_OK;
+}
+
+void
+ipx_ctx_stats_plugin_set(ipx_ctx_t *ctx, unsigned int idx, uint64_t value)
+{
+    assert(idx < ctx->stats_plugin.cnt && "Undefined counter");
+    __atomic_store_n(&ctx->stats_plugin.values[idx], value, __ATOMIC_RELAXED);
+}
+
+int
+ipx_ctx_stats_plugin_get(const ipx_ctx_t *ctx, unsigned int idx, const char **name,
+    uint64_t *value)
+{
+    if (idx >= __atomic_load_n(&ctx->stats_plugin.cnt, __ATOMIC_ACQUIRE)) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    *name = ctx->stats_plugin.names[idx];
+    *value = __atomic_load_n(&ctx->stats_plugin.values[idx], __ATOMIC_RELAXED);
+    return IPX_OK;
+}
+
 int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
 {
@@ -338,10 +697,32 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_OK;
     }
 
+    if (ctx->stats.enabled) {
+        stats_msg_out(ctx, msg);
+    }
     ipx_ring_push(ctx->pipeline.dst, msg);
     return IPX_OK;
 }
 
+int
+ipx_ctx_msg_pass_mt(ipx_ctx_t *ctx)
+{
+    // Only during initialization of input and intermediate instances
+    if (ctx->state != IPX_CS_NEW || (ctx->type != IPX_PT_INPUT && ctx->type != IPX_PT_INTERMEDIATE)) {
+        IPX_CTX_ERROR(ctx, "Called ipx_ctx_msg_pass_mt() but it is not allowed!", '\0');
+        return IPX_ERR_ARG;
+    }
+
+    if (!ctx->pipeline.dst) {
+        // Not connected, messages are destroyed immediately
+        return IPX_OK;
+    }
+
+    IPX_CTX_DEBUG(ctx, "Multi-writer mode of the output queue enabled.", '\0');
+    ipx_ring_mw_mode(ctx->pipeline.dst, true);
+    return IPX_OK;
+}
+
 void
 ipx_ctx_private_set(ipx_ctx_t *ctx, void *data)
 {
@@ -577,7 +958,7 @@ init_check_intermediate(const ipx_ctx_t *ctx)
         return IPX_ERR_ARG;
     }
 
-    if (ctx->plugin_cbs->process == NULL) {
+    if (ctx->plugin_cbs->process == NULL && ctx->plugin_cbs->process_batch == NULL) {
         IPX_CTX_ERROR(ctx, "Processing callback function is not defined!", '\0');
         return IPX_ERR_ARG;
     }
@@ -598,7 +979,7 @@ init_check_output(const ipx_ctx_t *ctx)
         return IPX_ERR_ARG;
     }
 
-    if (ctx->plugin_cbs->process == NULL) {
+    if (ctx->plugin_cbs->process == NULL && ctx->plugin_cbs->process_batch == NULL) {
         IPX_CTX_ERROR(ctx, "Processing callback function is not defined!", '\0');
         return IPX_ERR_ARG;
     }
@@ -749,6 +1130,15 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         break;
     }
 
+    if (plugin_type == IPX_PT_INPUT || plugin_type == IPX_PT_INTERMEDIATE) {
+        // Instances that can create IPFIX Messages recycle their wrappers
+        ctx->cfg_system.ipfix_pool = ipx_msg_ipfix_pool_create();
+        if (!ctx->cfg_system.ipfix_pool) {
+            IPX_CTX_WARNING(ctx, "Failed to create a pool of IPFIX Messages. Messages will be "
+                "allocated individually.", '\0');
+        }
+    }
+
     /* Change name of the current thread and block all signals because the instance can create
      * new threads and we want to preserve correct inheritance of these configurations
      */
@@ -781,6 +1171,8 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         ctx->permissions = 0;
         ctx->cfg_system.msg_mask_selected = 0;
         ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+        ipx_msg_ipfix_pool_destroy(ctx->cfg_system.ipfix_pool);
+        ctx->cfg_system.ipfix_pool = NULL;
         return IPX_ERR_DENIED;
     }
 
@@ -880,6 +1272,7 @@ thread_input_process_pipe(struct ipx_ctx *ctx)
 
     if (msg_type == IPX_MSG_PERIODIC) {
         ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
+        stats_periodic(ctx, periodic_message);
         ipx_msg_periodic_update_last_processed(periodic_message);
         ipx_ctx_msg_pass(ctx, msg_ptr);
         return IPX_OK;
@@ -890,6 +1283,7 @@ thread_input_process_pipe(struct ipx_ctx *ctx)
         const char *plugin_name = ctx->plugin_cbs->info->name;
         IPX_CTX_DEBUG(ctx, "Calling instance destructor of the input plugin '%s'", plugin_name);
         ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
+        stats_cpu_final(ctx);
         // Pass the termination message
         ipx_ring_push(ctx->pipeline.dst, msg_ptr);
         return IPX_ERR_EOF;
@@ -933,7 +1327,13 @@ thread_input(void *arg)
         }
 
         // Try to get a new IPFIX message
-        rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+        if (ctx->stats.enabled) {
+            uint64_t start = stats_time_get();
+            rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+            stats_cb_add(ctx, start, 0, 0);
+        } else {
+            rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+        }
         thread_handle_rc(ctx, rc);
     }
 
@@ -942,11 +1342,87 @@ thread_input(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Pass messages to the processing callback(s) of the plugin and update statistics
+ * \see thread_process_batch()
+ * \param[in] ctx  Instance context
+ * \param[in] msgs Array of messages
+ * \param[in] cnt  Number of messages in the array (non-zero)
+ */
+static void
+thread_process_batch_stats(struct ipx_ctx *ctx, ipx_msg_t **msgs, size_t cnt)
+{
+    // Records must be counted in advance, the plugin can modify or destroy the messages
+    uint64_t rec_cnt = 0;
+    if (ctx->plugin_cbs->process_batch != NULL) {
+        for (size_t i = 0; i < cnt; ++i) {
+            rec_cnt += stats_rec_cnt(msgs[i]);
+        }
+    }
+
+    int rc;
+    uint64_t start;
+    if (ctx->plugin_cbs->process_batch != NULL) {
+        start = stats_time_get();
+        rc = ctx->plugin_cbs->process_batch(ctx, ctx->cfg_plugin.private, msgs, cnt);
+        stats_cb_add(ctx, start, cnt, rec_cnt);
+        thread_handle_rc(ctx, rc);
+        return;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        uint64_t rec = stats_rec_cnt(msgs[i]);
+        start = stats_time_get();
+        rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msgs[i]);
+        stats_cb_add(ctx, start, 1, rec);
+        thread_handle_rc(ctx, rc);
+    }
+}
+
+/**
+ * \brief Pass messages to the processing callback(s) of the plugin
+ *
+ * If the plugin supports batch processing, all messages are passed at once. Otherwise, the
+ * messages are passed one by one to the standard processing callback.
+ * \param[in] ctx  Instance context
+ * \param[in] msgs Array of messages
+ * \param[in] cnt  Number of messages in the array (can be zero)
+ */
+static void
+thread_process_batch(struct ipx_ctx *ctx, ipx_msg_t **msgs, size_t cnt)
+{
+    if (cnt == 0) {
+        return;
+    }
+
+    if (ctx->stats.enabled) {
+        thread_process_batch_stats(ctx, msgs, cnt);
+        return;
+    }
+
+    int rc;
+    if (ctx->plugin_cbs->process_batch != NULL) {
+        rc = ctx->plugin_cbs->process_batch(ctx, ctx->cfg_plugin.private, msgs, cnt);
+        thread_handle_rc(ctx, rc);
+        return;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msgs[i]);
+        thread_handle_rc(ctx, rc);
+    }
+}
+
 /**
  * \brief Intermediate instance control thread
  *
  * Infinite loop that process messages from an input ring buffer and eventually pass them to
  * an output ring buffer.
+ *
+ * Messages are taken from the input ring buffer in batches. If the plugin supports batch
+ * processing, consecutive messages for the plugin are collected and passed to the plugin at once.
+ * The batch is always flushed before any message is passed directly to the output ring buffer,
+ * so the order of messages is preserved.
  * \param[in] arg Instance context
  * \return NULL
  */
@@ -960,72 +1436,105 @@ thread_intermediate(void *arg)
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has started!", plugin_name);
 
-    ipx_msg_t *msg_ptr;
-    enum ipx_msg_type msg_type;
+    ipx_msg_t *msgs[IPX_CTX_BATCH_SIZE];
+    ipx_msg_t *batch[IPX_CTX_BATCH_SIZE];
+    size_t batch_cnt;
+    const bool batch_enabled = (ctx->plugin_cbs->process_batch != NULL);
+
+    ipx_msg_t *msg_ptr = NULL;
+    enum ipx_msg_type msg_type = IPX_MSG_IPFIX;
 
     uint64_t waiting_for_seq = 0;
 
     bool terminate = false;
     while (!terminate) {
-        // Get a new message for the buffer
-        msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        msg_type = ipx_msg_get_type(msg_ptr);
-        bool processed = false; // only not processed messages are automatically passed
-
-        if (msg_type == IPX_MSG_TERMINATE) {
-            ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
-            enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
-
-            if (type == IPX_MSG_TERMINATE_INSTANCE && (--ctx->cfg_system.term_msg_cnt) != 0) {
-                // Drop the message, we are still waiting for another termination request
-                IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining input "
-                    "plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
-                ipx_msg_terminate_destroy(terminate_msg);
-                continue;
+        // Get new messages from the buffer
+        uint32_t msg_cnt = ipx_ring_pop_n(ctx->pipeline.src, msgs, IPX_CTX_BATCH_SIZE);
+        uint32_t idx;
+        batch_cnt = 0;
+
+        for (idx = 0; idx < msg_cnt && !terminate; ++idx) {
+            msg_ptr = msgs[idx];
+            msg_type = ipx_msg_get_type(msg_ptr);
+            bool processed = false; // only not processed messages are automatically passed
+
+            if (msg_type == IPX_MSG_TERMINATE) {
+                ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
+                enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
+
+                if (type == IPX_MSG_TERMINATE_INSTANCE && (--ctx->cfg_system.term_msg_cnt) != 0) {
+                    // Drop the message, we are still waiting for another termination request
+                    IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining "
+                        "input plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
+                    ipx_msg_terminate_destroy(terminate_msg);
+                    continue;
+                }
+
+                if (type == IPX_MSG_TERMINATE_INSTANCE) {
+                    terminate = true;
+                }
             }
 
-            if (type == IPX_MSG_TERMINATE_INSTANCE) {
-                terminate = true;
+            if (msg_type == IPX_MSG_PERIODIC) {
+                ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
+                if (ipx_msg_periodic_get_seq_num(periodic_message) != waiting_for_seq) {
+                    ipx_msg_periodic_destroy(periodic_message);
+                    continue;
+                }
+                waiting_for_seq++;
+                stats_periodic(ctx, periodic_message);
+                ipx_msg_periodic_update_last_processed(periodic_message);
             }
-        }
 
-        if (msg_type == IPX_MSG_PERIODIC) {
-            ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
-            if (ipx_msg_periodic_get_seq_num(periodic_message) != waiting_for_seq) {
-                ipx_msg_periodic_destroy(periodic_message);
+            if (!ipx_ctx_processing_get(ctx)
+                    && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
+                // Data processing is disabled -> drop IPFIX and Session messages
+                ipx_msg_destroy(msg_ptr);
                 continue;
             }
-            waiting_for_seq++;
-            ipx_msg_periodic_update_last_processed(periodic_message);
-        }
 
-        if (!ipx_ctx_processing_get(ctx)
-                && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
-            // Data processing is disabled -> drop IPFIX and Session messages
-            ipx_msg_destroy(msg_ptr);
-            continue;
-        }
+            bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+            if ((ipx_ctx_processing_get(ctx) || ctx->type == IPX_PT_OUTPUT_MGR) && msg_for_plugin) {
+                // Pass data to the plugin
+                if (batch_enabled) {
+                    batch[batch_cnt++] = msg_ptr;
+                } else {
+                    thread_process_batch(ctx, &msg_ptr, 1);
+                }
+                processed = true;
+            }
 
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-        if ((ipx_ctx_processing_get(ctx) || ctx->type == IPX_PT_OUTPUT_MGR) && msg_for_plugin) {
-            // Pass data to the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
-            thread_handle_rc(ctx, rc);
-            processed = true;
+            // The message hasn't been processed by the plugin
+            if (!processed && terminate != true) {
+                /* Not processed by the instance, pass the message.
+                 * Note: Termination message is passed after intermediate instance destructor! */
+                assert(ctx->type != IPX_PT_OUTPUT_MGR);
+                thread_process_batch(ctx, batch, batch_cnt);
+                batch_cnt = 0;
+                if (ctx->stats.enabled) {
+                    stats_msg_out(ctx, msg_ptr);
+                }
+                ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+            }
         }
 
-        // The message hasn't been processed by the plugin
-        if (!processed && terminate != true) {
-            /* Not processed by the instance, pass the message.
-             * Note: Termination message is passed after intermediate instance destructor! */
-            assert(ctx->type != IPX_PT_OUTPUT_MGR);
-            ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+        // Flush remaining messages of the batch
+        thread_process_batch(ctx, batch, batch_cnt);
+
+        if (idx < msg_cnt) {
+            // The termination message should be always the last one
+            IPX_CTX_WARNING(ctx, "%" PRIu32 " message(s) received after the termination message "
+                "will be dropped!", msg_cnt - idx);
+            for (; idx < msg_cnt; ++idx) {
+                ipx_msg_destroy(msgs[idx]);
+            }
         }
     }
 
     // Destroy the instance (usually produce garbage messages)
     IPX_CTX_DEBUG(ctx, "Calling instance destructor of the intermediate plugin '%s'", plugin_name);
     ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
+    stats_cpu_final(ctx);
 
     // Pass the termination message as the last message to the buffer
     assert(msg_type == IPX_MSG_TERMINATE);
@@ -1043,6 +1552,9 @@ thread_intermediate(void *arg)
  * \brief Output instance control thread
  *
  * Infinite loop that process messages from an input ring buffer.
+ *
+ * Messages are taken from the input ring buffer in batches and, if the plugin supports batch
+ * processing, passed to the plugin at once.
  * \param[in] arg Instance context
  * \return NULL
  */
@@ -1056,43 +1568,64 @@ thread_output(void *arg)
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has started!", plugin_name);
 
+    ipx_msg_t *msgs[IPX_CTX_BATCH_SIZE];
+    ipx_msg_t *batch[IPX_CTX_BATCH_SIZE];
+    size_t batch_cnt;
+
     bool terminate = false;
     while (!terminate) {
-        // Get a new message for the buffer
-        ipx_msg_t *msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-
-        if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
-            // Process the message by the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
-            thread_handle_rc(ctx, rc);
-        }
+        // Get new messages from the buffer
+        uint32_t msg_cnt = ipx_ring_pop_n(ctx->pipeline.src, msgs, IPX_CTX_BATCH_SIZE);
+        batch_cnt = 0;
 
-        if (msg_type == IPX_MSG_PERIODIC) {
-            ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
-            ipx_msg_periodic_update_last_processed(periodic_message);
+        for (uint32_t i = 0; i < msg_cnt; ++i) {
+            if (ipx_msg_get_type(msgs[i]) != IPX_MSG_PERIODIC) {
+                continue;
+            }
+
+            /* Record latency before the batch is processed. Note: The message is shared by all
+             * output instances, therefore, the timestamp of the last processing is not updated
+             * here (i.e. it still refers to the output manager). */
+            stats_periodic(ctx, ipx_msg_base2periodic(msgs[i]));
         }
 
-        if (msg_type == IPX_MSG_TERMINATE) {
-            ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
-            enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
-            if (type == IPX_MSG_TERMINATE_INSTANCE) {
-                // We received a request to terminate the instance
-                terminate = true;
+        if (ipx_ctx_processing_get(ctx)) {
+            // Select messages for the plugin and process them
+            for (uint32_t i = 0; i < msg_cnt; ++i) {
+                enum ipx_msg_type msg_type = ipx_msg_get_type(msgs[i]);
+                if ((msg_type & ctx->cfg_system.msg_mask_selected) != 0) {
+                    batch[batch_cnt++] = msgs[i];
+                }
             }
+
+            thread_process_batch(ctx, batch, batch_cnt);
         }
 
-        // Decrement the counter - DO NOT TOUCH the message from this point beyond
-        if (ipx_msg_header_cnt_dec(msg_ptr)) {
-            // This instance is the last user, destroy it
-            ipx_msg_destroy(msg_ptr);
+        for (uint32_t i = 0; i < msg_cnt; ++i) {
+            ipx_msg_t *msg_ptr = msgs[i];
+            enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+
+            if (msg_type == IPX_MSG_TERMINATE) {
+                ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
+                enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
+                if (type == IPX_MSG_TERMINATE_INSTANCE) {
+                    // We received a request to terminate the instance
+                    terminate = true;
+                }
+            }
+
+            // Decrement the counter - DO NOT TOUCH the message from this point beyond
+            if (ipx_msg_header_cnt_dec(msg_ptr)) {
+                // This instance is the last user, destroy it
+                ipx_msg_destroy(msg_ptr);
+            }
         }
     }
 
     // Destroy the instance
     IPX_CTX_DEBUG(ctx, "Calling instance destructor of the output plugin '%s'", plugin_name);
     ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
+    stats_cpu_final(ctx);
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has been terminated!",
         plugin_name);
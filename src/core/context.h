@@ -47,6 +47,9 @@
 #include "fpipe.h"
 #include "ring.h"
 
+struct ipx_msg_ipfix_pool;
+struct ipx_latency_hist;
+
 /** List of plugin callbacks  */
 struct ipx_ctx_callbacks {
     /** Plugin library handle (from dlopen)                                     */
@@ -65,11 +68,16 @@ struct ipx_ctx_callbacks {
     int  (*process) (ipx_ctx_t *, void *, ipx_msg_t *);
     /** Close session request (INPUT plugins only, can be NULL)                 */
     void  (*ts_close)(ipx_ctx_t *, void *, const struct ipx_session *);
+    /** Batch process function (INTERMEDIATE and OUTPUT plugins only, can be NULL) */
+    int  (*process_batch) (ipx_ctx_t *, void *, ipx_msg_t **, size_t);
 };
 
 /** Identification number of output manager plugin */
 #define IPX_PT_OUTPUT_MGR 255
 
+/** Maximum number of messages taken from an input ring buffer and processed at once */
+#define IPX_CTX_BATCH_SIZE 64U
+
 /**
  * \brief Create a context
  *
@@ -169,6 +177,16 @@ ipx_ctx_run(ipx_ctx_t *ctx);
 IPX_API size_t
 ipx_ctx_recsize_get(const ipx_ctx_t *ctx);
 
+/**
+ * \brief Get a pool of IPFIX Message wrappers of the instance
+ *
+ * The pool is available only for initialized input and intermediate instances.
+ * \param[in] ctx Plugin context
+ * \return Pointer to the pool or NULL
+ */
+struct ipx_msg_ipfix_pool *
+ipx_ctx_ipfix_pool_get(const ipx_ctx_t *ctx);
+
 /**
  * \brief Set size of one IPFIX record withe registered extensions (in bytes)
  *
@@ -264,6 +282,33 @@ ipx_ctx_verb_set(ipx_ctx_t *ctx, enum ipx_verb_level verb);
 IPX_API int
 ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt);
 
+/**
+ * \brief Allow the instance to subscribe to additional types of messages
+ *
+ * By default, an intermediate instance can subscribe only to IPFIX, Transport Session and
+ * periodic messages. Internal plugins (e.g. the parallel IPFIX parser), which must keep other
+ * types of messages in order with the processed ones, can extend the set of allowed types.
+ * \warning Can be called only before the instance is initialized or from its constructor.
+ * \param[in] ctx  Plugin context
+ * \param[in] mask Types of messages to allow
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the instance is already initialized
+ */
+IPX_API int
+ipx_ctx_subscribe_allow(ipx_ctx_t *ctx, ipx_msg_mask_t mask);
+
+/**
+ * \brief Set identification of a worker of an output instance
+ *
+ * By default, each instance consists of exactly one worker (i.e. id == 0 and cnt == 1).
+ * \see ipx_ctx_worker_get()
+ * \param[in] ctx Plugin context
+ * \param[in] id  Index of the worker (must be less than \p cnt)
+ * \param[in] cnt Total number of workers of the instance
+ */
+IPX_API void
+ipx_ctx_worker_set(ipx_ctx_t *ctx, unsigned int id, unsigned int cnt);
+
 /**
  * \brief Enable/disable data processing
  *
@@ -282,6 +327,35 @@ ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt);
 IPX_API void
 ipx_ctx_processing_set(ipx_ctx_t *ctx, bool en);
 
+/**
+ * \brief Enable/disable collection of runtime statistics
+ *
+ * If enabled, the instance thread counts processed messages and measures time spent in
+ * the getter (input plugins) or processing function (other plugins). The counters are
+ * available via ipx_ctx_stats_get(). Statistics of the input ring buffer of the instance are
+ * always available.
+ *
+ * \note
+ *   By default, collection of statistics is disabled.
+ * \warning
+ *   The function MUST be called before the thread of the instance is started.
+ * \param[in] ctx Plugin context
+ * \param[in] en  Enable/disable statistics
+ */
+IPX_API void
+ipx_ctx_stats_enable(ipx_ctx_t *ctx, bool en);
+
+/**
+ * \brief Get snapshots of latency histograms of the instance
+ * \see ipx_ctx_latency_get() for description of latencies
+ * \param[in]  ctx   Plugin context
+ * \param[out] total Histogram of latencies from creation of periodic messages
+ * \param[out] stage Histogram of latencies from the previous instance
+ */
+IPX_API void
+ipx_ctx_latency_hist_get(const ipx_ctx_t *ctx, struct ipx_latency_hist *total,
+    struct ipx_latency_hist *stage);
+
 /**
  * \brief Get registered extensions and dependencies
  *
@@ -0,0 +1,159 @@
+/**
+ * \file src/core/latency.c
+ * \brief Latency histograms (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <string.h>
+#include "latency.h"
+
+/** Number of sub-buckets in each exponential range (except the first one) */
+#define LATENCY_HALF   (1U << (IPX_LATENCY_SUB_BITS - 1U))
+/** The highest trackable value                                              */
+#define LATENCY_LIMIT  ((UINT64_C(1) << IPX_LATENCY_MAX_BITS) - 1U)
+
+/**
+ * \brief Get index of the bucket of a value
+ * \param[in] value Value (must be less or equal to #LATENCY_LIMIT)
+ * \return Index
+ */
+static inline uint32_t
+latency_idx(uint64_t value)
+{
+    if (value < (UINT64_C(1) << IPX_LATENCY_SUB_BITS)) {
+        return (uint32_t) value;
+    }
+
+    // Position of the most significant bit determines the exponential range
+    uint32_t msb = 63U - (uint32_t) __builtin_clzll(value);
+    uint32_t shift = msb - (IPX_LATENCY_SUB_BITS - 1U);
+    return shift * LATENCY_HALF + (uint32_t) (value >> shift);
+}
+
+/**
+ * \brief Get the highest value that belongs to a bucket
+ * \param[in] idx Index of the bucket
+ * \return Value
+ */
+static inline uint64_t
+latency_upper(uint32_t idx)
+{
+    if (idx < (1U << IPX_LATENCY_SUB_BITS)) {
+        return idx;
+    }
+
+    uint32_t shift = idx / LATENCY_HALF - 1U;
+    uint64_t sub = idx - shift * LATENCY_HALF;
+    return ((sub + 1U) << shift) - 1U;
+}
+
+void
+ipx_latency_hist_clear(struct ipx_latency_hist *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+void
+ipx_latency_hist_add(struct ipx_latency_hist *hist, uint64_t value)
+{
+    if (value > LATENCY_LIMIT) {
+        value = LATENCY_LIMIT;
+    }
+
+    // Only one writer, therefore, atomic stores are sufficient (readers can see partial update)
+    uint32_t *bucket = &hist->buckets[latency_idx(value)];
+    __atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->cnt, hist->cnt + 1, __ATOMIC_RELAXED);
+    if (value > hist->max) {
+        __atomic_store_n(&hist->max, value, __ATOMIC_RELAXED);
+    }
+}
+
+void
+ipx_latency_hist_snapshot(const struct ipx_latency_hist *src, struct ipx_latency_hist *dst)
+{
+    dst->cnt = 0;
+    dst->max = __atomic_load_n(&src->max, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        dst->buckets[i] = __atomic_load_n(&src->buckets[i], __ATOMIC_RELAXED);
+        dst->cnt += dst->buckets[i];
+    }
+}
+
+void
+ipx_latency_hist_sub(struct ipx_latency_hist *hist, const struct ipx_latency_hist *old)
+{
+    hist->cnt = 0;
+    hist->max = 0;
+    for (uint32_t i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        hist->buckets[i] -= old->buckets[i];
+        if (hist->buckets[i] == 0) {
+            continue;
+        }
+
+        hist->cnt += hist->buckets[i];
+        hist->max = latency_upper(i);
+    }
+}
+
+uint64_t
+ipx_latency_hist_perc(const struct ipx_latency_hist *hist, double perc)
+{
+    if (hist->cnt == 0) {
+        return 0;
+    }
+
+    // Rank of the value (at least the first one)
+    double rank_real = (perc / 100.0) * (double) hist->cnt;
+    uint64_t rank = (uint64_t) rank_real;
+    if ((double) rank < rank_real || rank == 0) {
+        rank++;
+    }
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < IPX_LATENCY_BUCKETS; ++i) {
+        sum += hist->buckets[i];
+        if (sum < rank) {
+            continue;
+        }
+
+        uint64_t value = latency_upper(i);
+        return (value < hist->max) ? value : hist->max;
+    }
+
+    return hist->max;
+}
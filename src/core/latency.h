@@ -0,0 +1,139 @@
+/**
+ * \file src/core/latency.h
+ * \brief Latency histograms (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_LATENCY_H
+#define IPX_LATENCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+
+/**
+ * \defgroup ipx_latency Latency histograms
+ * \brief Histograms of latencies with bounded relative error
+ *
+ * The histogram uses the same layout as HDR histograms. Values are split into exponential
+ * ranges (powers of two) and each range is split into the same number of linear sub-buckets.
+ * Therefore, memory usage is constant and relative error of each recorded value is less
+ * than 2^(-#IPX_LATENCY_SUB_BITS + 1), i.e. less than 1.6 %.
+ *
+ * Only a single thread can add values to the histogram. However, any thread can read it
+ * (e.g. make a snapshot) at any time.
+ * @{
+ */
+
+/** Number of bits of sub-buckets (i.e. precision of values)                        */
+#define IPX_LATENCY_SUB_BITS  7U
+/** Number of bits of the highest trackable value (larger values are clamped)        */
+#define IPX_LATENCY_MAX_BITS  40U
+/** Number of buckets of the histogram                                               */
+#define IPX_LATENCY_BUCKETS \
+    ((IPX_LATENCY_MAX_BITS - IPX_LATENCY_SUB_BITS + 2U) << (IPX_LATENCY_SUB_BITS - 1U))
+
+/** Histogram of latencies (in nanoseconds)                                          */
+struct ipx_latency_hist {
+    /** Number of recorded values                                                    */
+    uint64_t cnt;
+    /** The highest recorded value                                                   */
+    uint64_t max;
+    /** Counters of values in the buckets                                            */
+    uint32_t buckets[IPX_LATENCY_BUCKETS];
+};
+
+/**
+ * \brief Clear the histogram
+ * \param[in] hist Histogram
+ */
+IPX_API void
+ipx_latency_hist_clear(struct ipx_latency_hist *hist);
+
+/**
+ * \brief Add a value to the histogram
+ * \warning Only one thread can add values to the histogram at the same time.
+ * \param[in] hist  Histogram
+ * \param[in] value Value (in nanoseconds)
+ */
+IPX_API void
+ipx_latency_hist_add(struct ipx_latency_hist *hist, uint64_t value);
+
+/**
+ * \brief Make a snapshot of a histogram
+ *
+ * The function can be called while another thread is adding values to the source histogram.
+ * However, the snapshot doesn't have to be mutually consistent (e.g. the total count can
+ * be slightly different from the sum of buckets).
+ * \param[in]  src Source histogram
+ * \param[out] dst Destination histogram
+ */
+IPX_API void
+ipx_latency_hist_snapshot(const struct ipx_latency_hist *src, struct ipx_latency_hist *dst);
+
+/**
+ * \brief Subtract an older snapshot of the same histogram (i.e. get values of an interval)
+ *
+ * The maximum value is replaced by the upper bound of the highest non-empty bucket as
+ * the exact value cannot be determined.
+ * \param[in,out] hist Newer snapshot (will be replaced with the difference)
+ * \param[in]     old  Older snapshot
+ */
+IPX_API void
+ipx_latency_hist_sub(struct ipx_latency_hist *hist, const struct ipx_latency_hist *old);
+
+/**
+ * \brief Get a value at the given percentile
+ * \param[in] hist Histogram
+ * \param[in] perc Percentile (0.0 - 100.0)
+ * \return Value (upper bound of the bucket, never higher than the maximum) or 0, if the
+ *   histogram is empty
+ */
+IPX_API uint64_t
+ipx_latency_hist_perc(const struct ipx_latency_hist *hist, double perc);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_LATENCY_H
@@ -53,45 +53,340 @@
 static_assert(offsetof(struct ipx_msg_ipfix, msg_header.type) == 0,
     "Message header must be the first element of each IPFIXcol message.");
 
+/** Number of size classes of the pool (capacity of the class N is POOL_CLASS_MIN << N)      */
+#define POOL_CLASS_CNT   (9U)
+/** Capacity of Data Records of the smallest size class                                      */
+#define POOL_CLASS_MIN   (16U)
+/** Maximum size of cached wrappers per size class (in bytes)                                */
+#define POOL_CLASS_BYTES (4U * 1024U * 1024U)
+/** Minimum number of cached wrappers per size class (regardless of their size)              */
+#define POOL_CLASS_ITEMS (8U)
+/** Weight of the running average of records per message (i.e. 1/2^N of the new value)       */
+#define POOL_AVG_SHIFT   (4U)
+/** Fixed point precision of the running average (number of fraction bits)                  */
+#define POOL_AVG_FRAC    (8U)
+
+/** Free list of wrappers with the same capacity of Data Records                             */
+struct ipx_msg_ipfix_pool_class {
+    /** Top of the lock-free stack of wrappers                                               */
+    struct ipx_msg_ipfix *head;
+    /** Number of wrappers in the stack (approximate)                                        */
+    uint32_t cnt;
+    /** Only one thread at a time can take wrappers from the stack (prevents ABA problem)    */
+    bool pop_lock;
+};
+
+struct ipx_msg_ipfix_pool {
+    /** Size classes of wrappers                                                             */
+    struct ipx_msg_ipfix_pool_class classes[POOL_CLASS_CNT];
+    /** Running average of Data Records per message (fixed point, see POOL_AVG_FRAC)         */
+    uint32_t rec_avg;
+    /** Reference counter (the owner + wrappers in use)                                      */
+    uint32_t refs;
+    /** The owner has destroyed the pool (wrappers are not recycled anymore)                 */
+    bool destroyed;
+};
+
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size)
 {
     return offsetof(struct ipx_msg_ipfix, recs) + (rec_cnt * rec_size);
 }
 
+/**
+ * \brief Get a size class of wrappers for the given number of Data Records
+ * \param[in] rec_cnt Number of Data Records
+ * \return Index of the smallest class able to hold the records (can be out of range!)
+ */
+static inline unsigned int
+pool_class_idx(uint32_t rec_cnt)
+{
+    unsigned int idx = 0;
+    while (idx < POOL_CLASS_CNT && (POOL_CLASS_MIN << idx) < rec_cnt) {
+        idx++;
+    }
+    return idx;
+}
+
+/**
+ * \brief Free a wrapper including its extended array of IPFIX Sets
+ * \note The raw message must be already released!
+ * \param[in] msg Wrapper to free
+ */
+static void
+pool_wrapper_free(struct ipx_msg_ipfix *msg)
+{
+    free(msg->sets.extended);
+    ipx_msg_header_destroy((ipx_msg_t *) msg);
+    free(msg);
+}
+
+/**
+ * \brief Take a wrapper from the free list of a size class
+ * \param[in] cls Size class
+ * \return Pointer to the wrapper or NULL (empty or already used by another thread)
+ */
+static struct ipx_msg_ipfix *
+pool_class_pop(struct ipx_msg_ipfix_pool_class *cls)
+{
+    if (__atomic_load_n(&cls->head, __ATOMIC_RELAXED) == NULL
+            || __atomic_test_and_set(&cls->pop_lock, __ATOMIC_ACQUIRE)) {
+        // Nothing to take or another thread is taking a wrapper -> don't wait
+        return NULL;
+    }
+
+    // Only this thread removes wrappers, others can only add -> "next" of the head is stable
+    struct ipx_msg_ipfix *head = __atomic_load_n(&cls->head, __ATOMIC_ACQUIRE);
+    while (head != NULL && !__atomic_compare_exchange_n(&cls->head, &head, head->pool_next,
+            true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        // Head has been changed by a new wrapper, try again
+    }
+
+    __atomic_clear(&cls->pop_lock, __ATOMIC_RELEASE);
+    if (head != NULL) {
+        __atomic_sub_fetch(&cls->cnt, 1U, __ATOMIC_RELAXED);
+    }
+    return head;
+}
+
+/**
+ * \brief Return a wrapper to the free list of a size class
+ * \param[in] cls Size class
+ * \param[in] msg Wrapper to add
+ */
+static void
+pool_class_push(struct ipx_msg_ipfix_pool_class *cls, struct ipx_msg_ipfix *msg)
+{
+    __atomic_add_fetch(&cls->cnt, 1U, __ATOMIC_RELAXED);
+    msg->pool_next = __atomic_load_n(&cls->head, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&cls->head, &msg->pool_next, msg, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        // Head has been changed, try again
+    }
+}
+
+/**
+ * \brief Free all wrappers in free lists and the pool
+ * \param[in] pool Pool (nobody else can use it anymore)
+ */
+static void
+pool_free(struct ipx_msg_ipfix_pool *pool)
+{
+    for (unsigned int i = 0; i < POOL_CLASS_CNT; ++i) {
+        struct ipx_msg_ipfix *msg = pool->classes[i].head;
+        while (msg != NULL) {
+            struct ipx_msg_ipfix *next = msg->pool_next;
+            pool_wrapper_free(msg);
+            msg = next;
+        }
+    }
+
+    free(pool);
+}
+
+/**
+ * \brief Release a reference to the pool (free it after the last one)
+ * \param[in] pool Pool
+ */
+static inline void
+pool_unref(struct ipx_msg_ipfix_pool *pool)
+{
+    if (__atomic_sub_fetch(&pool->refs, 1U, __ATOMIC_ACQ_REL) == 0) {
+        pool_free(pool);
+    }
+}
+
+struct ipx_msg_ipfix_pool *
+ipx_msg_ipfix_pool_create(void)
+{
+    struct ipx_msg_ipfix_pool *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->rec_avg = REC_DEF_CNT << POOL_AVG_FRAC;
+    pool->refs = 1; // The owner
+    return pool;
+}
+
+void
+ipx_msg_ipfix_pool_destroy(struct ipx_msg_ipfix_pool *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    __atomic_store_n(&pool->destroyed, true, __ATOMIC_RELEASE);
+    pool_unref(pool);
+}
+
+/**
+ * \brief Get a wrapper from a pool
+ *
+ * If there is no suitable recycled wrapper, a new one is allocated.
+ * \param[in] pool     Pool
+ * \param[in] rec_size Size of a Data Record
+ * \return Pointer to the wrapper or NULL (memory allocation error)
+ */
+static struct ipx_msg_ipfix *
+pool_wrapper_get(struct ipx_msg_ipfix_pool *pool, size_t rec_size)
+{
+    // Expected number of records (the running average + 25%)
+    uint32_t rec_exp = __atomic_load_n(&pool->rec_avg, __ATOMIC_RELAXED) >> POOL_AVG_FRAC;
+    rec_exp += rec_exp / 4U;
+    unsigned int idx = pool_class_idx(rec_exp);
+    if (idx >= POOL_CLASS_CNT) {
+        idx = POOL_CLASS_CNT - 1;
+    }
+
+    struct ipx_msg_ipfix *msg = pool_class_pop(&pool->classes[idx]);
+    if (msg != NULL && msg->rec_info.rec_size != rec_size) {
+        // Size of records has been changed (e.g. new extensions) -> cannot be reused
+        pool_wrapper_free(msg);
+        msg = NULL;
+    }
+
+    if (!msg) {
+        const uint32_t rec_cnt = POOL_CLASS_MIN << idx;
+        msg = malloc(ipx_msg_ipfix_size(rec_cnt, rec_size));
+        if (!msg) {
+            return NULL;
+        }
+
+        msg->sets.extended = NULL;
+        msg->sets.cnt_alloc = SET_DEF_CNT;
+        msg->rec_info.cnt_alloc = rec_cnt;
+    }
+
+    msg->pool = pool;
+    __atomic_add_fetch(&pool->refs, 1U, __ATOMIC_RELAXED);
+    return msg;
+}
+
+/**
+ * \brief Return a wrapper to its pool
+ *
+ * The wrapper is freed if the pool has been already destroyed, its capacity doesn't correspond
+ * to any size class or the class already holds enough wrappers.
+ * \note The raw message must be already released!
+ * \param[in] msg Wrapper
+ */
+static void
+pool_wrapper_put(struct ipx_msg_ipfix *msg)
+{
+    struct ipx_msg_ipfix_pool *pool = msg->pool;
+
+    // Update the running average (races among threads only cause imprecision)
+    const uint32_t avg_old = __atomic_load_n(&pool->rec_avg, __ATOMIC_RELAXED);
+    const uint32_t avg_val = msg->rec_info.cnt_valid << POOL_AVG_FRAC;
+    const uint32_t avg_new = avg_old - (avg_old >> POOL_AVG_SHIFT) + (avg_val >> POOL_AVG_SHIFT);
+    __atomic_store_n(&pool->rec_avg, avg_new, __ATOMIC_RELAXED);
+
+    const unsigned int idx = pool_class_idx(msg->rec_info.cnt_alloc);
+    bool recycle = !__atomic_load_n(&pool->destroyed, __ATOMIC_ACQUIRE)
+        && idx < POOL_CLASS_CNT && (POOL_CLASS_MIN << idx) == msg->rec_info.cnt_alloc;
+
+    if (recycle) {
+        struct ipx_msg_ipfix_pool_class *cls = &pool->classes[idx];
+        const size_t msg_size = ipx_msg_ipfix_size(msg->rec_info.cnt_alloc,
+            msg->rec_info.rec_size);
+        const uint32_t cnt_max = POOL_CLASS_BYTES / msg_size;
+        recycle = __atomic_load_n(&cls->cnt, __ATOMIC_RELAXED)
+            < ((cnt_max > POOL_CLASS_ITEMS) ? cnt_max : POOL_CLASS_ITEMS);
+    }
+
+    if (recycle) {
+        pool_class_push(&pool->classes[idx], msg);
+    } else {
+        pool_wrapper_free(msg);
+    }
+
+    pool_unref(pool);
+}
+
 ipx_msg_ipfix_t *
 ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
     uint8_t *msg_data, uint16_t msg_size)
 {
     const size_t rec_size = ipx_ctx_recsize_get(plugin_ctx);
-    const size_t new_size = ipx_msg_ipfix_size(REC_DEF_CNT, rec_size);
-    struct ipx_msg_ipfix *wrapper = calloc(1, new_size);
-    if (!wrapper) {
-        return NULL;
+    struct ipx_msg_ipfix_pool *pool = ipx_ctx_ipfix_pool_get(plugin_ctx);
+    struct ipx_msg_ipfix *wrapper;
+
+    if (pool != NULL) {
+        // Recycled wrappers keep their allocated arrays, the rest must be reset
+        wrapper = pool_wrapper_get(pool, rec_size);
+        if (!wrapper) {
+            return NULL;
+        }
+
+        wrapper->raw_release = NULL;
+        wrapper->raw_release_data = NULL;
+        wrapper->pool_next = NULL;
+        wrapper->sets.cnt_valid = 0;
+        wrapper->rec_info.cnt_valid = 0;
+    } else {
+        const size_t new_size = ipx_msg_ipfix_size(REC_DEF_CNT, rec_size);
+        wrapper = calloc(1, new_size);
+        if (!wrapper) {
+            return NULL;
+        }
+
+        wrapper->sets.cnt_alloc = SET_DEF_CNT;
+        wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
     }
 
     ipx_msg_header_init(&wrapper->msg_header, IPX_MSG_IPFIX);
     wrapper->ctx = *msg_ctx;
     wrapper->raw_pkt = msg_data;
     wrapper->raw_size = msg_size;
-    wrapper->sets.cnt_alloc = SET_DEF_CNT;
-    wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
     wrapper->rec_info.rec_size = rec_size;
     return wrapper;
 }
 
+/**
+ * \brief Release the raw message of an IPFIX Message wrapper
+ * \param[in] msg IPFIX Message wrapper
+ */
+static inline void
+ipx_msg_ipfix_raw_release(struct ipx_msg_ipfix *msg)
+{
+    if (msg->raw_release != NULL) {
+        msg->raw_release(msg->raw_release_data, msg->raw_pkt);
+    } else {
+        free(msg->raw_pkt);
+    }
+}
+
 void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
 {
     // Destroy the IPFIX packet
-    free(msg->raw_pkt);
+    ipx_msg_ipfix_raw_release(msg);
 
-    // Destroy the wrapper
-    if (msg->sets.extended) {
-        free(msg->sets.extended);
+    // Destroy or recycle the wrapper
+    if (msg->pool != NULL) {
+        pool_wrapper_put(msg);
+        return;
     }
-    ipx_msg_header_destroy((ipx_msg_t *) msg);
-    free(msg);
+
+    pool_wrapper_free(msg);
+}
+
+void
+ipx_msg_ipfix_set_release(ipx_msg_ipfix_t *msg, ipx_msg_ipfix_release_cb cb, void *data)
+{
+    msg->raw_release = cb;
+    msg->raw_release_data = data;
+}
+
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *raw_pkt, uint16_t raw_size)
+{
+    ipx_msg_ipfix_raw_release(msg);
+    msg->raw_pkt = raw_pkt;
+    msg->raw_size = raw_size;
+    msg->raw_release = NULL;
+    msg->raw_release_data = NULL;
 }
 
 uint8_t *
@@ -111,7 +406,6 @@ ipx_msg_ipfix_get_sets(ipx_msg_ipfix_t *msg, struct ipx_ipfix_set **sets, size_t
 {
     if (sets != NULL) {
         if (msg->sets.cnt_valid <= SET_DEF_CNT) {
-            assert(msg->sets.extended == NULL);
             *sets = msg->sets.base;
         } else {
             *sets = msg->sets.extended;
@@ -152,19 +446,21 @@ ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
     if (msg->sets.cnt_valid == msg->sets.cnt_alloc) {
         const uint32_t alloc_new =  2U * msg->sets.cnt_alloc;
         const size_t alloc_size = alloc_new * sizeof(struct ipx_ipfix_set);
-        msg->sets.extended = realloc(msg->sets.extended, alloc_size);
-        if (!msg->sets.extended) {
+        struct ipx_ipfix_set *extended_new = realloc(msg->sets.extended, alloc_size);
+        if (!extended_new) {
             return NULL;
         }
 
-        // Move sets from base to extended array
-        if (msg->sets.cnt_valid == SET_DEF_CNT) {
-            const size_t copy_size = msg->sets.cnt_valid * sizeof(struct ipx_ipfix_set);
-            memcpy(msg->sets.extended, msg->sets.base, copy_size);
-        }
+        msg->sets.extended = extended_new;
         msg->sets.cnt_alloc = alloc_new;
     }
 
+    if (msg->sets.cnt_valid == SET_DEF_CNT) {
+        // Move sets from base to extended array (can be already allocated by a previous use)
+        const size_t copy_size = msg->sets.cnt_valid * sizeof(struct ipx_ipfix_set);
+        memcpy(msg->sets.extended, msg->sets.base, copy_size);
+    }
+
     // Return reference into "extended" array
     return &msg->sets.extended[msg->sets.cnt_valid++];
 }
@@ -190,7 +486,11 @@ ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
     assert(msg->rec_info.cnt_valid < msg->rec_info.cnt_alloc);
     const size_t offset = msg->rec_info.cnt_valid * msg->rec_info.rec_size;
     msg->rec_info.cnt_valid++;
-    return ((struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset));
+
+    // Records are not zeroed (recycled or reallocated wrappers) -> no extensions filled yet
+    struct ipx_ipfix_record *rec = (struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset);
+    rec->ext_mask = 0;
+    return rec;
 }
 
 void
@@ -52,6 +52,9 @@
 /** Default number of pre-allocated structures for parser IPFIX Data Records */
 #define REC_DEF_CNT (64)
 
+/** Pool of IPFIX Message wrappers (internal)                                */
+struct ipx_msg_ipfix_pool;
+
 /**
  * \brief Structure for a parsed IPFIX Message
  *
@@ -69,11 +72,23 @@ struct ipx_msg_ipfix {
     uint8_t *raw_pkt;
     /** Size of raw message                                                  */
     uint16_t raw_size;
+    /** Release function of the raw message (NULL for free())                */
+    ipx_msg_ipfix_release_cb raw_release;
+    /** User defined data of the release function                            */
+    void *raw_release_data;
+    /** Pool of the wrapper (NULL if not allocated from a pool)              */
+    struct ipx_msg_ipfix_pool *pool;
+    /** Next wrapper in a free list of the pool                              */
+    struct ipx_msg_ipfix *pool_next;
 
     struct {
         /** Array of sets (valid only when #cnt_valid <= SET_DEF_CNT)       */
         struct ipx_ipfix_set  base[SET_DEF_CNT];
-        /** Array of sets (valid only when #cnt_valid > SET_DEF_CNT)        */
+        /**
+         * Array of sets (valid only when #cnt_valid > SET_DEF_CNT)
+         * \note Wrappers recycled by a pool keep the array allocated (i.e. #cnt_alloc
+         *   can be greater than SET_DEF_CNT even if the array is not used)
+         */
         struct ipx_ipfix_set *extended;
 
         /** Number of the Sets in the message                                */
@@ -116,4 +131,58 @@ struct ipx_msg_ipfix {
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size);
 
+/**
+ * \brief Replace the raw message of an IPFIX Message wrapper
+ *
+ * The previous raw message is released (see ipx_msg_ipfix_set_release()) and the new one is
+ * expected to be allocated using malloc().
+ * \param[in] msg      IPFIX Message wrapper
+ * \param[in] raw_pkt  New raw message
+ * \param[in] raw_size Size of the new raw message
+ */
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *raw_pkt, uint16_t raw_size);
+
+/**
+ * \brief Create a pool of IPFIX Message wrappers
+ *
+ * The pool recycles wrappers (including their extended arrays of IPFIX Sets) created by
+ * ipx_msg_ipfix_create() and destroyed by ipx_msg_ipfix_destroy(), which can be called by any
+ * thread (usually output instances). Wrappers are stored in lock-free free lists of size classes
+ * based on their capacity of Data Records. The capacity of new wrappers adapts to the running
+ * average number of records per message, so reallocation during parsing is rare.
+ * \return Pointer to the pool or NULL (memory allocation error)
+ */
+struct ipx_msg_ipfix_pool *
+ipx_msg_ipfix_pool_create(void);
+
+/**
+ * \brief Destroy a pool of IPFIX Message wrappers
+ *
+ * \note Wrappers of the pool that are still in use are freed when they are destroyed and
+ *   the pool itself is freed after the last of them.
+ * \param[in] pool Pool to destroy
+ */
+void
+ipx_msg_ipfix_pool_destroy(struct ipx_msg_ipfix_pool *pool);
+
+/**
+ * \brief Get a hash of the Transport Session and ODID of an IPFIX Message context
+ *
+ * The hash is used to shard messages among threads (parser workers, output workers), so all
+ * messages of the same combination are always processed by the same thread.
+ * \param[in] msg_ctx Message context
+ * \return Hash value (SplitMix64 finalizer)
+ */
+static inline uint64_t
+ipx_msg_ctx_hash(const struct ipx_msg_ctx *msg_ctx)
+{
+    uint64_t key = (uint64_t) (uintptr_t) msg_ctx->session;
+    key ^= (uint64_t) msg_ctx->odid * 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return key;
+}
+
 #endif // IPFIXCOL_MESSAGE_IPFIX_INTERNAL_H
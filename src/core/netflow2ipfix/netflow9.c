@@ -1265,9 +1265,7 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
     conv->ipx_seq_next += conv->data.drecs_converted;
 
     // Finally, replace the converted NetFlow Message with the new IPFIX Message
-    free(wrapper->raw_pkt);
-    wrapper->raw_pkt = conv_mem_release(conv);
-    wrapper->raw_size = (uint16_t) ipx_size;
+    ipx_msg_ipfix_raw_replace(wrapper, conv_mem_release(conv), (uint16_t) ipx_size);
     return IPX_OK;
 }
 
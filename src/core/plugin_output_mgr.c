@@ -41,14 +41,19 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "plugin_output_mgr.h"
 #include "message_base.h"
+#include "message_ipfix.h"
 #include "context.h"
 
 /** Definition of a connection with an output instance      */
 struct ipx_output_mgr_rec {
-    /** Ring buffer connection (writer only)                */
-    ipx_ring_t *ring;
+    /** Ring buffer connections of workers (writer only)    */
+    ipx_ring_t **rings;
+    /** Number of workers (i.e. ring buffers)               */
+    uint32_t ring_cnt;
     /** Type of filter                                      */
     enum ipx_odid_filter_type type;
     /** ODID filter (NULL if #type == IPX_ODID_FILTER_NONE) */
@@ -57,9 +62,11 @@ struct ipx_output_mgr_rec {
 
 /** List of output destinations */
 struct ipx_output_mgr_list {
-    /** Number of output instances */
+    /** Number of output instances                 */
     size_t size;
-    /** Array of records           */
+    /** Number of ring buffers of all instances    */
+    size_t rings_total;
+    /** Array of records                           */
     struct ipx_output_mgr_rec *recs;
 };
 
@@ -72,6 +79,7 @@ ipx_output_mgr_list_create()
     }
 
     result->size = 0;
+    result->rings_total = 0;
     result->recs = NULL;
     return result;
 }
@@ -79,6 +87,10 @@ ipx_output_mgr_list_create()
 void
 ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list)
 {
+    for (size_t i = 0; i < list->size; ++i) {
+        free(list->recs[i].rings);
+    }
+
     free(list->recs);
     free(list);
 }
@@ -90,32 +102,47 @@ ipx_output_mgr_list_empty(const ipx_output_mgr_list_t *list)
 }
 
 int
-ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
+ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t * const *rings, size_t ring_cnt,
     enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter)
 {
     // Check arguments
-    if (list == NULL || ring == NULL) {
+    if (list == NULL || rings == NULL || ring_cnt == 0 || ring_cnt > UINT32_MAX) {
         return IPX_ERR_ARG;
     }
 
+    for (size_t i = 0; i < ring_cnt; ++i) {
+        if (rings[i] == NULL) {
+            return IPX_ERR_ARG;
+        }
+    }
+
     if (odid_type != IPX_ODID_FILTER_NONE && odid_filter == NULL) {
         // The ODID filter is missing
         return IPX_ERR_ARG;
     }
 
+    ipx_ring_t **rec_rings = malloc(ring_cnt * sizeof(*rec_rings));
+    if (!rec_rings) {
+        return IPX_ERR_NOMEM;
+    }
+
     // Add a new record
     size_t new_size = list->size + 1;
     size_t recs_size = new_size * sizeof(struct ipx_output_mgr_rec);
     struct ipx_output_mgr_rec *new_recs = realloc(list->recs, recs_size);
     if (!new_recs) {
+        free(rec_rings);
         return IPX_ERR_NOMEM;
     }
 
     list->size = new_size;
+    list->rings_total += ring_cnt;
     list->recs = new_recs;
 
     struct ipx_output_mgr_rec *rec = &list->recs[new_size - 1];
-    rec->ring = ring;
+    memcpy(rec_rings, rings, ring_cnt * sizeof(*rec_rings));
+    rec->rings = rec_rings;
+    rec->ring_cnt = (uint32_t) ring_cnt;
     rec->type = odid_type;
     rec->odid_filter = odid_filter;
     return IPX_OK;
@@ -155,34 +182,24 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) cfg;
 }
 
-int
-ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+/**
+ * \brief Get output destinations of an IPFIX Message
+ *
+ * \param[in]  list     List of output destinations
+ * \param[in]  msg      IPFIX Message
+ * \param[out] dest_cnt Number of destinations
+ * \return Bitmask of destinations (i-th bit represents i-th record of the list)
+ */
+static uint64_t
+output_mgr_dest_mask(const struct ipx_output_mgr_list *list, ipx_msg_t *msg,
+    unsigned int *dest_cnt)
 {
-    (void) ctx;
-    // List of output destination is prepared by the configurator
-    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
-    assert(list != NULL);
-
-    // Only IPFIX messages are filtered
-    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
-    if (msg_type != IPX_MSG_IPFIX) {
-        // Set the number of references and pass the message to all output instances
-        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
-
-        for (size_t i = 0; i < list->size; ++i) {
-            ipx_ring_push(list->recs[i].ring, msg);
-        }
-
-        return IPX_OK;
-    }
-
-    // First, get number of destinations...
     uint64_t dest_mask = 0;
-    unsigned int dest_cnt = 0;
+    unsigned int cnt = 0;
     uint32_t odid = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
 
     for (size_t i = 0; i < list->size; ++i) {
-        struct ipx_output_mgr_rec *rec = &list->recs[i];
+        const struct ipx_output_mgr_rec *rec = &list->recs[i];
         switch (rec->type) {
         case IPX_ODID_FILTER_NONE:
             // Add to the destinations
@@ -202,16 +219,66 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         dest_mask |= (1ULL << i);
-        dest_cnt++;
+        cnt++;
+    }
+
+    *dest_cnt = cnt;
+    return dest_mask;
+}
+
+/**
+ * \brief Get a hash of the Transport Session and ODID of an IPFIX Message
+ *
+ * The hash is used to select a worker of an output instance, so all messages of the same
+ * combination are always processed by the same worker.
+ * \param[in] msg IPFIX Message
+ * \return Hash value
+ */
+static inline uint64_t
+output_mgr_worker_hash(ipx_msg_t *msg)
+{
+    // Must match the sharding of parser threads (see ipx_msg_ctx_hash())
+    return ipx_msg_ctx_hash(ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg)));
+}
+
+int
+ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    // List of output destination is prepared by the configurator
+    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
+    assert(list != NULL);
+
+    // Only IPFIX messages are filtered
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    if (msg_type != IPX_MSG_IPFIX) {
+        // Set the number of references and pass the message to all workers of all outputs
+        ipx_msg_header_cnt_set(msg, (unsigned int) list->rings_total);
+
+        for (size_t i = 0; i < list->size; ++i) {
+            const struct ipx_output_mgr_rec *rec = &list->recs[i];
+            for (uint32_t w = 0; w < rec->ring_cnt; ++w) {
+                ipx_ring_push(rec->rings[w], msg);
+            }
+        }
+
+        return IPX_OK;
     }
 
+    // First, get number of destinations...
+    unsigned int dest_cnt;
+    uint64_t dest_mask = output_mgr_dest_mask(list, msg, &dest_cnt);
+
     if (dest_cnt == 0) {
         // No-one wants the message -> destroy
         ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
         return IPX_OK;
     }
 
-    // Set the number of references and send to all selected destinations
+    // The message cannot be touched after it has been passed to the first destination
+    const uint64_t hash = (list->rings_total > list->size) ? output_mgr_worker_hash(msg) : 0;
+
+    // Set the number of references and send to all selected destinations (one worker each)
     ipx_msg_header_cnt_set(msg, dest_cnt);
     for (size_t dest_idx = 0; dest_mask != 0; dest_idx++, dest_mask >>= 1) {
         if ((dest_mask & 0x1) == 0) {
@@ -220,8 +287,88 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         struct ipx_output_mgr_rec *rec = &list->recs[dest_idx];
-        ipx_ring_push(rec->ring, msg);
+        ipx_ring_push(rec->rings[hash % rec->ring_cnt], msg);
     }
 
     return IPX_OK;
-}
\ No newline at end of file
+}
+
+int
+ipx_plugin_output_mgr_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt)
+{
+    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
+    assert(list != NULL);
+
+    if (list->size > 64U) {
+        // Destinations cannot be represented by a bitmask -> process messages one by one
+        for (size_t i = 0; i < cnt; ++i) {
+            ipx_plugin_output_mgr_process(ctx, cfg, msgs[i]);
+        }
+        return IPX_OK;
+    }
+
+    const uint64_t all_mask = (list->size == 64U) ? UINT64_MAX : ((1ULL << list->size) - 1);
+    const bool workers = (list->rings_total > list->size);
+    uint64_t masks[IPX_CTX_BATCH_SIZE];
+    uint64_t hashes[IPX_CTX_BATCH_SIZE];
+    bool bcast[IPX_CTX_BATCH_SIZE];
+    ipx_msg_t *dst_msgs[IPX_CTX_BATCH_SIZE];
+
+    while (cnt > 0) {
+        const size_t part_cnt = (cnt < IPX_CTX_BATCH_SIZE) ? cnt : IPX_CTX_BATCH_SIZE;
+
+        // Set the number of references of all messages before any of them is passed
+        for (size_t i = 0; i < part_cnt; ++i) {
+            ipx_msg_t *msg = msgs[i];
+            if (ipx_msg_get_type(msg) != IPX_MSG_IPFIX) {
+                // Only IPFIX messages are filtered, others are passed to all workers
+                ipx_msg_header_cnt_set(msg, (unsigned int) list->rings_total);
+                masks[i] = all_mask;
+                bcast[i] = true;
+                continue;
+            }
+
+            bcast[i] = false;
+            hashes[i] = workers ? output_mgr_worker_hash(msg) : 0;
+
+            unsigned int dest_cnt;
+            masks[i] = output_mgr_dest_mask(list, msg, &dest_cnt);
+            if (dest_cnt == 0) {
+                // No-one wants the message -> destroy
+                ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
+                continue;
+            }
+
+            ipx_msg_header_cnt_set(msg, dest_cnt);
+        }
+
+        // Pass all selected messages to each destination at once (preserves the order)
+        for (size_t dest_idx = 0; dest_idx < list->size; ++dest_idx) {
+            const struct ipx_output_mgr_rec *rec = &list->recs[dest_idx];
+            const uint64_t dest_bit = 1ULL << dest_idx;
+
+            for (uint32_t w = 0; w < rec->ring_cnt; ++w) {
+                uint32_t dst_cnt = 0;
+
+                for (size_t i = 0; i < part_cnt; ++i) {
+                    if ((masks[i] & dest_bit) == 0) {
+                        continue;
+                    }
+                    if (rec->ring_cnt > 1 && !bcast[i] && (hashes[i] % rec->ring_cnt) != w) {
+                        continue; // Processed by another worker
+                    }
+                    dst_msgs[dst_cnt++] = msgs[i];
+                }
+
+                if (dst_cnt > 0) {
+                    ipx_ring_push_n(rec->rings[w], dst_msgs, dst_cnt);
+                }
+            }
+        }
+
+        msgs += part_cnt;
+        cnt -= part_cnt;
+    }
+
+    return IPX_OK;
+}
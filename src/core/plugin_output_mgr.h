@@ -77,8 +77,13 @@ ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list);
 
 /**
  * \brief Add a new destination to the list
+ *
+ * If the destination consists of multiple workers (i.e. ring buffers), each IPFIX Message is
+ * passed only to one of them based on its Transport Session and ODID. Other messages are passed
+ * to all of them.
  * \param[in] list        Output manager list
- * \param[in] ring        Output plugin connection  (for a writer)
+ * \param[in] rings       Output plugin connections (for a writer), one per worker
+ * \param[in] ring_cnt    Number of connections (at least 1)
  * \param[in] odid_type   ODID filter type
  * \param[in] odid_filter ODID filter (should be NULL, if odid_type == IPX_ODID_FILTER_NONE)
  * \return #IPX_OK on success
@@ -86,7 +91,7 @@ ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list);
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
 int
-ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
+ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t * const *rings, size_t ring_cnt,
     enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter);
 
 // ------------------------------------------------------------------------------------------------
@@ -127,4 +132,19 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg);
 int
 ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Pass a batch of messages to output plugins
+ *
+ * Same as ipx_plugin_output_mgr_process(), however, all messages of the batch for the same
+ * output instance are inserted into its ring buffer at once.
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Private instance data
+ * \param[in] msgs Array of messages to process
+ * \param[in] cnt  Number of messages in the array
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_output_mgr_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
 #endif //IPFIXCOL_PLUGIN_OUTPUT_MGR_H
@@ -39,10 +39,27 @@
  *
  */
 
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <libfds.h>
+
 #include "fpipe.h"
 #include "context.h"
+#include "message_base.h"
+#include "message_ipfix.h"
+#include "message_terminate.h"
 #include "plugin_parser.h"
 #include "parser.h"
+#include "ring.h"
+
+/** Maximum number of parser threads                                                           */
+#define PARSER_THREADS_MAX    64U
+/** Default size of ring buffers between the dispatcher and parser threads                      */
+#define PARSER_RING_DEF_SIZE  8192U
+/** Maximum number of messages that a parser thread takes from its ring buffer at once          */
+#define PARSER_BATCH_SIZE     64U
 
 const struct ipx_plugin_info ipx_plugin_parser_info = {
     .name    = "IPFIX Parser",
@@ -53,34 +70,191 @@ const struct ipx_plugin_info ipx_plugin_parser_info = {
     .ipx_min = "2.0.0"
 };
 
-int
-ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
+/** Configuration of the parser instance                                                        */
+struct parser_params {
+    /** Number of parser threads (1 == no extra threads)                                        */
+    unsigned int threads;
+    /** Size of ring buffers between the dispatcher and parser threads                          */
+    uint32_t ring_size;
+    /** Type of ring buffers between the dispatcher and parser threads                          */
+    enum ipx_ring_type ring_type;
+};
+
+/** XML nodes of the parser parameters                                                          */
+enum parser_params_xml_nodes {
+    PARSER_THREADS = 1,
+    PARSER_RING_SIZE,
+    PARSER_RING_TYPE
+};
+
+/** Definition of the \<params\> node of the parser                                            */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(PARSER_THREADS,   "threads",  FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARSER_RING_SIZE, "ringSize", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARSER_RING_TYPE, "ringType", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+struct parser_plugin;
+
+/** Transport Session blocked or removed by a parser thread (only in the multi-threaded mode)   */
+struct parser_ts_rec {
+    /** Transport Session                                                                       */
+    const struct ipx_session *session;
+    /** Messages of the Transport Session are dropped until it is closed                        */
+    bool blocked;
+    /** Parser threads that still have to remove the Transport Session from their parsers      */
+    uint64_t remove_mask;
+};
+
+/** Parser thread (only in the multi-threaded mode)                                            */
+struct parser_worker {
+    /** Instance of the parser plugin                                                           */
+    struct parser_plugin *plugin;
+    /** Parser of Transport Sessions and ODIDs assigned to the thread                           */
+    ipx_parser_t *parser;
+    /** Ring buffer of messages assigned to the thread                                          */
+    ipx_ring_t *ring;
+    /** Thread identification                                                                   */
+    pthread_t thread;
+};
+
+/** Instance of the parser plugin                                                               */
+struct parser_plugin {
+    /** Plugin context                                                                          */
+    ipx_ctx_t *ctx;
+    /** Parser (only in the single-threaded mode, otherwise NULL)                               */
+    ipx_parser_t *parser;
+
+    /** Number of parser threads (0 == single-threaded mode)                                    */
+    unsigned int workers_cnt;
+    /** Array of parser threads                                                                 */
+    struct parser_worker *workers;
+    /** Request to stop parser threads (always the last message in their ring buffers)          */
+    ipx_msg_terminate_t *workers_stop;
+    /** At least one parser thread has failed                                                   */
+    bool workers_failed;
+
+    /** Barrier of parser threads used to close a Transport Session                             */
+    struct {
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        /** Number of parser threads waiting at the barrier                                     */
+        unsigned int waiting;
+        /** Number of already completed barriers                                                */
+        uint64_t generation;
+    } barrier;
+
+    /** Transport Sessions blocked or removed by parser threads (shared by all threads)         */
+    struct {
+        pthread_mutex_t mutex;
+        /** Array of records                                                                    */
+        struct parser_ts_rec *recs;
+        /** Number of valid records (can be read without the mutex)                            */
+        unsigned int cnt;
+        /** Number of allocated records                                                         */
+        unsigned int alloc;
+    } sessions;
+};
+
+/**
+ * \brief Parse parameters of the parser instance
+ * \param[in]  ctx    Plugin context
+ * \param[in]  params XML parameters (can be NULL)
+ * \param[out] cfg    Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the parameters are not valid
+ */
+static int
+parser_params_parse(ipx_ctx_t *ctx, const char *params, struct parser_params *cfg)
 {
-    (void) params; // Not used
+    cfg->threads = 1;
+    cfg->ring_size = PARSER_RING_DEF_SIZE;
+    cfg->ring_type = IPX_RING_TYPE_LOCKED;
+    if (!params) {
+        return IPX_OK;
+    }
 
-    // Subscribe to receive IPFIX and Session messages
-    const uint16_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
-    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
-        IPX_CTX_ERROR(ctx, "Failed to subscribe to receive IPFIX and Transport Session Messages.",
-            '\0');
-        return IPX_ERR_DENIED;
+    fds_xml_t *xml = fds_xml_create();
+    if (!xml) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
     }
 
-    const char *plugin_name = ipx_ctx_name_get(ctx);
-    enum ipx_verb_level plugin_vlevel = ipx_ctx_verb_get(ctx);
+    fds_xml_ctx_t *root;
+    if (fds_xml_set_args(xml, args_params) != FDS_OK
+            || (root = fds_xml_parse_mem(xml, params, true)) == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse parameters of the parser: %s", fds_xml_last_err(xml));
+        fds_xml_destroy(xml);
+        return IPX_ERR_FORMAT;
+    }
+
+    int rc = IPX_OK;
+    const struct fds_xml_cont *content;
+    while (rc == IPX_OK && fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case PARSER_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > PARSER_THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of parser threads must be between 1 and %u.",
+                    PARSER_THREADS_MAX);
+                rc = IPX_ERR_FORMAT;
+                break;
+            }
+            cfg->threads = (unsigned int) content->val_uint;
+            break;
+        case PARSER_RING_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Invalid size of parser ring buffers.", '\0');
+                rc = IPX_ERR_FORMAT;
+                break;
+            }
+            cfg->ring_size = (uint32_t) content->val_uint;
+            break;
+        case PARSER_RING_TYPE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "lockfree") == 0) {
+                cfg->ring_type = IPX_RING_TYPE_LOCKFREE;
+            } else if (strcasecmp(content->ptr_string, "locked") == 0) {
+                cfg->ring_type = IPX_RING_TYPE_LOCKED;
+            } else {
+                IPX_CTX_ERROR(ctx, "Invalid type of parser ring buffers '%s'.",
+                    content->ptr_string);
+                rc = IPX_ERR_FORMAT;
+            }
+            break;
+        default:
+            // Unexpected XML node
+            assert(false);
+        }
+    }
 
-    // Create a parser
-    ipx_parser_t *parser = ipx_parser_create(plugin_name, plugin_vlevel);
+    fds_xml_destroy(xml);
+    return rc;
+}
+
+/**
+ * \brief Create a new parser of IPFIX Messages
+ * \param[in] ctx   Plugin context
+ * \param[in] ident Identification of the parser (used in log messages)
+ * \return Pointer to the parser or NULL
+ */
+static ipx_parser_t *
+parser_create(ipx_ctx_t *ctx, const char *ident)
+{
+    ipx_parser_t *parser = ipx_parser_create(ident, ipx_ctx_verb_get(ctx));
     if (!parser) {
         IPX_CTX_ERROR(ctx, "Failed to create a parser of IPFIX Messages!", '\0');
-        return IPX_ERR_DENIED;
+        return NULL;
     }
 
     ipx_msg_garbage_t *garbage = NULL;
     if (ipx_parser_ie_source(parser, ipx_ctx_iemgr_get(ctx), &garbage) != IPX_OK) {
         IPX_CTX_ERROR(ctx, "Failed to create set a source of Information Elements!", '\0');
         ipx_parser_destroy(parser);
-        return IPX_ERR_DENIED;
+        return NULL;
     }
 
     if (garbage != NULL) { // Should not produce any garbage, but you never know...
@@ -88,15 +262,20 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
         ipx_msg_garbage_destroy(garbage);
     }
 
-    ipx_ctx_private_set(ctx, parser);
-    return IPX_OK;
+    return parser;
 }
 
-void
-ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
+/**
+ * \brief Pass a parser as a garbage message
+ *
+ * The parser cannot be destroyed immediately because its (Options) Templates can be still
+ * referenced by earlier IPFIX Messages.
+ * \param[in] ctx    Plugin context
+ * \param[in] parser Parser to destroy
+ */
+static void
+parser_garbage_pass(ipx_ctx_t *ctx, ipx_parser_t *parser)
 {
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
-
     // Create a garbage message
     ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
     ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(parser, cb);
@@ -113,6 +292,374 @@ ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
     }
 }
 
+static void *
+parser_worker_thread(void *arg);
+
+/**
+ * \brief Stop parser threads
+ *
+ * All messages already assigned to the threads are processed before the threads are stopped.
+ * \param[in] plugin  Instance of the parser plugin
+ * \param[in] running Number of running threads (i.e. the first \p running threads are running)
+ */
+static void
+parser_workers_stop(struct parser_plugin *plugin, unsigned int running)
+{
+    for (unsigned int i = 0; i < running; ++i) {
+        ipx_ring_push(plugin->workers[i].ring, ipx_msg_terminate2base(plugin->workers_stop));
+    }
+
+    for (unsigned int i = 0; i < running; ++i) {
+        int rc = pthread_join(plugin->workers[i].thread, NULL);
+        if (rc != 0) {
+            IPX_CTX_ERROR(plugin->ctx, "pthread_join() failed (%s:%d, code: %d)", __FILE__,
+                __LINE__, rc);
+        }
+    }
+}
+
+/**
+ * \brief Destroy (already stopped) parser threads
+ * \param[in] plugin  Instance of the parser plugin
+ * \param[in] garbage Pass parsers as garbage messages (i.e. parsed IPFIX Messages can still
+ *   reference their templates) instead of immediate destruction
+ */
+static void
+parser_workers_free(struct parser_plugin *plugin, bool garbage)
+{
+    for (unsigned int i = 0; i < plugin->workers_cnt; ++i) {
+        struct parser_worker *worker = &plugin->workers[i];
+        if (worker->parser != NULL && garbage) {
+            parser_garbage_pass(plugin->ctx, worker->parser);
+        } else if (worker->parser != NULL) {
+            ipx_parser_destroy(worker->parser);
+        }
+
+        if (worker->ring != NULL) {
+            ipx_ring_destroy(worker->ring);
+        }
+    }
+
+    pthread_cond_destroy(&plugin->barrier.cond);
+    pthread_mutex_destroy(&plugin->barrier.mutex);
+    pthread_mutex_destroy(&plugin->sessions.mutex);
+    free(plugin->sessions.recs);
+    plugin->sessions.recs = NULL;
+    ipx_msg_terminate_destroy(plugin->workers_stop);
+    free(plugin->workers);
+    plugin->workers = NULL;
+    plugin->workers_cnt = 0;
+}
+
+/**
+ * \brief Create and start parser threads
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] cfg    Configuration of the instance
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+parser_workers_create(struct parser_plugin *plugin, const struct parser_params *cfg)
+{
+    ipx_ctx_t *ctx = plugin->ctx;
+    plugin->workers = calloc(cfg->threads, sizeof(*plugin->workers));
+    plugin->workers_stop = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+    if (!plugin->workers || !plugin->workers_stop) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed (%s:%d)", __FILE__, __LINE__);
+        goto err_alloc;
+    }
+
+    if (pthread_mutex_init(&plugin->barrier.mutex, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a mutex of parser threads.", '\0');
+        goto err_alloc;
+    }
+
+    if (pthread_cond_init(&plugin->barrier.cond, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a condition variable of parser threads.", '\0');
+        pthread_mutex_destroy(&plugin->barrier.mutex);
+        goto err_alloc;
+    }
+
+    if (pthread_mutex_init(&plugin->sessions.mutex, NULL) != 0) {
+        IPX_CTX_ERROR(ctx, "Failed to initialize a mutex of parser threads.", '\0');
+        pthread_cond_destroy(&plugin->barrier.cond);
+        pthread_mutex_destroy(&plugin->barrier.mutex);
+        goto err_alloc;
+    }
+
+    plugin->workers_cnt = cfg->threads;
+    plugin->workers_failed = false;
+    plugin->barrier.waiting = 0;
+    plugin->barrier.generation = 0;
+    plugin->sessions.recs = NULL;
+    plugin->sessions.cnt = 0;
+    plugin->sessions.alloc = 0;
+
+    // Prepare parsers and ring buffers
+    for (unsigned int i = 0; i < plugin->workers_cnt; ++i) {
+        struct parser_worker *worker = &plugin->workers[i];
+        char ident[128];
+        snprintf(ident, sizeof(ident), "%s #%u", ipx_ctx_name_get(ctx), i);
+
+        worker->plugin = plugin;
+        worker->parser = parser_create(ctx, ident);
+        worker->ring = ipx_ring_init(cfg->ring_size, false, cfg->ring_type);
+        if (!worker->parser || !worker->ring) {
+            IPX_CTX_ERROR(ctx, "Failed to prepare a parser thread.", '\0');
+            parser_workers_free(plugin, false);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    // Start the threads
+    for (unsigned int i = 0; i < plugin->workers_cnt; ++i) {
+        struct parser_worker *worker = &plugin->workers[i];
+        int rc = pthread_create(&worker->thread, NULL, &parser_worker_thread, worker);
+        if (rc != 0) {
+            IPX_CTX_ERROR(ctx, "Failed to start a parser thread (code: %d)", rc);
+            parser_workers_stop(plugin, i);
+            parser_workers_free(plugin, false);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    IPX_CTX_INFO(ctx, "IPFIX Messages are parsed by %u threads.", plugin->workers_cnt);
+    return IPX_OK;
+
+err_alloc:
+    free(plugin->workers);
+    if (plugin->workers_stop != NULL) {
+        ipx_msg_terminate_destroy(plugin->workers_stop);
+    }
+    plugin->workers = NULL;
+    plugin->workers_stop = NULL;
+    return IPX_ERR_DENIED;
+}
+
+int
+ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct parser_params cfg;
+    if (parser_params_parse(ctx, params, &cfg) != IPX_OK) {
+        return IPX_ERR_DENIED;
+    }
+
+    /* Subscribe to receive IPFIX and Session messages
+     * Parser threads must also see garbage and periodic messages, otherwise the messages would
+     * overtake IPFIX and Session messages that are still waiting in the threads.
+     */
+    uint16_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    if (cfg.threads > 1) {
+        mask |= IPX_MSG_GARBAGE | IPX_MSG_PERIODIC;
+        if (ipx_ctx_subscribe_allow(ctx, mask) != IPX_OK
+                || ipx_ctx_msg_pass_mt(ctx) != IPX_OK) {
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to subscribe to receive IPFIX and Transport Session Messages.",
+            '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    struct parser_plugin *plugin = calloc(1, sizeof(*plugin));
+    if (!plugin) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    plugin->ctx = ctx;
+
+    if (cfg.threads > 1) {
+        // Create parser threads
+        if (parser_workers_create(plugin, &cfg) != IPX_OK) {
+            free(plugin);
+            return IPX_ERR_DENIED;
+        }
+    } else {
+        // Create a parser
+        plugin->parser = parser_create(ctx, ipx_ctx_name_get(ctx));
+        if (!plugin->parser) {
+            free(plugin);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    ipx_ctx_private_set(ctx, plugin);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct parser_plugin *plugin = (struct parser_plugin *) cfg;
+
+    if (plugin->workers_cnt > 0) {
+        // Process all remaining messages and stop the threads
+        parser_workers_stop(plugin, plugin->workers_cnt);
+        parser_workers_free(plugin, true);
+    } else {
+        parser_garbage_pass(ctx, plugin->parser);
+    }
+
+    free(plugin);
+}
+
+/**
+ * \brief Find a record of a Transport Session blocked or removed by parser threads
+ * \warning The mutex of the records MUST be locked.
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] ts     Transport Session
+ * \return Pointer to the record or NULL
+ */
+static struct parser_ts_rec *
+parser_sessions_find(struct parser_plugin *plugin, const struct ipx_session *ts)
+{
+    for (unsigned int i = 0; i < plugin->sessions.cnt; ++i) {
+        if (plugin->sessions.recs[i].session == ts) {
+            return &plugin->sessions.recs[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Remove a record of a Transport Session blocked or removed by parser threads
+ * \warning The mutex of the records MUST be locked.
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] rec    Record to remove
+ */
+static void
+parser_sessions_erase(struct parser_plugin *plugin, struct parser_ts_rec *rec)
+{
+    const unsigned int last = plugin->sessions.cnt - 1;
+    *rec = plugin->sessions.recs[last];
+    __atomic_store_n(&plugin->sessions.cnt, last, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Share a block or a hard remove of a Transport Session with all parser threads
+ *
+ * A parser thread can modify only its own parser, however, messages of the Transport Session
+ * (TS) with other ODIDs are processed by other threads. If the TS is blocked, its messages are
+ * dropped by the dispatcher and all threads until the TS is closed. If the TS is removed,
+ * the other threads remove it from their parsers before they process its next message.
+ * \param[in] worker  Parser thread that has blocked or removed the TS in its parser
+ * \param[in] ts      Transport Session
+ * \param[in] blocked The TS has been blocked (otherwise removed)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation has failed
+ */
+static int
+parser_sessions_add(struct parser_worker *worker, const struct ipx_session *ts, bool blocked)
+{
+    struct parser_plugin *plugin = worker->plugin;
+    const unsigned int idx = (unsigned int) (worker - plugin->workers);
+    int rc = IPX_OK;
+
+    pthread_mutex_lock(&plugin->sessions.mutex);
+    struct parser_ts_rec *rec = parser_sessions_find(plugin, ts);
+    if (!rec && plugin->sessions.cnt == plugin->sessions.alloc) {
+        const unsigned int alloc = plugin->sessions.alloc;
+        const unsigned int new_alloc = (alloc == 0) ? 8U : 2U * alloc;
+        const size_t new_size = new_alloc * sizeof(struct parser_ts_rec);
+        struct parser_ts_rec *new_recs = realloc(plugin->sessions.recs, new_size);
+        if (!new_recs) {
+            rc = IPX_ERR_NOMEM;
+            goto end;
+        }
+        plugin->sessions.recs = new_recs;
+        plugin->sessions.alloc = new_alloc;
+    }
+
+    if (!rec) {
+        rec = &plugin->sessions.recs[plugin->sessions.cnt];
+        rec->session = ts;
+        rec->blocked = false;
+        rec->remove_mask = 0;
+        __atomic_store_n(&plugin->sessions.cnt, plugin->sessions.cnt + 1, __ATOMIC_RELEASE);
+    }
+
+    if (blocked) {
+        rec->blocked = true;
+    } else {
+        // All threads except this one (already removed)
+        const uint64_t all = (plugin->workers_cnt == 64) ? UINT64_MAX
+            : ((uint64_t) 1 << plugin->workers_cnt) - 1;
+        rec->remove_mask |= all & ~((uint64_t) 1 << idx);
+    }
+
+end:
+    pthread_mutex_unlock(&plugin->sessions.mutex);
+    return rc;
+}
+
+/**
+ * \brief Apply a block or a hard remove of a Transport Session to an IPFIX Message
+ *
+ * If the Transport Session (TS) has been removed by another thread, it's removed from the parser
+ * of the thread too. The dispatcher only checks whether the TS is blocked.
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] worker Parser thread that is going to process the message (NULL == the dispatcher)
+ * \param[in] ts     Transport Session of the message
+ * \return True if the TS is blocked, i.e. the message MUST be dropped
+ */
+static bool
+parser_sessions_apply(struct parser_plugin *plugin, struct parser_worker *worker,
+    const struct ipx_session *ts)
+{
+    if (__atomic_load_n(&plugin->sessions.cnt, __ATOMIC_ACQUIRE) == 0) {
+        // Nothing has been blocked or removed (the most common case)
+        return false;
+    }
+
+    bool blocked = false;
+    bool remove = false;
+
+    pthread_mutex_lock(&plugin->sessions.mutex);
+    struct parser_ts_rec *rec = parser_sessions_find(plugin, ts);
+    if (rec != NULL) {
+        blocked = rec->blocked;
+        const uint64_t bit = (worker != NULL)
+            ? (uint64_t) 1 << (unsigned int) (worker - plugin->workers) : 0;
+        if ((rec->remove_mask & bit) != 0) {
+            remove = true;
+            rec->remove_mask &= ~bit;
+        }
+        if (!rec->blocked && rec->remove_mask == 0) {
+            parser_sessions_erase(plugin, rec);
+        }
+    }
+    pthread_mutex_unlock(&plugin->sessions.mutex);
+
+    if (remove) {
+        // Previous messages of the TS have been already passed -> garbage can follow them
+        ipx_msg_garbage_t *garbage;
+        if (ipx_parser_session_remove(worker->parser, ts, &garbage) == IPX_OK && garbage != NULL) {
+            ipx_ctx_msg_pass(plugin->ctx, ipx_msg_garbage2base(garbage));
+        }
+    }
+
+    return blocked;
+}
+
+/**
+ * \brief Forget a closed Transport Session blocked or removed by parser threads
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] ts     Transport Session
+ */
+static void
+parser_sessions_forget(struct parser_plugin *plugin, const struct ipx_session *ts)
+{
+    pthread_mutex_lock(&plugin->sessions.mutex);
+    struct parser_ts_rec *rec = parser_sessions_find(plugin, ts);
+    if (rec != NULL) {
+        parser_sessions_erase(plugin, rec);
+    }
+    pthread_mutex_unlock(&plugin->sessions.mutex);
+}
+
 /**
  * \brief Process Transport Session event message
  *
@@ -178,16 +725,19 @@ parser_plugin_process_session(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_sess
  * has occurred and a parser is not able to process IPFIX Messages of the TS anymore.
  * After calling this function, the Session is removed from the parser (if an Input plugin doesn't
  * support feedback) or blocked until connection is closed (if an Input plugin supports feedback).
+ * In the multi-threaded mode, the block or the removal is shared with all parser threads.
  *
  * \warning Plugin context MUST be able to pass messages!
  * \param[in] ctx    Plugin context
  * \param[in] parser Parser
+ * \param[in] worker Parser thread of the parser (NULL in the single-threaded mode)
  * \param[in] ts     Transport Session to remove
  * \return #IPX_OK on success
  * \return #IPX_ERR_ARG in case of fatal internal error
  */
 static inline int
-parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct ipx_session *ts)
+parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, struct parser_worker *worker,
+    const struct ipx_session *ts)
 {
     ipx_msg_garbage_t *garbage;
 
@@ -203,6 +753,10 @@ parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct
         if (rc == IPX_OK && garbage != NULL) {
             ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
         }
+        if (worker != NULL && parser_sessions_add(worker, ts, false) != IPX_OK) {
+            IPX_CTX_WARNING(ctx, "Unable to remove the Transport Session '%s' from other parser "
+                "threads due to memory allocation error.", ts->ident);
+        }
 
         return IPX_OK;
     }
@@ -217,10 +771,18 @@ parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct
         if (rc == IPX_OK && garbage != NULL) {
             ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
         }
+        if (worker != NULL && parser_sessions_add(worker, ts, false) != IPX_OK) {
+            IPX_CTX_WARNING(ctx, "Unable to remove the Transport Session '%s' from other parser "
+                "threads due to memory allocation error.", ts->ident);
+        }
         return IPX_OK;
     }
 
     ipx_parser_session_block(parser, ts);
+    if (worker != NULL && parser_sessions_add(worker, ts, true) != IPX_OK) {
+        IPX_CTX_WARNING(ctx, "Unable to block the Transport Session '%s' in other parser threads "
+            "due to memory allocation error.", ts->ident);
+    }
     ipx_fpipe_write(feedback, ipx_msg_session2base(session_msg));
     return IPX_OK;
 }
@@ -240,12 +802,14 @@ parser_plugin_remove_session(ipx_ctx_t *ctx, ipx_parser_t *parser, const struct
  *
  * \param[in] ctx    Plugin context
  * \param[in] parser IPFIX Message parser
+ * \param[in] worker Parser thread of the parser (NULL in the single-threaded mode)
  * \param[in] ipfix  IPFIX Message
  * \return #IPX_OK on success or on non-fatal failure
  * \return #IPX_ERR_ARG on a fatal failure
  */
 static inline int
-parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_t *ipfix)
+parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, struct parser_worker *worker,
+    ipx_msg_ipfix_t *ipfix)
 {
     int rc;
     ipx_msg_garbage_t *garbage;
@@ -278,21 +842,243 @@ parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_
     }
 
     // Try to send request to close the Transport Session or remove it
-    rc = parser_plugin_remove_session(ctx, parser, msg_ctx->session);
+    rc = parser_plugin_remove_session(ctx, parser, worker, msg_ctx->session);
     ipx_msg_ipfix_destroy(ipfix); // Note: msg_ctx is not available anymore!
     return rc;
 }
 
+/**
+ * \brief Close a Transport Session in all parser threads
+ *
+ * Messages of the Transport Session (TS) can be processed by multiple threads (one per ODID),
+ * therefore, all threads must reach the close event before information about the TS is removed.
+ * Threads wait at a barrier and the last one removes the TS from parsers of all threads and
+ * passes the TS Message followed by garbage messages.
+ * \param[in] worker      Parser thread
+ * \param[in] msg_session Transport Session message (close event)
+ */
+static void
+parser_worker_session_close(struct parser_worker *worker, ipx_msg_session_t *msg_session)
+{
+    struct parser_plugin *plugin = worker->plugin;
+    ipx_ctx_t *ctx = plugin->ctx;
+
+    pthread_mutex_lock(&plugin->barrier.mutex);
+    if (++plugin->barrier.waiting < plugin->workers_cnt) {
+        // Wait until the last thread closes the session
+        const uint64_t generation = plugin->barrier.generation;
+        while (generation == plugin->barrier.generation) {
+            pthread_cond_wait(&plugin->barrier.cond, &plugin->barrier.mutex);
+        }
+        pthread_mutex_unlock(&plugin->barrier.mutex);
+        return;
+    }
+
+    // The last thread, all other threads are waiting -> their parsers can be modified
+    const struct ipx_session *session = ipx_msg_session_get_session(msg_session);
+    ipx_msg_garbage_t *garbage[PARSER_THREADS_MAX];
+    bool found = false;
+
+    for (unsigned int i = 0; i < plugin->workers_cnt; ++i) {
+        garbage[i] = NULL;
+        int rc = ipx_parser_session_remove(plugin->workers[i].parser, session, &garbage[i]);
+        switch (rc) {
+        case IPX_OK:
+            found = true;
+            if (garbage[i] == NULL) {
+                IPX_CTX_WARNING(ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+            }
+            break;
+        case IPX_ERR_NOTFOUND:
+            garbage[i] = NULL;
+            break;
+        default:
+            IPX_CTX_ERROR(ctx, "ipx_parser_session_remove() returned an unexpected value (%s:%d, "
+                "code: %d).", __FILE__, __LINE__, rc);
+            garbage[i] = NULL;
+            break;
+        }
+    }
+
+    if (!found) {
+        IPX_CTX_ERROR(ctx, "Received an event about closing of unknown Transport Session '%s'.",
+            session->ident);
+    }
+
+    // The TS is not blocked anymore (a new one can get the same address)
+    parser_sessions_forget(plugin, session);
+
+    // Garbage MUST be send after the Transport Session Message (see process_session() above)
+    ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg_session));
+    for (unsigned int i = 0; i < plugin->workers_cnt; ++i) {
+        if (garbage[i] != NULL) {
+            ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage[i]));
+        }
+    }
+
+    // Release other threads
+    plugin->barrier.waiting = 0;
+    plugin->barrier.generation++;
+    pthread_cond_broadcast(&plugin->barrier.cond);
+    pthread_mutex_unlock(&plugin->barrier.mutex);
+}
+
+/**
+ * \brief Parser thread
+ *
+ * Process IPFIX Messages of assigned Transport Sessions and ODIDs. Messages broadcasted to all
+ * threads (garbage, periodic and close events of Transport Sessions) are passed only by the
+ * last thread that processes them, so they never overtake related IPFIX Messages.
+ * \param[in] arg Parser thread (struct parser_worker)
+ * \return Always NULL
+ */
+static void *
+parser_worker_thread(void *arg)
+{
+    struct parser_worker *worker = (struct parser_worker *) arg;
+    struct parser_plugin *plugin = worker->plugin;
+    ipx_ctx_t *ctx = plugin->ctx;
+    const ipx_msg_t *stop = ipx_msg_terminate2base(plugin->workers_stop);
+
+    ipx_msg_t *msgs[PARSER_BATCH_SIZE];
+    bool terminate = false;
+
+    while (!terminate) {
+        uint32_t msg_cnt = ipx_ring_pop_n(worker->ring, msgs, PARSER_BATCH_SIZE);
+
+        for (uint32_t idx = 0; idx < msg_cnt; ++idx) {
+            ipx_msg_t *msg = msgs[idx];
+            if (msg == stop) {
+                // The request to stop is always the last message
+                terminate = true;
+                break;
+            }
+
+            switch (ipx_msg_get_type(msg)) {
+            case IPX_MSG_IPFIX: {
+                ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
+                if (parser_sessions_apply(plugin, worker, ipx_msg_ipfix_get_ctx(ipfix)->session)) {
+                    // The Transport Session has been blocked by another thread
+                    ipx_msg_ipfix_destroy(ipfix);
+                    break;
+                }
+                if (parser_plugin_process_ipfix(ctx, worker->parser, worker, ipfix) != IPX_OK) {
+                    __atomic_store_n(&plugin->workers_failed, true, __ATOMIC_RELAXED);
+                }
+                break;
+            }
+            case IPX_MSG_SESSION:
+                parser_worker_session_close(worker, ipx_msg_base2session(msg));
+                break;
+            default:
+                // Broadcasted message, pass it only if this is the last reference
+                if (ipx_msg_header_cnt_dec(msg)) {
+                    ipx_ctx_msg_pass(ctx, msg);
+                }
+                break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Get a parser thread of an IPFIX Message
+ *
+ * All messages of the same Transport Session and ODID are always processed by the same thread.
+ * \param[in] plugin  Instance of the parser plugin
+ * \param[in] msg_ctx Message context of the IPFIX Message
+ * \return Parser thread
+ */
+static inline struct parser_worker *
+parser_worker_get(struct parser_plugin *plugin, const struct ipx_msg_ctx *msg_ctx)
+{
+    return &plugin->workers[ipx_msg_ctx_hash(msg_ctx) % plugin->workers_cnt];
+}
+
+/**
+ * \brief Send a message to all parser threads
+ *
+ * The message is passed to the successor by the thread that releases the last reference.
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] msg    Message to broadcast
+ */
+static void
+parser_workers_broadcast(struct parser_plugin *plugin, ipx_msg_t *msg)
+{
+    ipx_msg_header_cnt_set(msg, plugin->workers_cnt);
+    for (unsigned int i = 0; i < plugin->workers_cnt; ++i) {
+        ipx_ring_push(plugin->workers[i].ring, msg);
+    }
+}
+
+/**
+ * \brief Dispatch a message to parser threads
+ * \param[in] plugin Instance of the parser plugin
+ * \param[in] msg    Message to dispatch
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if any parser thread has failed
+ */
+static int
+parser_workers_dispatch(struct parser_plugin *plugin, ipx_msg_t *msg)
+{
+    if (__atomic_load_n(&plugin->workers_failed, __ATOMIC_RELAXED)) {
+        ipx_msg_destroy(msg);
+        return IPX_ERR_DENIED;
+    }
+
+    switch (ipx_msg_get_type(msg)) {
+    case IPX_MSG_IPFIX: {
+        ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
+        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(ipfix);
+        if (parser_sessions_apply(plugin, NULL, msg_ctx->session)) {
+            // The Transport Session has been blocked, there is no need to bother the threads
+            ipx_msg_ipfix_destroy(ipfix);
+            break;
+        }
+        struct parser_worker *worker = parser_worker_get(plugin, msg_ctx);
+        ipx_ring_push(worker->ring, msg);
+        break;
+    }
+    case IPX_MSG_SESSION:
+        if (ipx_msg_session_get_event(ipx_msg_base2session(msg)) != IPX_MSG_SESSION_CLOSE) {
+            // Nothing refers to the new session yet -> it's safe to pass it immediately
+            ipx_ctx_msg_pass(plugin->ctx, msg);
+            break;
+        }
+        parser_workers_broadcast(plugin, msg);
+        break;
+    case IPX_MSG_GARBAGE:
+    case IPX_MSG_PERIODIC:
+        parser_workers_broadcast(plugin, msg);
+        break;
+    default:
+        // Unexpected type of the message
+        IPX_CTX_WARNING(plugin->ctx, "Received unexpected type of internal message. Skipping...",
+            '\0');
+        ipx_ctx_msg_pass(plugin->ctx, msg);
+        break;
+    }
+
+    return IPX_OK;
+}
+
 int
 ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     int rc;
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    struct parser_plugin *plugin = (struct parser_plugin *) cfg;
+    ipx_parser_t *parser = plugin->parser;
+
+    if (plugin->workers_cnt > 0) {
+        return parser_workers_dispatch(plugin, msg);
+    }
 
     switch (ipx_msg_get_type(msg)) {
     case IPX_MSG_IPFIX:
         // Process IPFIX Message
-        rc = parser_plugin_process_ipfix(ctx, parser, ipx_msg_base2ipfix(msg));
+        rc = parser_plugin_process_ipfix(ctx, parser, NULL, ipx_msg_base2ipfix(msg));
         break;
     case IPX_MSG_SESSION:
         // Process Transport Session
@@ -49,8 +49,19 @@ extern const struct ipx_plugin_info ipx_plugin_parser_info;
 
 /**
  * \brief Initialize an IPFIX parser
+ *
+ * By default, all messages are parsed by the instance thread. If the parameters define more
+ * than one parser thread, IPFIX Messages are dispatched to the threads based on their Transport
+ * Session and ODID (i.e. the order of messages of each Transport Session and ODID is preserved).
+ * \verbatim
+ *   <params>
+ *     <threads>...</threads>   <!-- Number of parser threads (default: 1) -->
+ *     <ringSize>...</ringSize> <!-- Size of ring buffers of the threads (optional) -->
+ *     <ringType>...</ringType> <!-- locked/lockfree (optional) -->
+ *   </params>
+ * \endverbatim
  * \param[in] ctx    Plugin context
- * \param[in] params Ignored (should be NULL)
+ * \param[in] params XML parameters (can be NULL)
  * \return #IPX_OK on success
  * \return #IPX_ERR_DENIED in case of a fatal error
  */
@@ -68,9 +79,12 @@ ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg);
 
 /**
  * \brief Process an IPFIX or a Transport Session Message
+ *
+ * In the multi-threaded mode, the message is only dispatched to a parser thread. Garbage and
+ * periodic messages are also processed to preserve their order with respect to parsed messages.
  * \param[in] ctx Plugin context
  * \param[in] cfg Private instance data
- * \param[in] msg IPFIX or Transport Session Message to process
+ * \param[in] msg Message to process
  * \return #IPX_OK on success
  * \return #IPX_ERR_DENIED in case of a fatal error
  */
@@ -44,25 +44,14 @@
 #include <pthread.h>
 #include <time.h>
 
-#include "ring.h"
-#include "verbose.h"
-
-
-// START TODO: move into header files
 #include <stdalign.h>
 #include <assert.h>
 #include <inttypes.h>
 
-#ifndef IPX_CLINE_SIZE
-/** Expected CPU cache-line size        */
-#define IPX_CLINE_SIZE 64
-#endif
-
-/** User specific cache-line alignment  */
-#define __ipx_aligned(x) __attribute__((__aligned__(x)))
-/** Cache-line alignment                */
-#define __ipx_cache_aligned __ipx_aligned(IPX_CLINE_SIZE)
-// END
+#include "ring.h"
+#include "ring_lockfree.h"
+#include "utils.h"
+#include "verbose.h"
 
 /** Internal identification of the ring buffer */
 static const char *module = "Ring buffer";
@@ -135,6 +124,14 @@ struct ring_writer {
      * \note After writing at least this amount of data, update synchronization structure.
      */
     uint32_t div_block;
+
+    /**
+     * \brief Total time spent by writers waiting for empty space (in nanoseconds)
+     * \warning This value can be read by ipx_ring_stats_get()! Modification MUST be atomic.
+     */
+    uint64_t stall_time;
+    /** \brief Number of times a writer had to wait for empty space (atomic access only) */
+    uint64_t stall_cnt;
 };
 
 /** \brief Exchange data structure for reader and writers */
@@ -174,19 +171,55 @@ struct ipx_ring {
     bool               mw_mode;
     /** Ring data (array of pointers)                   */
     ipx_msg_t        **data;
+    /**
+     * Lock-free implementation (only if ::IPX_RING_TYPE_LOCKFREE is used)
+     * \note If defined, all operations are delegated to it and other members are not used.
+     */
+    ipx_ring_lf_t     *lf;
 };
 
+/**
+ * \brief Create a ring buffer with lock-free implementation
+ * \param[in] size    Size of the ring buffer
+ * \param[in] mw_mode Multi-writer mode
+ * \return A pointer to the buffer or NULL (in case of an error).
+ */
+static ipx_ring_t *
+ipx_ring_init_lockfree(uint32_t size, bool mw_mode)
+{
+    ipx_ring_t *ring = aligned_alloc(alignof(struct ipx_ring), sizeof(struct ipx_ring));
+    if (!ring) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    ring->lf = ipx_ring_lf_init(size, mw_mode);
+    if (!ring->lf) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->data = NULL;
+    ring->mw_mode = mw_mode;
+    return ring;
+}
+
 ipx_ring_t *
-ipx_ring_init(uint32_t size, bool mw_mode)
+ipx_ring_init(uint32_t size, bool mw_mode, enum ipx_ring_type type)
 {
     ipx_ring_t *ring;
 
+    if (type == IPX_RING_TYPE_LOCKFREE) {
+        return ipx_ring_init_lockfree(size, mw_mode);
+    }
+
     // Prepare data structures
     ring = aligned_alloc(alignof(struct ipx_ring), sizeof(struct ipx_ring));
     if (!ring) {
         IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
         return NULL;
     }
+    ring->lf = NULL;
 
     ring->data = aligned_alloc(alignof(*ring->data), sizeof(*ring->data) * size);
     if (!ring->data) {
@@ -246,6 +279,8 @@ ipx_ring_init(uint32_t size, bool mw_mode)
     ring->writer.exchange_idx = size; // Amount of empty memory
     ring->writer.write_idx = 0;
     ring->writer.write_commit_idx = 0;
+    ring->writer.stall_time = 0;
+    ring->writer.stall_cnt = 0;
 
     ring->sync.read_idx = 0;
     ring->sync.write_idx = size;
@@ -272,6 +307,12 @@ exit_A:
 void
 ipx_ring_destroy(ipx_ring_t *ring)
 {
+    if (ring->lf != NULL) {
+        ipx_ring_lf_destroy(ring->lf);
+        free(ring);
+        return;
+    }
+
     // The last read message is not confirmed by the reader, it is 1 index behind -> "+ 1"
     if (ring->reader.read_idx + 1 != ring->writer.write_idx) {
         uint32_t cnt = ring->writer.write_idx - ring->reader.read_idx + 1;
@@ -308,6 +349,23 @@ ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mut
     return pthread_cond_timedwait(cond, mutex, &ts);
 }
 
+/**
+ * \brief Add a writer stall to the statistics
+ * \param[in] time  Total stall time (in nanoseconds)
+ * \param[in] cnt   Total number of stalls
+ * \param[in] start Start of the stall
+ * \param[in] end   End of the stall
+ */
+static inline void
+ring_stall_add(uint64_t *time, uint64_t *cnt, const struct timespec *start,
+    const struct timespec *end)
+{
+    int64_t diff = (int64_t) (end->tv_sec - start->tv_sec) * 1000000000LL
+        + (end->tv_nsec - start->tv_nsec);
+    __atomic_fetch_add(time, (uint64_t) ((diff > 0) ? diff : 0), __ATOMIC_RELAXED);
+    __atomic_fetch_add(cnt, 1, __ATOMIC_RELAXED);
+}
+
 /**
  * \brief Get a new empty field
  *
@@ -331,11 +389,20 @@ ipx_ring_begin(ipx_ring_t *ring)
     // Get an empty space -> reader-writer synchronization
     pthread_mutex_lock(&ring->sync.mutex);
     ring->writer.exchange_idx = ring->sync.write_idx;
-    while (ring->writer.exchange_idx - ring->writer.write_idx == 0) {
-        // After sync the buffer is still full, try again later
-        pthread_cond_signal(&ring->sync.cond_reader);
-        ring_cond_timedwait(&ring->sync.cond_writer, &ring->sync.mutex, 10);
-        ring->writer.exchange_idx = ring->sync.write_idx;
+    if (ring->writer.exchange_idx - ring->writer.write_idx == 0) {
+        // The buffer is still full -> the writer is stalled
+        struct timespec ts_start, ts_end;
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+        do {
+            // After sync the buffer is still full, try again later
+            pthread_cond_signal(&ring->sync.cond_reader);
+            ring_cond_timedwait(&ring->sync.cond_writer, &ring->sync.mutex, 10);
+            ring->writer.exchange_idx = ring->sync.write_idx;
+        } while (ring->writer.exchange_idx - ring->writer.write_idx == 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ring_stall_add(&ring->writer.stall_time, &ring->writer.stall_cnt, &ts_start, &ts_end);
     }
     pthread_cond_signal(&ring->sync.cond_reader);
     pthread_mutex_unlock(&ring->sync.mutex);
@@ -378,6 +445,11 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
 {
     ipx_msg_t **msg_space;
 
+    if (ring->lf != NULL) {
+        ipx_ring_lf_push_n(ring->lf, &msg, 1);
+        return;
+    }
+
     if (ring->mw_mode) {
         pthread_spin_lock(&ring->writer_lock);
     }
@@ -391,13 +463,46 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
     }
 }
 
+void
+ipx_ring_push_n(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    ipx_msg_t **msg_space;
+
+    if (ring->lf != NULL) {
+        ipx_ring_lf_push_n(ring->lf, msgs, cnt);
+        return;
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        msg_space = ipx_ring_begin(ring);
+        *msg_space = msgs[i];
+        ipx_ring_commit(ring);
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+}
+
 
 ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring)
 {
+    if (ring->lf != NULL) {
+        ipx_msg_t *msg;
+        ipx_ring_lf_pop_n(ring->lf, &msg, 1);
+        return msg;
+    }
+
     // Consider previous memory block as processed
     ring->reader.data_idx += ring->reader.last;
-    ring->reader.read_idx += ring->reader.last;
+    // Atomic store, the index can be read by ipx_ring_stats_get()
+    __atomic_store_n(&ring->reader.read_idx, ring->reader.read_idx + ring->reader.last,
+        __ATOMIC_RELAXED);
     ring->reader.last = 0;
 
     if (ring->reader.size == ring->reader.data_idx) {
@@ -453,8 +558,83 @@ ipx_ring_pop(ipx_ring_t *ring)
     }
 }
 
+/**
+ * \brief Try to get a message that is already owned by the reader (non-blocking)
+ *
+ * Unlike ipx_ring_pop(), the function doesn't synchronize with writers. It only returns
+ * messages that has been already synchronized by the previous calls.
+ * \param[in] ring Ring buffer
+ * \return Pointer to the message or NULL (no message is available without synchronization)
+ */
+static inline ipx_msg_t *
+ipx_ring_try_pop(ipx_ring_t *ring)
+{
+    if (ring->reader.exchange_idx - (ring->reader.read_idx + ring->reader.last) == 0) {
+        return NULL;
+    }
+
+    // Consider previous memory block as processed
+    ring->reader.data_idx += ring->reader.last;
+    // Atomic store, the index can be read by ipx_ring_stats_get()
+    __atomic_store_n(&ring->reader.read_idx, ring->reader.read_idx + ring->reader.last,
+        __ATOMIC_RELAXED);
+    ring->reader.last = 1;
+
+    if (ring->reader.size == ring->reader.data_idx) {
+        // The end of the ring buffer has been reached -> skip to the beginning
+        ring->reader.data_idx = 0;
+    }
+
+    return ring->data[ring->reader.data_idx];
+}
+
+uint32_t
+ipx_ring_pop_n(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    uint32_t idx;
+
+    if (ring->lf != NULL) {
+        return ipx_ring_lf_pop_n(ring->lf, msgs, cnt);
+    }
+
+    // Wait for the first message, the rest is optional
+    assert(cnt > 0);
+    msgs[0] = ipx_ring_pop(ring);
+    for (idx = 1; idx < cnt; ++idx) {
+        ipx_msg_t *msg = ipx_ring_try_pop(ring);
+        if (!msg) {
+            break;
+        }
+        msgs[idx] = msg;
+    }
+
+    return idx;
+}
+
 void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode)
 {
+    if (ring->lf != NULL) {
+        ipx_ring_lf_mw_mode(ring->lf, mode);
+    }
     ring->mw_mode = mode;
-}
\ No newline at end of file
+}
+
+void
+ipx_ring_stats_get(ipx_ring_t *ring, struct ipx_ring_stats *stats)
+{
+    if (ring->lf != NULL) {
+        ipx_ring_lf_stats_get(ring->lf, stats);
+        return;
+    }
+
+    // Note: the reader index is updated after processing, i.e. the fill is just an estimation
+    uint32_t write_idx = __atomic_load_n(&ring->writer.write_idx, __ATOMIC_RELAXED);
+    uint32_t read_idx = __atomic_load_n(&ring->reader.read_idx, __ATOMIC_RELAXED);
+    int32_t fill = (int32_t) (write_idx - read_idx);
+
+    stats->size = ring->writer.size;
+    stats->fill = (fill < 0) ? 0 : (uint32_t) fill;
+    stats->stall_time = __atomic_load_n(&ring->writer.stall_time, __ATOMIC_RELAXED);
+    stats->stall_cnt = __atomic_load_n(&ring->writer.stall_cnt, __ATOMIC_RELAXED);
+}
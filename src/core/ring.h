@@ -65,6 +65,21 @@ extern "C" {
 /** Internal ring buffer type  */
 typedef struct ipx_ring ipx_ring_t;
 
+/** Implementation of the ring buffer */
+enum ipx_ring_type {
+    /**
+     * Ring buffer synchronized by a mutex and condition variables. In multi-writer mode,
+     * writers are serialized by a spin lock.
+     */
+    IPX_RING_TYPE_LOCKED = 0,
+    /**
+     * Lock-free ring buffer based on atomic operations. Writers reserve slots independently and
+     * threads sleep (using a futex, if available) only when the buffer is empty or full.
+     * \note The size of the buffer is rounded up to the nearest power of two.
+     */
+    IPX_RING_TYPE_LOCKFREE
+};
+
 /**
  * \brief Create a new ring buffer
  *
@@ -74,10 +89,11 @@ typedef struct ipx_ring ipx_ring_t;
  *   necessary.
  * \param[in] size    Size of the ring buffer (number of pointers)
  * \param[in] mw_mode Multi-writer mode (multiple writers can writer into the buffer)
+ * \param[in] type    Implementation of the ring buffer
  * \return A pointer to the buffer or NULL (in case of an error).
  */
 IPX_API ipx_ring_t *
-ipx_ring_init(uint32_t size, bool mw_mode);
+ipx_ring_init(uint32_t size, bool mw_mode, enum ipx_ring_type type);
 
 /**
  * \brief A ring buffer to destroy
@@ -99,6 +115,22 @@ ipx_ring_destroy(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 
+/**
+ * \brief Add multiple messages into the ring buffer
+ *
+ * The messages are added in the same order as they are stored in the array. In comparison with
+ * multiple calls of ipx_ring_push(), synchronization overhead is paid only once per batch.
+ * Messages from one batch are not interleaved with messages of other writers, if the
+ * ::IPX_RING_TYPE_LOCKED is used. The lock-free ring buffer only preserves the order of
+ * messages from the same writer.
+ * \note The function blocks until all messages are added.
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added
+ * \param[in] cnt  Number of messages in the array
+ */
+IPX_API void
+ipx_ring_push_n(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt);
+
 /**
  * \brief Get a message from the ring buffer
  *
@@ -110,6 +142,20 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 IPX_API ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring);
 
+/**
+ * \brief Get multiple messages from the ring buffer
+ *
+ * The function blocks until at least one message is ready. After that, it takes all
+ * immediately available messages up to the maximum \p cnt without waiting for more.
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array to be filled with messages
+ * \param[in]  cnt  Maximum number of messages to get (i.e. size of the array, non-zero)
+ * \return Number of messages stored into the array (always at least 1)
+ */
+IPX_API uint32_t
+ipx_ring_pop_n(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt);
+
 /**
  * \brief Change (i.e. disable/enable) multi-writer mode
  *
@@ -122,6 +168,29 @@ ipx_ring_pop(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode);
 
+/** Runtime statistics of the ring buffer */
+struct ipx_ring_stats {
+    /** Size of the ring buffer (number of pointers)                                    */
+    uint32_t size;
+    /** Number of messages waiting for the reader (an estimation)                       */
+    uint32_t fill;
+    /** Total time spent by writers waiting for empty space (in nanoseconds)            */
+    uint64_t stall_time;
+    /** Number of times a writer had to wait for empty space                            */
+    uint64_t stall_cnt;
+};
+
+/**
+ * \brief Get runtime statistics of the ring buffer
+ *
+ * The function can be called by any thread at any time. However, values are not read
+ * atomically as a whole, therefore, they don't have to be mutually consistent.
+ * \param[in]  ring  Ring buffer
+ * \param[out] stats Statistics to fill
+ */
+IPX_API void
+ipx_ring_stats_get(ipx_ring_t *ring, struct ipx_ring_stats *stats);
+
 /**
  * @}
  */
@@ -0,0 +1,385 @@
+/**
+ * \file src/core/ring_lockfree.c
+ * \brief Lock-free ring buffer for messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdalign.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "ring_lockfree.h"
+#include "utils.h"
+#include "verbose.h"
+
+/** Internal identification of the ring buffer */
+static const char *module = "Ring buffer (lock-free)";
+
+/** Number of busy-wait iterations before a thread goes to sleep      */
+#define RING_LF_SPIN_CNT     (256U)
+/** Maximum sleep time (in milliseconds) before the state is checked  */
+#define RING_LF_SLEEP_MSEC   (10L)
+
+/** \brief Slot of the ring buffer */
+struct ring_lf_slot {
+    /**
+     * \brief Sequence number of the slot
+     *
+     * If the value is equal to the position of a writer, the slot is empty and ready for the
+     * writer. If the value is equal to the position of the reader + 1, the slot is filled and
+     * ready for the reader.
+     * \note Value range [0..UINT32_MAX]. Overflow is expected behavior.
+     */
+    uint32_t seq;
+    /** Stored message */
+    ipx_msg_t *msg;
+};
+
+/** \brief Sleeping (futex) structure */
+struct ring_lf_waiter {
+    /** Event counter (incremented before each wake-up)                        */
+    uint32_t event;
+    /** Flag indicating that at least one thread is (going to be) sleeping     */
+    uint32_t waiting;
+};
+
+/** \brief Lock-free ring buffer */
+struct ipx_ring_lf {
+    /** Reader head (start of the next read operation, only the reader modifies it)        */
+    uint32_t head             __ipx_cache_aligned;
+    /** Writer head (start of the next write operation, shared by all writers)             */
+    uint32_t tail             __ipx_cache_aligned;
+    /** Reader sleeping structure (empty buffer)                                           */
+    struct ring_lf_waiter rd  __ipx_cache_aligned;
+    /** Writers sleeping structure (full buffer)                                           */
+    struct ring_lf_waiter wr  __ipx_cache_aligned;
+
+    /** Size of the ring buffer (power of two)                                             */
+    uint32_t size             __ipx_cache_aligned;
+    /** Index mask (i.e. size - 1)                                                         */
+    uint32_t mask;
+    /** Number of busy-wait iterations before sleeping (zero on single CPU systems)       */
+    uint32_t spin_cnt;
+    /** Multiple writers mode                                                              */
+    bool mw_mode;
+    /** Total time spent by writers waiting for empty space (in nanoseconds, atomic access)  */
+    uint64_t stall_time;
+    /** Number of times a writer had to wait for empty space (atomic access)               */
+    uint64_t stall_cnt;
+    /** Ring data (array of slots)                                                         */
+    struct ring_lf_slot *data;
+};
+
+/**
+ * \brief Round up to the nearest power of two
+ * \param[in] value Value (must be non-zero and less than or equal to 2^31)
+ * \return Result
+ */
+static inline uint32_t
+ring_lf_pow2(uint32_t value)
+{
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * \brief Hint the CPU that the thread is busy-waiting
+ */
+static inline void
+ring_lf_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * \brief Sleep until the event counter changes (or a timeout expires)
+ *
+ * On platforms without futex support the thread simply yields the processor for a while.
+ * \param[in] addr  Event counter
+ * \param[in] value Expected value of the counter (if different, return immediately)
+ */
+static inline void
+ring_lf_futex_wait(uint32_t *addr, uint32_t value)
+{
+#if defined(__linux__)
+    struct timespec ts = {0, RING_LF_SLEEP_MSEC * 1000000L};
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, &ts, NULL, 0);
+#else
+    (void) addr;
+    (void) value;
+    struct timespec ts = {0, 50000L}; // 50 microseconds
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/**
+ * \brief Wake up threads sleeping on the event counter
+ * \param[in] addr Event counter
+ * \param[in] cnt  Maximum number of threads to wake up
+ */
+static inline void
+ring_lf_futex_wake(uint32_t *addr, int cnt)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, cnt, NULL, NULL, 0);
+#else
+    (void) addr;
+    (void) cnt;
+#endif
+}
+
+/**
+ * \brief Wait until a slot reaches the required sequence number
+ *
+ * First, the thread performs busy waiting. If the slot is still not ready, the thread sets
+ * the waiting flag and goes to sleep until the other side sends a notification. The flag is
+ * cleared only by the notifying side, therefore, multiple threads can wait at the same time.
+ * \param[in] slot     Slot of the ring buffer
+ * \param[in] seq      Required sequence number
+ * \param[in] waiter   Sleeping structure of this side of the buffer
+ * \param[in] spin_cnt Number of busy-wait iterations
+ */
+static void
+ring_lf_wait(struct ring_lf_slot *slot, uint32_t seq, struct ring_lf_waiter *waiter,
+    uint32_t spin_cnt)
+{
+    for (uint32_t i = 0; i < spin_cnt; ++i) {
+        if ((int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - seq) >= 0) {
+            return;
+        }
+        ring_lf_relax();
+    }
+
+    while (1) {
+        uint32_t event = __atomic_load_n(&waiter->event, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&waiter->waiting, 1, __ATOMIC_SEQ_CST);
+        // The other side might have published the slot before it noticed the flag
+        if ((int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST) - seq) >= 0) {
+            return;
+        }
+
+        ring_lf_futex_wait(&waiter->event, event);
+        if ((int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - seq) >= 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Wake up sleeping threads of the other side of the buffer (if any)
+ * \param[in] waiter Sleeping structure of the other side
+ * \param[in] cnt    Maximum number of threads to wake up
+ */
+static inline void
+ring_lf_notify(struct ring_lf_waiter *waiter, int cnt)
+{
+    // Make sure that published slots are visible before checking the waiters
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&waiter->waiting, __ATOMIC_RELAXED) == 0
+            || __atomic_exchange_n(&waiter->waiting, 0, __ATOMIC_ACQ_REL) == 0) {
+        return;
+    }
+
+    __atomic_fetch_add(&waiter->event, 1, __ATOMIC_RELEASE);
+    ring_lf_futex_wake(&waiter->event, cnt);
+}
+
+ipx_ring_lf_t *
+ipx_ring_lf_init(uint32_t size, bool mw_mode)
+{
+    ipx_ring_lf_t *ring;
+
+    if (size == 0 || size > (UINT32_C(1) << 31)) {
+        IPX_ERROR(module, "Invalid size of the ring buffer (%" PRIu32 ")!", size);
+        return NULL;
+    }
+
+    ring = aligned_alloc(alignof(struct ipx_ring_lf), sizeof(struct ipx_ring_lf));
+    if (!ring) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    ring->size = ring_lf_pow2(size);
+    ring->mask = ring->size - 1;
+    ring->data = aligned_alloc(IPX_CLINE_SIZE, sizeof(*ring->data) * ring->size);
+    if (!ring->data) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        free(ring);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < ring->size; ++i) {
+        ring->data[i].seq = i;
+        ring->data[i].msg = NULL;
+    }
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->rd.event = 0;
+    ring->rd.waiting = 0;
+    ring->wr.event = 0;
+    ring->wr.waiting = 0;
+    // Busy waiting makes sense only if the other side can run in parallel
+    ring->spin_cnt = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? RING_LF_SPIN_CNT : 0;
+    ring->mw_mode = mw_mode;
+    ring->stall_time = 0;
+    ring->stall_cnt = 0;
+    return ring;
+}
+
+void
+ipx_ring_lf_destroy(ipx_ring_lf_t *ring)
+{
+    uint32_t cnt = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - ring->head;
+    if (cnt != 0) {
+        IPX_WARNING(module, "Destroying of a ring buffer that still contains %" PRIu32
+            " unprocessed message(s)!", cnt);
+    }
+
+    free(ring->data);
+    free(ring);
+}
+
+void
+ipx_ring_lf_push_n(ipx_ring_lf_t *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    uint32_t pos;
+
+    if (cnt == 0) {
+        return;
+    }
+
+    // Reserve space for all messages at once
+    if (ring->mw_mode) {
+        pos = __atomic_fetch_add(&ring->tail, cnt, __ATOMIC_RELAXED);
+    } else {
+        pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        __atomic_store_n(&ring->tail, pos + cnt, __ATOMIC_RELAXED);
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i, ++pos) {
+        struct ring_lf_slot *slot = &ring->data[pos & ring->mask];
+        if ((int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos) < 0) {
+            // The buffer is full -> let the reader know about already published messages
+            struct timespec ts_start, ts_end;
+            clock_gettime(CLOCK_MONOTONIC, &ts_start);
+            ring_lf_notify(&ring->rd, 1);
+            ring_lf_wait(slot, pos, &ring->wr, ring->spin_cnt);
+            clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+            int64_t diff = (int64_t) (ts_end.tv_sec - ts_start.tv_sec) * 1000000000LL
+                + (ts_end.tv_nsec - ts_start.tv_nsec);
+            __atomic_fetch_add(&ring->stall_time, (uint64_t) ((diff > 0) ? diff : 0),
+                __ATOMIC_RELAXED);
+            __atomic_fetch_add(&ring->stall_cnt, 1, __ATOMIC_RELAXED);
+        }
+
+        slot->msg = msgs[i];
+        __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    }
+
+    ring_lf_notify(&ring->rd, 1);
+}
+
+uint32_t
+ipx_ring_lf_pop_n(ipx_ring_lf_t *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    uint32_t pos = ring->head;
+    struct ring_lf_slot *slot = &ring->data[pos & ring->mask];
+    uint32_t idx = 0;
+
+    assert(cnt > 0);
+    if ((int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - (pos + 1)) < 0) {
+        // The buffer is empty -> wait for a writer
+        ring_lf_wait(slot, pos + 1, &ring->rd, ring->spin_cnt);
+    }
+
+    do {
+        msgs[idx++] = slot->msg;
+        // Release the slot for the writer in the next round
+        __atomic_store_n(&slot->seq, pos + ring->size, __ATOMIC_RELEASE);
+        slot = &ring->data[(++pos) & ring->mask];
+    } while (idx < cnt
+        && __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1);
+
+    // Atomic store, the head can be read by ipx_ring_lf_stats_get()
+    __atomic_store_n(&ring->head, pos, __ATOMIC_RELAXED);
+    ring_lf_notify(&ring->wr, INT_MAX);
+    return idx;
+}
+
+void
+ipx_ring_lf_mw_mode(ipx_ring_lf_t *ring, bool mode)
+{
+    ring->mw_mode = mode;
+}
+
+void
+ipx_ring_lf_stats_get(ipx_ring_lf_t *ring, struct ipx_ring_stats *stats)
+{
+    // Note: the tail also includes slots reserved by writers waiting for empty space
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    int32_t fill = (int32_t) (tail - head);
+
+    stats->size = ring->size;
+    if (fill < 0) {
+        stats->fill = 0;
+    } else {
+        stats->fill = ((uint32_t) fill > ring->size) ? ring->size : (uint32_t) fill;
+    }
+    stats->stall_time = __atomic_load_n(&ring->stall_time, __ATOMIC_RELAXED);
+    stats->stall_cnt = __atomic_load_n(&ring->stall_cnt, __ATOMIC_RELAXED);
+}
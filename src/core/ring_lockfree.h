@@ -0,0 +1,114 @@
+/**
+ * \file src/core/ring_lockfree.h
+ * \brief Lock-free ring buffer for messages (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_RING_LOCKFREE_H
+#define IPX_RING_LOCKFREE_H
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ring.h"
+
+/**
+ * \brief Lock-free implementation of the ring buffer
+ *
+ * Multi Producer Single Consumer queue of fixed size. Each slot of the buffer holds a sequence
+ * number that determines whether the slot is ready for a writer or for the reader. Writers
+ * reserve slots by an atomic increment of the writer head (or by a simple store in the
+ * single-writer mode) and publish them independently. The reader consumes slots in order.
+ * A thread is put to sleep only if the buffer is empty (reader) or full (writers).
+ *
+ * \note This is an internal component used by the ring buffer interface (see ring.h).
+ */
+typedef struct ipx_ring_lf ipx_ring_lf_t;
+
+/**
+ * \brief Create a new lock-free ring buffer
+ * \param[in] size    Minimal size of the ring buffer (rounded up to the nearest power of two)
+ * \param[in] mw_mode Multi-writer mode
+ * \return A pointer to the buffer or NULL (in case of an error).
+ */
+ipx_ring_lf_t *
+ipx_ring_lf_init(uint32_t size, bool mw_mode);
+
+/**
+ * \brief Destroy a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ */
+void
+ipx_ring_lf_destroy(ipx_ring_lf_t *ring);
+
+/**
+ * \brief Add messages into the ring buffer (blocking)
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages
+ * \param[in] cnt  Number of messages
+ */
+void
+ipx_ring_lf_push_n(ipx_ring_lf_t *ring, ipx_msg_t **msgs, uint32_t cnt);
+
+/**
+ * \brief Get up to \p cnt messages from the ring buffer (blocks until at least one is ready)
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array to be filled
+ * \param[in]  cnt  Size of the array (non-zero)
+ * \return Number of messages stored into the array
+ */
+uint32_t
+ipx_ring_lf_pop_n(ipx_ring_lf_t *ring, ipx_msg_t **msgs, uint32_t cnt);
+
+/**
+ * \brief Change multi-writer mode
+ * \warning Nobody can push messages during this call.
+ * \param[in] ring Ring buffer
+ * \param[in] mode New mode
+ */
+void
+ipx_ring_lf_mw_mode(ipx_ring_lf_t *ring, bool mode);
+
+/**
+ * \brief Get runtime statistics of the ring buffer
+ * \param[in]  ring  Ring buffer
+ * \param[out] stats Statistics to fill
+ */
+void
+ipx_ring_lf_stats_get(ipx_ring_lf_t *ring, struct ipx_ring_stats *stats);
+
+#endif // IPX_RING_LOCKFREE_H
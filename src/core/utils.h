@@ -47,6 +47,16 @@ extern "C" {
 
 #include <ipfixcol2.h>
 
+#ifndef IPX_CLINE_SIZE
+/** Expected CPU cache-line size        */
+#define IPX_CLINE_SIZE 64
+#endif
+
+/** User specific cache-line alignment  */
+#define __ipx_aligned(x) __attribute__((__aligned__(x)))
+/** Cache-line alignment                */
+#define __ipx_cache_aligned __ipx_aligned(IPX_CLINE_SIZE)
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,12 +32,13 @@
 
 namespace tcp_in {
 
-Acceptor::Acceptor(ClientManager &clients, ipx_ctx_t *ctx) :
+Acceptor::Acceptor(std::vector<std::unique_ptr<ClientManager>> &clients, ipx_ctx_t *ctx) :
     m_epoll(),
     m_sockets(),
     m_pipe_in(),
     m_pipe_out(),
     m_clients(clients),
+    m_next_manager(0),
     m_thread(),
     m_ctx(ctx)
 {
@@ -230,11 +231,34 @@ void Acceptor::mainloop() {
         }
 
         try {
-            m_clients.add_connection(std::move(new_sd));
+            auto idx = select_manager();
+            m_clients[idx]->add_connection(std::move(new_sd));
+            if (m_clients.size() > 1) {
+                IPX_CTX_DEBUG(m_ctx, "Acceptor: The connection assigned to thread %zu.", idx);
+            }
         } catch (std::exception &ex) {
             IPX_CTX_ERROR(m_ctx, "Acceptor: %s", ex.what());
         }
     }
 }
 
+size_t Acceptor::select_manager() {
+    // least loaded manager, ties are broken in round-robin fashion
+    auto count = m_clients.size();
+    auto best = m_next_manager;
+    auto best_load = m_clients[best]->connection_count();
+
+    for (size_t i = 1; i < count && best_load != 0; ++i) {
+        auto idx = (m_next_manager + i) % count;
+        auto load = m_clients[idx]->connection_count();
+        if (load < best_load) {
+            best = idx;
+            best_load = load;
+        }
+    }
+
+    m_next_manager = (best + 1) % count;
+    return best;
+}
+
 } // namespace tcp_in
@@ -12,7 +12,9 @@
 
 #include <thread>  // std::thread
 #include <vector>  // std::vector
+#include <memory>  // std::unique_ptr
 #include <cstdint> // uint16_t
+#include <cstddef> // size_t
 
 #include <ipfixcol2.h> // ipx_ctx_t
 
@@ -31,11 +33,11 @@ public:
     /**
      * @brief Creates the acceptor thread.
      *
-     * @param clients Reference to client manager.
-     * @param config File configuration.
+     * @param clients Reference to client managers. New connections are assigned to the manager
+     * with the least number of connections.
      * @param ctx The plugin context.
      */
-    Acceptor(ClientManager &clients, ipx_ctx_t *ctx);
+    Acceptor(std::vector<std::unique_ptr<ClientManager>> &clients, ipx_ctx_t *ctx);
 
     // force that acceptor stays in its original memory (so that `this` pointer stays valid on the
     // other thread)
@@ -66,6 +68,9 @@ private:
     /** Runs on the other therad */
     void mainloop();
 
+    /** Selects the client manager for a new connection. */
+    size_t select_manager();
+
     /** File descriptor of epoll for accepting connections. */
     Epoll m_epoll;
     /** Sockets listened to by epoll. */
@@ -77,7 +82,9 @@ private:
     UniqueFd m_pipe_out;
 
     /** Accepted clients. */
-    ClientManager &m_clients;
+    std::vector<std::unique_ptr<ClientManager>> &m_clients;
+    /** Client manager to try first when selecting the manager for a new connection. */
+    size_t m_next_manager;
     std::thread m_thread;
     ipx_ctx_t *m_ctx;
 };
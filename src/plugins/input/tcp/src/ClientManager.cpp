@@ -34,6 +34,7 @@ ClientManager::ClientManager(ipx_ctx_t *ctx, DecoderFactory factory) :
     m_epoll(),
     m_mutex(),
     m_connections(),
+    m_close_requests(),
     m_factory(std::move(factory))
 {}
 
@@ -112,6 +113,40 @@ size_t ClientManager::wait_for_connections(Connection **connections, int max_con
     return events.size();
 }
 
+bool ClientManager::request_close(const ipx_session *session) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto &con : m_connections) {
+        if (con->get_session() == session) {
+            m_close_requests.push_back(session);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ClientManager::process_close_requests() {
+    std::vector<const ipx_session *> requests;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_close_requests.empty()) {
+            return;
+        }
+        requests.swap(m_close_requests);
+    }
+
+    for (auto session : requests) {
+        close_connection(session);
+    }
+}
+
+size_t ClientManager::connection_count() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_connections.size();
+}
+
 void ClientManager::close_all_connections() {
     std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -42,7 +42,7 @@ public:
 
     /**
      * @brief Removes connection from the vector based on its session. This is safe only for the
-     * main thread (not the acceptor thread).
+     * thread that processes the connections of this manager (not the acceptor thread).
      * @param ctx Context used for closing sessions.
      * @param session session of the connection to remove.
      */
@@ -58,6 +58,23 @@ public:
      */
     size_t wait_for_connections(Connection **connections, int max_connections);
 
+    /**
+     * @brief Requests closing of connection based on its session. The connection is closed by the
+     * thread that processes the connections of this manager (see `process_close_requests`).
+     * @param session session of the connection to close.
+     * @return true if the connection is managed by this manager, otherwise false.
+     */
+    bool request_close(const ipx_session *session);
+
+    /** Closes all connections requested by `request_close`. */
+    void process_close_requests();
+
+    /**
+     * @brief Gets the number of connections managed by this manager.
+     * @return Number of connections.
+     */
+    size_t connection_count();
+
     /** Closes all connections. */
     void close_all_connections();
 private:
@@ -68,6 +85,8 @@ private:
     Epoll m_epoll;
     std::mutex m_mutex;
     std::vector<std::unique_ptr<Connection>> m_connections;
+    /** Sessions of connections to close. */
+    std::vector<const ipx_session *> m_close_requests;
     DecoderFactory m_factory;
 };
 
@@ -30,12 +30,14 @@ namespace tcp_in {
  * <params>
  *  <localPort>...</localPort>                    <!-- optional -->
  *  <localIPAddress>...</localIPAddress>          <!-- optional, multiple times -->
+ *  <threads>...</threads>                        <!-- optional -->
  * </params>
  */
 
 enum ParamsXmlNodes {
     PARAM_PORT,
     PARAM_IPADDR,
+    PARAM_THREADS,
 };
 
 static const struct fds_xml_args args_params[] = {
@@ -43,10 +45,17 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(PARAM_PORT  , "localPort"     , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(PARAM_IPADDR, "localIPAddress", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT
                                                                    | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(PARAM_THREADS, "threads"      , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_END,
 };
 
-Config::Config(ipx_ctx *ctx, const char *params) : local_port(DEFAULT_PORT), local_addrs() {
+constexpr unsigned Config::THREADS_MAX;
+
+Config::Config(ipx_ctx *ctx, const char *params) :
+    local_port(DEFAULT_PORT),
+    local_addrs(),
+    threads(1)
+{
     std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
     if (!xml) {
         throw std::runtime_error("Failed to create XML parser.");
@@ -92,6 +101,16 @@ void Config::parse_params(ipx_ctx *ctx, fds_xml_ctx_t *params) {
                 empty_address = true;
             }
             break;
+        case PARAM_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > THREADS_MAX) {
+                throw std::invalid_argument(
+                    "Number of threads must be in range from 1 to " + std::to_string(THREADS_MAX)
+                        + " but it was " + std::to_string(content->val_uint)
+                );
+            }
+            threads = content->val_uint;
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <params>.");
         }
@@ -23,8 +23,13 @@ namespace tcp_in {
 
 /** TCP input plugin configuration */
 struct Config {
+    /** Maximum number of threads receiving data from connections. */
+    static constexpr unsigned THREADS_MAX = 64;
+
     uint16_t local_port;
     std::vector<IpAddress> local_addrs;
+    /** Number of threads receiving data from connections (including the instance thread). */
+    unsigned threads;
 
     /**
      * @brief Parse configuration of the TCP plugin
@@ -13,16 +13,19 @@
 #include <stdexcept> // runtime_error
 #include <string>    // string, to_string
 #include <cstdint>   // uint8_t
+#include <cstddef>   // offsetof
+#include <cstring>   // memcpy
 
 #include <sys/socket.h> // sockaddr_storage, socklen_t, getpeername, sockaddr, AF_INET, AF_INET6
 #include <netinet/in.h> // ntohs, sockaddr_in, sockaddr_in6, in_addr, IN6_IS_ADDR_V4MAPPED
 
 #include <ipfixcol2.h> // ipx_*, IPX_*, fds_ipfix_msg_hdr
 
-#include "UniqueFd.hpp"   // UniqueFd
-#include "Decoder.hpp"    // Decoder
-#include "Connection.hpp" // Connection
-#include "ByteVector.hpp" // ByteVector
+#include "UniqueFd.hpp"     // UniqueFd
+#include "Decoder.hpp"      // Decoder
+#include "Connection.hpp"   // Connection
+#include "DecodeBuffer.hpp" // DecodedMsg
+#include "Slab.hpp"         // Slab
 
 namespace tcp_in {
 
@@ -106,11 +109,11 @@ bool Connection::receive(ipx_ctx_t *ctx) {
     }
 
     auto &buffer = m_decoder->decode();
-    buffer.process_decoded([=](ByteVector &&msg) { send_msg(ctx, std::move(msg)); });
+    buffer.process_decoded([=](DecodedMsg &&msg) { send_msg(ctx, std::move(msg)); });
     return !buffer.is_eof_reached();
 }
 
-void Connection::send_msg(ipx_ctx_t *ctx, ByteVector &&msg) {
+void Connection::send_msg(ipx_ctx_t *ctx, DecodedMsg &&msg) {
     if (m_new_connnection) {
         // Send information about new transform session
         ipx_msg_session_t *session = ipx_msg_session_create(m_session, IPX_MSG_SESSION_OPEN);
@@ -127,7 +130,10 @@ void Connection::send_msg(ipx_ctx_t *ctx, ByteVector &&msg) {
 
     ipx_msg_ctx msg_ctx;
     msg_ctx.session = m_session;
-    msg_ctx.odid = ntohl(reinterpret_cast<const fds_ipfix_msg_hdr *>(msg.data())->odid);
+    // the message doesn't have to be aligned when it is a part of a slab
+    uint32_t odid;
+    std::memcpy(&odid, msg.data() + offsetof(fds_ipfix_msg_hdr, odid), sizeof(odid));
+    msg_ctx.odid = ntohl(odid);
     msg_ctx.stream = 0; // Streams are not supported over TCP
 
     ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg.data(), msg.size());
@@ -137,10 +143,14 @@ void Connection::send_msg(ipx_ctx_t *ctx, ByteVector &&msg) {
         );
     }
 
-    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(ipfix_msg));
-
     // release the message data so that it is not freed by the destructor
-    msg.take();
+    Slab *slab = msg.take();
+    if (slab) {
+        // the message is a part of a slab, release the reference instead of free()
+        ipx_msg_ipfix_set_release(ipfix_msg, &Slab::release_cb, slab);
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(ipfix_msg));
 }
 
 void Connection::close(ipx_ctx_t *ctx) {
@@ -14,7 +14,7 @@
 
 #include <ipfixcol2.h> // ipx_ctx_t, ipx_session
 
-#include "ByteVector.hpp"     // ByteVector
+#include "DecodeBuffer.hpp"   // DecodedMsg
 #include "Decoder.hpp"        // Decoder
 #include "DecoderFactory.hpp"
 #include "UniqueFd.hpp"       // UniqueFd
@@ -68,7 +68,7 @@ public:
     ~Connection();
 
 private:
-    void send_msg(ipx_ctx_t *ctx, ByteVector &&msg);
+    void send_msg(ipx_ctx_t *ctx, DecodedMsg &&msg);
 
     /** TCP file descriptor */
     UniqueFd m_fd;
@@ -13,11 +13,90 @@
 #include <vector>  // std::vector
 #include <cstdint> // uint8_t, UINT16_MAX
 #include <cstddef> // size_t
+#include <utility> // std::move
 
 #include "ByteVector.hpp" // ByteVector
+#include "Slab.hpp"       // Slab
 
 namespace tcp_in {
 
+/** Decoded IPFIX message stored either in its own buffer or in a part of a receive slab. */
+class DecodedMsg {
+public:
+    /**
+     * @brief Creates message stored in its own buffer.
+     * @param data IPFIX message. This buffer will be emptied.
+     */
+    DecodedMsg(ByteVector &&data) :
+        m_owned(std::move(data)),
+        m_slab(nullptr),
+        m_data(m_owned.data()),
+        m_size(m_owned.size())
+    {}
+
+    /**
+     * @brief Creates message stored in a part of a slab. Takes over one reference to the slab.
+     * @param slab Slab with the message.
+     * @param data Start of the message in the slab.
+     * @param size Size of the message.
+     */
+    DecodedMsg(Slab *slab, uint8_t *data, size_t size) noexcept :
+        m_owned(),
+        m_slab(slab),
+        m_data(data),
+        m_size(size)
+    {}
+
+    DecodedMsg(DecodedMsg &&other) noexcept :
+        m_owned(std::move(other.m_owned)),
+        m_slab(other.m_slab),
+        m_data(other.m_data),
+        m_size(other.m_size)
+    {
+        other.m_slab = nullptr;
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    DecodedMsg &operator=(const DecodedMsg &) = delete;
+
+    ~DecodedMsg() {
+        if (m_slab) {
+            m_slab->release();
+        }
+    }
+
+    /** Gets pointer to the message. */
+    uint8_t *data() noexcept {
+        return m_data;
+    }
+
+    /** Gets size of the message. */
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    /**
+     * @brief Releases the ownership of the message and makes this object empty.
+     * @return Slab with the message whose reference has been passed to the caller, or nullptr
+     * if the message has its own buffer that must be freed by `free`.
+     */
+    Slab *take() noexcept {
+        Slab *slab = m_slab;
+        m_owned.take();
+        m_slab = nullptr;
+        m_data = nullptr;
+        m_size = 0;
+        return slab;
+    }
+
+private:
+    ByteVector m_owned;
+    Slab *m_slab;
+    uint8_t *m_data;
+    size_t m_size;
+};
+
 /** Buffer for collecting and reconstructing decoded IPFIX messages. */
 class DecodeBuffer {
 public:
@@ -45,8 +124,16 @@ public:
      * @param data IPFIX message to add. This buffer will be emptied.
      */
     void add(ByteVector &&data) {
-        m_total_bytes_decoded += data.size();
-        m_decoded.push_back(std::move(data));
+        add(DecodedMsg(std::move(data)));
+    }
+
+    /**
+     * @brief Adds new decoded IPFIX message (possibly a part of a slab) to the buffer.
+     * @param msg IPFIX message to add.
+     */
+    void add(DecodedMsg &&msg) {
+        m_total_bytes_decoded += msg.size();
+        m_decoded.push_back(std::move(msg));
     }
 
     /**
@@ -118,7 +205,7 @@ private:
     size_t m_total_bytes_decoded;
     bool m_eof_reached;
     /** Decoded data waiting to be sent. */
-    std::vector<ByteVector> m_decoded;
+    std::vector<DecodedMsg> m_decoded;
     /** Partially decoded data. */
     ByteVector m_part_decoded;
     /** Expected length of fully decoded data. */
@@ -13,74 +13,159 @@
 #include <stdexcept> // runtime_error
 #include <string>    // string
 #include <errno.h>   // errno, EWOULDBLOCK, EAGAIN
-#include <stddef.h>  // size_t
+#include <stddef.h>  // size_t, offsetof
+#include <cstring>   // memcpy, memmove
+#include <cstdint>   // uintptr_t
+#include <algorithm> // min
+#include <utility>   // move
 
-#include <unistd.h> // read
+#include <sys/socket.h> // recv
 
 #include <ipfixcol2.h> // fds_ipfix_msg_hdr, ipx_strerror
 
-#include "DecodeBuffer.hpp" // DecodeBuffer
-#include "read_until_n.hpp" // read_until_n
+#include "ByteVector.hpp"   // ByteVector
+#include "DecodeBuffer.hpp" // DecodeBuffer, DecodedMsg
+#include "Slab.hpp"         // Slab
 
 namespace tcp_in {
 
+/**
+ * Alignment of messages passed to the pipeline. Consumers (e.g. the IPFIX parser and output
+ * plugins) access the message header directly, i.e. as `fds_ipfix_msg_hdr *`.
+ */
+constexpr size_t MSG_ALIGN = alignof(fds_ipfix_msg_hdr);
+
+/**
+ * @brief Reads the length from an IPFIX header.
+ * @param data Start of the message (the message might not be complete yet, nor aligned)
+ * @return Length of the message.
+ */
+static size_t read_length(const uint8_t *data) {
+    uint16_t length;
+    std::memcpy(&length, data + offsetof(fds_ipfix_msg_hdr, length), sizeof(length));
+    return ntohs(length);
+}
+
 DecodeBuffer &IpfixDecoder::decode() {
     while (!m_decoded.enough_data()) {
-        // Read the header of the message.
-        if (!read_header()) {
-            // There is not enough data to read the whole header.
-            break;
-        }
-
-        // Read the body of the message.
-        if (!read_body()) {
-            // There is not enough data to read the whole body of the message.
+        bool more = receive();
+        process_slab();
+        if (!more) {
+            // There is no more data available at the moment.
             break;
         }
     }
 
-    if (m_decoded.is_eof_reached() && m_part_readed.size() != 0) {
+    if (m_decoded.is_eof_reached() && m_begin != m_end) {
         throw std::runtime_error("Received incomplete message.");
     }
 
     return m_decoded;
 }
 
-bool IpfixDecoder::read_header() {
-    if (m_msg_size != 0) {
-        // The header is already read, but the message body is incomplete.
-        return true;
+IpfixDecoder::~IpfixDecoder() {
+    if (m_slab) {
+        m_slab->release();
     }
+}
+
+bool IpfixDecoder::receive() {
+    prepare_slab();
+
+    auto space = m_slab->capacity() - m_end;
+    auto res = recv(m_fd, m_slab->data() + m_end, space, 0);
+    if (res == -1) {
+        int err = errno;
+        if (err == EWOULDBLOCK || err == EAGAIN) {
+            return false;
+        }
 
-    // Read the header
-    if (!read_until_n(sizeof(fds_ipfix_msg_hdr))) {
-        // There is not enough data to read the whole header.
+        const char *err_str;
+        ipx_strerror(err, err_str);
+        throw std::runtime_error("Failed to read from descriptor: " + std::string(err_str));
+    }
+
+    if (res == 0) {
+        m_decoded.signal_eof();
         return false;
     }
 
-    // The header has been read, load the size of the message.
-    auto hdr = reinterpret_cast<fds_ipfix_msg_hdr *>(m_part_readed.data());
-    m_msg_size = ntohs(hdr->length);
-    return true;
+    m_end += res;
+    return static_cast<size_t>(res) == space;
 }
 
-bool IpfixDecoder::read_body() {
-    // Read the body.
-    if (!read_until_n(m_msg_size)) {
-        // There is not enough data to read the whole body
-        return false;
+void IpfixDecoder::prepare_slab() {
+    constexpr size_t HDR_SIZE = sizeof(fds_ipfix_msg_hdr);
+
+    if (m_slab && m_begin == m_end && m_slab->is_unique()) {
+        // All messages have been already released, start from the beginning of the slab.
+        m_begin = 0;
+        m_end = 0;
     }
 
-    // Whole message has been read. Add it to the decode buffer.
-    m_decoded.add(std::move(m_part_readed));
-    m_part_readed = ByteVector();
-    m_msg_size = 0;
-    return true;
+    if (m_slab && m_begin == m_end) {
+        // Nothing is pending, let the next message start at an aligned offset.
+        size_t aligned = (m_end + MSG_ALIGN - 1) & ~(MSG_ALIGN - 1);
+        m_begin = m_end = std::min(aligned, m_slab->capacity());
+    }
+
+    // Size of the incomplete message (or at least its header) at the end of the slab.
+    auto pending = m_end - m_begin;
+    size_t needed = HDR_SIZE;
+    if (pending >= HDR_SIZE) {
+        needed = read_length(m_slab->data() + m_begin);
+    }
+
+    if (m_slab && m_end < m_slab->capacity() && m_slab->capacity() - m_begin >= needed) {
+        // The incomplete message fits into the rest of the slab.
+        return;
+    }
+
+    if (m_slab && m_slab->is_unique()) {
+        // Nobody else refers to the slab, move the incomplete message to its beginning.
+        std::memmove(m_slab->data(), m_slab->data() + m_begin, pending);
+    } else {
+        // The message straddles the slab boundary, copy it to a new slab.
+        Slab *slab = Slab::create();
+        if (m_slab) {
+            std::memcpy(slab->data(), m_slab->data() + m_begin, pending);
+            m_slab->release();
+        }
+        m_slab = slab;
+    }
+
+    m_begin = 0;
+    m_end = pending;
 }
 
-bool IpfixDecoder::read_until_n(size_t n) {
-    return ::read_until_n(n, m_fd, m_part_readed, m_decoded);
+void IpfixDecoder::process_slab() {
+    constexpr size_t HDR_SIZE = sizeof(fds_ipfix_msg_hdr);
+
+    while (m_end - m_begin >= HDR_SIZE) {
+        auto data = m_slab->data() + m_begin;
+        size_t msg_size = read_length(data);
+        if (msg_size < HDR_SIZE) {
+            throw std::runtime_error("Received message with invalid length.");
+        }
+
+        if (m_end - m_begin < msg_size) {
+            // The message is incomplete
+            break;
+        }
+
+        // Whole message has been read. Add it to the decode buffer.
+        if (reinterpret_cast<uintptr_t>(data) % MSG_ALIGN == 0) {
+            m_slab->acquire();
+            m_decoded.add(DecodedMsg(m_slab, data, msg_size));
+        } else {
+            // The message follows a message of unaligned length, copy it to its own buffer.
+            ByteVector msg;
+            msg.resize(msg_size);
+            std::memcpy(msg.data(), data, msg_size);
+            m_decoded.add(std::move(msg));
+        }
+        m_begin += msg_size;
+    }
 }
 
 } // namespace tcp_in
-
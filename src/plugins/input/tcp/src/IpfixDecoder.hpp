@@ -15,21 +15,32 @@
 
 #include "Decoder.hpp"      // Decoder
 #include "DecodeBuffer.hpp" // DecodeBuffer
-#include "ByteVector.hpp"   // ByteVector
+#include "Slab.hpp"         // Slab
 
 namespace tcp_in {
 
 /** Identifies data for which this decoder should be used. */
 constexpr uint16_t IPFIX_MAGIC = 10;
 
-/** Decoder for basic IPFX data. */
+/**
+ * @brief Decoder for basic IPFX data.
+ *
+ * Data are received in large chunks into a slab (see `Slab`) and complete IPFIX messages are
+ * passed on as parts of the slab, i.e. without copying. Only a message that doesn't fit into
+ * the rest of the slab is copied to the beginning of a new one. Messages passed on are always
+ * aligned for `fds_ipfix_msg_hdr`, i.e. a message that directly follows a message of unaligned
+ * length is copied to its own buffer.
+ */
 class IpfixDecoder : public Decoder {
 public:
     /**
      * @brief Creates ipfix decoder.
      * @param fd TCP connection file descriptor.
      */
-    IpfixDecoder(int fd) : m_fd(fd), m_decoded(), m_part_readed(), m_msg_size(0) {}
+    IpfixDecoder(int fd) : m_fd(fd), m_decoded(), m_slab(nullptr), m_begin(0), m_end(0) {}
+
+    IpfixDecoder(const IpfixDecoder &) = delete;
+    IpfixDecoder &operator=(const IpfixDecoder &) = delete;
 
     virtual DecodeBuffer &decode() override;
 
@@ -37,20 +48,26 @@ public:
         return "IPFIX";
     }
 
+    virtual ~IpfixDecoder() override;
+
 private:
-    /** returns true if there was enough data to read the header or if the header is already read */
-    bool read_header();
-    /** returns true if there was enough data to read the body */
-    bool read_body();
-    /** returns true if there was enough data to read to the given amount */
-    bool read_until_n(size_t n);
+    /** returns true if the whole free space of the slab has been filled (i.e. more data might be
+     * available) */
+    bool receive();
+    /** makes sure that there is free space in the slab for the rest of the incomplete message */
+    void prepare_slab();
+    /** passes all complete messages in the slab to the decode buffer */
+    void process_slab();
 
     int m_fd;
     DecodeBuffer m_decoded;
 
-    ByteVector m_part_readed;
-    /** Final size of the whole IPFIX message. When 0 IPIFX header is not fully read. */
-    size_t m_msg_size;
+    /** Slab with received data (the decoder owns one reference) or nullptr. */
+    Slab *m_slab;
+    /** Offset of the first byte in the slab that is not a part of a passed message. */
+    size_t m_begin;
+    /** Offset after the last received byte in the slab. */
+    size_t m_end;
 };
 
 } // namespace tcp_in
@@ -10,9 +10,11 @@
 
 #include "Plugin.hpp"
 
-#include <array>     // array
-#include <stdexcept> // exception
-#include <cstddef>   // size_t
+#include <array>        // array
+#include <stdexcept>    // exception, runtime_error
+#include <system_error> // system_error
+#include <cstddef>      // size_t
+#include <functional>   // ref
 
 #include <ipfixcol2.h> // ipx_ctx_t, IPX_CTX_ERROR, IPX_CTX_INFO, IPX_CTX_WARNING, ipx_session
 
@@ -24,19 +26,44 @@ namespace tcp_in {
 
 Plugin::Plugin(ipx_ctx_t *ctx, Config &config) :
     m_ctx(ctx),
-    m_clients(ctx, DecoderFactory()),
-    m_acceptor(m_clients, ctx)
+    m_clients(),
+    m_acceptor(m_clients, ctx),
+    m_workers(),
+    m_workers_stop(false),
+    m_workers_failed(false)
 {
+    if (config.threads > 1 && ipx_ctx_msg_pass_mt(ctx) != IPX_OK) {
+        throw std::runtime_error("Failed to enable passing of messages from multiple threads.");
+    }
+
+    for (unsigned i = 0; i < config.threads; ++i) {
+        m_clients.emplace_back(new ClientManager(ctx, DecoderFactory()));
+    }
+
     m_acceptor.bind_addresses(config);
     m_acceptor.start();
 }
 
 void Plugin::get() {
+    if (m_workers.size() + 1 != m_clients.size()) {
+        // Worker threads cannot be started during initialization as messages cannot be passed yet
+        start_workers();
+    }
+
+    if (m_workers_failed.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("A worker thread has failed!");
+    }
+
+    receive(*m_clients[0]);
+}
+
+void Plugin::receive(ClientManager &clients) {
     /** Maximum number of connections to process in one call to get */
     constexpr int MAX_CONNECTION_BATCH_SIZE = 16;
     std::array<Connection *, MAX_CONNECTION_BATCH_SIZE> connections{};
 
-    auto count = m_clients.wait_for_connections(connections.begin(), connections.size());
+    clients.process_close_requests();
+    auto count = clients.wait_for_connections(connections.begin(), connections.size());
 
     for (size_t i = 0; i < count; ++i) {
         try {
@@ -44,28 +71,86 @@ void Plugin::get() {
                 // EOF reached
                 auto session = connections[i]->get_session();
                 IPX_CTX_INFO(m_ctx, "Closing %s", session->ident);
-                m_clients.close_connection(session);
+                clients.close_connection(session);
             }
         } catch (std::exception &ex) {
             IPX_CTX_ERROR(m_ctx, "%s", ex.what());
             auto session = connections[i]->get_session();
             IPX_CTX_INFO(m_ctx, "Closing %s", session->ident);
-            m_clients.close_connection(session);
+            clients.close_connection(session);
+        }
+    }
+}
+
+void Plugin::start_workers() {
+    while (m_workers.size() + 1 < m_clients.size()) {
+        ClientManager &clients = *m_clients[m_workers.size() + 1];
+        try {
+            m_workers.emplace_back(&Plugin::worker_main, this, std::ref(clients));
+        } catch (std::system_error &ex) {
+            throw std::runtime_error("Failed to start a worker thread: " + std::string(ex.what()));
+        }
+    }
+
+    IPX_CTX_DEBUG(m_ctx, "%zu worker thread(s) started.", m_workers.size());
+}
+
+void Plugin::stop_workers() noexcept {
+    m_workers_stop.store(true, std::memory_order_relaxed);
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void Plugin::worker_main(ClientManager &clients) noexcept {
+    while (!m_workers_stop.load(std::memory_order_relaxed)) {
+        try {
+            receive(clients);
+        } catch (std::exception &ex) {
+            // Fatal error -> let the instance thread stop the plugin
+            IPX_CTX_ERROR(m_ctx, "%s", ex.what());
+            m_workers_failed.store(true, std::memory_order_relaxed);
+            break;
         }
     }
 }
 
 void Plugin::close_session(const ipx_session *session) noexcept {
-    m_clients.close_connection(session);
+    // The connection must be closed by the thread that processes it
+    if (m_clients.empty()) {
+        return;
+    }
+
+    try {
+        m_clients[0]->close_connection(session);
+        for (size_t i = 1; i < m_clients.size(); ++i) {
+            if (m_clients[i]->request_close(session)) {
+                break;
+            }
+        }
+    } catch (std::exception &ex) {
+        IPX_CTX_WARNING(m_ctx, "%s", ex.what());
+    }
 }
 
 Plugin::~Plugin() {
     try {
         m_acceptor.stop();
-        m_clients.close_all_connections();
     } catch (std::exception &ex) {
         IPX_CTX_WARNING(m_ctx, "%s", ex.what());
     }
+
+    // Stop workers first, so only this thread passes messages from now
+    stop_workers();
+
+    for (auto &clients : m_clients) {
+        try {
+            clients->close_all_connections();
+        } catch (std::exception &ex) {
+            IPX_CTX_WARNING(m_ctx, "%s", ex.what());
+        }
+    }
 }
 
 } // namespace tcp_in
@@ -10,6 +10,12 @@
 
 #pragma once
 
+#include <atomic> // std::atomic
+#include <memory> // std::unique_ptr
+#include <string> // std::string
+#include <thread> // std::thread
+#include <vector> // std::vector
+
 #include <ipfixcol2.h> // ipx_ctx_t, ipx_session
 
 #include "Config.hpp"        // Config
@@ -18,7 +24,14 @@
 
 namespace tcp_in {
 
-/** TCP input plugin for ipfixcol2. */
+/**
+ * @brief TCP input plugin for ipfixcol2.
+ *
+ * Connections are distributed among one or more client managers. Connections of the first
+ * manager are processed by the instance thread and each additional manager has its own worker
+ * thread. All messages of a connection (including session open/close) are always passed by the
+ * thread of its manager, so their order is preserved.
+ */
 class Plugin {
 public:
     /**
@@ -39,6 +52,7 @@ public:
      * @brief Wait for the next tcp message and process all received messages.
      * @throws when fails to wait for connections
      * @throws when fails to receive
+     * @throws when a worker thread has failed
      */
     void get();
 
@@ -50,10 +64,27 @@ public:
 
     ~Plugin();
 private:
+    /** Receives data from connections of the given client manager. */
+    void receive(ClientManager &clients);
+    /** Starts worker threads of additional client managers. */
+    void start_workers();
+    /** Stops all worker threads. */
+    void stop_workers() noexcept;
+    /** Main function of a worker thread. */
+    void worker_main(ClientManager &clients) noexcept;
+
     ipx_ctx_t *m_ctx;
-    ClientManager m_clients;
+    /** Client managers (the first one is processed by the instance thread). */
+    std::vector<std::unique_ptr<ClientManager>> m_clients;
     /** Acceptor thread. */
     Acceptor m_acceptor;
+
+    /** Worker threads of additional client managers. */
+    std::vector<std::thread> m_workers;
+    /** Request to stop the worker threads. */
+    std::atomic<bool> m_workers_stop;
+    /** A worker thread has failed. */
+    std::atomic<bool> m_workers_failed;
 };
 
 } // namespace tcp_in
@@ -0,0 +1,44 @@
+/**
+ * \file
+ * \brief Reference counted receive buffer (source file)
+ * \date 2026
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Slab.hpp"
+
+#include <cstdlib>   // malloc, free
+#include <new>       // placement new
+#include <stdexcept> // runtime_error
+#include <string>    // to_string
+
+namespace tcp_in {
+
+constexpr size_t Slab::DEFAULT_CAPACITY;
+
+Slab *Slab::create(size_t capacity) {
+    void *mem = malloc(sizeof(Slab) + capacity);
+    if (!mem) {
+        throw std::runtime_error("Failed to allocate slab of size " + std::to_string(capacity));
+    }
+
+    return new (mem) Slab(capacity);
+}
+
+void Slab::release() noexcept {
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    this->~Slab();
+    free(this);
+}
+
+void Slab::release_cb(void *slab, uint8_t *pkt) noexcept {
+    (void) pkt;
+    static_cast<Slab *>(slab)->release();
+}
+
+} // namespace tcp_in
@@ -0,0 +1,91 @@
+/**
+ * \file
+ * \brief Reference counted receive buffer (header file)
+ * \date 2026
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <atomic>  // std::atomic
+#include <cstdint> // uint8_t
+#include <cstddef> // size_t
+
+namespace tcp_in {
+
+/**
+ * @brief Large receive buffer shared by multiple IPFIX messages.
+ *
+ * Data are received from a socket directly into the slab and complete IPFIX messages are passed
+ * to the pipeline as parts of the slab, i.e. without copying. Each message holds one reference
+ * and the slab is freed when the last reference is released. References can be released from
+ * any thread.
+ */
+class Slab {
+public:
+    /** Default capacity of a slab (in bytes). */
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;
+
+    /**
+     * @brief Creates new slab with a single reference owned by the caller.
+     * @param capacity Number of bytes the slab can hold.
+     * @return Pointer to the new slab.
+     * @throws std::runtime_error when allocation fails
+     */
+    static Slab *create(size_t capacity = DEFAULT_CAPACITY);
+
+    Slab(const Slab &) = delete;
+    Slab &operator=(const Slab &) = delete;
+
+    /** Adds a reference to the slab. */
+    void acquire() noexcept {
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Releases a reference to the slab. The slab is freed when the last one is released. */
+    void release() noexcept;
+
+    /**
+     * @brief Checks whether the caller holds the only reference to the slab.
+     * @return true if the slab is not shared, otherwise false.
+     */
+    bool is_unique() const noexcept {
+        return m_refs.load(std::memory_order_acquire) == 1;
+    }
+
+    /**
+     * @brief Gets pointer to the data of the slab.
+     * @return Pointer to the data.
+     */
+    uint8_t *data() noexcept {
+        return reinterpret_cast<uint8_t *>(this + 1);
+    }
+
+    /**
+     * @brief Gets the number of bytes the slab can hold.
+     * @return Capacity of the slab.
+     */
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    /**
+     * @brief Releases a reference of an IPFIX message that refers to the slab.
+     *
+     * Matches the prototype of ipx_msg_ipfix_release_cb.
+     * @param slab The slab (i.e. Slab *)
+     * @param pkt Raw IPFIX message inside the slab (unused)
+     */
+    static void release_cb(void *slab, uint8_t *pkt) noexcept;
+
+private:
+    explicit Slab(size_t capacity) noexcept : m_refs(1), m_capacity(capacity) {}
+    ~Slab() = default;
+
+    std::atomic<size_t> m_refs;
+    size_t m_capacity;
+};
+
+} // namespace tcp_in
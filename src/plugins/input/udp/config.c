@@ -43,6 +43,7 @@
 #include <limits.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/socket.h>
 #include "config.h"
 
 /** Minimal connection timeout                                                                   */
@@ -53,6 +54,14 @@
 #define LIFETIME_DATA_DEF (1800)
 /** Default Options Template Lifetime                                                            */
 #define LIFETIME_OPTS_DEF (1800)
+/** Maximum number of datagrams received at once                                                 */
+#define RECV_BATCH_MAX (1024)
+/** Minimal size of a receive buffer                                                             */
+#define RECV_BUFFER_MIN (512)
+/** Default size of a receive buffer (enough for jumbo frames)                                   */
+#define RECV_BUFFER_DEF (9216)
+/** Maximum number of receiver threads                                                           */
+#define THREADS_MAX (128)
 
 /*
  * <params>
@@ -61,6 +70,9 @@
  *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
  *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
  *  <connectionTimeout>...</connectionTimeout>    <!-- optional                  -->
+ *  <recvBatchSize>...</recvBatchSize>            <!-- optional                  -->
+ *  <recvBufferSize>...</recvBufferSize>          <!-- optional                  -->
+ *  <threads>...</threads>                        <!-- optional                  -->
  * </params>
  */
 
@@ -70,7 +82,10 @@ enum params_xml_nodes {
     NODE_IPADDR,
     NODE_LT_DATA,
     NODE_LT_OPTS,
-    NODE_TIMEOUT
+    NODE_TIMEOUT,
+    NODE_RECV_BATCH,
+    NODE_RECV_BUFFER,
+    NODE_THREADS
 };
 
 /** Definition of the \<params\> node  */
@@ -81,6 +96,9 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_LT_DATA, "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_LT_OPTS, "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_TIMEOUT, "connectionTimeout",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RECV_BATCH,  "recvBatchSize",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RECV_BUFFER, "recvBufferSize",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS, "threads",                 FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -187,6 +205,41 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct udp_config *cfg)
             }
             cfg->timeout_conn = (uint16_t) content->val_uint;
             break;
+        case NODE_RECV_BATCH:
+            // Number of datagrams received at once
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > RECV_BATCH_MAX) {
+                IPX_CTX_ERROR(ctx, "Receive batch size must be between 0..%d", RECV_BATCH_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->recv_batch = (uint16_t) content->val_uint;
+            break;
+        case NODE_RECV_BUFFER:
+            // Size of a receive buffer
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < RECV_BUFFER_MIN || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Receive buffer size must be between %d..%" PRIu16,
+                    RECV_BUFFER_MIN, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->recv_buffer = (uint16_t) content->val_uint;
+            break;
+        case NODE_THREADS:
+            // Number of receiver threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of threads must be between 1..%d", THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+#ifndef SO_REUSEPORT
+            if (content->val_uint > 1) {
+                IPX_CTX_ERROR(ctx, "Multiple threads are not supported on this platform "
+                    "(SO_REUSEPORT is not available)!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+#endif
+            cfg->threads = (uint16_t) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -208,6 +261,9 @@ config_default_set(struct udp_config *cfg)
     cfg->timeout_conn = CONN_TIMEOUT_DEF;
     cfg->lifetime_data = LIFETIME_DATA_DEF;
     cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->recv_batch = 0; // Disabled
+    cfg->recv_buffer = RECV_BUFFER_DEF;
+    cfg->threads = 1;
 }
 
 struct udp_config *
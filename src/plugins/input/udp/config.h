@@ -68,6 +68,13 @@ struct udp_config {
     /** Connection timeout                                                                       */
     uint16_t timeout_conn;
 
+    /** Max. number of datagrams received by a single system call (0 = batching disabled)        */
+    uint16_t recv_batch;
+    /** Size of preallocated receive buffers (used only if batching is enabled)                  */
+    uint16_t recv_buffer;
+    /** Number of receiver threads                                                               */
+    uint16_t threads;
+
     struct {
         /** Size of the array                                                                    */
         size_t cnt;
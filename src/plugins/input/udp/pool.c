@@ -0,0 +1,209 @@
+/**
+ * \file src/plugins/input/udp/pool.c
+ * \brief Pool of receive buffers of UDP input plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "pool.h"
+
+/** Alignment of buffers (in bytes)                                                              */
+#define POOL_ALIGN (64U)
+
+/** Header of a buffer (placed right before the buffer)                                          */
+struct udp_pool_buf {
+    /** Next unused buffer (valid only when the buffer is in the pool)                           */
+    struct udp_pool_buf *next;
+};
+
+/** Slab of buffers (allocated at once)                                                          */
+struct udp_pool_slab {
+    /** Next slab                                                                                */
+    struct udp_pool_slab *next;
+};
+
+/** Pool of buffers                                                                              */
+struct udp_pool {
+    /** Mutex protecting the pool                                                                */
+    pthread_mutex_t lock;
+    /** List of unused buffers                                                                   */
+    struct udp_pool_buf *unused;
+    /** List of allocated slabs                                                                  */
+    struct udp_pool_slab *slabs;
+
+    /** Size of the buffer (without header)                                                      */
+    size_t buf_size;
+    /** Distance between two consecutive headers in a slab                                       */
+    size_t buf_stride;
+    /** Number of buffers per slab                                                               */
+    size_t slab_size;
+
+    /** Number of buffers currently used outside of the pool                                     */
+    size_t used;
+    /** The owner has already destroyed the pool                                                 */
+    bool destroyed;
+};
+
+/** Offset of the data from the start of the buffer header                                       */
+#define POOL_DATA_OFFSET \
+    (((sizeof(struct udp_pool_buf) + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN)
+
+/**
+ * \brief Free the pool and all its slabs
+ * \param[in] pool Pool of buffers
+ */
+static void
+pool_free(struct udp_pool *pool)
+{
+    struct udp_pool_slab *slab = pool->slabs;
+    while (slab != NULL) {
+        struct udp_pool_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+/**
+ * \brief Allocate a new slab of buffers and add them to the list of unused buffers
+ * \note The pool MUST be locked!
+ * \param[in] pool Pool of buffers
+ * \return True on success, false on memory allocation error
+ */
+static bool
+pool_slab_add(struct udp_pool *pool)
+{
+    const size_t offset = POOL_DATA_OFFSET; // Space for the slab header
+    uint8_t *mem;
+    if (posix_memalign((void **) &mem, POOL_ALIGN, offset + pool->slab_size * pool->buf_stride)) {
+        return false;
+    }
+
+    struct udp_pool_slab *slab = (struct udp_pool_slab *) mem;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    for (size_t i = 0; i < pool->slab_size; ++i) {
+        struct udp_pool_buf *buf = (struct udp_pool_buf *) (mem + offset + i * pool->buf_stride);
+        buf->next = pool->unused;
+        pool->unused = buf;
+    }
+
+    return true;
+}
+
+struct udp_pool *
+udp_pool_create(size_t buf_size, size_t slab_size)
+{
+    struct udp_pool *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        free(pool);
+        return NULL;
+    }
+
+    const size_t stride = POOL_DATA_OFFSET + buf_size;
+    pool->buf_size = buf_size;
+    pool->buf_stride = ((stride + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN;
+    pool->slab_size = (slab_size == 0) ? 1 : slab_size;
+    pool->unused = NULL;
+    pool->slabs = NULL;
+    pool->used = 0;
+    pool->destroyed = false;
+    return pool;
+}
+
+void
+udp_pool_destroy(struct udp_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->destroyed = true;
+    bool unused = (pool->used == 0);
+    pthread_mutex_unlock(&pool->lock);
+
+    if (unused) {
+        pool_free(pool);
+    }
+}
+
+size_t
+udp_pool_get_n(struct udp_pool *pool, uint8_t **bufs, size_t cnt)
+{
+    size_t idx;
+
+    pthread_mutex_lock(&pool->lock);
+    for (idx = 0; idx < cnt; ++idx) {
+        if (pool->unused == NULL && !pool_slab_add(pool)) {
+            // Memory allocation error
+            break;
+        }
+
+        struct udp_pool_buf *buf = pool->unused;
+        pool->unused = buf->next;
+        bufs[idx] = ((uint8_t *) buf) + POOL_DATA_OFFSET;
+    }
+
+    pool->used += idx;
+    pthread_mutex_unlock(&pool->lock);
+    return idx;
+}
+
+void
+udp_pool_put(void *pool, uint8_t *buf)
+{
+    struct udp_pool *p = (struct udp_pool *) pool;
+    struct udp_pool_buf *hdr = (struct udp_pool_buf *) (buf - POOL_DATA_OFFSET);
+
+    pthread_mutex_lock(&p->lock);
+    hdr->next = p->unused;
+    p->unused = hdr;
+    p->used--;
+    bool release = (p->destroyed && p->used == 0);
+    pthread_mutex_unlock(&p->lock);
+
+    if (release) {
+        // The owner doesn't exist anymore and this was the last buffer
+        pool_free(p);
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * \file src/plugins/input/udp/pool.h
+ * \brief Pool of receive buffers of UDP input plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef UDP_POOL_H
+#define UDP_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \brief Pool of fixed size receive buffers
+ *
+ * Buffers are allocated in slabs (i.e. multiple buffers by a single allocation) and returned
+ * buffers are reused. Buffers can be returned from any thread, therefore, they can be used as
+ * raw packets of IPFIX Messages (see ipx_msg_ipfix_set_release()).
+ *
+ * The pool is destroyed when its owner calls udp_pool_destroy() AND all buffers have been
+ * returned. In other words, messages that still refer to buffers of the pool can safely outlive
+ * the instance of the plugin.
+ */
+struct udp_pool;
+
+/**
+ * \brief Create a new pool of buffers
+ * \param[in] buf_size  Size of a single buffer (in bytes)
+ * \param[in] slab_size Number of buffers allocated at once when the pool is empty
+ * \return Pointer to the pool or NULL (memory allocation error)
+ */
+struct udp_pool *
+udp_pool_create(size_t buf_size, size_t slab_size);
+
+/**
+ * \brief Destroy the pool
+ *
+ * \note If any buffer has not been returned yet, the pool is destroyed as soon as the last
+ *   buffer is returned.
+ * \param[in] pool Pool of buffers
+ */
+void
+udp_pool_destroy(struct udp_pool *pool);
+
+/**
+ * \brief Get one or more buffers from the pool
+ * \param[in]  pool Pool of buffers
+ * \param[out] bufs Array of buffers to fill
+ * \param[in]  cnt  Number of buffers to get
+ * \return Number of buffers stored into the array (less than \p cnt only in case of a memory
+ *   allocation error)
+ */
+size_t
+udp_pool_get_n(struct udp_pool *pool, uint8_t **bufs, size_t cnt);
+
+/**
+ * \brief Return a buffer to the pool
+ *
+ * The function is thread-safe and matches the prototype of ::ipx_msg_ipfix_release_cb.
+ * \param[in] pool Pool of buffers (i.e. struct udp_pool *)
+ * \param[in] buf  Buffer to return
+ */
+void
+udp_pool_put(void *pool, uint8_t *buf);
+
+#endif // UDP_POOL_H
@@ -39,6 +39,7 @@
  *
  */
 
+#define _GNU_SOURCE // recvmmsg()
 #include <ipfixcol2.h>
 
 #include <sys/types.h>
@@ -53,7 +54,9 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include "config.h"
+#include "pool.h"
 
 /** Identification of an invalid socket descriptor                                               */
 #define INVALID_FD        (-1)
@@ -157,8 +160,15 @@ struct udp_source {
     bool new_connection;
 };
 
-/** Instance data                                                                                */
+struct udp_instance;
+
+/** Receiver data (each receiver has its own sockets, Transport Sessions and thread)             */
 struct udp_data {
+    /** Instance to which the receiver belongs                                                   */
+    struct udp_instance *instance;
+    /** Receiver thread (valid only for additional receivers with a running thread)              */
+    pthread_t thread;
+
     /** Parsed configuration parameters                                                          */
     struct udp_config *config;
     /** Instance context                                                                         */
@@ -184,6 +194,54 @@ struct udp_data {
         /** Array of active sources (identification and corresponding Transport Session)         */
         struct udp_source **sources;
     } active; /**< Active connections                                                            */
+
+#ifdef HAVE_RECVMMSG
+    struct {
+        /** Pool of receive buffers (NULL, if batch receive is disabled)                         */
+        struct udp_pool *pool;
+        /** Number of receive slots (i.e. max. number of datagrams received at once)             */
+        size_t cnt;
+        /** Size of a receive buffer                                                             */
+        size_t buf_size;
+        /** Message headers (one per slot)                                                       */
+        struct mmsghdr *hdrs;
+        /** Data vectors (one per slot)                                                          */
+        struct iovec *iovs;
+        /** Source addresses (one per slot)                                                      */
+        struct sockaddr_storage *addrs;
+        /** Receive buffers from the pool (one per slot, NULL if the slot doesn't have a buffer) */
+        uint8_t **bufs;
+    } recv; /**< Batch receive of datagrams                                                      */
+#endif
+};
+
+/** Instance data                                                                                */
+struct udp_instance {
+    /** Parsed configuration parameters                                                          */
+    struct udp_config *config;
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+
+    /** Number of receivers                                                                      */
+    size_t cnt;
+    /**
+     * Array of receivers.
+     * The first receiver is served by the instance thread (i.e. by ipx_plugin_get()), the others
+     * by their own threads. If there are multiple receivers, all of them bind the same local
+     * addresses and ports using SO_REUSEPORT, so the kernel distributes exporters among them.
+     */
+    struct udp_data *receivers;
+
+    struct {
+        /** Threads have been already started                                                    */
+        bool started;
+        /** Number of running threads of additional receivers                                    */
+        size_t running;
+        /** Request to stop the threads                                                          */
+        bool stop;
+        /** A fatal error occurred in a thread                                                   */
+        bool failed;
+    } threads; /**< Threads of additional receivers                                              */
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -197,11 +255,12 @@ struct udp_data {
  * \param[in] addrlen  Size of the address
  * \param[in] ipv6only Accept only IPv6 addresses (only for AF_INET6 and the wildcard address)
  * \param[in] rbuffer  Change the receive buffer size (ignored, if zero or negative)
+ * \param[in] shared   Allow multiple sockets to bind the same address and port (SO_REUSEPORT)
  * \return On failure returns #INVALID_FD. Otherwise returns valid socket descriptor.
  */
 static int
 address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, bool ipv6only,
-    int rbuffer)
+    int rbuffer, bool shared)
 {
     sa_family_t family = addr->sa_family;
     assert(family == AF_INET || family == AF_INET6);
@@ -223,6 +282,18 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
             "the port can be used again. (error: %s)", err_str);
     }
 
+#ifdef SO_REUSEPORT
+    // Shared port (the kernel distributes datagrams among the sockets by source address and port)
+    if (shared && setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Cannot turn on socket option SO_REUSEPORT. (error: %s)", err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+#else
+    assert(!shared && "SO_REUSEPORT is not supported");
+#endif
+
     // Make sure that IPv6 only is disabled
     if (family == AF_INET6) {
         if (!ipv6only && setsockopt(sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == -1) {
@@ -307,6 +378,7 @@ listener_bind(struct udp_data *instance)
     // Create a poll and new array of binded sockets
     const char *err_str;
     const size_t socket_cnt = instance->config->local_addrs.cnt;
+    const bool shared = (instance->config->threads > 1);
     int *sockets = malloc(sizeof(*sockets) * ((socket_cnt == 0) ? 1 : socket_cnt));
     if (!sockets) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
@@ -322,7 +394,7 @@ listener_bind(struct udp_data *instance)
         addr.sin6_addr = in6addr_any;
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr, sizeof(addr), false,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, shared);
         if (sd == INVALID_FD) {
             free(sockets);
             return IPX_ERR_DENIED;
@@ -375,7 +447,7 @@ listener_bind(struct udp_data *instance)
         }
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr_helper, addrlen, ipv6only,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, shared);
         if (sd == INVALID_FD) {
             // Failed
             break;
@@ -933,6 +1005,109 @@ process_timer(struct udp_data *instance, int fd)
         instance->active.cnt);
 }
 
+/**
+ * \brief Find the Transport Session of a received IPFIX/NetFlow message and pass the message
+ *
+ * \note On success, the message wrapper takes responsibility for the buffer. Otherwise, the caller
+ *   is responsible for the buffer.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ * \param[in] addr     Source (i.e. remote) IPv4/IPv6 address and port of the message
+ * \param[in] buffer   Buffer with the message
+ * \param[in] msg_size Size of the message
+ * \param[in] pool     Pool to which the buffer belongs (NULL, if allocated using malloc())
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the message is malformed
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+process_datagram(struct udp_data *instance, int sd, const struct sockaddr *addr, uint8_t *buffer,
+    uint16_t msg_size, struct udp_pool *pool)
+{
+    // Find the source
+    struct udp_source *source = active_get(instance, sd, addr);
+    if (!source) { // Memory allocation error!
+        return IPX_ERR_NOMEM;
+    }
+
+    // Check NetFlow/IPFIX header length and extract ODID/Source ID
+    const uint16_t msg_ver = ntohs(*(uint16_t *) buffer);
+    uint32_t msg_odid = 0;
+    bool is_len_ok = true;
+
+    switch (msg_ver) {
+    case FDS_IPFIX_VERSION: // IPFIX
+        if (msg_size < FDS_IPFIX_MSG_HDR_LEN) {
+            is_len_ok = false;
+            break;
+        }
+
+        msg_odid = ntohl(((const struct fds_ipfix_msg_hdr *) buffer)->odid);
+        break;
+    case NF9_HDR_VERSION: // NetFlow v9
+        if (msg_size < NF9_HDR_LEN) {
+            is_len_ok = false;
+            break;
+        }
+
+        msg_odid = ntohl(((const struct nf9_msg_hdr *) buffer)->source_id);
+        break;
+    case NF5_HDR_VERSION: // NetFlow v5
+        if (msg_size < NF5_HDR_LEN) {
+            is_len_ok = false;
+            break;
+        }
+
+        // Source ID is not available in NetFlow v5 -> always 0
+        msg_odid = 0;
+        break;
+    default:
+        is_len_ok = false;
+        break;
+    }
+
+    if (!is_len_ok) {
+        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
+            "The message will be dropped!", source->session->ident);
+        return IPX_ERR_FORMAT;
+    }
+
+    if (source->new_connection) {
+        // Send information about the new Transport Session
+        source->new_connection = false;
+        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
+                source->session->ident, __FILE__, __LINE__);
+        } else {
+            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg));
+        }
+    }
+
+    // Create a message wrapper and pass the message
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = source->session;
+    msg_ctx.odid = msg_odid;
+    msg_ctx.stream = 0; // Streams are not supported over UDP
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, msg_size);
+    if (!msg) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (pool != NULL) {
+        // Return the buffer to the pool instead of free() when the message is destroyed
+        ipx_msg_ipfix_set_release(msg, &udp_pool_put, pool);
+    }
+
+    ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
+    source->msg_cnt++;
+    return IPX_OK;
+}
+
+
 /**
  * \brief Get an IPFIX/NetFlow message from a socket and pass it
  * \param[in] instance Instance data
@@ -1007,152 +1182,271 @@ process_socket(struct udp_data *instance, int sd)
         return;
     }
 
-    // Find the source
-    struct udp_source *source = active_get(instance, sd, (struct sockaddr *) &addr);
-    if (!source) { // Memory allocation error!
+    if (process_datagram(instance, sd, (struct sockaddr *) &addr, buffer, (uint16_t) msg_size,
+            NULL) != IPX_OK) {
         free(buffer);
-        return;
     }
+}
 
-    // Check NetFlow/IPFIX header length and extract ODID/Source ID
-    const uint16_t msg_ver = ntohs(*(uint16_t *) buffer);
-    uint32_t msg_odid = 0;
-    bool is_len_ok = true;
+#ifdef HAVE_RECVMMSG
+/**
+ * \brief Initialize batch receive of datagrams
+ *
+ * Based on the parsed configuration, receive slots and a pool of receive buffers are prepared.
+ * If batch receive is disabled, nothing is initialized.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (memory allocation error)
+ */
+static int
+recv_init(struct udp_data *instance)
+{
+    const size_t cnt = instance->config->recv_batch;
+    memset(&instance->recv, 0, sizeof(instance->recv));
+    if (cnt == 0) {
+        // Disabled
+        return IPX_OK;
+    }
 
-    switch (msg_ver) {
-    case FDS_IPFIX_VERSION: // IPFIX
-        if (msg_size < FDS_IPFIX_MSG_HDR_LEN) {
-            is_len_ok = false;
-            break;
+    instance->recv.cnt = cnt;
+    instance->recv.buf_size = instance->config->recv_buffer;
+    instance->recv.hdrs = calloc(cnt, sizeof(*instance->recv.hdrs));
+    instance->recv.iovs = calloc(cnt, sizeof(*instance->recv.iovs));
+    instance->recv.addrs = calloc(cnt, sizeof(*instance->recv.addrs));
+    instance->recv.bufs = calloc(cnt, sizeof(*instance->recv.bufs));
+    instance->recv.pool = udp_pool_create(instance->recv.buf_size, cnt);
+
+    if (!instance->recv.hdrs || !instance->recv.iovs || !instance->recv.addrs
+            || !instance->recv.bufs || !instance->recv.pool) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(instance->recv.hdrs);
+        free(instance->recv.iovs);
+        free(instance->recv.addrs);
+        free(instance->recv.bufs);
+        if (instance->recv.pool) {
+            udp_pool_destroy(instance->recv.pool);
         }
+        memset(&instance->recv, 0, sizeof(instance->recv));
+        return IPX_ERR_DENIED;
+    }
 
-        msg_odid = ntohl(((const struct fds_ipfix_msg_hdr *) buffer)->odid);
-        break;
-    case NF9_HDR_VERSION: // NetFlow v9
-        if (msg_size < (int) NF9_HDR_LEN) {
-            is_len_ok = false;
-            break;
+    IPX_CTX_INFO(instance->ctx, "Batch receive enabled (up to %zu datagrams per system call, "
+        "receive buffer size %zu bytes).", cnt, instance->recv.buf_size);
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy batch receive of datagrams
+ *
+ * Unused receive buffers are returned to the pool and the pool is destroyed. Buffers that are
+ * still referenced by IPFIX Messages in the pipeline are freed later (when returned).
+ * \param[in] instance Instance data
+ */
+static void
+recv_destroy(struct udp_data *instance)
+{
+    if (instance->recv.pool == NULL) {
+        // Disabled
+        return;
+    }
+
+    for (size_t i = 0; i < instance->recv.cnt; ++i) {
+        if (instance->recv.bufs[i] != NULL) {
+            udp_pool_put(instance->recv.pool, instance->recv.bufs[i]);
         }
+    }
 
-        msg_odid = ntohl(((const struct nf9_msg_hdr *) buffer)->source_id);
-        break;
-    case NF5_HDR_VERSION: // NetFlow v5
-        if (msg_size < (int) NF5_HDR_LEN) {
-            is_len_ok = false;
-            break;
+    udp_pool_destroy(instance->recv.pool);
+    free(instance->recv.hdrs);
+    free(instance->recv.iovs);
+    free(instance->recv.addrs);
+    free(instance->recv.bufs);
+    memset(&instance->recv, 0, sizeof(instance->recv));
+}
+
+/**
+ * \brief Prepare receive slots for the next system call
+ *
+ * Slots without a buffer get a new one from the pool and message headers are (re)initialized.
+ * \param[in] instance Instance data
+ * \return Number of slots ready to receive a datagram (can be less than the number of slots in
+ *   case of a memory allocation error)
+ */
+static size_t
+recv_slots_prepare(struct udp_data *instance)
+{
+    uint8_t **bufs = instance->recv.bufs;
+    size_t valid = 0;
+
+    // Move remaining buffers to the front (the order of slots doesn't matter)
+    for (size_t i = 0; i < instance->recv.cnt; ++i) {
+        if (bufs[i] == NULL) {
+            continue;
         }
 
-        // Source ID is not available in NetFlow v5 -> always 0
-        msg_odid = 0;
-        break;
-    default:
-        is_len_ok = false;
-        break;
+        uint8_t *tmp = bufs[i];
+        bufs[i] = NULL;
+        bufs[valid++] = tmp;
     }
 
-    if (!is_len_ok) {
-        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
-            "The message will be dropped!", source->session->ident);
-        free(buffer);
-        return;
+    // Get new buffers from the pool
+    if (valid < instance->recv.cnt) {
+        valid += udp_pool_get_n(instance->recv.pool, &bufs[valid], instance->recv.cnt - valid);
     }
 
-    if (source->new_connection) {
-        // Send information about the new Transport Session
-        source->new_connection = false;
-        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
-        if (!msg) {
-            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
-                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
-                source->session->ident, __FILE__, __LINE__);
-        } else {
-            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg));
-        }
+    for (size_t i = 0; i < valid; ++i) {
+        instance->recv.iovs[i].iov_base = bufs[i];
+        instance->recv.iovs[i].iov_len = instance->recv.buf_size;
+
+        struct msghdr *hdr = &instance->recv.hdrs[i].msg_hdr;
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->msg_name = &instance->recv.addrs[i];
+        hdr->msg_namelen = sizeof(instance->recv.addrs[i]);
+        hdr->msg_iov = &instance->recv.iovs[i];
+        hdr->msg_iovlen = 1;
+        instance->recv.hdrs[i].msg_len = 0;
     }
 
-    // Create a message wrapper and pass the message
-    struct ipx_msg_ctx msg_ctx;
-    msg_ctx.session = source->session;
-    msg_ctx.odid = msg_odid;
-    msg_ctx.stream = 0; // Streams are not supported over UDP
+    return valid;
+}
 
-    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, (uint16_t) msg_size);
-    if (!msg) {
+/**
+ * \brief Get multiple IPFIX/NetFlow messages from a socket at once and pass them
+ *
+ * Messages are received directly into preallocated buffers from the pool of the instance by
+ * a single system call.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ */
+static void
+process_socket_batch(struct udp_data *instance, int sd)
+{
+    const char *err_str;
+
+    size_t slots = recv_slots_prepare(instance);
+    if (slots == 0) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(buffer);
         return;
     }
 
-    ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
-    source->msg_cnt++;
-}
-
-// -------------------------------------------------------------------------------------------------
+    int ret = recvmmsg(sd, instance->recv.hdrs, (unsigned int) slots, MSG_DONTWAIT, NULL);
+    if (ret == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return;
+        }
 
-int
-ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
-{
-    struct udp_data *data = calloc(1, sizeof(*data));
-    if (!data) {
-        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        return IPX_ERR_DENIED;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to read datagrams. recvmmsg() failed: %s", err_str);
+        return;
     }
 
-    data->ctx = ctx;
-    data->active.cnt = 0;
-    data->active.sources = NULL;
+    for (int i = 0; i < ret; ++i) {
+        const struct mmsghdr *hdr = &instance->recv.hdrs[i];
+        const size_t msg_size = hdr->msg_len;
 
-    // Parse configuration
-    data->config = config_parse(ctx, params);
-    if (!data->config) {
-        free(data);
+        if ((hdr->msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            IPX_CTX_WARNING(instance->ctx, "Received a datagram larger than the receive buffer "
+                "(%zu bytes). The datagram will be dropped! Increase the receive buffer size.",
+                instance->recv.buf_size);
+            continue;
+        }
+
+        if (msg_size < sizeof(uint16_t) || msg_size > UINT16_MAX) {
+            IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%zu bytes long)",
+                msg_size);
+            continue;
+        }
+
+        const struct sockaddr *addr = (const struct sockaddr *) &instance->recv.addrs[i];
+        uint8_t *buffer = instance->recv.bufs[i];
+        if (process_datagram(instance, sd, addr, buffer, (uint16_t) msg_size,
+                instance->recv.pool) == IPX_OK) {
+            // The buffer is owned by the IPFIX Message now
+            instance->recv.bufs[i] = NULL;
+        }
+    }
+}
+#endif
+
+/**
+ * \brief Initialize a receiver
+ *
+ * Local IP addresses are binded, a timer is armed and the batch receive is prepared (if enabled).
+ * \param[in] ctx      Instance context
+ * \param[in] config   Parsed configuration
+ * \param[in] receiver Receiver to initialize
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+receiver_init(ipx_ctx_t *ctx, struct udp_config *config, struct udp_data *receiver)
+{
+    receiver->ctx = ctx;
+    receiver->config = config;
+    receiver->active.cnt = 0;
+    receiver->active.sources = NULL;
+
+#ifdef HAVE_RECVMMSG
+    // Prepare batch receive of datagrams
+    if (recv_init(receiver) != IPX_OK) {
         return IPX_ERR_DENIED;
     }
+#endif
 
     // Bind to local addresses and arm a timer
-    if (listener_init(data) != IPX_OK) {
-        config_destroy(data->config);
-        free(data);
+    if (listener_init(receiver) != IPX_OK) {
+#ifdef HAVE_RECVMMSG
+        recv_destroy(receiver);
+#endif
         return IPX_ERR_DENIED;
     }
 
-    ipx_ctx_private_set(ctx, data);
     return IPX_OK;
 }
 
-void
-ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+/**
+ * \brief Destroy a receiver
+ *
+ * All local IP addresses are unbinded and all its Transport Sessions are closed.
+ * \warning The receiver thread (if any) MUST be already stopped!
+ * \param[in] receiver Receiver to destroy
+ */
+static void
+receiver_destroy(struct udp_data *receiver)
 {
-    (void) ctx;
-    struct udp_data *data = (struct udp_data *) cfg;
     // Unbind all local IP addresses and disarm the timer
-    listener_destroy(data);
+    listener_destroy(receiver);
 
     // Close all Transport Session (this generates Session messages per each active Session)
-    while (data->active.cnt > 0) {
-        active_remove_by_id(data, 0);
+    while (receiver->active.cnt > 0) {
+        active_remove_by_id(receiver, 0);
     }
-    free(data->active.sources);
+    free(receiver->active.sources);
 
-    config_destroy(data->config);
-    free(data);
+#ifdef HAVE_RECVMMSG
+    // Unused receive buffers (buffers of already passed messages are returned later)
+    recv_destroy(receiver);
+#endif
 }
 
-int
-ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+/**
+ * \brief Wait for events of a receiver and process them
+ * \param[in] receiver Receiver
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error
+ */
+static int
+receiver_get(struct udp_data *receiver)
 {
-    struct udp_data *data = (struct udp_data *) cfg;
-
-
     // Process messages from up to 16 sockets (including the timer)
     struct epoll_event ev[GETTER_MAX_EVENTS];
-    int ev_valid = epoll_wait(data->listen.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
+    int ev_valid = epoll_wait(receiver->listen.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
     if (ev_valid == -1) {
         // Failed
         int error_code = errno;
         const char *err_str;
         ipx_strerror(error_code, err_str);
-        IPX_CTX_ERROR(ctx, "epoll_wait() failed: %s", err_str);
+        IPX_CTX_ERROR(receiver->ctx, "epoll_wait() failed: %s", err_str);
         if (error_code == EINTR) {
             return IPX_OK;
         }
@@ -1170,14 +1464,203 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     for (int i = 0; i < ev_valid; ++i) {
         int sd = ev[i].data.fd;
 
-        if (sd == data->listen.timer_fd) {
+        if (sd == receiver->listen.timer_fd) {
             // Timer event
-            process_timer(data, sd);
+            process_timer(receiver, sd);
             continue;
         }
 
-        process_socket(data, sd);
+#ifdef HAVE_RECVMMSG
+        if (receiver->recv.pool != NULL) {
+            process_socket_batch(receiver, sd);
+            continue;
+        }
+#endif
+        process_socket(receiver, sd);
     }
 
     return IPX_OK;
 }
+
+/**
+ * \brief Main function of an additional receiver thread
+ *
+ * Process events of the receiver until the instance requests to stop.
+ * \param[in] arg Receiver
+ * \return NULL
+ */
+static void *
+receiver_thread(void *arg)
+{
+    struct udp_data *receiver = (struct udp_data *) arg;
+    struct udp_instance *instance = receiver->instance;
+
+    while (!__atomic_load_n(&instance->threads.stop, __ATOMIC_RELAXED)) {
+        if (receiver_get(receiver) != IPX_OK) {
+            // Fatal error -> let the instance thread stop the plugin
+            __atomic_store_n(&instance->threads.failed, true, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Start threads of additional receivers
+ *
+ * \note Threads cannot be started during initialization of the instance because the instance
+ *   is not allowed to pass messages yet.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+threads_start(struct udp_instance *instance)
+{
+    instance->threads.started = true;
+    instance->threads.stop = false;
+    instance->threads.failed = false;
+
+    for (size_t i = 1; i < instance->cnt; ++i) {
+        struct udp_data *receiver = &instance->receivers[i];
+        int rc = pthread_create(&receiver->thread, NULL, &receiver_thread, receiver);
+        if (rc != 0) {
+            const char *err_str;
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to start a receiver thread: %s", err_str);
+            break;
+        }
+
+        instance->threads.running++;
+    }
+
+    if (instance->threads.running != instance->cnt - 1) {
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_CTX_DEBUG(instance->ctx, "%zu additional receiver thread(s) started.",
+        instance->threads.running);
+    return IPX_OK;
+}
+
+/**
+ * \brief Stop all running threads of additional receivers
+ * \param[in] instance Instance data
+ */
+static void
+threads_stop(struct udp_instance *instance)
+{
+    __atomic_store_n(&instance->threads.stop, true, __ATOMIC_RELAXED);
+
+    for (size_t i = 1; i <= instance->threads.running; ++i) {
+        pthread_join(instance->receivers[i].thread, NULL);
+    }
+
+    instance->threads.running = 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct udp_instance *instance = calloc(1, sizeof(*instance));
+    if (!instance) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    instance->ctx = ctx;
+
+    // Parse configuration
+    instance->config = config_parse(ctx, params);
+    if (!instance->config) {
+        free(instance);
+        return IPX_ERR_DENIED;
+    }
+
+#ifndef HAVE_RECVMMSG
+    if (instance->config->recv_batch != 0) {
+        IPX_CTX_WARNING(ctx, "Batch receive of datagrams is not supported on this platform. "
+            "The parameter will be ignored.", '\0');
+    }
+#endif
+
+    const size_t cnt = instance->config->threads;
+    if (cnt > 1 && ipx_ctx_msg_pass_mt(ctx) != IPX_OK) {
+        config_destroy(instance->config);
+        free(instance);
+        return IPX_ERR_DENIED;
+    }
+
+    instance->receivers = calloc(cnt, sizeof(*instance->receivers));
+    if (!instance->receivers) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        config_destroy(instance->config);
+        free(instance);
+        return IPX_ERR_DENIED;
+    }
+
+    // Initialize all receivers (each of them binds its own sockets)
+    for (instance->cnt = 0; instance->cnt < cnt; ++instance->cnt) {
+        struct udp_data *receiver = &instance->receivers[instance->cnt];
+        receiver->instance = instance;
+        if (receiver_init(ctx, instance->config, receiver) != IPX_OK) {
+            break;
+        }
+    }
+
+    if (instance->cnt != cnt) {
+        while (instance->cnt > 0) {
+            receiver_destroy(&instance->receivers[--instance->cnt]);
+        }
+        free(instance->receivers);
+        config_destroy(instance->config);
+        free(instance);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, instance);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct udp_instance *instance = (struct udp_instance *) cfg;
+
+    // Stop additional receivers first, so only this thread passes messages from now
+    threads_stop(instance);
+
+    for (size_t i = 0; i < instance->cnt; ++i) {
+        receiver_destroy(&instance->receivers[i]);
+    }
+
+    free(instance->receivers);
+    config_destroy(instance->config);
+    free(instance);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct udp_instance *instance = (struct udp_instance *) cfg;
+
+    if (!instance->threads.started) {
+        // Additional receivers haven't been started yet
+        if (threads_start(instance) != IPX_OK) {
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    if (__atomic_load_n(&instance->threads.failed, __ATOMIC_RELAXED)) {
+        IPX_CTX_ERROR(ctx, "A receiver thread has failed!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    // The first receiver is served by the instance thread
+    return receiver_get(&instance->receivers[0]);
+}
@@ -1043,11 +1043,11 @@ static uint8_t	m_initVector[MAX_IV_SIZE];
 static uint32_t	m_uRounds;
 static uint8_t	m_expandedKey[_MAX_ROUNDS+1][4][4];
 
-static void keySched(uint8_t key[_MAX_KEY_COLUMNS][4]);
+static void keySched(uint32_t uRounds, uint8_t expandedKey[_MAX_ROUNDS+1][4][4], uint8_t key[_MAX_KEY_COLUMNS][4]);
 
 static void keyEncToDec(void);
 
-static void encrypt(const uint8_t a[16], uint8_t b[16]);
+static void encrypt(uint32_t uRounds, const uint8_t expandedKey[_MAX_ROUNDS+1][4][4], const uint8_t a[16], uint8_t b[16]);
 
 static void decrypt(const uint8_t a[16], uint8_t b[16]);
 
@@ -1115,7 +1115,7 @@ uint8_t keyMatrix[_MAX_KEY_COLUMNS][4];
 
 	for(i = 0;i < uKeyLenInBytes;i++)keyMatrix[i >> 2][i & 3] = key[i];
 
-	keySched(keyMatrix);
+	keySched(m_uRounds, m_expandedKey, keyMatrix);
 
 	if(m_direction == Decrypt)keyEncToDec();
 
@@ -1140,7 +1140,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 		case ECB:
 			for(i = numBlocks;i > 0;i--)
 			{
-				encrypt(input,outBuffer);
+				encrypt(m_uRounds, m_expandedKey, input, outBuffer);
 				input += 16;
 				outBuffer += 16;
 			}
@@ -1150,7 +1150,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 			((uint32_t*)block)[1] = ((uint32_t*)m_initVector)[1] ^ ((uint32_t*)input)[1];
 			((uint32_t*)block)[2] = ((uint32_t*)m_initVector)[2] ^ ((uint32_t*)input)[2];
 			((uint32_t*)block)[3] = ((uint32_t*)m_initVector)[3] ^ ((uint32_t*)input)[3];
-			encrypt(block,outBuffer);
+			encrypt(m_uRounds, m_expandedKey, block, outBuffer);
 			input += 16;
 			for(i = numBlocks - 1;i > 0;i--)
 			{
@@ -1159,7 +1159,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 				((uint32_t*)block)[2] = ((uint32_t*)outBuffer)[2] ^ ((uint32_t*)input)[2];
 				((uint32_t*)block)[3] = ((uint32_t*)outBuffer)[3] ^ ((uint32_t*)input)[3];
 				outBuffer += 16;
-				encrypt(block,outBuffer);
+				encrypt(m_uRounds, m_expandedKey, block, outBuffer);
 				input += 16;
 			}
 		break;
@@ -1180,7 +1180,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 					*((uint32_t*)(block+ 4)) = *((uint32_t*)iv[1]);
 					*((uint32_t*)(block+ 8)) = *((uint32_t*)iv[2]);
 					*((uint32_t*)(block+12)) = *((uint32_t*)iv[3]);
-					encrypt(block,block);
+					encrypt(m_uRounds, m_expandedKey, block, block);
 					outBuffer[k/8] ^= (block[0] & 0x80) >> (k & 7);
 					iv[0][0] = (iv[0][0] << 1) | (iv[0][1] >> 7);
 					iv[0][1] = (iv[0][1] << 1) | (iv[0][2] >> 7);
@@ -1226,7 +1226,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 		case ECB:
 			for(i = numBlocks; i > 0; i--)
 			{
-				encrypt(input, outBuffer);
+				encrypt(m_uRounds, m_expandedKey, input, outBuffer);
 				input += 16;
 				outBuffer += 16;
 			}
@@ -1234,7 +1234,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 //			assert(padLen > 0 && padLen <= 16);
 			memcpy(block, input, 16 - padLen);
 			memset(block + 16 - padLen, padLen, padLen);
-			encrypt(block,outBuffer);
+			encrypt(m_uRounds, m_expandedKey, block, outBuffer);
 		break;
 		case CBC:
 			iv = m_initVector;
@@ -1244,7 +1244,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 				((uint32_t*)block)[1] = ((uint32_t*)input)[1] ^ ((uint32_t*)iv)[1];
 				((uint32_t*)block)[2] = ((uint32_t*)input)[2] ^ ((uint32_t*)iv)[2];
 				((uint32_t*)block)[3] = ((uint32_t*)input)[3] ^ ((uint32_t*)iv)[3];
-				encrypt(block, outBuffer);
+				encrypt(m_uRounds, m_expandedKey, block, outBuffer);
 				iv = outBuffer;
 				input += 16;
 				outBuffer += 16;
@@ -1257,7 +1257,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 			for (i = 16 - padLen; i < 16; i++) {
 				block[i] = (uint8_t)padLen ^ iv[i];
 			}
-			encrypt(block,outBuffer);
+			encrypt(m_uRounds, m_expandedKey, block, outBuffer);
 		break;
 		default:
 			return -1;
@@ -1335,7 +1335,7 @@ int Rijndael_blockDecrypt(const uint8_t *input, int inputLen, uint8_t *outBuffer
 					*((uint32_t*)(block+ 4)) = *((uint32_t*)iv[1]);
 					*((uint32_t*)(block+ 8)) = *((uint32_t*)iv[2]);
 					*((uint32_t*)(block+12)) = *((uint32_t*)iv[3]);
-					encrypt(block, block);
+					encrypt(m_uRounds, m_expandedKey, block, block);
 					iv[0][0] = (iv[0][0] << 1) | (iv[0][1] >> 7);
 					iv[0][1] = (iv[0][1] << 1) | (iv[0][2] >> 7);
 					iv[0][2] = (iv[0][2] << 1) | (iv[0][3] >> 7);
@@ -1437,10 +1437,48 @@ int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ALGORITHM
+int Rijndael_ctxInit(Rijndael_ctx *ctx, const uint8_t *key, int keyLen)
+{
+uint32_t i, uKeyLenInBytes;
+uint8_t keyMatrix[_MAX_KEY_COLUMNS][4];
+
+	switch(keyLen)
+	{
+		case Key16Bytes:
+			uKeyLenInBytes = 16;
+			ctx->uRounds = 10;
+		break;
+		case Key24Bytes:
+			uKeyLenInBytes = 24;
+			ctx->uRounds = 12;
+		break;
+		case Key32Bytes:
+			uKeyLenInBytes = 32;
+			ctx->uRounds = 14;
+		break;
+		default:
+			return RIJNDAEL_UNSUPPORTED_KEY_LENGTH;
+		break;
+	}
+
+	if(!key)return RIJNDAEL_BAD_KEY;
+
+	for(i = 0;i < uKeyLenInBytes;i++)keyMatrix[i >> 2][i & 3] = key[i];
+
+	keySched(ctx->uRounds, ctx->expandedKey, keyMatrix);
+
+	return RIJNDAEL_SUCCESS;
+}
+
+void Rijndael_ctxEncrypt(const Rijndael_ctx *ctx, const uint8_t input[16], uint8_t outBuffer[16])
+{
+	encrypt(ctx->uRounds, ctx->expandedKey, input, outBuffer);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
+void keySched(uint32_t uRounds, uint8_t expandedKey[_MAX_ROUNDS+1][4][4], uint8_t key[_MAX_KEY_COLUMNS][4])
 {
 	int j,rconpointer = 0;
 	int r = 0;
@@ -1448,7 +1486,7 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 
 	// Calculate the necessary round keys
 	// The number of calculations depends on keyBits and blockBits
-	int uKeyColumns = m_uRounds - 6;
+	int uKeyColumns = uRounds - 6;
 
 	uint8_t tempKey[_MAX_KEY_COLUMNS][4];
 
@@ -1460,11 +1498,11 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 	}
 
 	// copy values into round key array
-	for(j = 0;(j < uKeyColumns) && (r <= m_uRounds); )
+	for(j = 0;(j < uKeyColumns) && (r <= uRounds); )
 	{
 		for(;(j < uKeyColumns) && (t < 4); j++, t++)
 		{
-			*((uint32_t*)m_expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
+			*((uint32_t*)expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
 		}
 
 
@@ -1475,7 +1513,7 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 		}
 	}
 
-	while(r <= m_uRounds)
+	while(r <= uRounds)
 	{
 		tempKey[0][0] ^= S[tempKey[uKeyColumns-1][1]];
 		tempKey[0][1] ^= S[tempKey[uKeyColumns-1][2]];
@@ -1503,11 +1541,11 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 				*((uint32_t*)tempKey[j]) ^= *((uint32_t*)tempKey[j-1]);
 			}
 		}
-		for(j = 0; (j < uKeyColumns) && (r <= m_uRounds); )
+		for(j = 0; (j < uKeyColumns) && (r <= uRounds); )
 		{
 			for(; (j < uKeyColumns) && (t < 4); j++, t++)
 			{
-				*((uint32_t*)m_expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
+				*((uint32_t*)expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
 			}
 			if(t == 4)
 			{
@@ -1536,15 +1574,15 @@ void keyEncToDec()
 	}
 }
 
-void encrypt(const uint8_t a[16], uint8_t b[16])
+void encrypt(uint32_t uRounds, const uint8_t expandedKey[_MAX_ROUNDS+1][4][4], const uint8_t a[16], uint8_t b[16])
 {
 	int r;
 	uint8_t temp[4][4];
 
-    *((uint32_t*)temp[0]) = *((uint32_t*)(a   )) ^ *((uint32_t*)m_expandedKey[0][0]);
-    *((uint32_t*)temp[1]) = *((uint32_t*)(a+ 4)) ^ *((uint32_t*)m_expandedKey[0][1]);
-    *((uint32_t*)temp[2]) = *((uint32_t*)(a+ 8)) ^ *((uint32_t*)m_expandedKey[0][2]);
-    *((uint32_t*)temp[3]) = *((uint32_t*)(a+12)) ^ *((uint32_t*)m_expandedKey[0][3]);
+    *((uint32_t*)temp[0]) = *((uint32_t*)(a   )) ^ *((const uint32_t*)expandedKey[0][0]);
+    *((uint32_t*)temp[1]) = *((uint32_t*)(a+ 4)) ^ *((const uint32_t*)expandedKey[0][1]);
+    *((uint32_t*)temp[2]) = *((uint32_t*)(a+ 8)) ^ *((const uint32_t*)expandedKey[0][2]);
+    *((uint32_t*)temp[3]) = *((uint32_t*)(a+12)) ^ *((const uint32_t*)expandedKey[0][3]);
     *((uint32_t*)(b    )) = *((uint32_t*)T1[temp[0][0]])
 						^ *((uint32_t*)T2[temp[1][1]])
 						^ *((uint32_t*)T3[temp[2][2]])
@@ -1561,12 +1599,12 @@ void encrypt(const uint8_t a[16], uint8_t b[16])
 						^ *((uint32_t*)T2[temp[0][1]])
 						^ *((uint32_t*)T3[temp[1][2]])
 						^ *((uint32_t*)T4[temp[2][3]]);
-	for(r = 1; r < m_uRounds-1; r++)
+	for(r = 1; r < uRounds-1; r++)
 	{
-		*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)m_expandedKey[r][0]);
-		*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)m_expandedKey[r][1]);
-		*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)m_expandedKey[r][2]);
-		*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)m_expandedKey[r][3]);
+		*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((const uint32_t*)expandedKey[r][0]);
+		*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((const uint32_t*)expandedKey[r][1]);
+		*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((const uint32_t*)expandedKey[r][2]);
+		*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((const uint32_t*)expandedKey[r][3]);
 
 		*((uint32_t*)(b    )) = *((uint32_t*)T1[temp[0][0]])
 							^ *((uint32_t*)T2[temp[1][1]])
@@ -1585,10 +1623,10 @@ void encrypt(const uint8_t a[16], uint8_t b[16])
 							^ *((uint32_t*)T3[temp[1][2]])
 							^ *((uint32_t*)T4[temp[2][3]]);
 	}
-	*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][0]);
-	*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][1]);
-	*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][2]);
-	*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][3]);
+	*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((const uint32_t*)expandedKey[uRounds-1][0]);
+	*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((const uint32_t*)expandedKey[uRounds-1][1]);
+	*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((const uint32_t*)expandedKey[uRounds-1][2]);
+	*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((const uint32_t*)expandedKey[uRounds-1][3]);
 	b[ 0] = T1[temp[0][0]][1];
 	b[ 1] = T1[temp[1][1]][1];
 	b[ 2] = T1[temp[2][2]][1];
@@ -1605,10 +1643,10 @@ void encrypt(const uint8_t a[16], uint8_t b[16])
 	b[13] = T1[temp[0][1]][1];
 	b[14] = T1[temp[1][2]][1];
 	b[15] = T1[temp[2][3]][1];
-	*((uint32_t*)(b   )) ^= *((uint32_t*)m_expandedKey[m_uRounds][0]);
-	*((uint32_t*)(b+ 4)) ^= *((uint32_t*)m_expandedKey[m_uRounds][1]);
-	*((uint32_t*)(b+ 8)) ^= *((uint32_t*)m_expandedKey[m_uRounds][2]);
-	*((uint32_t*)(b+12)) ^= *((uint32_t*)m_expandedKey[m_uRounds][3]);
+	*((uint32_t*)(b   )) ^= *((const uint32_t*)expandedKey[uRounds][0]);
+	*((uint32_t*)(b+ 4)) ^= *((const uint32_t*)expandedKey[uRounds][1]);
+	*((uint32_t*)(b+ 8)) ^= *((const uint32_t*)expandedKey[uRounds][2]);
+	*((uint32_t*)(b+12)) ^= *((const uint32_t*)expandedKey[uRounds][3]);
 }
 
 void decrypt(const uint8_t a[16], uint8_t b[16])
@@ -197,4 +197,23 @@ int Rijndael_blockDecrypt(const uint8_t *input, int inputLen, uint8_t *outBuffer
 // outBuffer must be at least inputLen bytes long
 // Returns the decrypted buffer length in BYTES and an error code < 0 in case of error
 int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffer);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// API with an explicit key schedule (ECB encryption only)
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Expanded key of a cipher instance. Unlike the API above, which shares one global
+// state, any number of instances with different keys can be used at the same time.
+typedef struct {
+	uint32_t uRounds;
+	uint8_t  expandedKey[_MAX_ROUNDS+1][4][4];
+} Rijndael_ctx;
+
+// Rijndael_ctxInit(): Expands the key into the key schedule of the instance
+// Returns RIJNDAEL_SUCCESS or an error code
+// key       : array of unsigned octets , it can be 16 , 24 or 32 bytes long
+// keyLen    : Key16Bytes , Key24Bytes or Key32Bytes
+int Rijndael_ctxInit(Rijndael_ctx *ctx, const uint8_t *key, int keyLen);
+// Encrypts one 16 byte block in ECB mode
+void Rijndael_ctxEncrypt(const Rijndael_ctx *ctx, const uint8_t input[16], uint8_t outBuffer[16]);
 #endif
@@ -44,8 +44,8 @@
 #include <unistd.h>
 #include <inttypes.h>
 
+#include "anonymizer.h"
 #include "config.h"
-#include "Crypto-PAn/panonymizer.h"
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -67,52 +67,10 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
 struct instance_data {
     /** Parsed configuration of the instance  */
     struct anon_config *config;
+    /** Anonymizer of addresses               */
+    anonymizer_t *anon;
 };
 
-/**
- * \brief Anonymize an IPv4/IPv6 address by setting lower half of the address to be zeros
- * \param field IPFIX field with an address to anonymize
- */
-static void
-anonymize_trunc(struct fds_drec_field *field)
-{
-    // IP addresses are stored in Network byte order
-    if (field->size == 4) {
-        memset(&field->data[2], 0, 2);
-        return;
-    }
-
-    if (field->size == 16) {
-        memset(&field->data[8], 0, 8);
-        return;
-    }
-}
-
-/**
- * \brief Anonymize an IPv4/IPV6 address using Crypto-PAn anonymization technique
- * \param[in] field IPFIX field with an address to anonymize
- */
-static void
-anonymize_cryptopan(struct fds_drec_field *field)
-{
-    if (field->size == 4) {
-        uint32_t *mem = (uint32_t *) field->data;
-        (*mem) = htonl(anonymize(ntohl(*mem)));
-        return;
-    }
-
-    if (field->size == 16) {
-        uint64_t addr_orig[2];
-        uint64_t addr_anon[2];
-        memcpy(addr_orig, field->data, field->size);
-        anonymize_v6(addr_orig, addr_anon);
-        memcpy(field->data, addr_anon, field->size);
-        return;
-    }
-}
-
-// -------------------------------------------------------------------------------------------------
-
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 {
@@ -127,8 +85,12 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
-    if (data->config->mode == AN_CRYPTOPAN) {
-        PAnonymizer_Init((uint8_t *)data->config->crypto_key);
+    data->anon = anonymizer_create(ctx, data->config->mode, data->config->crypto_key);
+    if (!data->anon) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
     }
 
     ipx_ctx_private_set(ctx, data);
@@ -141,6 +103,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx; // Suppress warnings
     struct instance_data *data = (struct instance_data *) cfg;
 
+    anonymizer_destroy(data->anon);
     config_destroy(data->config);
     free(data);
 }
@@ -151,43 +114,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     struct instance_data *data = (struct instance_data *) cfg;
 
     // Process all data records in the IPFIX message
-    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_base2ipfix(msg);
-    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
-    for (uint32_t i = 0; i < rec_cnt; ++i) {
-        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
-
-        // Go through the record and anonymize all IPv4/IPv6 addresses
-        struct fds_drec_iter it;
-        fds_drec_iter_init(&it, &rec->rec, 0);
-
-        while (fds_drec_iter_next(&it) != FDS_EOC) {
-            const struct fds_tfield *info = it.field.info;
-            if (info->def == NULL) {
-                // Skip unknown fields
-                continue;
-            }
-
-            const enum fds_iemgr_element_type type = info->def->data_type;
-            if (type != FDS_ET_IPV4_ADDRESS && type != FDS_ET_IPV6_ADDRESS) {
-                // Not an IPv4/IPv6 address
-                continue;
-            }
-
-            if (it.field.size != 4U && it.field.size != 16U) {
-                IPX_CTX_DEBUG(ctx, "Unable to anonymize an IP address with invalid size "
-                    "(%" PRIu16 "bytes)!", it.field.size);
-                continue;
-            }
-
-            if (data->config->mode == AN_TRUNC) {
-                // Truncate the address
-                anonymize_trunc(&it.field);
-            } else {
-                // Crypto-PAn
-                anonymize_cryptopan(&it.field);
-            }
-        }
-    }
+    anonymizer_process(data->anon, ipx_msg_base2ipfix(msg));
 
     // Always pass the message
     ipx_ctx_msg_pass(ctx, msg);
@@ -0,0 +1,323 @@
+/**
+ * \file src/plugins/intermediate/anonymization/anonymizer.c
+ * \brief Anonymization of addresses in IPFIX Messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <arpa/inet.h>
+
+#include "anonymizer.h"
+#include "cryptopan.h"
+
+/** Number of records of the cache of template plans (must be a power of two) */
+#define PLAN_CACHE_SIZE 256U
+
+/** Address field of a template plan */
+struct plan_field {
+    /** Offset from the start of a data record */
+    uint16_t offset;
+    /** Size of the address (4 or 16 bytes)    */
+    uint16_t size;
+};
+
+/** Plan of a template, i.e. positions of all IPv4/IPv6 addresses in its data records */
+struct plan {
+    /** Identification of the template                                        */
+    struct ipx_tmplt_id id;
+    /** An address follows a variable-length field (use the field iterator)    */
+    bool iter;
+    /** Address fields with fixed offsets                                     */
+    struct plan_field *fields;
+    /** Number of address fields                                              */
+    uint16_t fields_cnt;
+};
+
+/** Anonymizer */
+struct anonymizer {
+    /** Plugin context (only for log messages)      */
+    ipx_ctx_t *ctx;
+    /** Anonymization technique                     */
+    enum anon_mode mode;
+    /** Crypto-PAn context (only in Crypto-PAn mode) */
+    cpan_t *cpan;
+    /** Cache of template plans (direct mapped)      */
+    struct plan plans[PLAN_CACHE_SIZE];
+};
+
+/**
+ * \brief Anonymize an IPv4/IPv6 address by setting lower half of the address to be zeros
+ * \param[in] addr Address to anonymize
+ * \param[in] size Size of the address (4 or 16 bytes)
+ */
+static inline void
+anonymize_trunc(uint8_t *addr, uint16_t size)
+{
+    // IP addresses are stored in Network byte order
+    if (size == 4) {
+        memset(&addr[2], 0, 2);
+        return;
+    }
+
+    if (size == 16) {
+        memset(&addr[8], 0, 8);
+        return;
+    }
+}
+
+/**
+ * \brief Anonymize an IPv4/IPV6 address using Crypto-PAn anonymization technique
+ * \param[in] cpan Crypto-PAn context
+ * \param[in] addr Address to anonymize
+ * \param[in] size Size of the address (4 or 16 bytes)
+ */
+static inline void
+anonymize_cryptopan(cpan_t *cpan, uint8_t *addr, uint16_t size)
+{
+    if (size == 4) {
+        uint32_t value;
+        memcpy(&value, addr, sizeof(value));
+        value = htonl(cpan_anon_v4(cpan, ntohl(value)));
+        memcpy(addr, &value, sizeof(value));
+        return;
+    }
+
+    if (size == 16) {
+        uint8_t addr_anon[16];
+        cpan_anon_v6(cpan, addr, addr_anon);
+        memcpy(addr, addr_anon, size);
+        return;
+    }
+}
+
+/**
+ * \brief Anonymize an IPv4/IPv6 address using the configured technique
+ * \param[in] anon Anonymizer
+ * \param[in] addr Address to anonymize
+ * \param[in] size Size of the address (4 or 16 bytes)
+ */
+static inline void
+anonymize_addr(anonymizer_t *anon, uint8_t *addr, uint16_t size)
+{
+    if (anon->mode == AN_TRUNC) {
+        // Truncate the address
+        anonymize_trunc(addr, size);
+    } else {
+        // Crypto-PAn
+        anonymize_cryptopan(anon->cpan, addr, size);
+    }
+}
+
+/**
+ * \brief Is the field an IPv4/IPv6 address?
+ */
+static inline bool
+field_is_addr(const struct fds_tfield *info)
+{
+    if (info->def == NULL) {
+        // Skip unknown fields
+        return false;
+    }
+
+    const enum fds_iemgr_element_type type = info->def->data_type;
+    return (type == FDS_ET_IPV4_ADDRESS || type == FDS_ET_IPV6_ADDRESS);
+}
+
+/**
+ * \brief Anonymize all addresses of a record using the field iterator
+ * \param[in] anon Anonymizer
+ * \param[in] rec  Data record
+ */
+static void
+anonymize_rec_iter(anonymizer_t *anon, struct fds_drec *rec)
+{
+    // Go through the record and anonymize all IPv4/IPv6 addresses
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, rec, 0);
+
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        if (!field_is_addr(it.field.info)) {
+            // Not an IPv4/IPv6 address
+            continue;
+        }
+
+        if (it.field.size != 4U && it.field.size != 16U) {
+            IPX_CTX_DEBUG(anon->ctx, "Unable to anonymize an IP address with invalid size "
+                "(%" PRIu16 "bytes)!", it.field.size);
+            continue;
+        }
+
+        anonymize_addr(anon, it.field.data, it.field.size);
+    }
+}
+
+/**
+ * \brief Clear a template plan
+ */
+static void
+plan_clear(struct plan *plan)
+{
+    ipx_tmplt_id_clear(&plan->id);
+    free(plan->fields);
+    memset(plan, 0, sizeof(*plan));
+}
+
+/**
+ * \brief Get a plan of a template of a record (create it, if it's not in the cache)
+ * \param[in] anon Anonymizer
+ * \param[in] rec  Data record
+ * \return Pointer to the plan or NULL (memory allocation error)
+ */
+static const struct plan *
+plan_get(anonymizer_t *anon, const struct fds_drec *rec)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    struct plan *plan = &anon->plans[ipx_tmplt_id_hash(tmplt) & (PLAN_CACHE_SIZE - 1)];
+
+    if (ipx_tmplt_id_match(&plan->id, tmplt, rec->snap)) {
+        return plan;
+    }
+
+    // Create a new plan
+    plan_clear(plan);
+    plan->fields = malloc(tmplt->fields_cnt_total * sizeof(*plan->fields));
+    if (!plan->fields && tmplt->fields_cnt_total > 0) {
+        return NULL;
+    }
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *info = &tmplt->fields[i];
+        if (!field_is_addr(info)) {
+            continue;
+        }
+
+        if (info->length == FDS_IPFIX_VAR_IE_LEN || info->offset == FDS_IPFIX_VAR_IE_LEN) {
+            // Variable-length address or unknown offset (follows a variable-length field)
+            plan->iter = true;
+            break;
+        }
+
+        if (info->length != 4U && info->length != 16U) {
+            // An address with invalid size (cannot be anonymized)
+            continue;
+        }
+
+        struct plan_field *field = &plan->fields[plan->fields_cnt++];
+        field->offset = info->offset;
+        field->size = info->length;
+    }
+
+    if (ipx_tmplt_id_set(&plan->id, tmplt, rec->snap) != IPX_OK) {
+        plan_clear(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+anonymizer_t *
+anonymizer_create(ipx_ctx_t *ctx, enum anon_mode mode, const char *key)
+{
+    struct anonymizer *anon = calloc(1, sizeof(*anon));
+    if (!anon) {
+        return NULL;
+    }
+
+    anon->ctx = ctx;
+    anon->mode = mode;
+    if (mode != AN_CRYPTOPAN) {
+        return anon;
+    }
+
+    anon->cpan = cpan_create((const uint8_t *) key, false);
+    if (!anon->cpan) {
+        free(anon);
+        return NULL;
+    }
+
+    if (cpan_aesni(anon->cpan)) {
+        IPX_CTX_INFO(ctx, "Crypto-PAn uses AES-NI instructions.", '\0');
+    } else {
+        IPX_CTX_WARNING(ctx, "AES-NI instructions are not available. Crypto-PAn "
+            "anonymization might be slow.", '\0');
+    }
+    return anon;
+}
+
+void
+anonymizer_destroy(anonymizer_t *anon)
+{
+    for (size_t i = 0; i < PLAN_CACHE_SIZE; ++i) {
+        plan_clear(&anon->plans[i]);
+    }
+    if (anon->cpan != NULL) {
+        cpan_destroy(anon->cpan);
+    }
+    free(anon);
+}
+
+void
+anonymizer_process(anonymizer_t *anon, ipx_msg_ipfix_t *msg)
+{
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    const struct fds_template *tmplt = NULL;
+    const struct plan *plan = NULL;
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+
+        if (rec->rec.tmplt != tmplt) {
+            // Records of the same Data Set share the template
+            tmplt = rec->rec.tmplt;
+            plan = plan_get(anon, &rec->rec);
+        }
+
+        if (plan == NULL || plan->iter) {
+            // Positions of addresses depend on the content of the record
+            anonymize_rec_iter(anon, &rec->rec);
+            continue;
+        }
+
+        for (uint16_t f = 0; f < plan->fields_cnt; ++f) {
+            const struct plan_field *field = &plan->fields[f];
+            anonymize_addr(anon, &rec->rec.data[field->offset], field->size);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * \file src/plugins/intermediate/anonymization/anonymizer.h
+ * \brief Anonymization of addresses in IPFIX Messages (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef ANONYMIZER_H
+#define ANONYMIZER_H
+
+#include <ipfixcol2.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Internal anonymizer type */
+typedef struct anonymizer anonymizer_t;
+
+/**
+ * \brief Create an anonymizer
+ * \param[in] ctx  Plugin context (only for log messages)
+ * \param[in] mode Anonymization technique
+ * \param[in] key  Crypto-PAn key of #ANON_KEY_LEN bytes (ignored in other modes)
+ * \return Pointer to the anonymizer or NULL (memory allocation error)
+ */
+anonymizer_t *
+anonymizer_create(ipx_ctx_t *ctx, enum anon_mode mode, const char *key);
+
+/**
+ * \brief Destroy an anonymizer
+ * \param[in] anon Anonymizer
+ */
+void
+anonymizer_destroy(anonymizer_t *anon);
+
+/**
+ * \brief Anonymize all IPv4/IPv6 addresses in data records of an IPFIX Message
+ *
+ * Positions of addresses in records of a template are determined only once and cached,
+ * unless an address is variable-length or follows a variable-length field. Records of such
+ * templates are always processed using the field iterator.
+ * \param[in] anon Anonymizer
+ * \param[in] msg  IPFIX Message
+ */
+void
+anonymizer_process(anonymizer_t *anon, ipx_msg_ipfix_t *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANONYMIZER_H
@@ -0,0 +1,391 @@
+/**
+ * \file src/plugins/intermediate/anonymization/cryptopan.c
+ * \brief Crypto-PAn anonymization with prefix caches and AES-NI acceleration
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h>
+#define CPAN_HAVE_AESNI 1
+#endif
+
+#include "cryptopan.h"
+#include "Crypto-PAn/rijndael.h"
+
+/*
+ * Crypto-PAn generates i-th bit of a one-time pad by encryption of a block that consists of
+ * the first i bits of the address and the rest of the secret pad. Therefore, the first N bits
+ * of the one-time pad depend only on the N-bit prefix of the address, which allows us to cache
+ * them for popular prefixes (/24 for IPv4, /48 for IPv6). Moreover, all blocks of an address
+ * are independent, so they can be encrypted at once and AES-NI rounds can be pipelined.
+ */
+
+/** Number of records of each cache (must be a power of two)           */
+#define CPAN_CACHE_SIZE 4096U
+/** IPv4 prefix length of the prefix cache                             */
+#define CPAN_V4_PREFIX 24U
+/** IPv6 prefix length of the prefix cache (must be a multiple of 8)   */
+#define CPAN_V6_PREFIX 48U
+/** Number of blocks encrypted at once by AES-NI                       */
+#define CPAN_AESNI_WIDTH 8U
+
+/** Cache record of IPv4 addresses (full addresses or prefixes)        */
+struct cpan_v4_rec {
+    /** Original address (or prefix)                                  */
+    uint32_t addr;
+    /** Anonymized address (or the one-time pad of the prefix)        */
+    uint32_t anon;
+    /** The record is valid                                           */
+    bool valid;
+};
+
+/** Cache record of IPv6 addresses (full addresses or prefixes)        */
+struct cpan_v6_rec {
+    /** Original address (or prefix, the rest is zeroed)              */
+    uint8_t addr[16];
+    /** Anonymized address (or the one-time pad of the prefix)        */
+    uint8_t anon[16];
+    /** The record is valid                                           */
+    bool valid;
+};
+
+/** Function for encryption of multiple 128b blocks                    */
+typedef void (*cpan_encrypt_fn)(const cpan_t *cpan, const uint8_t (*in)[16], uint8_t (*out)[16],
+    unsigned int cnt);
+
+struct cpan {
+#ifdef CPAN_HAVE_AESNI
+    /** AES-128 round keys (only if AES-NI is used)                   */
+    __m128i round_keys[11];
+#endif
+    /** Key schedule of the bundled Rijndael implementation (otherwise) */
+    Rijndael_ctx rijndael;
+    /** Encryption function                                           */
+    cpan_encrypt_fn encrypt;
+    /** Encrypted secret pad                                          */
+    uint8_t pad[16];
+
+    /** Cache of full IPv4 addresses                                  */
+    struct cpan_v4_rec v4_full[CPAN_CACHE_SIZE];
+    /** Cache of one-time pads of IPv4 prefixes                       */
+    struct cpan_v4_rec v4_prefix[CPAN_CACHE_SIZE];
+    /** Cache of full IPv6 addresses                                  */
+    struct cpan_v6_rec v6_full[CPAN_CACHE_SIZE];
+    /** Cache of one-time pads of IPv6 prefixes                       */
+    struct cpan_v6_rec v6_prefix[CPAN_CACHE_SIZE];
+};
+
+/**
+ * \brief Encrypt blocks using the bundled Rijndael implementation
+ */
+static void
+cpan_encrypt_sw(const cpan_t *cpan, const uint8_t (*in)[16], uint8_t (*out)[16], unsigned int cnt)
+{
+    for (unsigned int i = 0; i < cnt; ++i) {
+        Rijndael_ctxEncrypt(&cpan->rijndael, in[i], out[i]);
+    }
+}
+
+#ifdef CPAN_HAVE_AESNI
+/**
+ * \brief Expand an AES-128 key (one step)
+ */
+__attribute__((target("aes,sse2")))
+static inline __m128i
+cpan_aesni_expand_step(__m128i key, __m128i keygened)
+{
+    keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(3, 3, 3, 3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, keygened);
+}
+
+/**
+ * \brief Expand an AES-128 key into round keys
+ */
+__attribute__((target("aes,sse2")))
+static void
+cpan_aesni_init(cpan_t *cpan, const uint8_t key[16])
+{
+    __m128i *rk = cpan->round_keys;
+    rk[0] = _mm_loadu_si128((const __m128i *) key);
+#define CPAN_EXPAND(idx, rcon) \
+    rk[idx] = cpan_aesni_expand_step(rk[idx - 1], _mm_aeskeygenassist_si128(rk[idx - 1], rcon))
+    CPAN_EXPAND(1, 0x01);
+    CPAN_EXPAND(2, 0x02);
+    CPAN_EXPAND(3, 0x04);
+    CPAN_EXPAND(4, 0x08);
+    CPAN_EXPAND(5, 0x10);
+    CPAN_EXPAND(6, 0x20);
+    CPAN_EXPAND(7, 0x40);
+    CPAN_EXPAND(8, 0x80);
+    CPAN_EXPAND(9, 0x1B);
+    CPAN_EXPAND(10, 0x36);
+#undef CPAN_EXPAND
+}
+
+/**
+ * \brief Encrypt blocks using AES-NI
+ *
+ * Up to #CPAN_AESNI_WIDTH blocks go through the rounds together, so latencies of AES
+ * instructions are hidden.
+ */
+__attribute__((target("aes,sse2")))
+static void
+cpan_encrypt_aesni(const cpan_t *cpan, const uint8_t (*in)[16], uint8_t (*out)[16],
+    unsigned int cnt)
+{
+    const __m128i *rk = cpan->round_keys;
+    __m128i state[CPAN_AESNI_WIDTH];
+
+    for (unsigned int base = 0; base < cnt; base += CPAN_AESNI_WIDTH) {
+        const unsigned int part = (cnt - base < CPAN_AESNI_WIDTH) ? cnt - base : CPAN_AESNI_WIDTH;
+
+        for (unsigned int i = 0; i < part; ++i) {
+            state[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in[base + i]), rk[0]);
+        }
+        for (unsigned int r = 1; r < 10; ++r) {
+            for (unsigned int i = 0; i < part; ++i) {
+                state[i] = _mm_aesenc_si128(state[i], rk[r]);
+            }
+        }
+        for (unsigned int i = 0; i < part; ++i) {
+            state[i] = _mm_aesenclast_si128(state[i], rk[10]);
+            _mm_storeu_si128((__m128i *) out[base + i], state[i]);
+        }
+    }
+}
+#endif // CPAN_HAVE_AESNI
+
+cpan_t *
+cpan_create(const uint8_t *key, bool sw_only)
+{
+    cpan_t *cpan;
+    if (posix_memalign((void **) &cpan, 64, sizeof(*cpan)) != 0) {
+        return NULL;
+    }
+
+    memset(cpan, 0, sizeof(*cpan));
+    cpan->encrypt = &cpan_encrypt_sw;
+
+#ifdef CPAN_HAVE_AESNI
+    __builtin_cpu_init();
+    if (!sw_only && __builtin_cpu_supports("aes")) {
+        cpan_aesni_init(cpan, key);
+        cpan->encrypt = &cpan_encrypt_aesni;
+    }
+#endif
+
+    if (cpan->encrypt == &cpan_encrypt_sw) {
+        // The first half of the key is the key of the cipher
+        Rijndael_ctxInit(&cpan->rijndael, key, Key16Bytes);
+    }
+
+    // The secret pad is encrypted before being used for padding
+    const uint8_t (*pad_in)[16] = (const uint8_t (*)[16]) &key[16];
+    cpan->encrypt(cpan, pad_in, &cpan->pad, 1);
+    return cpan;
+}
+
+void
+cpan_destroy(cpan_t *cpan)
+{
+    free(cpan);
+}
+
+bool
+cpan_aesni(const cpan_t *cpan)
+{
+    return cpan->encrypt != &cpan_encrypt_sw;
+}
+
+/**
+ * \brief Get a cache index of a value
+ */
+static inline uint32_t
+cpan_cache_idx(uint64_t value)
+{
+    return (uint32_t) ((value * 0x9E3779B97F4A7C15ULL) >> 32) & (CPAN_CACHE_SIZE - 1);
+}
+
+/**
+ * \brief Compute bits of the one-time pad of an IPv4 address
+ * \param[in] cpan Context
+ * \param[in] addr Address (in host byte order)
+ * \param[in] from First bit position (0 == MSB)
+ * \param[in] to   Last bit position (excluded)
+ * \return Bits of the one-time pad at the given positions (other bits are zeros)
+ */
+static uint32_t
+cpan_v4_otp(const cpan_t *cpan, uint32_t addr, unsigned int from, unsigned int to)
+{
+    uint8_t in[32][16];
+    uint8_t out[32][16];
+    const uint32_t pad4 = ((uint32_t) cpan->pad[0] << 24) | ((uint32_t) cpan->pad[1] << 16)
+        | ((uint32_t) cpan->pad[2] << 8) | (uint32_t) cpan->pad[3];
+
+    for (unsigned int pos = from; pos < to; ++pos) {
+        // The most significant "pos" bits are taken from the address, the rest from the pad
+        const uint32_t mask = (pos == 0) ? 0 : (UINT32_MAX << (32 - pos));
+        const uint32_t first4 = (addr & mask) | (pad4 & ~mask);
+        uint8_t *block = in[pos - from];
+
+        memcpy(block, cpan->pad, 16);
+        block[0] = (uint8_t) (first4 >> 24);
+        block[1] = (uint8_t) (first4 >> 16);
+        block[2] = (uint8_t) (first4 >> 8);
+        block[3] = (uint8_t) first4;
+    }
+
+    cpan->encrypt(cpan, (const uint8_t (*)[16]) in, out, to - from);
+
+    uint32_t result = 0;
+    for (unsigned int pos = from; pos < to; ++pos) {
+        // Only the first bit of each encrypted block is used
+        result |= (uint32_t) (out[pos - from][0] >> 7) << (31 - pos);
+    }
+    return result;
+}
+
+uint32_t
+cpan_anon_v4(cpan_t *cpan, uint32_t addr)
+{
+    struct cpan_v4_rec *full = &cpan->v4_full[cpan_cache_idx(addr)];
+    if (full->valid && full->addr == addr) {
+        return full->anon;
+    }
+
+    const uint32_t prefix = addr & (UINT32_MAX << (32 - CPAN_V4_PREFIX));
+    struct cpan_v4_rec *pref = &cpan->v4_prefix[cpan_cache_idx(prefix)];
+    uint32_t otp;
+
+    if (pref->valid && pref->addr == prefix) {
+        otp = pref->anon;
+        otp |= cpan_v4_otp(cpan, addr, CPAN_V4_PREFIX, 32);
+    } else {
+        // Compute all bits at once and remember the prefix part
+        otp = cpan_v4_otp(cpan, addr, 0, 32);
+        pref->addr = prefix;
+        pref->anon = otp & (UINT32_MAX << (32 - CPAN_V4_PREFIX));
+        pref->valid = true;
+    }
+
+    full->addr = addr;
+    full->anon = otp ^ addr;
+    full->valid = true;
+    return full->anon;
+}
+
+/**
+ * \brief Compute bits of the one-time pad of an IPv6 address
+ * \note Bits are stored in the same (reversed within each byte) order as by the original
+ *   implementation.
+ * \param[in]    cpan Context
+ * \param[in]    addr Address (in network byte order)
+ * \param[in]    from First bit position (0 == MSB)
+ * \param[in]    to   Last bit position (excluded)
+ * \param[inout] otp  One-time pad to which the bits are added
+ */
+static void
+cpan_v6_otp(const cpan_t *cpan, const uint8_t addr[16], unsigned int from, unsigned int to,
+    uint8_t otp[16])
+{
+    uint8_t in[128][16];
+    uint8_t out[128][16];
+
+    for (unsigned int pos = from; pos < to; ++pos) {
+        const unsigned int bit_num = pos & 0x7;
+        const unsigned int left_byte = pos >> 3;
+        uint8_t *block = in[pos - from];
+
+        /* The most significant bits are taken from the address, the rest from the pad. Note:
+         * The middle byte is computed exactly as by the original implementation (i.e. with
+         * integer promotion), otherwise, the mapping would be different. */
+        memcpy(block, addr, left_byte);
+        block[left_byte] = (uint8_t) ((addr[left_byte] >> (7 - bit_num) << (7 - bit_num))
+            | ((cpan->pad[left_byte] << bit_num) >> bit_num));
+        memcpy(&block[left_byte + 1], &cpan->pad[left_byte + 1], 15 - left_byte);
+    }
+
+    cpan->encrypt(cpan, (const uint8_t (*)[16]) in, out, to - from);
+
+    for (unsigned int pos = from; pos < to; ++pos) {
+        otp[pos >> 3] |= (uint8_t) ((out[pos - from][0] >> 7) << (pos & 0x7));
+    }
+}
+
+void
+cpan_anon_v6(cpan_t *cpan, const uint8_t addr[16], uint8_t res[16])
+{
+    uint64_t key[2];
+    memcpy(key, addr, 16);
+    struct cpan_v6_rec *full = &cpan->v6_full[cpan_cache_idx(key[0] ^ (key[1] * 31))];
+    if (full->valid && memcmp(full->addr, addr, 16) == 0) {
+        memcpy(res, full->anon, 16);
+        return;
+    }
+
+    const unsigned int prefix_bytes = CPAN_V6_PREFIX / 8;
+    uint8_t prefix[16] = {0};
+    memcpy(prefix, addr, prefix_bytes);
+    memcpy(key, prefix, 16);
+    struct cpan_v6_rec *pref = &cpan->v6_prefix[cpan_cache_idx(key[0] ^ (key[1] * 31))];
+    uint8_t otp[16] = {0};
+
+    if (pref->valid && memcmp(pref->addr, prefix, 16) == 0) {
+        memcpy(otp, pref->anon, 16);
+        cpan_v6_otp(cpan, addr, CPAN_V6_PREFIX, 128, otp);
+    } else {
+        // Compute all bits at once and remember the prefix part
+        cpan_v6_otp(cpan, addr, 0, 128, otp);
+        memcpy(pref->addr, prefix, 16);
+        memset(pref->anon, 0, 16);
+        memcpy(pref->anon, otp, prefix_bytes);
+        pref->valid = true;
+    }
+
+    for (unsigned int i = 0; i < 16; ++i) {
+        full->anon[i] = otp[i] ^ addr[i];
+    }
+    memcpy(full->addr, addr, 16);
+    full->valid = true;
+    memcpy(res, full->anon, 16);
+}
@@ -0,0 +1,100 @@
+/**
+ * \file src/plugins/intermediate/anonymization/cryptopan.h
+ * \brief Crypto-PAn anonymization with prefix caches and AES-NI acceleration
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CRYPTOPAN_H
+#define CRYPTOPAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Length of the Crypto-PAn key (the first half is the AES key, the second one is the pad) */
+#define CPAN_KEY_LEN 32
+
+/** Internal Crypto-PAn context */
+typedef struct cpan cpan_t;
+
+/**
+ * \brief Create a Crypto-PAn context
+ *
+ * The mapping of addresses is the same as the mapping of the original implementation (see
+ * Crypto-PAn/panonymizer.h). If the CPU supports AES-NI instructions, they are used to
+ * encrypt multiple blocks at once. Otherwise, the bundled Rijndael implementation is used.
+ * Each context has its own key schedule, i.e. contexts with different keys can be used at
+ * the same time.
+ * \param[in] key     Key of #CPAN_KEY_LEN bytes
+ * \param[in] sw_only Use the bundled Rijndael implementation even if AES-NI is available
+ * \return Pointer to the context or NULL (memory allocation error)
+ */
+cpan_t *
+cpan_create(const uint8_t *key, bool sw_only);
+
+/**
+ * \brief Destroy a Crypto-PAn context
+ * \param[in] cpan Context
+ */
+void
+cpan_destroy(cpan_t *cpan);
+
+/**
+ * \brief Is AES-NI used by the context?
+ * \param[in] cpan Context
+ */
+bool
+cpan_aesni(const cpan_t *cpan);
+
+/**
+ * \brief Anonymize an IPv4 address
+ * \param[in] cpan Context
+ * \param[in] addr Address (in host byte order)
+ * \return Anonymized address (in host byte order)
+ */
+uint32_t
+cpan_anon_v4(cpan_t *cpan, uint32_t addr);
+
+/**
+ * \brief Anonymize an IPv6 address
+ * \param[in]  cpan Context
+ * \param[in]  addr Address (in network byte order)
+ * \param[out] res  Anonymized address (in network byte order)
+ */
+void
+cpan_anon_v6(cpan_t *cpan, const uint8_t addr[16], uint8_t res[16]);
+
+#endif // CRYPTOPAN_H
@@ -47,11 +47,13 @@
 #include <assert.h>
 #include <time.h> // timespec
 #include <stdbool.h>
+#include <string.h>
 
 #include <stdio.h>
 
 #include "config.h"
 #include "msg_builder.h"
+#include "refs.h"
 
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .type = IPX_PT_INTERMEDIATE,
@@ -62,10 +64,47 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.0.0"
 };
 
+/** Number of records of the per-template cache (must be a power of two) */
+#define TMPLT_CACHE_SIZE 256U
+
+/** Record of the per-template cache */
+struct tmplt_cache_rec {
+    /** Identification of the template                                       */
+    struct ipx_tmplt_id id;
+    /** At least one field referenced by the expression is in the template   */
+    bool has_refs;
+};
+
+/** Result of the filter that doesn't depend on the record */
+enum const_verdict {
+    VERDICT_UNKNOWN = 0,
+    VERDICT_MATCH,
+    VERDICT_NO_MATCH
+};
+
 struct plugin_ctx {
     struct config *config;
     fds_ipfix_filter_t *filter;
     ipx_ctx_t *ipx_ctx;
+    /** Manager of IEs the filter has been compiled with (and its fields resolved) */
+    const fds_iemgr_t *filter_iemgr;
+
+    /** Fields referenced by the expression (valid only if refs_valid)      */
+    struct filter_refs refs;
+    /** Fields of the expression are known, so the per-template cache can be used */
+    bool refs_valid;
+
+    /**
+     * Result of the expression for records without any referenced field
+     * (evaluated on the first such record, same for all templates)
+     */
+    enum const_verdict verdict;
+    /** Per-template cache (direct mapped)                                   */
+    struct tmplt_cache_rec cache[TMPLT_CACHE_SIZE];
+
+    /** Results of records of the current message                            */
+    bool *matches;
+    size_t matches_size;
 };
 
 struct plugin_ctx *
@@ -78,17 +117,92 @@ create_plugin_ctx()
     return pctx;
 }
 
+/**
+ * Invalidate all records of the per-template cache and the verdict
+ */
+static void
+tmplt_cache_clear(struct plugin_ctx *pctx)
+{
+    for (size_t i = 0; i < TMPLT_CACHE_SIZE; i++) {
+        ipx_tmplt_id_clear(&pctx->cache[i].id);
+    }
+    pctx->verdict = VERDICT_UNKNOWN;
+}
+
 void
 destroy_plugin_ctx(struct plugin_ctx *pctx)
 {
     if (!pctx) {
         return;
     }
+    tmplt_cache_clear(pctx);
+    free(pctx->matches);
+    filter_refs_clear(&pctx->refs);
     config_destroy(pctx->config);
     fds_ipfix_filter_destroy(pctx->filter);
     free(pctx);
 }
 
+/**
+ * Compile the filter expression and find the fields it references using a manager of IEs
+ *
+ * Both are always done with the same manager, so the per-template cache is consistent with
+ * the identifiers resolved by the filter.
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the expression cannot be compiled (the previous filter is kept)
+ * \return #IPX_ERR_NOMEM on memory allocation error
+ */
+static int
+filter_update(struct plugin_ctx *pctx, const fds_iemgr_t *iemgr)
+{
+    fds_ipfix_filter_t *filter = NULL;
+    int rc = fds_ipfix_filter_create(&filter, iemgr, pctx->config->expr);
+    if (rc != FDS_OK) {
+        const char *error = fds_ipfix_filter_get_error(filter);
+        IPX_CTX_ERROR(pctx->ipx_ctx, "Error creating filter: %s", error);
+        fds_ipfix_filter_destroy(filter);
+        return IPX_ERR_FORMAT;
+    }
+
+    fds_ipfix_filter_destroy(pctx->filter);
+    pctx->filter = filter;
+    pctx->filter_iemgr = iemgr;
+    tmplt_cache_clear(pctx);
+
+    rc = filter_refs_parse(&pctx->refs, iemgr, pctx->config->expr);
+    if (rc == IPX_ERR_NOMEM) {
+        pctx->refs_valid = false;
+        IPX_CTX_ERROR(pctx->ipx_ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return rc;
+    }
+
+    pctx->refs_valid = (rc == IPX_OK);
+    if (!pctx->refs_valid) {
+        IPX_CTX_WARNING(pctx->ipx_ctx, "Unable to analyze the filter expression. All records will "
+            "be evaluated one by one.", '\0');
+    }
+    return IPX_OK;
+}
+
+/**
+ * Check (cached) if the result of the expression might depend on content of records
+ * of the given template
+ */
+static bool
+tmplt_cache_has_refs(struct plugin_ctx *pctx, const struct fds_drec *rec)
+{
+    struct tmplt_cache_rec *cache_rec =
+        &pctx->cache[ipx_tmplt_id_hash(rec->tmplt) & (TMPLT_CACHE_SIZE - 1)];
+    if (ipx_tmplt_id_match(&cache_rec->id, rec->tmplt, rec->snap)) {
+        return cache_rec->has_refs;
+    }
+
+    // If it's not possible to cache the result (memory allocation error), just return it
+    cache_rec->has_refs = filter_refs_in_tmplt(&pctx->refs, rec->tmplt);
+    ipx_tmplt_id_set(&cache_rec->id, rec->tmplt, rec->snap);
+    return cache_rec->has_refs;
+}
+
 static inline bool
 record_belongs_to_set(struct fds_ipfix_set_hdr *set, struct fds_drec *record)
 {
@@ -118,13 +232,8 @@ ipx_plugin_init(ipx_ctx_t *ipx_ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
-    // Create the opts
-    int rc = fds_ipfix_filter_create(&pctx->filter,
-        ipx_ctx_iemgr_get(ipx_ctx), pctx->config->expr);
-
-    if (rc != FDS_OK) {
-        const char *error = fds_ipfix_filter_get_error(pctx->filter);
-        IPX_CTX_ERROR(ipx_ctx, "Error creating filter: %s", error);
+    // Create the filter and find referenced fields for the per-template cache
+    if (filter_update(pctx, ipx_ctx_iemgr_get(ipx_ctx)) != IPX_OK) {
         destroy_plugin_ctx(pctx);
         return IPX_ERR_DENIED;
     }
@@ -140,6 +249,71 @@ ipx_plugin_destroy(ipx_ctx_t *ipx_ctx, void *data)
     destroy_plugin_ctx(data);
 }
 
+/**
+ * Evaluate all records of the message
+ *
+ * Data Sets of templates that don't contain any field referenced by the expression are
+ * evaluated only once as the result is the same for all their records.
+ * \param[out] match_cnt Number of matching records
+ */
+static int
+evaluate_records(struct plugin_ctx *pctx, ipx_msg_ipfix_t *msg, size_t *match_cnt)
+{
+    const uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    size_t cnt = 0;
+
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(pctx->ipx_ctx);
+    if (iemgr != pctx->filter_iemgr) {
+        // Identifiers of the expression might refer to different fields now
+        if (filter_update(pctx, iemgr) != IPX_OK) {
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    if (drec_cnt > pctx->matches_size) {
+        bool *new_matches = realloc(pctx->matches, drec_cnt * sizeof(*new_matches));
+        if (!new_matches) {
+            IPX_CTX_ERROR(pctx->ipx_ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+        pctx->matches = new_matches;
+        pctx->matches_size = drec_cnt;
+    }
+
+    const struct fds_template *tmplt_prev = NULL;
+    bool tmplt_refs = true;
+
+    for (uint32_t idx = 0; idx < drec_cnt; idx++) {
+        struct ipx_ipfix_record *drec = ipx_msg_ipfix_get_drec(msg, idx);
+        const struct fds_template *tmplt = drec->rec.tmplt;
+        bool match;
+
+        if (tmplt != tmplt_prev) {
+            // Records of the same Data Set share the template
+            tmplt_refs = !pctx->refs_valid || tmplt_cache_has_refs(pctx, &drec->rec);
+            tmplt_prev = tmplt;
+        }
+
+        if (tmplt_refs) {
+            match = (fds_ipfix_filter_eval_biflow(pctx->filter, &drec->rec)
+                != FDS_IPFIX_FILTER_NO_MATCH);
+        } else {
+            if (pctx->verdict == VERDICT_UNKNOWN) {
+                // The result doesn't depend on the record, evaluate it only once
+                pctx->verdict = (fds_ipfix_filter_eval_biflow(pctx->filter, &drec->rec)
+                    != FDS_IPFIX_FILTER_NO_MATCH) ? VERDICT_MATCH : VERDICT_NO_MATCH;
+            }
+            match = (pctx->verdict == VERDICT_MATCH);
+        }
+
+        pctx->matches[idx] = match;
+        cnt += match;
+    }
+
+    *match_cnt = cnt;
+    return IPX_OK;
+}
+
 int
 ipx_plugin_process(ipx_ctx_t *ipx_ctx, void *data, ipx_msg_t *base_msg)
 {
@@ -153,10 +327,24 @@ ipx_plugin_process(ipx_ctx_t *ipx_ctx, void *data, ipx_msg_t *base_msg)
 
     // Get the ipfix message
     ipx_msg_ipfix_t *orig_msg = ipx_msg_base2ipfix(base_msg);
+    const uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(orig_msg);
+
+    // Evaluate all records first
+    size_t match_cnt;
+    int rc = evaluate_records(pctx, orig_msg, &match_cnt);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    if (match_cnt == drec_cnt && drec_cnt != 0) {
+        // All records match, pass the original message
+        ipx_ctx_msg_pass(ipx_ctx, base_msg);
+        return IPX_OK;
+    }
 
     // Initialize message builder
     msg_builder_s mb;
-    int rc = msg_builder_init(&mb, ipx_ctx, orig_msg);
+    rc = msg_builder_init(&mb, ipx_ctx, orig_msg);
     if (rc != IPX_OK) {
         IPX_CTX_ERROR(ipx_ctx, "Error initializing message builder");
         return rc;
@@ -199,7 +387,7 @@ ipx_plugin_process(ipx_ctx_t *ipx_ctx, void *data, ipx_msg_t *base_msg)
                 break;
             }
 
-            if (fds_ipfix_filter_eval_biflow(pctx->filter, &drec->rec) != FDS_IPFIX_FILTER_NO_MATCH) {
+            if (pctx->matches[drec_idx]) {
                 rc = msg_builder_copy_drec(&mb, drec);
                 if (rc != IPX_OK) {
                     IPX_CTX_ERROR(ipx_ctx, "Error copying data record");
@@ -235,4 +423,4 @@ ipx_plugin_process(ipx_ctx_t *ipx_ctx, void *data, ipx_msg_t *base_msg)
     }
 
     return IPX_OK;
-}
\ No newline at end of file
+}
@@ -0,0 +1,191 @@
+/**
+ * \file src/plugins/intermediate/filter/refs.c
+ * \brief Fields referenced by a filter expression (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "refs.h"
+
+/** Maximum length of an identifier that can be resolved */
+#define IDENT_MAX_LEN 255U
+
+/**
+ * Add a referenced field (if not present yet)
+ */
+static int
+refs_add(struct filter_refs *refs, const struct fds_iemgr_elem *elem)
+{
+    const uint32_t en = elem->scope->pen;
+    const uint16_t id = elem->id;
+
+    for (size_t i = 0; i < refs->cnt; i++) {
+        if (refs->fields[i].en == en && refs->fields[i].id == id) {
+            return IPX_OK;
+        }
+    }
+
+    struct field_ref *new_fields = realloc(refs->fields, (refs->cnt + 1) * sizeof(*new_fields));
+    if (!new_fields) {
+        return IPX_ERR_NOMEM;
+    }
+
+    refs->fields = new_fields;
+    refs->fields[refs->cnt].en = en;
+    refs->fields[refs->cnt].id = id;
+    refs->cnt++;
+    return IPX_OK;
+}
+
+/**
+ * Add fields referenced by an identifier of the expression (if it's a field at all)
+ */
+static int
+refs_add_ident(struct filter_refs *refs, const fds_iemgr_t *iemgr, const char *name)
+{
+    const struct fds_iemgr_alias *alias = fds_iemgr_alias_find(iemgr, name);
+    if (alias) {
+        for (size_t i = 0; i < alias->sources_cnt; i++) {
+            if (refs_add(refs, alias->sources[i]) != IPX_OK) {
+                return IPX_ERR_NOMEM;
+            }
+        }
+        return IPX_OK;
+    }
+
+    const struct fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, name);
+    if (!elem && strchr(name, ':') == NULL) {
+        // The "iana:" prefix can be omitted
+        char iana_name[IDENT_MAX_LEN + 6];
+        snprintf(iana_name, sizeof(iana_name), "iana:%s", name);
+        elem = fds_iemgr_elem_find_name(iemgr, iana_name);
+    }
+
+    if (elem) {
+        return refs_add(refs, elem);
+    }
+
+    // Keywords, value mappings, MAC/IPv6 addresses, etc.
+    return IPX_OK;
+}
+
+int
+filter_refs_parse(struct filter_refs *refs, const fds_iemgr_t *iemgr, const char *expr)
+{
+    const char *pos = expr;
+    char name[IDENT_MAX_LEN + 1];
+
+    filter_refs_clear(refs);
+
+    while (*pos != '\0') {
+        if (*pos == '"') {
+            // Skip string literals (including escape sequences)
+            for (pos++; *pos != '\0' && *pos != '"'; pos++) {
+                if (*pos == '\\' && pos[1] != '\0') {
+                    pos++;
+                }
+            }
+            if (*pos == '"') {
+                pos++;
+            }
+            continue;
+        }
+
+        if (!isalnum((unsigned char) *pos) && *pos != '_') {
+            pos++;
+            continue;
+        }
+
+        // Identifier or a number/address
+        const char *begin = pos;
+        while (*pos != '\0' && (isalnum((unsigned char) *pos) || strchr("_:@.", *pos) != NULL)) {
+            pos++;
+        }
+
+        const size_t len = (size_t) (pos - begin);
+        if (isdigit((unsigned char) *begin)) {
+            continue; // Numbers, IPv4 addresses, timestamps, etc.
+        }
+        if (len > IDENT_MAX_LEN) {
+            filter_refs_clear(refs);
+            return IPX_ERR_FORMAT;
+        }
+
+        memcpy(name, begin, len);
+        name[len] = '\0';
+        if (refs_add_ident(refs, iemgr, name) != IPX_OK) {
+            filter_refs_clear(refs);
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    return IPX_OK;
+}
+
+bool
+filter_refs_in_tmplt(const struct filter_refs *refs, const struct fds_template *tmplt)
+{
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; i++) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        const struct fds_tfield *field_rev = (tmplt->fields_rev) ? &tmplt->fields_rev[i] : NULL;
+
+        for (size_t r = 0; r < refs->cnt; r++) {
+            const struct field_ref *ref = &refs->fields[r];
+            if (field->en == ref->en && field->id == ref->id) {
+                return true;
+            }
+            if (field_rev && field_rev->en == ref->en && field_rev->id == ref->id) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void
+filter_refs_clear(struct filter_refs *refs)
+{
+    free(refs->fields);
+    refs->fields = NULL;
+    refs->cnt = 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * \file src/plugins/intermediate/filter/refs.h
+ * \brief Fields referenced by a filter expression (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef FILTER_REFS_H
+#define FILTER_REFS_H
+
+#include <libfds.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Identification of an IPFIX field referenced by the filter expression */
+struct field_ref {
+    uint32_t en;
+    uint16_t id;
+};
+
+/** Set of IPFIX fields referenced by the filter expression */
+struct filter_refs {
+    /** Referenced fields                                     */
+    struct field_ref *fields;
+    /** Number of referenced fields                           */
+    size_t cnt;
+};
+
+/**
+ * \brief Find all fields referenced by a filter expression
+ *
+ * Identifiers of the expression are resolved the same way as by the filter, i.e. as aliases
+ * and names of Information Elements (the "iana:" prefix can be omitted). String literals,
+ * numbers, addresses, keywords and value mappings cannot refer to content of records and are
+ * ignored. Previous content of \p refs is replaced.
+ * \param[in,out] refs  Set of referenced fields
+ * \param[in]     iemgr Manager of Information Elements used by the filter
+ * \param[in]     expr  Filter expression
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if an identifier cannot be analyzed (\p refs is empty)
+ * \return #IPX_ERR_NOMEM on memory allocation error (\p refs is empty)
+ */
+int
+filter_refs_parse(struct filter_refs *refs, const fds_iemgr_t *iemgr, const char *expr);
+
+/**
+ * \brief Check if a template contains at least one of the referenced fields
+ *
+ * Reverse fields of biflow templates are considered too.
+ * \param[in] refs  Set of referenced fields
+ * \param[in] tmplt Template
+ */
+bool
+filter_refs_in_tmplt(const struct filter_refs *refs, const struct fds_template *tmplt);
+
+/**
+ * \brief Remove all referenced fields
+ * \param[in] refs Set of referenced fields
+ */
+void
+filter_refs_clear(struct filter_refs *refs);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // FILTER_REFS_H
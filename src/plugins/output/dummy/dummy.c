@@ -59,8 +59,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "dummy",
     // Brief description of plugin
     .dsc = "Example output plugin.",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (instances have no shared state, multiple workers are allowed)
+    .flags = IPX_PF_OUTPUT_WORKERS,
     // Plugin version string (like "1.2.3")
     .version = "2.2.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -22,6 +22,7 @@
  *     <align>...</align>                 <!-- optional -->
  *   </dumpInterval>
  *   <asyncIO>...</asyncIO>               <!-- optional -->
+ *   <writerQueue>...</writerQueue>       <!-- optional -->
  *   <outputSelection>                    <!-- optional -->
  *     <element>...</element>
  *     <element>...</element>
@@ -36,6 +37,7 @@ enum params_xml_nodes {
     NODE_COMPRESS,
     NODE_DUMP,
     NODE_ASYNCIO,
+    NODE_WQUEUE,
     NODE_SELECTION,
 
     DUMP_WINDOW,
@@ -64,6 +66,7 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_COMPRESS,    "compression",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_DUMP,      "dumpInterval",       args_dump,         FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_ASYNCIO,     "asyncIO",            FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_WQUEUE,      "writerQueue",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_SELECTION, "outputSelection",    args_selection,    FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -106,6 +109,7 @@ Config::set_default()
     m_path.clear();
     m_calg = calg::NONE;
     m_async = true;
+    m_writer_queue = 0;
 
     m_window.align = true;
     m_window.size = WINDOW_SIZE;
@@ -166,6 +170,15 @@ Config::parse_root(fds_xml_ctx_t *ctx, const fds_iemgr_t *iemgr)
             assert(content->type == FDS_OPTS_T_BOOL);
             m_async = content->val_bool;
             break;
+        case NODE_WQUEUE:
+            // Queue of the writer thread
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > WRITER_QUEUE_MAX) {
+                throw std::runtime_error("Size of the writer queue must be between 0.."
+                    + std::to_string(WRITER_QUEUE_MAX) + "!");
+            }
+            m_writer_queue = static_cast<unsigned int>(content->val_uint);
+            break;
         case NODE_DUMP:
             // Dump window
             assert(content->type == FDS_OPTS_T_CONTEXT);
@@ -42,6 +42,8 @@ public:
     calg m_calg;
     /// Asynchronous I/O enabled
     bool m_async;
+    /// Number of blocks in the queue of the writer thread (0 == writer thread disabled)
+    unsigned int m_writer_queue;
 
     struct {
         bool     align;   ///< Enable/disable window alignment
@@ -58,6 +60,8 @@ public:
 private:
     /// Default window size
     static const uint32_t WINDOW_SIZE = 300U;
+    /// Maximal number of blocks in the queue of the writer thread
+    static const unsigned int WRITER_QUEUE_MAX = 1024U;
 
     void
     set_default();
@@ -63,6 +63,10 @@ create_modified_template(const fds_template *tmplt,
         }
     }
 
+    if (fields.empty()) {
+        // No fields selected -> the template is not stored at all
+        return;
+    }
 
     /**
     * Build the template definition...
@@ -129,59 +133,146 @@ create_modified_template(const fds_template *tmplt,
     }
 }
 
-static void
-create_modified_data_record(fds_drec &drec,
-                            const std::vector<Config::element> &selected_elements,
-                            std::vector<uint8_t> &out_buffer)
+/**
+ * @brief Compile a projection plan of Data Records described by a Template
+ *
+ * Adjacent selected fixed-length fields are merged into a single copy run. Unselected
+ * fixed-length fields only shift offsets of following operations. Variable-length fields
+ * require special handling as their size must be read from each Data Record.
+ * @param[in]  tmplt             Template
+ * @param[in]  selected_elements Fields to select
+ * @param[out] plan              Projection plan
+ */
+void
+create_projection(const fds_template *tmplt,
+                  const std::vector<Config::element> &selected_elements,
+                  proj_plan &plan)
 {
-    out_buffer.clear();
+    plan.ops.clear();
+
+    // Offset from the end of the last variable-length field
+    uint16_t offset = 0;
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; i++) {
+        const fds_tfield &field = tmplt->fields[i];
+        const bool selected = contains_element(selected_elements, field);
+
+        if (field.length == FDS_IPFIX_VAR_IE_LEN) {
+            proj_op op;
+            op.type = selected ? proj_op::type::VAR_COPY : proj_op::type::VAR_SKIP;
+            op.offset = offset;
+            op.length = 0;
+            plan.ops.push_back(op);
+            offset = 0;
+        } else if (selected) {
+            proj_op *last = plan.ops.empty() ? nullptr : &plan.ops.back();
+            if (last && last->type == proj_op::type::COPY
+                    && last->offset + last->length == offset) {
+                // Extend the previous copy run
+                last->length += field.length;
+            } else {
+                proj_op op;
+                op.type = proj_op::type::COPY;
+                op.offset = offset;
+                op.length = field.length;
+                plan.ops.push_back(op);
+            }
+            offset += field.length;
+        } else {
+            offset += field.length;
+        }
+    }
+
+    // Variable-length fields after the last selected field are irrelevant
+    while (!plan.ops.empty() && plan.ops.back().type == proj_op::type::VAR_SKIP) {
+        plan.ops.pop_back();
+    }
+}
 
+/**
+ * @brief Create a projected Data Record using a projection plan
+ *
+ * Variable-length fields are stored with the shortest possible length prefix, i.e. the same
+ * way as the fields are encoded by libfds.
+ * @param[in]  plan       Projection plan of the Template of the Data Record
+ * @param[in]  drec       Data Record to project
+ * @param[out] out_buffer Output buffer (resized to fit the Data Record, if necessary)
+ * @return Size of the projected Data Record or -1 if the Data Record is malformed
+ */
+int
+project_record(const proj_plan &plan, const fds_drec &drec, std::vector<uint8_t> &out_buffer)
+{
     /**
-     * Data record consists of a sequence of field values.
-     *
-     * Data Record:
-     *    +--------------------------------------------------+
-     *    | Field Value                                      |
-     *    +--------------------------------------------------+
-     *    | Field Value                                      |
-     *    +--------------------------------------------------+
-     *     ...
-     *    +--------------------------------------------------+
-     *    | Field Value                                      |
-     *    +--------------------------------------------------+
+     * The projected record is never longer than the original one as the original prefix of
+     * a variable-length field is at least as long as the shortest possible prefix.
      */
+    if (out_buffer.size() < drec.size) {
+        out_buffer.resize(drec.size);
+    }
+
+    const uint8_t *base = drec.data;
+    const uint8_t *end = drec.data + drec.size;
+    uint8_t *out = out_buffer.data();
+
+    for (const proj_op &op : plan.ops) {
+        const uint8_t *ptr = base + op.offset;
+
+        if (op.type == proj_op::type::COPY) {
+            if (ptr + op.length > end) {
+                return -1;
+            }
+            std::memcpy(out, ptr, op.length);
+            out += op.length;
+            continue;
+        }
+
+        /**
+         * Variable length fields are specified with 65535 in their template field length.
+         * In this case, the first octet of the field value in the data record specifies its
+         * length (of the data only, the extra octet is not included in this length).
+         *
+         * If the data were to be longer than 254, the octet is 255 and the next 2 octets are
+         * uint16 of the length.
+         */
+        if (ptr + 1 > end) {
+            return -1;
+        }
+
+        uint16_t size = *ptr++;
+        if (size == 255) {
+            if (ptr + 2 > end) {
+                return -1;
+            }
+            size = (uint16_t(ptr[0]) << 8) | ptr[1];
+            ptr += 2;
+        }
+
+        if (ptr + size > end) {
+            return -1;
+        }
 
-    fds_drec_iter iter;
-    fds_drec_iter_init(&iter, &drec, 0);
-    while (fds_drec_iter_next(&iter) != FDS_EOC) {
-        if (contains_element(selected_elements, *iter.field.info)) {
-            if (iter.field.info->length == FDS_IPFIX_VAR_IE_LEN) {
-              /**
-               * Variable length fields are specified with 65535 in their
-               * template field length. In this case, the first octet of the
-               * field value in the data record specifies its length (of the
-               * data only, the extra octet is not included in this length).
-               *
-               * If the data were to be longer than 254, the octet is 255 and the
-               * next 2 octets are uint16 of the length.
-               */
-              if (iter.field.size < 255) {
-                buf_write(out_buffer, uint8_t(iter.field.size));
-                } else {
-                    buf_write(out_buffer, uint8_t(255));
-                    buf_write(out_buffer, htons(uint16_t(iter.field.size)));
-                }
-                buf_write(out_buffer, iter.field.data, iter.field.size);
+        if (op.type == proj_op::type::VAR_COPY) {
+            if (size < 255) {
+                *out++ = uint8_t(size);
             } else {
-                buf_write(out_buffer, iter.field.data, iter.field.size);
+                *out++ = 255;
+                *out++ = uint8_t(size >> 8);
+                *out++ = uint8_t(size);
             }
+            std::memcpy(out, ptr, size);
+            out += size;
         }
+
+        base = ptr + size;
     }
+
+    return int(out - out_buffer.data());
 }
 
 Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) :
     m_ctx(ctx),
     m_path(cfg.m_path),
+    m_writer_blocks(cfg.m_writer_queue),
     m_selection_used(cfg.m_selection_used),
     m_selection(cfg.m_selection)
 {
@@ -210,6 +301,20 @@ Storage::Storage(ipx_ctx_t *ctx, const Config &cfg) :
     }
 
     m_flags |= FDS_FILE_APPEND;
+
+    if (m_writer_blocks > 0) {
+        // Expose occupancy of the queue of the asynchronous writer
+        unsigned int size_idx;
+        if (ipx_ctx_stats_plugin_add(m_ctx, "writer_queue_size", &size_idx) != IPX_OK
+                || ipx_ctx_stats_plugin_add(m_ctx, "writer_queue_fill",
+                    &m_writer_stats.queue_fill) != IPX_OK
+                || ipx_ctx_stats_plugin_add(m_ctx, "writer_stall_cnt",
+                    &m_writer_stats.stall_cnt) != IPX_OK) {
+            throw FDS_exception("Failed to register statistics of the writer!");
+        }
+
+        ipx_ctx_stats_plugin_set(m_ctx, size_idx, m_writer_blocks);
+    }
 }
 
 Storage::~Storage()
@@ -237,15 +342,10 @@ Storage::window_new(time_t ts)
         throw FDS_exception("Failed to create directory '" + std::string(dir2create) + "'");
     }
 
-    m_file.reset(fds_file_init());
-    if (!m_file) {
-        throw FDS_exception("Failed to create FDS file handler!");
-    }
-
-    if (fds_file_open(m_file.get(), new_file.c_str(), m_flags) != FDS_OK) {
-        std::string err_msg = fds_file_error(m_file.get());
-        m_file.reset();
-        throw FDS_exception("Failed to create/append file '" + new_file + "': " + err_msg);
+    if (m_writer_blocks > 0) {
+        m_file.reset(new AsyncWriter(m_ctx, new_file, m_flags, m_writer_blocks, m_writer_stats));
+    } else {
+        m_file.reset(new Writer(m_ctx, new_file, m_flags));
     }
 }
 
@@ -278,13 +378,13 @@ Storage::process_msg(ipx_msg_ipfix_t *msg)
     assert(ntohs(hdr_ptr->version) == FDS_IPFIX_VERSION && "Unexpected packet version");
     const uint32_t exp_time = ntohl(hdr_ptr->export_time);
 
-    if (fds_file_write_ctx(m_file.get(), file_ctx.id, msg_ctx->odid, exp_time) != FDS_OK) {
-        const char *err_msg = fds_file_error(m_file.get());
-        throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
-    }
+    m_file->select(file_ctx.id, msg_ctx->odid, exp_time);
 
     // Get info about the last seen Template snapshot
     struct snap_info &snap_last = file_ctx.odid2snap[msg_ctx->odid];
+    // Projection plan of the last seen Template (records are usually grouped by Templates)
+    const struct fds_template *plan_tmplt = nullptr;
+    const struct proj_plan *plan = nullptr;
 
     // For each Data Record in the file
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
@@ -299,6 +399,7 @@ Storage::process_msg(ipx_msg_ipfix_t *msg)
                 "Updating template definitions...", session_name, session_odid);
 
             tmplts_update(snap_last, rec_ptr->rec.snap);
+            plan_tmplt = nullptr;
         }
 
         // Write the Data Record
@@ -307,19 +408,41 @@ Storage::process_msg(ipx_msg_ipfix_t *msg)
         uint16_t tmplt_id = rec_ptr->rec.tmplt->id;
 
         if (m_selection_used) {
-            create_modified_data_record(rec_ptr->rec, m_selection, m_buffer);
+            if (rec_ptr->rec.tmplt != plan_tmplt) {
+                auto plan_it = snap_last.plans.find(tmplt_id);
+                plan = (plan_it != snap_last.plans.end()) ? &plan_it->second : nullptr;
+                plan_tmplt = rec_ptr->rec.tmplt;
+            }
+
+            if (!plan) {
+                // The Template is not stored (e.g. no fields have been selected) -> skip
+                continue;
+            }
+
+            int proj_size = project_record(*plan, rec_ptr->rec, m_buffer);
+            if (proj_size < 0) {
+                IPX_CTX_WARNING(m_ctx, "Malformed Data Record (Template ID %" PRIu16 ") has "
+                    "been skipped.", tmplt_id);
+                continue;
+            }
+
             rec_data = m_buffer.data();
-            rec_size = m_buffer.size();
+            rec_size = uint16_t(proj_size);
             if (rec_size == 0) {
-                // No record fields were selected -> the record is empty, skip
+                // Only zero-length fields have been selected -> the record is empty, skip
                 continue;
             }
         }
 
-        if (fds_file_write_rec(m_file.get(), tmplt_id, rec_data, rec_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(m_file.get());
-            throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
-        }
+        m_file->rec_add(tmplt_id, rec_data, rec_size);
+    }
+}
+
+void
+Storage::flush()
+{
+    if (m_file) {
+        m_file->flush();
     }
 }
 
@@ -330,8 +453,8 @@ struct tmplt_update_data {
     /// Plugin context (only for log!)
     ipx_ctx_t *ctx;
 
-    /// FDS file with specified context
-    fds_file_t *file;
+    /// Writer of the FDS file with specified context
+    Writer *file;
     /// Set of processed Templates in the snapshot
     std::set<uint16_t> ids;
     /// Whether selection is used
@@ -340,6 +463,8 @@ struct tmplt_update_data {
     std::vector<Config::element> *selection;
     /// Buffer for building modified templates
     std::vector<uint8_t> *buffer;
+    /// Projection plans of processed Templates (only if selection is used)
+    std::map<uint16_t, proj_plan> plans;
 };
 
 /**
@@ -382,36 +507,12 @@ tmplt_update_cb(const struct fds_template *tmplt, void *data)
 
         // Only now store the template ID as we're now sure that this is an active template
         info->ids.emplace(tmplt->id);
-
-        // Get definition of the Template specified in the file
-        fds_template_type old_t_type;
-        const uint8_t *old_t_data;
-        uint16_t old_t_size;
-
-        int res = fds_file_write_tmplt_get(info->file, tmplt->id, &old_t_type, &old_t_data, &old_t_size);
-        if (res != FDS_OK && res != FDS_ERR_NOTFOUND) {
-            // Something bad happened
-            const char *err_msg = fds_file_error(info->file);
-            throw FDS_exception("fds_file_write_tmplt_get() failed: " + std::string(err_msg));
-        }
-
-        // Should we add/redefine the definition of the Template
-        if (res == FDS_OK
-                && old_t_type == new_t_type
-                && old_t_size == new_t_size
-                && memcmp(old_t_data, new_t_data, new_t_size) == 0) {
-            // The same -> nothing to do
-            return info->is_ok;
-        }
-
-        // Add the definition (i.e. templates are different or the template hasn't been defined)
-        IPX_CTX_DEBUG(info->ctx, "Adding/updating definition of Template ID %" PRIu16, tmplt->id);
-
-        if (fds_file_write_tmplt_add(info->file, new_t_type, new_t_data, new_t_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(info->file);
-            throw FDS_exception("fds_file_write_tmplt_add() failed: " + std::string(err_msg));
+        if (info->selection_used) {
+            create_projection(tmplt, *info->selection, info->plans[tmplt->id]);
         }
 
+        // Add/redefine the definition of the Template, if different
+        info->file->tmplt_add(new_t_type, new_t_data, new_t_size);
     } catch (std::exception &ex) {
         // Exceptions
         IPX_CTX_ERROR(info->ctx, "Failure during update of Template ID %" PRIu16 ": %s", tmplt->id,
@@ -475,27 +576,13 @@ Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
 
     // Remove old templates that are not available in the new snapshot
     for (uint16_t tid : ids2remove) {
-        IPX_CTX_DEBUG(m_ctx, "Removing definition of Template ID %" PRIu16, tid);
-
-        int rc = fds_file_write_tmplt_remove(m_file.get(), tid);
-        if (rc == FDS_OK) {
-            continue;
-        }
-
-        // Something bad happened
-        if (rc != FDS_ERR_NOTFOUND) {
-            std::string err_msg = fds_file_error(m_file.get());
-            throw FDS_exception("fds_file_write_tmplt_remove() failed: " + err_msg);
-        }
-
-        // Weird, but not critical
-        IPX_CTX_WARNING(m_ctx, "Failed to remove undefined Template ID %" PRIu16 ". "
-            "Weird, this should not happen.", tid);
+        m_file->tmplt_remove(tid);
     }
 
     // Update information about the last update of Templates
     info.ptr = snap;
     std::swap(info.tmplt_ids, data.ids);
+    std::swap(info.plans, data.plans);
 }
 
 /**
@@ -509,7 +596,7 @@ Storage::tmplts_update(struct snap_info &info, const fds_tsnapshot_t *snap)
 std::string
 Storage::filename_gen(const time_t &ts)
 {
-    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S.fds";
+    const char pattern[] = "%Y/%m/%d/flows.%Y%m%d%H%M%S";
     constexpr size_t buffer_size = 64;
     char buffer_data[buffer_size];
 
@@ -526,8 +613,17 @@ Storage::filename_gen(const time_t &ts)
     if (new_path.back() != '/') {
         new_path += '/';
     }
+    new_path += buffer_data;
+
+    // Each worker of the instance must write its own file
+    unsigned int worker_id;
+    unsigned int worker_cnt;
+    ipx_ctx_worker_get(m_ctx, &worker_id, &worker_cnt);
+    if (worker_cnt > 1) {
+        new_path += "." + std::to_string(worker_id);
+    }
 
-    return new_path + buffer_data;
+    return new_path + ".fds";
 }
 
 /**
@@ -569,18 +665,20 @@ Storage::session_get(const struct ipx_session *sptr)
     assert(m_file != nullptr && "File must be opened!");
 
     struct fds_file_session new_session;
-    fds_file_sid_t new_sid;
+    // Sessions are never removed from the file, i.e. keys are assigned sequentially
+    const uint32_t new_key = static_cast<uint32_t>(m_session2params.size());
 
     session_ipx2fds(sptr, &new_session);
-    if (fds_file_session_add(m_file.get(), &new_session, &new_sid) != FDS_OK) {
-        const char *err_msg = fds_file_error(m_file.get());
+    try {
+        m_file->session_add(new_key, new_session);
+    } catch (const FDS_exception &ex) {
         throw FDS_exception("Failed to register Transport Session '" + std::string(sptr->ident)
-            + "': " + err_msg);
+            + "': " + ex.what());
     }
 
     // Create a new session
     struct session_ctx &ctx = m_session2params[sptr];
-    ctx.id = new_sid;
+    ctx.id = new_key;
     return ctx;
 }
 
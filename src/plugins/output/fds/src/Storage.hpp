@@ -16,10 +16,73 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include <libfds.h>
 
 #include "Exception.hpp"
 #include "Config.hpp"
+#include "Writer.hpp"
+
+/**
+ * @brief Operation of a projection plan
+ *
+ * Offsets are relative to the end of the last preceding variable-length field (or to the
+ * beginning of the Data Record if there is no such field).
+ */
+struct proj_op {
+    /// Type of the operation
+    enum class type : uint8_t {
+        COPY,     ///< Copy a run of fixed-length fields
+        VAR_COPY, ///< Copy a variable-length field
+        VAR_SKIP  ///< Skip a variable-length field
+    } type;
+    /// Offset of the field(s)
+    uint16_t offset;
+    /// Number of bytes to copy (only for fixed-length fields)
+    uint16_t length;
+};
+
+/// Projection plan of Data Records described by a (Options) Template
+struct proj_plan {
+    /// Sequence of operations that builds the projected Data Record
+    std::vector<proj_op> ops;
+};
+
+/**
+ * @brief Create a definition of a Template with selected fields only
+ *
+ * Fields keep their order in the original Template.
+ * @param[in]  tmplt             Template
+ * @param[in]  selected_elements Fields to select
+ * @param[out] out_buffer        Raw Template record (empty if no field is selected)
+ */
+void
+create_modified_template(const fds_template *tmplt,
+                         const std::vector<Config::element> &selected_elements,
+                         std::vector<uint8_t> &out_buffer);
+
+/**
+ * @brief Compile a projection plan of Data Records described by a Template
+ * @param[in]  tmplt             Template
+ * @param[in]  selected_elements Fields to select
+ * @param[out] plan              Projection plan
+ */
+void
+create_projection(const fds_template *tmplt,
+                  const std::vector<Config::element> &selected_elements,
+                  proj_plan &plan);
+
+/**
+ * @brief Create a projected Data Record using a projection plan
+ *
+ * The projected record matches the Template created by create_modified_template().
+ * @param[in]  plan       Projection plan of the Template of the Data Record
+ * @param[in]  drec       Data Record to project
+ * @param[out] out_buffer Output buffer (resized to fit the Data Record, if necessary)
+ * @return Size of the projected Data Record or -1 if the Data Record is malformed
+ */
+int
+project_record(const proj_plan &plan, const fds_drec &drec, std::vector<uint8_t> &out_buffer);
 
 /// Flow storage file
 class Storage {
@@ -74,6 +137,16 @@ public:
     void
     process_msg(ipx_msg_ipfix_t *msg);
 
+    /**
+     * @brief Pass already processed Data Records to the file as soon as possible
+     *
+     * Useful only if the asynchronous writer is used as its blocks are otherwise submitted
+     * only when they are full.
+     * @throw FDS_exception if the writer has failed
+     */
+    void
+    flush();
+
 private:
     /// Information about Templates in a snapshot
     struct snap_info {
@@ -81,6 +154,8 @@ private:
         const fds_tsnapshot_t *ptr;
         /// Set of Template IDs in the snapshot
         std::set<uint16_t> tmplt_ids;
+        /// Projection plans of Templates in the snapshot (only if selection is used)
+        std::map<uint16_t, struct proj_plan> plans;
 
         snap_info() {
             ptr = nullptr;
@@ -90,8 +165,8 @@ private:
 
     /// Description parameters of a Transport Session
     struct session_ctx {
-        /// Session ID used in the FDS file
-        fds_file_sid_t id;
+        /// Session key used by the writer of the FDS file
+        uint32_t id;
         /// Last seen snapshot for a specific ODID of the Transport Session
         std::map<uint32_t, struct snap_info> odid2snap;
     };
@@ -102,9 +177,13 @@ private:
     std::string m_path;
     /// Flags for opening file
     uint32_t m_flags;
+    /// Number of blocks of the asynchronous writer (0 == disabled)
+    unsigned int m_writer_blocks;
+    /// Indexes of statistics of the asynchronous writer
+    struct async_stats m_writer_stats;
 
-    /// Output FDS file
-    std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
+    /// Writer of the output FDS file
+    std::unique_ptr<Writer> m_file;
     /// Output FDS file name
     std::string m_file_name;
     /// Mapping of Transport Sessions to FDS specific parameters
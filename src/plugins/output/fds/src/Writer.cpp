@@ -0,0 +1,360 @@
+/**
+ * \file src/plugins/output/fds/src/Writer.cpp
+ * \brief Writers of FDS files (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <system_error>
+#include <arpa/inet.h>
+
+#include "Writer.hpp"
+
+constexpr size_t AsyncWriter::BLOCK_SIZE;
+
+Writer::Writer(ipx_ctx_t *ctx, const std::string &path, uint32_t flags) : m_ctx(ctx)
+{
+    m_file.reset(fds_file_init());
+    if (!m_file) {
+        throw FDS_exception("Failed to create FDS file handler!");
+    }
+
+    if (fds_file_open(m_file.get(), path.c_str(), flags) != FDS_OK) {
+        std::string err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("Failed to create/append file '" + path + "': " + err_msg);
+    }
+}
+
+void
+Writer::session_add(uint32_t key, const struct fds_file_session &desc)
+{
+    assert(key == m_sids.size() && "Unexpected session key");
+    (void) key;
+
+    fds_file_sid_t new_sid;
+    if (fds_file_session_add(m_file.get(), &desc, &new_sid) != FDS_OK) {
+        const char *err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("Failed to register Transport Session: " + std::string(err_msg));
+    }
+
+    m_sids.push_back(new_sid);
+}
+
+void
+Writer::select(uint32_t key, uint32_t odid, uint32_t exp_time)
+{
+    assert(key < m_sids.size() && "Undefined session key");
+
+    if (fds_file_write_ctx(m_file.get(), m_sids[key], odid, exp_time) != FDS_OK) {
+        const char *err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
+    }
+}
+
+void
+Writer::tmplt_add(enum fds_template_type type, const uint8_t *data, uint16_t size)
+{
+    // Template ID is the first field of the Template definition
+    uint16_t tid;
+    std::memcpy(&tid, data, sizeof(tid));
+    tid = ntohs(tid);
+
+    // Get definition of the Template specified in the file
+    fds_template_type old_t_type;
+    const uint8_t *old_t_data;
+    uint16_t old_t_size;
+
+    int res = fds_file_write_tmplt_get(m_file.get(), tid, &old_t_type, &old_t_data, &old_t_size);
+    if (res != FDS_OK && res != FDS_ERR_NOTFOUND) {
+        // Something bad happened
+        const char *err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("fds_file_write_tmplt_get() failed: " + std::string(err_msg));
+    }
+
+    // Should we add/redefine the definition of the Template
+    if (res == FDS_OK
+            && old_t_type == type
+            && old_t_size == size
+            && memcmp(old_t_data, data, size) == 0) {
+        // The same -> nothing to do
+        return;
+    }
+
+    // Add the definition (i.e. templates are different or the template hasn't been defined)
+    IPX_CTX_DEBUG(m_ctx, "Adding/updating definition of Template ID %" PRIu16, tid);
+
+    if (fds_file_write_tmplt_add(m_file.get(), type, data, size) != FDS_OK) {
+        const char *err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("fds_file_write_tmplt_add() failed: " + std::string(err_msg));
+    }
+}
+
+void
+Writer::tmplt_remove(uint16_t tid)
+{
+    IPX_CTX_DEBUG(m_ctx, "Removing definition of Template ID %" PRIu16, tid);
+
+    int rc = fds_file_write_tmplt_remove(m_file.get(), tid);
+    if (rc == FDS_OK) {
+        return;
+    }
+
+    // Something bad happened
+    if (rc != FDS_ERR_NOTFOUND) {
+        std::string err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("fds_file_write_tmplt_remove() failed: " + err_msg);
+    }
+
+    // Weird, but not critical
+    IPX_CTX_WARNING(m_ctx, "Failed to remove undefined Template ID %" PRIu16 ". "
+        "Weird, this should not happen.", tid);
+}
+
+void
+Writer::rec_add(uint16_t tid, const uint8_t *data, uint16_t size)
+{
+    if (fds_file_write_rec(m_file.get(), tid, data, size) != FDS_OK) {
+        const char *err_msg = fds_file_error(m_file.get());
+        throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
+    }
+}
+
+AsyncWriter::AsyncWriter(ipx_ctx_t *ctx, const std::string &path, uint32_t flags,
+        unsigned int blocks, const struct async_stats &stats)
+    : Writer(ctx, path, flags), m_stats(stats), m_blocks_max(blocks), m_failed(false)
+{
+    if (m_blocks_max == 0) {
+        throw FDS_exception("Size of the queue of the writer cannot be zero!");
+    }
+
+    m_current.reserve(BLOCK_SIZE + UINT16_MAX + sizeof(op_hdr));
+
+    try {
+        m_thread = std::thread(&AsyncWriter::thread_main, this);
+    } catch (const std::system_error &ex) {
+        throw FDS_exception("Failed to start the writer thread: " + std::string(ex.what()));
+    }
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    if (!m_current.empty() && !m_failed) {
+        submit();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv_submit.notify_one();
+    m_thread.join();
+
+    ipx_ctx_stats_plugin_set(m_ctx, m_stats.queue_fill, 0);
+    if (m_failed && !m_reported) {
+        IPX_CTX_ERROR(m_ctx, "Writer thread failed: %s", m_error.c_str());
+    }
+}
+
+void
+AsyncWriter::session_add(uint32_t key, const struct fds_file_session &desc)
+{
+    op_push(op_type::SESSION_ADD, key, 0, 0, &desc, sizeof(desc));
+}
+
+void
+AsyncWriter::select(uint32_t key, uint32_t odid, uint32_t exp_time)
+{
+    op_push(op_type::SELECT, key, odid, exp_time, nullptr, 0);
+}
+
+void
+AsyncWriter::tmplt_add(enum fds_template_type type, const uint8_t *data, uint16_t size)
+{
+    op_push(op_type::TMPLT_ADD, static_cast<uint32_t>(type), 0, 0, data, size);
+}
+
+void
+AsyncWriter::tmplt_remove(uint16_t tid)
+{
+    op_push(op_type::TMPLT_REMOVE, tid, 0, 0, nullptr, 0);
+}
+
+void
+AsyncWriter::rec_add(uint16_t tid, const uint8_t *data, uint16_t size)
+{
+    op_push(op_type::REC_ADD, tid, 0, 0, data, size);
+}
+
+void
+AsyncWriter::flush()
+{
+    check();
+    if (!m_current.empty()) {
+        submit();
+    }
+}
+
+/**
+ * @brief Append an operation to the current block
+ *
+ * If the size of the block exceeds the limit, the block is submitted to the writer thread.
+ * @param[in] type Type of the operation
+ * @param[in] arg0 The first argument
+ * @param[in] arg1 The second argument
+ * @param[in] arg2 The third argument
+ * @param[in] data Data of the operation (can be nullptr, if @p size is zero)
+ * @param[in] size Size of the data
+ * @throw FDS_exception if the writer thread has failed
+ */
+void
+AsyncWriter::op_push(op_type type, uint32_t arg0, uint32_t arg1, uint32_t arg2,
+    const void *data, uint16_t size)
+{
+    struct op_hdr hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    hdr.type = type;
+    hdr.size = size;
+    hdr.args[0] = arg0;
+    hdr.args[1] = arg1;
+    hdr.args[2] = arg2;
+
+    m_current.append(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    if (size > 0) {
+        m_current.append(reinterpret_cast<const char *>(data), size);
+    }
+
+    if (m_current.size() >= BLOCK_SIZE) {
+        check();
+        submit();
+    }
+}
+
+/**
+ * @brief Pass the current block to the writer thread and prepare a new one
+ *
+ * If all blocks are occupied, the function waits until the writer thread processes a block.
+ */
+void
+AsyncWriter::submit()
+{
+    std::string block;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_busy >= m_blocks_max) {
+            // All blocks are occupied -> wait
+            ipx_ctx_stats_plugin_set(m_ctx, m_stats.stall_cnt, ++m_stall_cnt);
+            m_cv_done.wait(lock, [this]() { return m_busy < m_blocks_max; });
+        }
+
+        m_queue.push_back(std::move(m_current));
+        ++m_busy;
+        ipx_ctx_stats_plugin_set(m_ctx, m_stats.queue_fill, m_busy);
+
+        if (!m_spare.empty()) {
+            block = std::move(m_spare.back());
+            m_spare.pop_back();
+        }
+    }
+    m_cv_submit.notify_one();
+
+    m_current = std::move(block);
+    m_current.clear();
+    m_current.reserve(BLOCK_SIZE + UINT16_MAX + sizeof(op_hdr));
+}
+
+/**
+ * @brief Check if the writer thread has failed
+ * @throw FDS_exception if the writer thread has failed
+ */
+void
+AsyncWriter::check()
+{
+    if (m_failed.load(std::memory_order_acquire)) {
+        m_reported = true;
+        throw FDS_exception("Writer thread failed: " + m_error);
+    }
+}
+
+/**
+ * @brief Main function of the writer thread
+ *
+ * Blocks are processed in the order of submission. After a failure, all following blocks are
+ * dropped as the file is possibly corrupted.
+ */
+void
+AsyncWriter::thread_main()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_cv_submit.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            // Stop request and nothing to do
+            break;
+        }
+
+        std::string block = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        if (!m_failed.load(std::memory_order_relaxed)) {
+            try {
+                block_process(block);
+            } catch (const std::exception &ex) {
+                m_error = ex.what();
+                m_failed.store(true, std::memory_order_release);
+            }
+        }
+
+        lock.lock();
+        m_spare.push_back(std::move(block));
+        --m_busy;
+        ipx_ctx_stats_plugin_set(m_ctx, m_stats.queue_fill, m_busy);
+        m_cv_done.notify_one();
+    }
+}
+
+/**
+ * @brief Perform all operations in a block
+ * @param[in] block Block to process
+ * @throw FDS_exception if any operation fails
+ */
+void
+AsyncWriter::block_process(const std::string &block)
+{
+    const uint8_t *pos = reinterpret_cast<const uint8_t *>(block.data());
+    const uint8_t *end = pos + block.size();
+
+    while (pos < end) {
+        struct op_hdr hdr;
+        std::memcpy(&hdr, pos, sizeof(hdr));
+        const uint8_t *data = pos + sizeof(hdr);
+        pos = data + hdr.size;
+
+        switch (hdr.type) {
+        case op_type::SESSION_ADD: {
+            struct fds_file_session desc;
+            std::memcpy(&desc, data, sizeof(desc));
+            Writer::session_add(hdr.args[0], desc);
+            } break;
+        case op_type::SELECT:
+            Writer::select(hdr.args[0], hdr.args[1], hdr.args[2]);
+            break;
+        case op_type::TMPLT_ADD:
+            Writer::tmplt_add(static_cast<enum fds_template_type>(hdr.args[0]), data, hdr.size);
+            break;
+        case op_type::TMPLT_REMOVE:
+            Writer::tmplt_remove(static_cast<uint16_t>(hdr.args[0]));
+            break;
+        case op_type::REC_ADD:
+            Writer::rec_add(static_cast<uint16_t>(hdr.args[0]), data, hdr.size);
+            break;
+        }
+    }
+}
@@ -0,0 +1,225 @@
+/**
+ * \file src/plugins/output/fds/src/Writer.hpp
+ * \brief Writers of FDS files (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_FDS_WRITER_HPP
+#define IPFIXCOL2_FDS_WRITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "Exception.hpp"
+
+/**
+ * @brief Writer of an FDS file
+ *
+ * Transport Sessions are identified by keys assigned by the user, i.e. the first registered
+ * session has key 0, the second one has key 1, etc.
+ */
+class Writer {
+public:
+    /**
+     * @brief Create or append an FDS file
+     * @param[in] ctx   Plugin context (only for log)
+     * @param[in] path  Path of the file
+     * @param[in] flags Flags for opening the file (see fds_file_open())
+     * @throw FDS_exception if the file cannot be opened
+     */
+    Writer(ipx_ctx_t *ctx, const std::string &path, uint32_t flags);
+    /// Close the file
+    virtual ~Writer() = default;
+
+    // Disable copy constructors
+    Writer(const Writer &other) = delete;
+    Writer &operator=(const Writer &other) = delete;
+
+    /**
+     * @brief Register a new Transport Session
+     * @param[in] key  Key of the session (MUST be equal to the number of registered sessions)
+     * @param[in] desc Description of the session
+     * @throw FDS_exception on failure
+     */
+    virtual void
+    session_add(uint32_t key, const struct fds_file_session &desc);
+    /**
+     * @brief Select a Transport Session, ODID and Export Time of following operations
+     * @param[in] key      Key of the session
+     * @param[in] odid     Observation Domain ID
+     * @param[in] exp_time Export Time
+     * @throw FDS_exception on failure
+     */
+    virtual void
+    select(uint32_t key, uint32_t odid, uint32_t exp_time);
+    /**
+     * @brief Add or redefine a (Options) Template, if its current definition is different
+     * @param[in] type Template type
+     * @param[in] data Raw Template definition
+     * @param[in] size Size of the definition
+     * @throw FDS_exception on failure
+     */
+    virtual void
+    tmplt_add(enum fds_template_type type, const uint8_t *data, uint16_t size);
+    /**
+     * @brief Remove a definition of a (Options) Template
+     * @param[in] tid Template ID
+     * @throw FDS_exception on failure
+     */
+    virtual void
+    tmplt_remove(uint16_t tid);
+    /**
+     * @brief Add a Data Record
+     * @param[in] tid  Template ID of the record
+     * @param[in] data Record data
+     * @param[in] size Size of the record
+     * @throw FDS_exception on failure
+     */
+    virtual void
+    rec_add(uint16_t tid, const uint8_t *data, uint16_t size);
+    /**
+     * @brief Pass already added data to the file as soon as possible
+     * @throw FDS_exception on failure
+     */
+    virtual void
+    flush() {}
+
+protected:
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+
+private:
+    /// Output FDS file
+    std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
+    /// Mapping of session keys to session IDs in the file
+    std::vector<fds_file_sid_t> m_sids;
+};
+
+/// Indexes of plugin-specific counters of the asynchronous writer
+struct async_stats {
+    /// Number of blocks in the queue (filled or being written)
+    unsigned int queue_fill;
+    /// Number of times the plugin thread waited for a free block
+    unsigned int stall_cnt;
+};
+
+/**
+ * @brief Asynchronous writer of an FDS file
+ *
+ * Operations are serialized into blocks of fixed size which are passed to a dedicated writer
+ * thread. The thread performs the operations (including compression of data blocks of the file)
+ * in the original order. The caller waits only if all blocks of the queue are occupied.
+ *
+ * Errors of the writer thread are reported by an exception thrown by the next operation.
+ */
+class AsyncWriter : public Writer {
+public:
+    /**
+     * @brief Create or append an FDS file and start the writer thread
+     * @param[in] ctx    Plugin context (only for log and statistics)
+     * @param[in] path   Path of the file
+     * @param[in] flags  Flags for opening the file (see fds_file_open())
+     * @param[in] blocks Number of blocks in the queue
+     * @param[in] stats  Indexes of plugin-specific counters
+     * @throw FDS_exception if the file cannot be opened or the thread cannot be started
+     */
+    AsyncWriter(ipx_ctx_t *ctx, const std::string &path, uint32_t flags, unsigned int blocks,
+        const struct async_stats &stats);
+    /// Perform all remaining operations, stop the thread and close the file
+    ~AsyncWriter() override;
+
+    void
+    session_add(uint32_t key, const struct fds_file_session &desc) override;
+    void
+    select(uint32_t key, uint32_t odid, uint32_t exp_time) override;
+    void
+    tmplt_add(enum fds_template_type type, const uint8_t *data, uint16_t size) override;
+    void
+    tmplt_remove(uint16_t tid) override;
+    void
+    rec_add(uint16_t tid, const uint8_t *data, uint16_t size) override;
+    void
+    flush() override;
+
+private:
+    /// Size of a block (a block is submitted when its size exceeds the limit)
+    static constexpr size_t BLOCK_SIZE = 1024 * 1024;
+
+    /// Type of a serialized operation
+    enum class op_type : uint8_t {
+        SESSION_ADD,
+        SELECT,
+        TMPLT_ADD,
+        TMPLT_REMOVE,
+        REC_ADD
+    };
+
+    /// Header of a serialized operation (followed by optional data)
+    struct op_hdr {
+        /// Type of the operation
+        op_type type;
+        /// Size of data after the header
+        uint16_t size;
+        /// Arguments of the operation
+        uint32_t args[3];
+    };
+
+    /// Statistics
+    struct async_stats m_stats;
+    /// Maximal number of blocks in the queue
+    size_t m_blocks_max;
+
+    /// Block being filled (only the plugin thread)
+    std::string m_current;
+    /// Unused blocks ready for reuse (protected by the mutex)
+    std::vector<std::string> m_spare;
+    /// Blocks to process by the writer thread (protected by the mutex)
+    std::deque<std::string> m_queue;
+    /// Number of blocks in the queue or being processed (protected by the mutex)
+    size_t m_busy = 0;
+    /// Number of times the plugin thread waited for a free block
+    uint64_t m_stall_cnt = 0;
+
+    /// Mutex
+    std::mutex m_mutex;
+    /// A new block has been submitted or the termination has been requested
+    std::condition_variable m_cv_submit;
+    /// A block has been processed
+    std::condition_variable m_cv_done;
+    /// Termination flag (protected by the mutex)
+    bool m_stop = false;
+    /// Failure of the writer thread
+    std::atomic<bool> m_failed;
+    /// Error message of the writer thread (valid only if failed)
+    std::string m_error;
+    /// The failure has been already reported to the caller
+    bool m_reported = false;
+    /// Writer thread
+    std::thread m_thread;
+
+    void
+    op_push(op_type type, uint32_t arg0, uint32_t arg1, uint32_t arg2,
+        const void *data, uint16_t size);
+    void
+    submit();
+    void
+    check();
+    void
+    thread_main();
+    void
+    block_process(const std::string &block);
+};
+
+#endif // IPFIXCOL2_FDS_WRITER_HPP
@@ -25,8 +25,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     "Flow Data Storage output plugin",
     // Plugin type
     IPX_PT_OUTPUT,
-    // Configuration flags (reserved for future use)
-    0,
+    // Configuration flags (each worker writes its own file, multiple workers are allowed)
+    IPX_PF_OUTPUT_WORKERS,
     // Plugin version string (like "1.2.3")
     "2.0.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -123,6 +123,9 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         if (msg_type == IPX_MSG_IPFIX) {
             ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
             inst->storage_ptr->process_msg(msg_ipfix);
+        } else if (msg_type == IPX_MSG_PERIODIC) {
+            // Don't keep records in a partially filled block of the writer for too long
+            inst->storage_ptr->flush();
         }
     } catch (const FDS_exception &ex) {
         IPX_CTX_ERROR(ctx, "%s", ex.what());
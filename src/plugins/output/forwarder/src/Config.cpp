@@ -53,6 +53,9 @@
 /// Config schema definition
 ///
 
+/// The maximum number of messages waiting to be sent per connection
+static constexpr unsigned int QUEUE_SIZE_MAX = 1U << 20;
+
 enum {
     MODE,
     PROTOCOL,
@@ -65,7 +68,9 @@ enum {
     NAME,
     ADDRESS,
     PORT,
-    PREMADE_CONNECTIONS
+    PREMADE_CONNECTIONS,
+    QUEUE_SIZE,
+    OVERFLOW_POLICY
 };
 
 static fds_xml_args host_schema[] = {
@@ -88,6 +93,8 @@ static fds_xml_args params_schema[] = {
     FDS_OPTS_ELEM  (TEMPLATES_RESEND_PKTS, "templatesResendPkts", FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (RECONNECT_SECS       , "reconnectSecs"      , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM  (PREMADE_CONNECTIONS  , "premadeConnections" , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (QUEUE_SIZE           , "queueSize"          , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM  (OVERFLOW_POLICY      , "overflowPolicy"     , FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(HOSTS                , "hosts"              , hosts_schema     , 0             ),
     FDS_OPTS_END
 };
@@ -144,8 +151,11 @@ Config::parse_params(fds_xml_ctx_t *params_ctx)
             } else if (strcasecmp(content->ptr_string, "all") == 0) {
                 this->forward_mode = ForwardMode::SENDTOALL;
 
+            } else if (strcasecmp(content->ptr_string, "hash") == 0) {
+                this->forward_mode = ForwardMode::HASH;
+
             } else {
-                throw std::invalid_argument("mode must be one of: 'RoundRobin', 'All'");
+                throw std::invalid_argument("mode must be one of: 'RoundRobin', 'All', 'Hash'");
 
             }
             break;
@@ -183,6 +193,31 @@ Config::parse_params(fds_xml_ctx_t *params_ctx)
             this->nb_premade_connections = content->val_uint;
             break;
 
+        case QUEUE_SIZE:
+            if (content->val_uint == 0 || content->val_uint > QUEUE_SIZE_MAX) {
+                throw std::invalid_argument("queueSize must be in range 1.."
+                    + std::to_string(QUEUE_SIZE_MAX));
+            }
+            this->queue_size = content->val_uint;
+            break;
+
+        case OVERFLOW_POLICY:
+            if (strcasecmp(content->ptr_string, "block") == 0) {
+                this->overflow_policy = OverflowPolicy::BLOCK;
+
+            } else if (strcasecmp(content->ptr_string, "dropoldest") == 0) {
+                this->overflow_policy = OverflowPolicy::DROP_OLDEST;
+
+            } else if (strcasecmp(content->ptr_string, "dropnewest") == 0) {
+                this->overflow_policy = OverflowPolicy::DROP_NEWEST;
+
+            } else {
+                throw std::invalid_argument(
+                    "overflowPolicy must be one of: 'Block', 'DropOldest', 'DropNewest'");
+
+            }
+            break;
+
         default: assert(0);
         }
     }
@@ -246,6 +281,8 @@ Config::set_defaults()
     this->tmplts_resend_pkts = 5000;
     this->reconnect_secs = 10;
     this->nb_premade_connections = 5;
+    this->queue_size = 1024;
+    this->overflow_policy = OverflowPolicy::DROP_NEWEST;
 }
 
 void
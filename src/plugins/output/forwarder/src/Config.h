@@ -51,7 +51,15 @@
 enum class ForwardMode {
     UNASSIGNED,
     SENDTOALL, /// Every message is forwarded to all of the hosts
-    ROUNDROBIN /// Only one host receives each message, next host is selected every message
+    ROUNDROBIN, /// Only one host receives each message, next host is selected every message
+    HASH /// Only one host receives each message, the host is selected by a hash of session and ODID
+};
+
+/// The behavior when the queue of a connection is full
+enum class OverflowPolicy {
+    BLOCK,       /// Wait until there is a free space in the queue
+    DROP_OLDEST, /// Drop the oldest messages waiting in the queue
+    DROP_NEWEST  /// Drop the new message
 };
 
 struct HostConfig {
@@ -81,6 +89,10 @@ public:
     unsigned int reconnect_secs;
     /// Number of premade connections to keep
     unsigned int nb_premade_connections;
+    /// The maximum number of messages waiting to be sent per connection
+    unsigned int queue_size;
+    /// The behavior when the queue of a connection is full
+    OverflowPolicy overflow_policy;
 
     Config() {};
 
@@ -39,57 +39,78 @@
  *
  */
 
-#include <sys/socket.h>
 #include "Connection.h"
 
-#include <stdexcept>
-#include <algorithm>
 #include <cinttypes>
-#include <cerrno>
 #include <cstring>
-#include <ctime>
 #include <cassert>
-
-#include <netdb.h>
-#include <unistd.h>
-#include <arpa/inet.h>
+#include <chrono>
+#include <thread>
 
 #include <libfds.h>
 
 #include "Message.h"
 
+constexpr unsigned int Connection::BLOCK_WAIT_USECS;
+
 Connection::Connection(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
                        unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs,
-                       Connector &connector) :
+                       size_t queue_size, OverflowPolicy overflow_policy,
+                       Connector &connector, SendLoop &send_loop) :
     m_ident(ident),
     m_con_params(con_params),
     m_log_ctx(log_ctx),
     m_tmplts_resend_pkts(tmplts_resend_pkts),
     m_tmplts_resend_secs(tmplts_resend_secs),
-    m_connector(connector)
+    m_queue_size(queue_size),
+    m_overflow_policy(overflow_policy),
+    m_connector(connector),
+    m_send_loop(send_loop)
 {
 }
 
+Connection::~Connection()
+{
+    if (m_channel) {
+        m_send_loop.remove(m_channel);
+    }
+}
+
 void
 Connection::connect()
 {
-    assert(m_sockfd.get() < 0);
+    assert(!m_channel);
     m_future_socket = m_connector.get(m_con_params);
 }
 
 void
-Connection::forward_message(ipx_msg_ipfix_t *msg)
+Connection::forward_message(ipx_msg_ipfix_t *msg, const SharedPacket &packet)
 {
     assert(check_connected());
 
     Sender &sender = get_or_create_sender(msg);
+
+    // Parts of the message that refer to the original message are referenced from the shared copy
+    m_packet_raw = ipx_msg_ipfix_get_packet(msg);
+    m_packet = packet;
+    m_transfers_lost = false;
+
     try {
         sender.process_message(msg);
 
-    } catch (const ConnectionError &err) {
-        // In case connection was lost, we have to resend templates when it reconnects
-        sender.clear_templates();
-        throw err;
+    } catch (...) {
+        m_packet_raw = nullptr;
+        m_packet = nullptr;
+        throw;
+    }
+
+    m_packet_raw = nullptr;
+    m_packet = nullptr;
+
+    if (m_transfers_lost) {
+        // Templates might have been dropped, send them again with the next message
+        // (cannot be done earlier, the sender marks the templates as sent after emitting them)
+        clear_templates();
     }
 }
 
@@ -100,127 +121,155 @@ Connection::lose_message(ipx_msg_ipfix_t *msg)
     sender.lose_message(msg);
 }
 
-void
-Connection::advance_transfers()
+bool
+Connection::reserve()
 {
-    assert(check_connected());
-
-    IPX_CTX_DEBUG(m_log_ctx, "Waiting transfers on connection %s: %zu", m_ident.c_str(), m_transfers.size());
-
-    for (auto it = m_transfers.begin(); it != m_transfers.end(); ) {
+    assert(m_channel);
+    LockFreeQueue<Transfer> &queue = m_channel->queue();
 
-        Transfer &transfer = *it;
-
-        assert(transfer.data.size() <= UINT16_MAX); // The transfer consists of one IPFIX message which cannot be larger
-
-        ssize_t ret = send(m_sockfd.get(), &transfer.data[transfer.offset],
-                           transfer.data.size() - transfer.offset, MSG_DONTWAIT | MSG_NOSIGNAL);
-
-        check_socket_error(ret);
-
-        size_t sent = std::max<ssize_t>(0, ret);
-        IPX_CTX_DEBUG(m_log_ctx, "Sent %zu/%zu B to %s", sent, transfer.data.size(), m_ident.c_str());
-
-        // Is the transfer done?
-        if (transfer.offset + sent == transfer.data.size()) {
-            it = m_transfers.erase(it);
-            // Remove the transfer and continue with the next one
+    if (!queue.full()) {
+        return true;
+    }
 
-        } else {
-            transfer.offset += sent;
+    switch (m_overflow_policy) {
+    case OverflowPolicy::DROP_NEWEST:
+        IPX_CTX_DEBUG(m_log_ctx, "Message to %s not forwarded because the queue is full", m_ident.c_str());
+        m_send_loop.count_dropped(1);
+        return false;
+
+    case OverflowPolicy::DROP_OLDEST:
+        IPX_CTX_DEBUG(m_log_ctx, "Dropping the oldest messages to %s because the queue is full",
+                      m_ident.c_str());
+        while (queue.full() && m_send_loop.drop_oldest(*m_channel)) {}
+        // Templates might have been dropped too, send them again with the next message
+        clear_templates();
+        return true;
 
-            // Finish, cannot advance next transfer before the one before it is fully sent
-            break;
+    case OverflowPolicy::BLOCK:
+        m_send_loop.count_stall();
+        while (queue.full() && !m_channel->failed() && m_send_loop.alive()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(BLOCK_WAIT_USECS));
+        }
+        if (queue.full()) {
+            m_send_loop.count_dropped(1);
+            return false;
         }
+        return true;
+
+    default: assert(0);
     }
+
+    return false;
 }
 
 bool
 Connection::check_connected()
 {
-    if (m_sockfd.get() >= 0) {
-        return true;
+    if (m_channel) {
+        if (!m_channel->failed()) {
+            return true;
+        }
+
+        IPX_CTX_ERROR(m_log_ctx, "A connection to %s lost! (%s)", m_ident.c_str(),
+                      m_channel->error().c_str());
+        m_send_loop.remove(m_channel);
+        m_channel = nullptr;
+
+        // In case connection was lost, we have to resend templates when it reconnects
+        clear_templates();
+        connect();
+        return false;
     }
 
     if (m_future_socket && m_future_socket->ready()) {
-        m_sockfd = m_future_socket->retrieve();
+        m_channel = std::make_shared<Channel>(m_future_socket->retrieve(), m_ident,
+                                              m_con_params.protocol == Protocol::TCP, m_queue_size);
         m_future_socket = nullptr;
+        m_send_loop.add(m_channel);
         return true;
     }
 
     return false;
 }
 
-
+/**
+ * Create a transfer from the message, parts of the original IPFIX message are not copied
+ */
 static Transfer
-make_transfer(const std::vector<iovec> &parts, uint16_t offset, uint16_t total_length)
+make_transfer(Message &msg, const uint8_t *packet_raw, const SharedPacket &packet)
 {
-    uint16_t length = total_length - offset;
+    Transfer transfer;
+    transfer.length = msg.length();
 
-    // Find first unfinished part
-    size_t i = 0;
+    uintptr_t packet_start = reinterpret_cast<uintptr_t>(packet_raw);
+    uintptr_t packet_end = packet_start + (packet ? packet->size() : 0);
 
-    while (offset >= parts[i].iov_len) {
-        offset -= parts[i].iov_len;
-        i++;
-    }
+    for (const iovec &part : msg.parts()) {
+        uintptr_t part_start = reinterpret_cast<uintptr_t>(part.iov_base);
+        Transfer::Chunk chunk;
+        chunk.length = static_cast<uint16_t>(part.iov_len);
 
-    // Copy the unfinished portion
-    std::vector<uint8_t> buffer(length); //NOTE: We might want to do this more effectively...
-    uint16_t buffer_pos = 0;
+        if (part_start >= packet_start && part_start + part.iov_len <= packet_end) {
+            chunk.shared = true;
+            chunk.offset = static_cast<uint16_t>(part_start - packet_start);
+            transfer.packet = packet;
 
-    for (; i < parts.size(); i++) {
-        memcpy(buffer.data() + buffer_pos, &((uint8_t *) parts[i].iov_base)[offset], parts[i].iov_len - offset);
-        buffer_pos += parts[i].iov_len - offset;
-        offset = 0;
-    }
+        } else {
+            const uint8_t *data = static_cast<const uint8_t *>(part.iov_base);
+            chunk.shared = false;
+            chunk.offset = static_cast<uint16_t>(transfer.data.size());
+            transfer.data.insert(transfer.data.end(), data, data + part.iov_len);
+        }
 
-    // Create the transfer
-    Transfer transfer;
-    transfer.data = std::move(buffer);
-    transfer.offset = 0;
+        transfer.chunks.push_back(chunk);
+    }
 
     return transfer;
 }
 
-void
-Connection::store_unfinished_transfer(Message &msg, uint16_t offset)
-{
-    Transfer transfer = make_transfer(msg.parts(), offset, msg.length());
-
-    IPX_CTX_DEBUG(m_log_ctx, "Storing unfinished transfer of %" PRIu16 " bytes in connection to %s",
-                  msg.length() - offset, m_ident.c_str());
-
-    m_transfers.push_back(std::move(transfer));
-}
-
-
 void
 Connection::send_message(Message &msg)
 {
-    // All waiting transfers have to be sent first
-    if (!m_transfers.empty()) {
-        store_unfinished_transfer(msg, 0);
-        return;
-    }
-
-    std::vector<iovec> &parts = msg.parts();
-
-    msghdr hdr;
-    memset(&hdr, 0, sizeof(hdr));
-    hdr.msg_iov = parts.data();
-    hdr.msg_iovlen = parts.size();
-
-    ssize_t ret = sendmsg(m_sockfd.get(), &hdr, MSG_DONTWAIT | MSG_NOSIGNAL);
-
-    check_socket_error(ret);
+    Transfer transfer = make_transfer(msg, m_packet_raw, m_packet);
+
+    IPX_CTX_DEBUG(m_log_ctx, "Queueing %" PRIu16 " B to %s", msg.length(), m_ident.c_str());
+
+    // One forwarded message can produce more transfers (e.g. templates) than reserve() made space
+    // for, so the overflow policy is applied to each of them
+    bool stalled = false;
+
+    while (!m_send_loop.push(*m_channel, std::move(transfer))) {
+        // Note: the transfer is not moved from if the push fails
+        switch (m_overflow_policy) {
+        case OverflowPolicy::DROP_OLDEST:
+            // Make space for the transfer (fails only if the queue has been emptied meanwhile)
+            if (m_send_loop.drop_oldest(*m_channel)) {
+                m_transfers_lost = true;
+            }
+            continue;
+
+        case OverflowPolicy::BLOCK:
+            if (!m_channel->failed() && m_send_loop.alive()) {
+                if (!stalled) {
+                    m_send_loop.count_stall();
+                    stalled = true;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(BLOCK_WAIT_USECS));
+                continue;
+            }
+            break;
 
-    size_t sent = std::max<ssize_t>(0, ret);
+        case OverflowPolicy::DROP_NEWEST:
+            break;
 
-    IPX_CTX_DEBUG(m_log_ctx, "Sent %zu/%" PRIu16 " B to %s", sent, msg.length(), m_ident.c_str());
+        default: assert(0);
+        }
 
-    if (sent < msg.length()) {
-        store_unfinished_transfer(msg, sent);
+        IPX_CTX_DEBUG(m_log_ctx, "Message to %s not forwarded because the queue is full",
+                      m_ident.c_str());
+        m_send_loop.count_dropped(1);
+        m_transfers_lost = true;
+        return;
     }
 }
 
@@ -246,18 +295,9 @@ Connection::get_or_create_sender(ipx_msg_ipfix_t *msg)
 }
 
 void
-Connection::check_socket_error(ssize_t sock_ret)
+Connection::clear_templates()
 {
-    if (sock_ret < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
-        char *errbuf;
-        ipx_strerror(errno, errbuf);
-
-        IPX_CTX_ERROR(m_log_ctx, "A connection to %s lost! (%s)", m_ident.c_str(), errbuf);
-        m_sockfd.reset();
-
-        // All state from the previous connection is lost once new one is estabilished
-        m_transfers.clear();
-
-        throw ConnectionError(errbuf);
+    for (auto &p : m_senders) {
+        p.second->clear_templates();
     }
 }
@@ -49,39 +49,10 @@
 #include <ipfixcol2.h>
 
 #include "common.h"
+#include "Config.h"
 #include "connector/Connector.h"
 #include "Sender.h"
-
-class Connection;
-
-/// An error to be thrown on connection errors
-class ConnectionError {
-public:
-    ConnectionError(std::string message)
-    : m_message(message) {}
-
-    ConnectionError(std::string message, std::shared_ptr<Connection> &connection)
-    : m_message(message), m_connection(&connection) {}
-
-    ConnectionError with_connection(std::shared_ptr<Connection> &connection) const
-    { return ConnectionError(m_message, connection); }
-
-    const char *what() const { return m_message.c_str(); }
-
-    std::shared_ptr<Connection> *connection() const { return m_connection; }
-
-private:
-    std::string m_message;
-    std::shared_ptr<Connection> *m_connection;
-};
-
-/// A transfer to be sent through the connection
-struct Transfer {
-    /// The data to send
-    std::vector<uint8_t> data;
-    /// The offset to send from, i.e. the amount of data that was already sent
-    uint16_t offset;
-};
+#include "SendLoop.h"
 
 /// A class representing one of the connections to the subcollector
 /// Each host opens one connection per session
@@ -94,10 +65,15 @@ public:
      * \param log_ctx             The logging context
      * \param tmplts_resend_pkts  Interval in packets after which templates are resend (UDP only)
      * \param tmplts_resend_secs  Interval in seconds after which templates are resend (UDP only)
+     * \param queue_size          The maximum number of messages waiting to be sent
+     * \param overflow_policy     The behavior when the queue is full
+     * \param connector           The connector
+     * \param send_loop           The send loop that sends the messages
      */
     Connection(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
                unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs,
-               Connector &connector);
+               size_t queue_size, OverflowPolicy overflow_policy,
+               Connector &connector, SendLoop &send_loop);
 
     /// Do not permit copying or moving as the connection holds a raw socket that is closed in the destructor
     /// (we could instead implement proper moving and copying behavior, but we don't really need it at the moment)
@@ -105,18 +81,24 @@ public:
     Connection(Connection &&) = delete;
 
     /**
-     * \brief Connect the connection socket
-     * \throw ConnectionError if the socket couldn't be connected
+     * \brief The destructor - passes the unsent messages to the send loop to finish
+     */
+    ~Connection();
+
+    /**
+     * \brief Start connecting the connection socket
      */
     void
     connect();
 
     /**
      * \brief Forward an IPFIX message
-     * \param msg  The IPFIX message
+     * \param msg     The IPFIX message
+     * \param packet  A copy of the raw IPFIX message to be referenced by the queued messages
+     * \warning The connection must be connected and must have a space in the queue
      */
     void
-    forward_message(ipx_msg_ipfix_t *msg);
+    forward_message(ipx_msg_ipfix_t *msg, const SharedPacket &packet);
 
     /**
      * \brief Lose an IPFIX message, i.e. update the internal state as if it has been forwarded
@@ -127,29 +109,29 @@ public:
     lose_message(ipx_msg_ipfix_t *msg);
 
     /**
-     * \brief Advance the unfinished transfers
+     * \brief Make a space in the queue for a new message according to the overflow policy
+     * \return true if a new message can be forwarded, false if it should be dropped
      */
-    void
-    advance_transfers();
+    bool
+    reserve();
 
     /**
      * \brief Check if the connection socket is currently connected
+     *
+     * If the connection has been lost, a new connection is started.
      * \return true or false
      */
     bool check_connected();
 
-    /**
-     * \brief Get number of transfers still waiting to be transmitted
-     * \return The number of waiting transfers
-     */
-    size_t waiting_transfers_cnt() const { return m_transfers.size(); }
-
     /**
      * \brief The identification of the connection
      */
     const std::string &ident() const { return m_ident; }
 
 private:
+    /// The interval of checking the queue when waiting for a free space
+    static constexpr unsigned int BLOCK_WAIT_USECS = 100;
+
     const std::string &m_ident;
 
     ConnectionParams m_con_params;
@@ -160,18 +142,25 @@ private:
 
     unsigned int m_tmplts_resend_secs;
 
-    UniqueFd m_sockfd;
+    size_t m_queue_size;
+
+    OverflowPolicy m_overflow_policy;
+
+    std::shared_ptr<Channel> m_channel;
 
     std::shared_ptr<FutureSocket> m_future_socket;
 
     std::unordered_map<uint32_t, std::unique_ptr<Sender>> m_senders;
 
-    std::vector<Transfer> m_transfers;
-
     Connector &m_connector;
 
-    void
-    store_unfinished_transfer(Message &msg, uint16_t offset);
+    SendLoop &m_send_loop;
+
+    /// The raw IPFIX message being forwarded and its shared copy
+    const uint8_t *m_packet_raw = nullptr;
+    SharedPacket m_packet;
+    /// A transfer of the message being forwarded (or an older one) has been dropped
+    bool m_transfers_lost = false;
 
     void
     send_message(Message &msg);
@@ -180,5 +169,5 @@ private:
     get_or_create_sender(ipx_msg_ipfix_t *msg);
 
     void
-    check_socket_error(ssize_t sock_ret);
-};
\ No newline at end of file
+    clear_templates();
+};
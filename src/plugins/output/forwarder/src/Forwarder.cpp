@@ -41,6 +41,43 @@
 
 #include "Forwarder.h"
 
+#include <cstring>
+#include <numeric>
+#include <arpa/inet.h>
+
+/**
+ * \brief Compute a hash of the exporter of a Transport Session
+ *
+ * Only the source address is used, because the source port of a TCP session changes with each
+ * reconnection of the exporter.
+ * \param session  The Transport Session
+ * \return The hash
+ */
+static uint64_t
+exporter_hash(const ipx_session *session)
+{
+    const ipx_session_net *net;
+
+    switch (session->type) {
+    case FDS_SESSION_TCP:
+        net = &session->tcp.net;
+        break;
+    case FDS_SESSION_UDP:
+        net = &session->udp.net;
+        break;
+    case FDS_SESSION_SCTP:
+        net = &session->sctp.net;
+        break;
+    default:
+        return hash_fnv1a(session->ident, strlen(session->ident));
+    }
+
+    if (net->l3_proto == AF_INET) {
+        return hash_fnv1a(&net->addr_src.ipv4, sizeof(net->addr_src.ipv4));
+    }
+    return hash_fnv1a(&net->addr_src.ipv6, sizeof(net->addr_src.ipv6));
+}
+
 Forwarder::Forwarder(Config config, ipx_ctx_t *log_ctx) :
     m_config(config),
     m_log_ctx(log_ctx)
@@ -54,6 +91,9 @@ Forwarder::Forwarder(Config config, ipx_ctx_t *log_ctx) :
     m_connector.reset(new Connector(con_params, m_config.nb_premade_connections,
                                     m_config.reconnect_secs, m_log_ctx));
 
+    // Set up the send loop
+    m_send_loop.reset(new SendLoop(m_log_ctx));
+
     // Set up hosts
     for (const auto &host_config : m_config.hosts) {
         m_hosts.emplace_back(
@@ -63,7 +103,10 @@ Forwarder::Forwarder(Config config, ipx_ctx_t *log_ctx) :
                      m_config.tmplts_resend_pkts,
                      m_config.tmplts_resend_secs,
                      m_config.forward_mode == ForwardMode::SENDTOALL,
-                     *m_connector.get()));
+                     m_config.queue_size,
+                     m_config.overflow_policy,
+                     *m_connector.get(),
+                     *m_send_loop.get()));
 
     }
 }
@@ -75,6 +118,7 @@ void Forwarder::handle_session_message(ipx_msg_session_t *msg)
     switch (ipx_msg_session_get_event(msg)) {
     case IPX_MSG_SESSION_OPEN:
         IPX_CTX_DEBUG(m_log_ctx, "New session %s", session->ident);
+        m_session_hashes[session] = exporter_hash(session);
         for (auto &host : m_hosts) {
             host->setup_connection(session);
         }
@@ -85,20 +129,31 @@ void Forwarder::handle_session_message(ipx_msg_session_t *msg)
         for (auto &host : m_hosts) {
             host->finish_connection(session);
         }
+        m_session_hashes.erase(session);
         break;
     }
 }
 
 void Forwarder::handle_ipfix_message(ipx_msg_ipfix_t *msg)
 {
+    // The message is released after processing, but its parts are sent later by the send loop,
+    // so make one copy that is shared by all the hosts
+    const uint8_t *raw = ipx_msg_ipfix_get_packet(msg);
+    uint16_t raw_len = ntohs(reinterpret_cast<const fds_ipfix_msg_hdr *>(raw)->length);
+    SharedPacket packet = std::make_shared<const std::vector<uint8_t>>(raw, raw + raw_len);
+
     // Forward message
     switch (m_config.forward_mode) {
     case ForwardMode::SENDTOALL:
-        forward_to_all(msg);
+        forward_to_all(msg, packet);
         break;
 
     case ForwardMode::ROUNDROBIN:
-        forward_round_robin(msg);
+        forward_round_robin(msg, packet);
+        break;
+
+    case ForwardMode::HASH:
+        forward_hash(msg, packet);
         break;
 
     default: assert(0);
@@ -106,21 +161,21 @@ void Forwarder::handle_ipfix_message(ipx_msg_ipfix_t *msg)
 }
 
 void
-Forwarder::forward_to_all(ipx_msg_ipfix_t *msg)
+Forwarder::forward_to_all(ipx_msg_ipfix_t *msg, const SharedPacket &packet)
 {
     for (auto &host : m_hosts) {
-        host->forward_message(msg);
+        host->forward_message(msg, packet);
     }
 }
 
 void
-Forwarder::forward_round_robin(ipx_msg_ipfix_t *msg)
+Forwarder::forward_round_robin(ipx_msg_ipfix_t *msg, const SharedPacket &packet)
 {
     bool ok = false;
 
     for (size_t i = 0; i < m_hosts.size(); i++) {
         auto &host = m_hosts[m_rr_index];
-        ok = host->forward_message(msg);
+        ok = host->forward_message(msg, packet);
         m_rr_index = (m_rr_index + 1) % m_hosts.size();
         if (ok) {
             break;
@@ -131,3 +186,33 @@ Forwarder::forward_round_robin(ipx_msg_ipfix_t *msg)
         IPX_CTX_WARNING(m_log_ctx, "Couldn't forward to any of the hosts, dropping message!", 0);
     }
 }
+
+void
+Forwarder::forward_hash(ipx_msg_ipfix_t *msg, const SharedPacket &packet)
+{
+    // Messages of the same exporter and ODID are always delivered to the same host (if available)
+    const ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    auto it = m_session_hashes.find(msg_ctx->session);
+    const uint64_t session_hash = (it != m_session_hashes.end())
+        ? it->second
+        : exporter_hash(msg_ctx->session); // Should not happen (the session wasn't announced)
+    const uint64_t key = hash_fnv1a(&msg_ctx->odid, sizeof(msg_ctx->odid), session_hash);
+
+    // If the selected host is unavailable, remove it from the candidates and select another one
+    // by a different key, so the load of the host is spread over all the remaining hosts
+    m_candidates.resize(m_hosts.size());
+    std::iota(m_candidates.begin(), m_candidates.end(), 0);
+
+    for (uint32_t attempt = 0; !m_candidates.empty(); attempt++) {
+        const uint64_t attempt_key = (attempt == 0)
+            ? key
+            : hash_fnv1a(&attempt, sizeof(attempt), key);
+        const size_t pos = jump_consistent_hash(attempt_key, m_candidates.size());
+        if (m_hosts[m_candidates[pos]]->forward_message(msg, packet)) {
+            return;
+        }
+        m_candidates.erase(m_candidates.begin() + pos);
+    }
+
+    IPX_CTX_WARNING(m_log_ctx, "Couldn't forward to any of the hosts, dropping message!", 0);
+}
@@ -45,8 +45,10 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include "Host.h"
+#include "SendLoop.h"
 #include "common.h"
 #include "connector/Connector.h"
 
@@ -90,15 +92,25 @@ private:
 
     ipx_ctx_t *m_log_ctx;
 
+    std::unique_ptr<SendLoop> m_send_loop;
+
     std::vector<std::unique_ptr<Host>> m_hosts;
 
     size_t m_rr_index = 0;
 
+    std::unordered_map<const ipx_session *, uint64_t> m_session_hashes;
+
+    /// Indexes of hosts that can be selected by the hash (reused to avoid allocations)
+    std::vector<size_t> m_candidates;
+
     std::unique_ptr<Connector> m_connector;
 
     void
-    forward_to_all(ipx_msg_ipfix_t *msg);
+    forward_to_all(ipx_msg_ipfix_t *msg, const SharedPacket &packet);
+
+    void
+    forward_round_robin(ipx_msg_ipfix_t *msg, const SharedPacket &packet);
 
     void
-    forward_round_robin(ipx_msg_ipfix_t *msg);
+    forward_hash(ipx_msg_ipfix_t *msg, const SharedPacket &packet);
 };
\ No newline at end of file
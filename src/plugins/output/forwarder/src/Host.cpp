@@ -44,14 +44,17 @@
 
 Host::Host(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
            unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs, bool indicate_lost_msgs,
-           Connector &connector) :
+           size_t queue_size, OverflowPolicy overflow_policy, Connector &connector, SendLoop &send_loop) :
     m_ident(ident),
     m_con_params(con_params),
     m_log_ctx(log_ctx),
     m_tmplts_resend_pkts(tmplts_resend_pkts),
     m_tmplts_resend_secs(tmplts_resend_secs),
     m_indicate_lost_msgs(indicate_lost_msgs),
-    m_connector(connector)
+    m_queue_size(queue_size),
+    m_overflow_policy(overflow_policy),
+    m_connector(connector),
+    m_send_loop(send_loop)
 {
 }
 
@@ -71,7 +74,10 @@ Host::setup_connection(const ipx_session *session)
             m_log_ctx,
             m_tmplts_resend_pkts,
             m_tmplts_resend_secs,
-            m_connector)));
+            m_queue_size,
+            m_overflow_policy,
+            m_connector,
+            m_send_loop)));
     m_session_to_connection[session]->connect();
 }
 
@@ -80,89 +86,36 @@ Host::finish_connection(const ipx_session *session)
 {
     IPX_CTX_INFO(m_log_ctx, "Finishing a connection to %s", m_ident.c_str());
 
-    // Get the corresponding connection and remove it from the session map
-    std::unique_ptr<Connection> &connection = m_session_to_connection[session];
-    assert(connection);
-
-    // Try to send the waiting transfers if there are any, if the connection is dropped just finish anyway
-    if (connection->check_connected()) {
-
-        try {
-            connection->advance_transfers();
-
-        } catch (const ConnectionError &) {
-            // Ignore...
-        }
-    }
-
-    if (connection->waiting_transfers_cnt() > 0) {
-        IPX_CTX_WARNING(m_log_ctx, "Dropping %zu transfers when finishing connection",
-                        connection->waiting_transfers_cnt());
-    }
+    // The send loop tries to send the waiting messages, the rest is dropped
+    assert(m_session_to_connection.find(session) != m_session_to_connection.end());
+    m_session_to_connection.erase(session);
 
     IPX_CTX_INFO(m_log_ctx, "Connection to %s finished", m_ident.c_str());
-
-    m_session_to_connection.erase(session);
 }
 
 bool
-Host::forward_message(ipx_msg_ipfix_t *msg)
+Host::forward_message(ipx_msg_ipfix_t *msg, const SharedPacket &packet)
 {
     const ipx_session *session = ipx_msg_ipfix_get_ctx(msg)->session;
     Connection &connection = *m_session_to_connection[session].get();
 
-    if (!connection.check_connected()) {
+    if (!connection.check_connected() || !connection.reserve()) {
         if (m_indicate_lost_msgs) {
             connection.lose_message(msg);
         }
         return false;
     }
 
-    try {
-        connection.advance_transfers();
-
-        if (connection.waiting_transfers_cnt() > 0) {
-            IPX_CTX_DEBUG(m_log_ctx, "Message to %s not forwarded because there are unsent transfers\n", m_ident.c_str());
-            if (m_indicate_lost_msgs) {
-                connection.lose_message(msg);
-            }
-            return false;
-        }
-
-        IPX_CTX_DEBUG(m_log_ctx, "Forwarding message to %s\n", m_ident.c_str());
-
-        connection.forward_message(msg);
-
-    } catch (const ConnectionError &err) {
-        IPX_CTX_ERROR(m_log_ctx, "Lost connection while forwarding: %s", err.what());
-        connection.connect();
-        return false;
-    }
+    IPX_CTX_DEBUG(m_log_ctx, "Forwarding message to %s\n", m_ident.c_str());
 
+    connection.forward_message(msg, packet);
     return true;
 }
 
 Host::~Host()
 {
-    for (auto &p : m_session_to_connection) {
-        std::unique_ptr<Connection> &connection = p.second;
-
-        // Try to send the waiting transfers if there are any, if the connection is dropped just finish anyway
-        if (connection->check_connected()) {
-
-            try {
-                connection->advance_transfers();
-
-            } catch (const ConnectionError &) {
-                // Ignore...
-            }
-        }
-
-        if (connection->waiting_transfers_cnt() > 0) {
-            IPX_CTX_WARNING(m_log_ctx, "Dropping %zu transfers when closing connection %s",
-                            connection->waiting_transfers_cnt(), connection->ident().c_str());
-        }
-    }
+    // The send loop tries to send the waiting messages of all connections, the rest is dropped
+    m_session_to_connection.clear();
 
     IPX_CTX_INFO(m_log_ctx, "All connections to %s closed", m_ident.c_str());
 }
@@ -47,6 +47,7 @@
 #include "common.h"
 #include "Config.h"
 #include "Connection.h"
+#include "SendLoop.h"
 #include "connector/Connector.h"
 
 /// A class representing one of the subcollectors messages are forwarded to
@@ -61,10 +62,14 @@ public:
      * \param tmplts_resend_secs         Interval in seconds after which templates are resend (UDP only)
      * \param indicate_lost_msgs         Indicate that the message has been lost if it couldn't be forwarded
      *                                   by increasing the sequence numbers
+     * \param queue_size                 The maximum number of messages waiting to be sent per connection
+     * \param overflow_policy            The behavior when the queue of a connection is full
+     * \param connector                  The connector
+     * \param send_loop                  The send loop
      */
     Host(const std::string &ident, ConnectionParams con_params, ipx_ctx_t *log_ctx,
          unsigned int tmplts_resend_pkts, unsigned int tmplts_resend_secs, bool indicate_lost_msgs,
-         Connector &connector);
+         size_t queue_size, OverflowPolicy overflow_policy, Connector &connector, SendLoop &send_loop);
 
     /**
      * Disable copy and move constructors
@@ -93,12 +98,12 @@ public:
 
     /**
      * \brief Forward an IPFIX message to this host
-     * \param msg  The IPFIX message
+     * \param msg     The IPFIX message
+     * \param packet  A copy of the raw IPFIX message shared by all hosts
      * \return true on success, false on failure
-     * \throw ConnectionError when the connection fails
      */
     bool
-    forward_message(ipx_msg_ipfix_t *msg);
+    forward_message(ipx_msg_ipfix_t *msg, const SharedPacket &packet);
 
 private:
     const std::string &m_ident;
@@ -113,7 +118,13 @@ private:
 
     bool m_indicate_lost_msgs;
 
+    size_t m_queue_size;
+
+    OverflowPolicy m_overflow_policy;
+
     Connector &m_connector;
 
+    SendLoop &m_send_loop;
+
     std::unordered_map<const ipx_session *, std::unique_ptr<Connection>> m_session_to_connection;
 };
\ No newline at end of file
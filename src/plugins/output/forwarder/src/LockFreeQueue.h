@@ -0,0 +1,207 @@
+/**
+ * \file src/plugins/output/forwarder/src/LockFreeQueue.h
+ * \brief Bounded lock-free queue
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * \brief A bounded lock-free queue with multiple producers and multiple consumers
+ *
+ * Each slot of the queue has its own sequence number which says whether the slot is ready to be
+ * written or read in the current lap, so producers and consumers only synchronize on the
+ * positions of the queue (see D. Vyukov's bounded MPMC queue).
+ */
+template <typename T>
+class LockFreeQueue {
+public:
+    /**
+     * \brief The constructor
+     * \param capacity  The maximum number of items in the queue
+     * \throw std::invalid_argument if the capacity is zero
+     */
+    LockFreeQueue(size_t capacity) :
+        m_cells(new Cell[capacity]),
+        m_capacity(capacity)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("capacity of the queue cannot be zero");
+        }
+
+        for (size_t i = 0; i < capacity; i++) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue(LockFreeQueue &&) = delete;
+
+    /**
+     * \brief Try to append an item to the end of the queue
+     * \param item  The item (moved into the queue on success)
+     * \return true on success, false if the queue is full
+     */
+    bool
+    try_push(T &&item)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell *cell;
+
+        while (true) {
+            cell = &m_cells[pos % m_capacity];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(seq - pos);
+
+            if (diff == 0) {
+                // The slot is free in this lap, try to claim it
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+
+            } else if (diff < 0) {
+                // The slot still holds an item from the previous lap
+                return false;
+
+            } else {
+                // Another producer has claimed the slot
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(item);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Try to remove an item from the beginning of the queue
+     * \param[out] item  The item
+     * \return true on success, false if the queue is empty
+     */
+    bool
+    try_pop(T &item)
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        Cell *cell;
+
+        while (true) {
+            cell = &m_cells[pos % m_capacity];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(seq - (pos + 1));
+
+            if (diff == 0) {
+                // The slot holds an item of this lap, try to claim it
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+
+            } else if (diff < 0) {
+                // The item hasn't been written yet
+                return false;
+
+            } else {
+                // Another consumer has claimed the slot
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->seq.store(pos + m_capacity, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Get the number of items in the queue
+     * \note The value is only approximate if the queue is concurrently modified
+     */
+    size_t
+    size() const
+    {
+        size_t tail = m_enqueue_pos.load(std::memory_order_relaxed);
+        size_t head = m_dequeue_pos.load(std::memory_order_relaxed);
+        return (tail > head) ? (tail - head) : 0;
+    }
+
+    /**
+     * \brief Check if the queue is empty
+     * \note The value is only approximate if the queue is concurrently modified
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * \brief Check if the queue is full
+     * \note The value is only approximate if the queue is concurrently modified
+     */
+    bool full() const { return size() >= m_capacity; }
+
+    /**
+     * \brief Get the maximum number of items in the queue
+     */
+    size_t capacity() const { return m_capacity; }
+
+private:
+    /// Size of padding that keeps the positions in separate cache lines
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Cell {
+        /// Sequence number of the slot
+        std::atomic<size_t> seq;
+        /// The item
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+
+    const size_t m_capacity;
+
+    char m_pad0[CACHE_LINE];
+
+    std::atomic<size_t> m_enqueue_pos{0};
+
+    char m_pad1[CACHE_LINE];
+
+    std::atomic<size_t> m_dequeue_pos{0};
+
+    char m_pad2[CACHE_LINE];
+};
@@ -0,0 +1,508 @@
+/**
+ * \file src/plugins/output/forwarder/src/SendLoop.cpp
+ * \brief SendLoop class
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "SendLoop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+constexpr size_t SendLoop::BATCH_MAX;
+constexpr unsigned int SendLoop::ROUNDS_MAX;
+
+Channel::Channel(UniqueFd sockfd, const std::string &ident, bool is_stream, size_t queue_size) :
+    m_sockfd(std::move(sockfd)),
+    m_ident(ident),
+    m_is_stream(is_stream),
+    m_queue(queue_size)
+{
+}
+
+SendLoop::SendLoop(ipx_ctx_t *log_ctx) :
+    m_log_ctx(log_ctx)
+{
+    if (ipx_ctx_stats_plugin_add(m_log_ctx, "sender_queue_fill", &m_stats_queue_fill) != IPX_OK
+            || ipx_ctx_stats_plugin_add(m_log_ctx, "sender_dropped", &m_stats_dropped) != IPX_OK
+            || ipx_ctx_stats_plugin_add(m_log_ctx, "sender_stall_cnt", &m_stats_stall_cnt) != IPX_OK) {
+        throw std::runtime_error("Failed to register statistics of the sender!");
+    }
+
+    int epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollfd < 0) {
+        throw errno_runtime_error(errno, "epoll_create1");
+    }
+    m_epollfd.reset(epollfd);
+
+    // The pipe is identified by a null pointer
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(m_epollfd.get(), EPOLL_CTL_ADD, m_statpipe.readfd(), &event) != 0) {
+        throw errno_runtime_error(errno, "epoll_ctl");
+    }
+
+    // Start the worker thread
+    m_thread = std::thread([this](){ this->run(); });
+}
+
+SendLoop::~SendLoop()
+{
+    // Let the worker thread know that we're stopping
+    m_stop_flag = true;
+    m_statpipe.poke(true);
+    m_thread.join();
+}
+
+void
+SendLoop::add(const std::shared_ptr<Channel> &channel)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_new_channels.push_back(channel);
+    m_statpipe.poke(true);
+}
+
+void
+SendLoop::remove(const std::shared_ptr<Channel> &channel)
+{
+    channel->m_closed.store(true, std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_closed_channels = true;
+    m_statpipe.poke(true);
+}
+
+bool
+SendLoop::push(Channel &channel, Transfer &&transfer)
+{
+    if (!channel.m_queue.try_push(std::move(transfer))) {
+        return false;
+    }
+
+    m_queued.fetch_add(1, std::memory_order_relaxed);
+    wake_up();
+    return true;
+}
+
+bool
+SendLoop::drop_oldest(Channel &channel)
+{
+    Transfer transfer;
+    if (!channel.m_queue.try_pop(transfer)) {
+        return false;
+    }
+
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Wake up the worker thread if it's waiting for events (called after a new transfer is pushed)
+ */
+void
+SendLoop::wake_up()
+{
+    // Pairs with the fence in main_loop(), i.e. either the worker thread sees the new transfer
+    // before it goes to sleep, or we see that it's sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_idle.load(std::memory_order_relaxed) && m_idle.exchange(false)) {
+        m_statpipe.poke(true);
+    }
+}
+
+/**
+ * Register new channels and close channels that were removed
+ */
+void
+SendLoop::process_requests()
+{
+    std::vector<std::shared_ptr<Channel>> new_channels;
+    bool closed_channels;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        new_channels.swap(m_new_channels);
+        closed_channels = m_closed_channels;
+        m_closed_channels = false;
+    }
+
+    for (auto &channel : new_channels) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = 0; // Only errors until the socket becomes full
+        event.data.ptr = channel.get();
+
+        m_channels.push_back(std::move(channel));
+
+        if (epoll_ctl(m_epollfd.get(), EPOLL_CTL_ADD, m_channels.back()->m_sockfd.get(), &event) != 0) {
+            char *errbuf;
+            ipx_strerror(errno, errbuf);
+            fail(*m_channels.back(), std::string("epoll_ctl() failed: ") + errbuf);
+        }
+    }
+
+    if (!closed_channels) {
+        return;
+    }
+
+    for (auto it = m_channels.begin(); it != m_channels.end(); ) {
+        if ((*it)->m_closed.load(std::memory_order_relaxed)) {
+            close(**it);
+            it = m_channels.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+/**
+ * Send queued transfers of the channel until the queue is empty or the socket is full
+ */
+SendLoop::FlushResult
+SendLoop::flush(Channel &channel)
+{
+    // Datagrams must be sent one by one
+    const size_t batch_max = channel.m_is_stream ? BATCH_MAX : 1;
+
+    for (unsigned int round = 0; round < ROUNDS_MAX; round++) {
+        while (channel.m_inflight.size() < batch_max) {
+            Transfer transfer;
+            if (!channel.m_queue.try_pop(transfer)) {
+                break;
+            }
+            channel.m_inflight.push_back(std::move(transfer));
+        }
+
+        if (channel.m_inflight.empty()) {
+            return FlushResult::EMPTY;
+        }
+
+        // Collect parts of in-flight transfers, skip what was already sent
+        m_iov.clear();
+        size_t skip = channel.m_offset;
+
+        for (const Transfer &transfer : channel.m_inflight) {
+            if (!m_iov.empty() && m_iov.size() + transfer.chunks.size() > IOV_MAX) {
+                break;
+            }
+
+            for (const Transfer::Chunk &chunk : transfer.chunks) {
+                if (skip >= chunk.length) {
+                    skip -= chunk.length;
+                    continue;
+                }
+
+                const uint8_t *base = chunk.shared ? transfer.packet->data() : transfer.data.data();
+                struct iovec part;
+                part.iov_base = const_cast<uint8_t *>(base + chunk.offset + skip);
+                part.iov_len = chunk.length - skip;
+                m_iov.push_back(part);
+                skip = 0;
+            }
+        }
+
+        struct msghdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_iov = m_iov.data();
+        hdr.msg_iovlen = m_iov.size();
+
+        ssize_t ret = sendmsg(channel.m_sockfd.get(), &hdr, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                set_blocked(channel, true);
+                return FlushResult::BLOCKED;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+
+            char *errbuf;
+            ipx_strerror(errno, errbuf);
+            fail(channel, errbuf);
+            return FlushResult::EMPTY;
+        }
+
+        // Remove finished transfers
+        size_t sent = channel.m_offset + static_cast<size_t>(ret);
+        while (!channel.m_inflight.empty() && sent >= channel.m_inflight.front().length) {
+            sent -= channel.m_inflight.front().length;
+            channel.m_inflight.pop_front();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        channel.m_offset = sent;
+    }
+
+    return FlushResult::MORE;
+}
+
+/**
+ * Mark the channel as failed and drop its in-flight transfers
+ */
+void
+SendLoop::fail(Channel &channel, const std::string &reason)
+{
+    // The channel might be still registered
+    epoll_ctl(m_epollfd.get(), EPOLL_CTL_DEL, channel.m_sockfd.get(), nullptr);
+
+    // All state from the previous connection is lost once new one is estabilished
+    size_t dropped = channel.m_inflight.size();
+    channel.m_inflight.clear();
+    channel.m_offset = 0;
+    channel.m_blocked = false;
+    m_queued.fetch_sub(dropped, std::memory_order_relaxed);
+    m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+
+    // The plugin thread reads the error only after it sees the flag
+    channel.m_error = reason;
+    channel.m_failed.store(true, std::memory_order_release);
+}
+
+/**
+ * Try to send the remaining transfers of the channel without waiting and drop the rest
+ */
+void
+SendLoop::close(Channel &channel)
+{
+    if (!channel.failed()) {
+        if (flush(channel) != FlushResult::EMPTY) {
+            // Not everything has been sent
+            IPX_CTX_DEBUG(m_log_ctx, "Unable to send all transfers to %s", channel.m_ident.c_str());
+        }
+        epoll_ctl(m_epollfd.get(), EPOLL_CTL_DEL, channel.m_sockfd.get(), nullptr);
+    }
+
+    size_t dropped = channel.m_inflight.size();
+    channel.m_inflight.clear();
+    m_queued.fetch_sub(dropped, std::memory_order_relaxed);
+    m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+
+    while (drop_oldest(channel)) {
+        dropped++;
+    }
+
+    if (dropped > 0) {
+        IPX_CTX_WARNING(m_log_ctx, "Dropping %zu transfers when closing connection to %s",
+                        dropped, channel.m_ident.c_str());
+    }
+}
+
+/**
+ * Start or stop waiting for the socket of the channel to become writable
+ */
+void
+SendLoop::set_blocked(Channel &channel, bool blocked)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = blocked ? static_cast<uint32_t>(EPOLLOUT) : 0U;
+    event.data.ptr = &channel;
+
+    if (epoll_ctl(m_epollfd.get(), EPOLL_CTL_MOD, channel.m_sockfd.get(), &event) != 0) {
+        char *errbuf;
+        ipx_strerror(errno, errbuf);
+        fail(channel, std::string("epoll_ctl() failed: ") + errbuf);
+        return;
+    }
+
+    channel.m_blocked = blocked;
+}
+
+/**
+ * Check if there is a channel with transfers that can be sent right now
+ */
+bool
+SendLoop::has_pending()
+{
+    for (const auto &channel : m_channels) {
+        if (!channel->failed() && !channel->m_blocked && !channel->m_queue.empty()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Wait for a writable socket, a socket error or the status pipe event
+ */
+void
+SendLoop::wait_for_events(int timeout)
+{
+    struct epoll_event events[64];
+
+    int ret = epoll_wait(m_epollfd.get(), events, 64, timeout);
+    if (ret < 0) {
+        if (errno != EINTR) {
+            char *errbuf;
+            ipx_strerror(errno, errbuf);
+            IPX_CTX_ERROR(m_log_ctx, "epoll_wait() failed: %s", errbuf);
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret; i++) {
+        Channel *channel = static_cast<Channel *>(events[i].data.ptr);
+
+        if (!channel) {
+            // Empty the pipe as it's only used to stop the waiting
+            m_statpipe.clear();
+            continue;
+        }
+
+        if (channel->failed()) {
+            continue;
+        }
+
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            int optval = 0;
+            socklen_t optlen = sizeof(optval);
+            getsockopt(channel->m_sockfd.get(), SOL_SOCKET, SO_ERROR, &optval, &optlen);
+
+            if (optval != 0) {
+                char *errbuf;
+                ipx_strerror(optval, errbuf);
+                fail(*channel, errbuf);
+            } else {
+                fail(*channel, "Connection closed by the remote side");
+            }
+            continue;
+        }
+
+        if (events[i].events & EPOLLOUT) {
+            set_blocked(*channel, false);
+        }
+    }
+}
+
+/**
+ * Publish statistics
+ */
+void
+SendLoop::update_stats()
+{
+    ipx_ctx_stats_plugin_set(m_log_ctx, m_stats_queue_fill, m_queued.load());
+    ipx_ctx_stats_plugin_set(m_log_ctx, m_stats_dropped, m_dropped.load());
+    ipx_ctx_stats_plugin_set(m_log_ctx, m_stats_stall_cnt, m_stall_cnt.load());
+}
+
+/**
+ * The main loop
+ */
+void
+SendLoop::main_loop()
+{
+    while (!m_stop_flag) {
+        process_requests();
+
+        bool more = false;
+        for (auto &channel : m_channels) {
+            if (channel->failed() || channel->m_blocked) {
+                continue;
+            }
+
+            if (flush(*channel) == FlushResult::MORE) {
+                more = true;
+            }
+        }
+
+        update_stats();
+
+        if (more) {
+            // Just check the sockets and continue
+            wait_for_events(0);
+            continue;
+        }
+
+        // Let producers know that we're going to sleep, but check the queues once more as
+        // a transfer could have been pushed in the meantime (pairs with the fence in wake_up())
+        m_idle.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!has_pending()) {
+            wait_for_events(1000);
+        }
+
+        m_idle.store(false);
+    }
+
+    // Try to send what's left
+    process_requests();
+    for (auto &channel : m_channels) {
+        close(*channel);
+    }
+    m_channels.clear();
+    update_stats();
+}
+
+/**
+ * The entry point of the worker thread
+ */
+void
+SendLoop::run()
+{
+    try {
+        main_loop();
+
+    } catch (const std::bad_alloc &ex) {
+        IPX_CTX_ERROR(m_log_ctx, "Caught exception in sender thread: Memory error", 0);
+        IPX_CTX_ERROR(m_log_ctx, "Fatal error, sender stopped!", 0);
+
+    } catch (const std::runtime_error &ex) {
+        IPX_CTX_ERROR(m_log_ctx, "Caught exception in sender thread: %s", ex.what());
+        IPX_CTX_ERROR(m_log_ctx, "Fatal error, sender stopped!", 0);
+
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(m_log_ctx, "Caught exception in sender thread: %s", ex.what());
+        IPX_CTX_ERROR(m_log_ctx, "Fatal error, sender stopped!", 0);
+
+    } catch (...) {
+        IPX_CTX_ERROR(m_log_ctx, "Caught exception in sender thread", 0);
+        IPX_CTX_ERROR(m_log_ctx, "Fatal error, sender stopped!", 0);
+    }
+
+    // Nobody takes transfers from the queues anymore, don't let the plugin thread wait for them
+    m_alive.store(false, std::memory_order_release);
+}
@@ -0,0 +1,291 @@
+/**
+ * \file src/plugins/output/forwarder/src/SendLoop.h
+ * \brief SendLoop class
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/uio.h>
+#include <ipfixcol2.h>
+
+#include "common.h"
+#include "LockFreeQueue.h"
+#include "connector/Pipe.h"
+
+/// A shared copy of a raw IPFIX message
+using SharedPacket = std::shared_ptr<const std::vector<uint8_t>>;
+
+/// A transfer to be sent through the connection, i.e. one IPFIX message
+struct Transfer {
+    /// A contiguous part of the message
+    struct Chunk {
+        /// The part is stored in the shared packet (otherwise in the private data)
+        bool shared;
+        /// Offset of the part in the storage
+        uint16_t offset;
+        /// Length of the part
+        uint16_t length;
+    };
+
+    /// The original IPFIX message shared by all transfers created from it
+    SharedPacket packet;
+    /// Data created while forwarding (e.g. message header and templates)
+    std::vector<uint8_t> data;
+    /// Parts of the message in order
+    std::vector<Chunk> chunks;
+    /// The total length of the message
+    uint16_t length = 0;
+};
+
+/// A connected socket and the queue of transfers to be sent through it
+class Channel {
+public:
+    /**
+     * \brief The constructor
+     * \param sockfd      The connected socket
+     * \param ident       The identification of the connection
+     * \param is_stream   The socket is a stream socket (i.e. messages can be coalesced)
+     * \param queue_size  The maximum number of transfers in the queue
+     */
+    Channel(UniqueFd sockfd, const std::string &ident, bool is_stream, size_t queue_size);
+
+    Channel(const Channel &) = delete;
+    Channel(Channel &&) = delete;
+
+    /**
+     * \brief Check if the connection has failed
+     */
+    bool failed() const { return m_failed.load(std::memory_order_acquire); }
+
+    /**
+     * \brief Get the reason of the failure (valid only if the connection has failed)
+     */
+    const std::string &error() const { return m_error; }
+
+    /**
+     * \brief Access the queue of transfers
+     */
+    LockFreeQueue<Transfer> &queue() { return m_queue; }
+
+private:
+    friend class SendLoop;
+
+    UniqueFd m_sockfd;
+
+    std::string m_ident;
+
+    bool m_is_stream;
+
+    LockFreeQueue<Transfer> m_queue;
+
+    std::atomic<bool> m_failed{false};
+
+    std::string m_error;
+
+    std::atomic<bool> m_closed{false};
+
+    // The following members are exclusively handled by the send loop thread!
+
+    /// Transfers taken from the queue that are being sent
+    std::deque<Transfer> m_inflight;
+    /// The number of bytes of the first in-flight transfer that were already sent
+    size_t m_offset = 0;
+    /// The socket is full, waiting for the socket to become writable
+    bool m_blocked = false;
+};
+
+/**
+ * \brief A loop that sends queued transfers of all channels on a separate thread
+ *
+ * The plugin thread only builds transfers and pushes them to the queues of channels, so a slow
+ * host does not delay processing of messages for other hosts.
+ */
+class SendLoop {
+public:
+    /**
+     * \brief The constructor
+     * \param log_ctx  The logging context (also used for statistics)
+     * \throw std::runtime_error on failure
+     */
+    SendLoop(ipx_ctx_t *log_ctx);
+
+    // No copying or moving
+    SendLoop(const SendLoop &) = delete;
+    SendLoop(SendLoop &&) = delete;
+
+    /**
+     * \brief The destructor - tries to send the remaining transfers and stops the thread
+     */
+    ~SendLoop();
+
+    /**
+     * \brief Start sending transfers of the channel
+     * \param channel  The channel
+     */
+    void
+    add(const std::shared_ptr<Channel> &channel);
+
+    /**
+     * \brief Stop sending transfers of the channel
+     *
+     * The remaining transfers are sent if possible without waiting, the rest is dropped. The
+     * socket is closed when the last reference to the channel is released.
+     * \param channel  The channel
+     */
+    void
+    remove(const std::shared_ptr<Channel> &channel);
+
+    /**
+     * \brief Push a transfer to the queue of the channel
+     * \param channel   The channel
+     * \param transfer  The transfer
+     * \return true on success, false if the queue is full
+     */
+    bool
+    push(Channel &channel, Transfer &&transfer);
+
+    /**
+     * \brief Drop the oldest transfer waiting in the queue of the channel
+     * \param channel  The channel
+     * \return true on success, false if the queue is empty
+     */
+    bool
+    drop_oldest(Channel &channel);
+
+    /**
+     * \brief Count transfers dropped by the plugin thread
+     * \param cnt  The number of dropped transfers
+     */
+    void
+    count_dropped(uint64_t cnt) { m_dropped.fetch_add(cnt, std::memory_order_relaxed); }
+
+    /**
+     * \brief Count waiting of the plugin thread for a free space in a queue
+     */
+    void
+    count_stall() { m_stall_cnt.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * \brief Check if the worker thread is still running (i.e. queued transfers are being sent)
+     */
+    bool
+    alive() const { return m_alive.load(std::memory_order_acquire); }
+
+private:
+    /// The maximum number of transfers coalesced into one system call (stream sockets only)
+    static constexpr size_t BATCH_MAX = 64;
+    /// The maximum number of system calls per channel before moving to the next channel
+    static constexpr unsigned int ROUNDS_MAX = 16;
+
+    enum class FlushResult { EMPTY, BLOCKED, MORE };
+
+    // The logging context
+    ipx_ctx_t *m_log_ctx;
+    // Mutex for shared state
+    std::mutex m_mutex;
+    // Channels to be added by the worker thread
+    std::vector<std::shared_ptr<Channel>> m_new_channels;
+    // Set if any channel has been marked as closed
+    bool m_closed_channels = false;
+    // The channels - exclusively handled by the worker thread!
+    std::vector<std::shared_ptr<Channel>> m_channels;
+    // The epoll instance
+    UniqueFd m_epollfd;
+    // Pipe to wake up the worker thread
+    Pipe m_statpipe;
+    // The worker thread sleeps (or is about to sleep) and must be woken up on a new transfer
+    std::atomic<bool> m_idle{false};
+    // Stop flag for the worker thread
+    std::atomic<bool> m_stop_flag{false};
+    // Cleared when the worker thread exits (e.g. after a fatal error)
+    std::atomic<bool> m_alive{true};
+    // The worker thread
+    std::thread m_thread;
+    // Buffer of parts for a system call - exclusively handled by the worker thread!
+    std::vector<iovec> m_iov;
+
+    // Statistics
+    std::atomic<uint64_t> m_queued{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_stall_cnt{0};
+    unsigned int m_stats_queue_fill;
+    unsigned int m_stats_dropped;
+    unsigned int m_stats_stall_cnt;
+
+    void
+    wake_up();
+
+    void
+    process_requests();
+
+    FlushResult
+    flush(Channel &channel);
+
+    void
+    fail(Channel &channel, const std::string &reason);
+
+    void
+    close(Channel &channel);
+
+    void
+    set_blocked(Channel &channel, bool blocked);
+
+    bool
+    has_pending();
+
+    void
+    wait_for_events(int timeout);
+
+    void
+    update_stats();
+
+    void
+    main_loop();
+
+    void
+    run();
+};
@@ -96,3 +96,34 @@ errno_runtime_error(int errno_, const std::string &func_name)
     ipx_strerror(errno_, errbuf);
     return std::runtime_error(func_name + "() failed: " + std::string(errbuf));
 }
+
+uint64_t
+hash_fnv1a(const void *data, size_t size, uint64_t seed)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+uint32_t
+jump_consistent_hash(uint64_t key, uint32_t buckets)
+{
+    // See "A Fast, Minimal Memory, Consistent Hash Algorithm" by J. Lamping and E. Veach
+    assert(buckets > 0);
+    int64_t b = -1;
+    int64_t j = 0;
+
+    while (j < static_cast<int64_t>(buckets)) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = static_cast<int64_t>((b + 1) * (double(1LL << 31) / double((key >> 33) + 1)));
+    }
+
+    return static_cast<uint32_t>(b);
+}
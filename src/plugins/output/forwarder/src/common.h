@@ -155,3 +155,27 @@ get_monotonic_time();
  */
 std::runtime_error
 errno_runtime_error(int errno_, const std::string &func_name);
+
+/// The initial value of the FNV-1a hash
+constexpr uint64_t HASH_FNV1A_INIT = 0xcbf29ce484222325ULL;
+
+/**
+ * \brief Compute a 64-bit FNV-1a hash of a memory block
+ * \param data  The data
+ * \param size  The size of the data
+ * \param seed  The initial value (i.e. a hash of preceding data to continue with)
+ * \return The hash
+ */
+uint64_t
+hash_fnv1a(const void *data, size_t size, uint64_t seed = HASH_FNV1A_INIT);
+
+/**
+ * \brief Map a key to one of the buckets using the jump consistent hash
+ *
+ * When the number of buckets changes from N to N+1, only 1/(N+1) of the keys are remapped.
+ * \param key      The key (should be well distributed, e.g. the result of a hash function)
+ * \param buckets  The number of buckets (must be greater than 0)
+ * \return The bucket in range [0, buckets)
+ */
+uint32_t
+jump_consistent_hash(uint64_t key, uint32_t buckets);
@@ -0,0 +1,268 @@
+/**
+ * \file src/plugins/output/json/src/Compressor.cpp
+ * \brief Parallel GZIP compressor of output files (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#include "Compressor.hpp"
+
+#include <stdexcept>
+#include <system_error>
+#include <zlib.h>
+
+constexpr size_t Compressor::BLOCK_SIZE;
+constexpr time_t Compressor::FLUSH_TIMEOUT;
+
+Compressor::Compressor(ipx_ctx_t *ctx, unsigned int threads, int level)
+    : m_ctx(ctx), m_level(level), m_current_ts(0), m_stop(false)
+{
+    if (threads == 0) {
+        throw std::runtime_error("(File output) Number of compression threads must be positive");
+    }
+
+    // Limit memory usage, but keep all workers busy while finished blocks are written
+    m_max_blocks = 2 * threads + 2;
+    m_current.reset(new block);
+    m_current->in.reserve(BLOCK_SIZE);
+
+    try {
+        for (unsigned int i = 0; i < threads; ++i) {
+            m_workers.emplace_back(&Compressor::worker, this);
+        }
+    } catch (const std::system_error &ex) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv_job.notify_all();
+        for (auto &thread : m_workers) {
+            thread.join();
+        }
+        throw std::runtime_error("(File output) Failed to start compression threads: "
+            + std::string(ex.what()));
+    }
+}
+
+Compressor::~Compressor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv_job.notify_all();
+    for (auto &thread : m_workers) {
+        thread.join();
+    }
+}
+
+void
+Compressor::write(FILE *file, const char *data, size_t len)
+{
+    while (len > 0) {
+        if (m_current->in.empty()) {
+            m_current_ts = now();
+        }
+
+        const size_t space = BLOCK_SIZE - m_current->in.size();
+        const size_t todo = (len < space) ? len : space;
+        m_current->in.append(data, todo);
+        data += todo;
+        len -= todo;
+
+        if (m_current->in.size() < BLOCK_SIZE) {
+            break;
+        }
+
+        submit();
+        drain(file, false);
+    }
+}
+
+void
+Compressor::flush(FILE *file)
+{
+    if (!m_current->in.empty() && now() - m_current_ts >= FLUSH_TIMEOUT) {
+        submit();
+    }
+
+    drain(file, false);
+    fflush(file);
+}
+
+void
+Compressor::finish(FILE *file)
+{
+    if (!m_current->in.empty()) {
+        submit();
+    }
+
+    drain(file, true);
+    fflush(file);
+}
+
+/**
+ * \brief Pass the current block to the workers and prepare a new one
+ */
+void
+Compressor::submit()
+{
+    block *ptr = m_current.get();
+    ptr->done = false;
+    ptr->failed = false;
+    m_pipeline.push_back(std::move(m_current));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(ptr);
+    }
+    m_cv_job.notify_one();
+
+    if (!m_spare.empty()) {
+        m_current = std::move(m_spare.back());
+        m_spare.pop_back();
+        m_current->in.clear();
+    } else {
+        m_current.reset(new block);
+        m_current->in.reserve(BLOCK_SIZE);
+    }
+}
+
+/**
+ * \brief Write compressed blocks to the file (in the order of submission)
+ *
+ * If the pipeline is full, the function waits until the oldest block is compressed.
+ * \param[in] file Output file
+ * \param[in] all  Wait until all blocks in the pipeline are compressed and written
+ */
+void
+Compressor::drain(FILE *file, bool all)
+{
+    while (!m_pipeline.empty()) {
+        block *ptr = m_pipeline.front().get();
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!ptr->done) {
+                if (!all && m_pipeline.size() < m_max_blocks) {
+                    // Nothing to write without blocking
+                    return;
+                }
+
+                m_cv_done.wait(lock, [ptr]() { return ptr->done; });
+            }
+        }
+
+        if (ptr->failed) {
+            IPX_CTX_ERROR(m_ctx, "(File output) Failed to compress a block of records. "
+                "%zu bytes of records have been dropped.", ptr->in.size());
+        } else if (fwrite(ptr->out.data(), ptr->out.size(), 1, file) != 1) {
+            IPX_CTX_ERROR(m_ctx, "(File output) Failed to write compressed records to "
+                "a file.", '\0');
+        }
+
+        m_spare.push_back(std::move(m_pipeline.front()));
+        m_pipeline.pop_front();
+    }
+}
+
+/**
+ * \brief Main function of a worker thread
+ *
+ * Each block is compressed as an independent GZIP member. The deflate stream is reused
+ * among blocks to avoid repeated allocation of its internal state.
+ */
+void
+Compressor::worker()
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    // Window bits 15 + 16 -> GZIP header and trailer
+    const bool stream_ready =
+        deflateInit2(&stream, m_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+
+    while (true) {
+        block *ptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_job.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                // Stop request
+                break;
+            }
+
+            ptr = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        bool failed = !stream_ready || deflateReset(&stream) != Z_OK;
+        if (!failed) {
+            ptr->out.resize(deflateBound(&stream, ptr->in.size()));
+            stream.next_in = (Bytef *) ptr->in.data();
+            stream.avail_in = (uInt) ptr->in.size();
+            stream.next_out = (Bytef *) &ptr->out[0];
+            stream.avail_out = (uInt) ptr->out.size();
+
+            failed = deflate(&stream, Z_FINISH) != Z_STREAM_END;
+            ptr->out.resize(ptr->out.size() - stream.avail_out);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ptr->failed = failed;
+            ptr->done = true;
+        }
+        m_cv_done.notify_all();
+    }
+
+    if (stream_ready) {
+        deflateEnd(&stream);
+    }
+}
+
+/**
+ * \brief Get the current time of the monotonic clock (in seconds)
+ */
+time_t
+Compressor::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ts.tv_sec;
+}
@@ -0,0 +1,173 @@
+/**
+ * \file src/plugins/output/json/src/Compressor.hpp
+ * \brief Parallel GZIP compressor of output files (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef JSON_COMPRESSOR_H
+#define JSON_COMPRESSOR_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ipfixcol2.h>
+
+/**
+ * \brief Parallel GZIP compressor
+ *
+ * Written data are split into blocks of fixed size which are compressed by a pool of worker
+ * threads. Each block is compressed as an independent GZIP member and the members are written
+ * to the output file in the original order. Concatenated GZIP members form a valid GZIP file
+ * (RFC 1952), so the result can be decompressed by common tools (gzip, zcat, etc.).
+ *
+ * \warning
+ *   Methods of the class are not thread-safe, i.e. only one thread can write data at time.
+ */
+class Compressor {
+public:
+    /**
+     * \brief Create a compressor and start its worker threads
+     * \param[in] ctx     Instance context (only for logging)
+     * \param[in] threads Number of worker threads
+     * \param[in] level   Compression level (0-9)
+     * \throw runtime_error if the threads cannot be started
+     */
+    Compressor(ipx_ctx_t *ctx, unsigned int threads, int level);
+    /** \brief Stop the worker threads (unwritten data are dropped!) */
+    ~Compressor();
+
+    // Disable copy constructors
+    Compressor(const Compressor &) = delete;
+    Compressor &operator=(const Compressor &) = delete;
+
+    /**
+     * \brief Append data to the file
+     *
+     * Full blocks are passed to the workers and already compressed blocks are written to
+     * the file. The function blocks only if too many blocks are being compressed.
+     * \param[in] file Output file
+     * \param[in] data Data to write
+     * \param[in] len  Size of the data
+     */
+    void
+    write(FILE *file, const char *data, size_t len);
+    /**
+     * \brief Write already compressed blocks to the file
+     *
+     * To avoid tiny GZIP members, a partially filled block is passed to compression only if
+     * it contains data older than #FLUSH_TIMEOUT. The File output calls the function every
+     * second from its thread, so data are written even if no new records arrive.
+     * \param[in] file Output file
+     */
+    void
+    flush(FILE *file);
+    /**
+     * \brief Compress all remaining data and write them to the file
+     *
+     * Must be called before the file is closed. The function waits until all blocks are
+     * compressed and written.
+     * \param[in] file Output file
+     */
+    void
+    finish(FILE *file);
+
+private:
+    /** Size of an uncompressed block                                         */
+    static constexpr size_t BLOCK_SIZE = 256 * 1024;
+    /** Maximal age of data in a partially filled block on flush (seconds)    */
+    static constexpr time_t FLUSH_TIMEOUT = 1;
+
+    /** Data block                                                            */
+    struct block {
+        /** Uncompressed data                                                 */
+        std::string in;
+        /** Compressed data (GZIP member)                                     */
+        std::string out;
+        /** Compression finished (protected by the mutex)                     */
+        bool done;
+        /** Compression failed                                                */
+        bool failed;
+    };
+
+    /** Instance context (only for logging)                                   */
+    ipx_ctx_t *m_ctx;
+    /** Compression level                                                     */
+    int m_level;
+    /** Maximal number of blocks in the pipeline                              */
+    size_t m_max_blocks;
+
+    /** Block being filled                                                    */
+    std::unique_ptr<block> m_current;
+    /** Timestamp of the first byte in the current block (monotonic clock)    */
+    time_t m_current_ts;
+    /** Blocks passed to compression (in the order of submission)             */
+    std::deque<std::unique_ptr<block>> m_pipeline;
+    /** Unused blocks ready for reuse                                         */
+    std::vector<std::unique_ptr<block>> m_spare;
+
+    /** Mutex protecting the queue of jobs, the stop flag and "done" flags    */
+    std::mutex m_mutex;
+    /** New job available or termination request                             */
+    std::condition_variable m_cv_job;
+    /** A block has been compressed                                           */
+    std::condition_variable m_cv_done;
+    /** Blocks waiting for a worker                                           */
+    std::deque<block *> m_jobs;
+    /** Termination flag                                                      */
+    bool m_stop;
+    /** Worker threads                                                        */
+    std::vector<std::thread> m_workers;
+
+    void
+    submit();
+    void
+    drain(FILE *file, bool all);
+    void
+    worker();
+    static time_t
+    now();
+};
+
+#endif // JSON_COMPRESSOR_H
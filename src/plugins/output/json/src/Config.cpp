@@ -63,6 +63,8 @@
 
 #define SYSLOG_APPNAME_MAX_LEN 48
 
+#define FILE_CTHREADS_MAX 64
+
 /** XML nodes */
 enum params_xml_nodes {
     // Formatting parameters
@@ -104,6 +106,7 @@ enum params_xml_nodes {
     FILE_WINDOW,       /**< Window interval                 */
     FILE_ALIGN,        /**< Window alignment                */
     FILE_COMPRESS,     /**< Compression                     */
+    FILE_CTHREADS,     /**< Compression threads             */
     // Kafka output
     KAFKA_NAME,        /**< Name of the output              */
     KAFKA_BROKERS,     /**< List of brokers                 */
@@ -165,6 +168,7 @@ static const struct fds_xml_args args_file[] = {
     FDS_OPTS_ELEM(FILE_WINDOW, "timeWindow",    FDS_OPTS_T_UINT,   0),
     FDS_OPTS_ELEM(FILE_ALIGN,  "timeAlignment", FDS_OPTS_T_BOOL,   0),
     FDS_OPTS_ELEM(FILE_COMPRESS, "compression", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FILE_CTHREADS, "compressionThreads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -444,6 +448,7 @@ Config::parse_file(fds_xml_ctx_t *file)
     output.window_align = true;
     output.window_size = 300;
     output.m_calg = calg::NONE;
+    output.compress_threads = 0;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(file, &content) != FDS_EOC) {
@@ -485,6 +490,15 @@ Config::parse_file(fds_xml_ctx_t *file)
                 throw std::invalid_argument("Unknown compression algorithm '" + inv_str + "'");
             }
             break;
+        case FILE_CTHREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > FILE_CTHREADS_MAX) {
+                throw std::invalid_argument("Number of compression threads must be between 0.."
+                    + std::to_string(FILE_CTHREADS_MAX) + "!");
+            }
+
+            output.compress_threads = static_cast<unsigned int>(content->val_uint);
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <file>!");
         }
@@ -499,6 +513,11 @@ Config::parse_file(fds_xml_ctx_t *file)
             + "' must be defined!");
     }
 
+    if (output.m_calg == calg::NONE) {
+        // Compression threads are pointless without compression
+        output.compress_threads = 0;
+    }
+
     outputs.files.push_back(output);
 }
 
@@ -127,6 +127,8 @@ struct cfg_file : cfg_output {
     bool window_align;
     /** Compression algorithm                                                                    */
     calg m_calg;
+    /** Number of compression threads (0 == compression by the plugin thread)                    */
+    unsigned int compress_threads;
 };
 
 /** Configuration of kafka output                                                                */
@@ -54,6 +54,11 @@
 #include <climits>
 #include <zlib.h>
 
+/** Compression level of GZIP files    */
+#define GZIP_LEVEL (9)
+/** Mode of GZIP files (append, level) */
+#define GZIP_MODE  "a9"
+
 /**
  * \brief Class constructor
  * \param[in] cfg Parsed configuration
@@ -74,10 +79,20 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
     time(&_thread->window_time);
 
     if (cfg.window_size < _WINDOW_MIN_SIZE) {
+        delete _thread;
         throw std::runtime_error("(File output) Window size is too small (min. size: "
             + std::to_string(_WINDOW_MIN_SIZE) + ")");
     }
 
+    if (cfg.m_calg == calg::GZIP && cfg.compress_threads > 0) {
+        try {
+            _thread->compressor.reset(new Compressor(ctx, cfg.compress_threads, GZIP_LEVEL));
+        } catch (...) {
+            delete _thread;
+            throw;
+        }
+    }
+
     // Make sure the path ends with '/' character
     if (_thread->storage_path.back() != '/') {
         _thread->storage_path += '/';
@@ -91,7 +106,7 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 
     // Create directory & first file
     void *new_file = file_create(ctx, _thread->storage_path, _thread->file_prefix,
-        _thread->window_time, _thread->m_calg);
+        _thread->window_time, _thread->m_calg, _thread->compressor != nullptr);
     if (!new_file) {
         delete _thread;
         throw std::runtime_error("(File output) Failed to create a time window file.");
@@ -101,11 +116,7 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 
     pthread_rwlockattr_t attr;
     if (pthread_rwlockattr_init(&attr) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         delete _thread;
         throw std::runtime_error("(File output) Rwlockattr initialization failed!");
     }
@@ -114,11 +125,7 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
     // PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP avoids writer starvation
     // It is a non-portable GNU extension only available on Linux systems
     if (pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         pthread_rwlockattr_destroy(&attr);
         delete _thread;
         throw std::runtime_error("(File output) Rwlockattr setkind failed!");
@@ -126,11 +133,7 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 #endif
 
     if (pthread_rwlock_init(&_thread->rwlock, &attr) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         pthread_rwlockattr_destroy(&attr);
         delete _thread;
         throw std::runtime_error("(File output) Rwlock initialization failed!");
@@ -138,11 +141,7 @@ File::File(const struct cfg_file &cfg, ipx_ctx_t *ctx) : Output(cfg.name, ctx)
 
     pthread_rwlockattr_destroy(&attr);
     if (pthread_create(&_thread->thread, NULL, &File::thread_window, _thread) != 0) {
-        if (_thread->m_calg == calg::GZIP) {
-            gzclose((gzFile)_thread->file);
-        } else {
-            fclose((FILE *)_thread->file);
-        }
+        file_close(_thread);
         pthread_rwlock_destroy(&_thread->rwlock);
         delete _thread;
         throw std::runtime_error("(File output) Failed to start a thread for changing time "
@@ -162,13 +161,7 @@ File::~File()
         pthread_join(_thread->thread, NULL);
         pthread_rwlock_destroy(&_thread->rwlock);
 
-        if (_thread->file) {
-            if (_thread->m_calg == calg::GZIP) {
-                gzclose((gzFile)_thread->file);
-            } else {
-                fclose((FILE *)_thread->file);
-            }
-        }
+        file_close(_thread);
 
         delete _thread;
     }
@@ -184,6 +177,8 @@ File::thread_window(void *context)
 {
     thread_ctx_t *data = (thread_ctx_t *) context;
     IPX_CTX_DEBUG(data->ctx, "(File output) Thread started...", '\0');
+    time_t last_flush;
+    time(&last_flush);
 
     while(!data->stop) {
         // Sleep
@@ -196,23 +191,27 @@ File::thread_window(void *context)
         time_t now;
         time(&now);
 
+        if (data->compressor && difftime(now, last_flush) >= 1) {
+            // Write partially filled blocks even if no records arrive
+            pthread_rwlock_wrlock(&data->rwlock);
+            if (data->file) {
+                data->compressor->flush((FILE *) data->file);
+            }
+            pthread_rwlock_unlock(&data->rwlock);
+            last_flush = now;
+        }
+
         if (difftime(now, data->window_time) <= data->window_size) {
             continue;
         }
 
         // New time window
         pthread_rwlock_wrlock(&data->rwlock);
-        if (data->file) {
-            if (data->m_calg == calg::GZIP) {
-                gzclose((gzFile)data->file);
-            } else {
-                fclose((FILE *)data->file);
-            }
-            data->file = nullptr;
-        }
+        file_close(data);
 
         data->window_time += data->window_size;
-        void *file = file_create(data->ctx, data->storage_path, data->file_prefix, data->window_time, data->m_calg);
+        void *file = file_create(data->ctx, data->storage_path, data->file_prefix,
+            data->window_time, data->m_calg, data->compressor != nullptr);
         if (!file) {
             IPX_CTX_ERROR(data->ctx, "(File output) Failed to create a time window file.", '\0');
         }
@@ -239,7 +238,9 @@ File::process(const char *str, size_t len)
     pthread_rwlock_rdlock(&_thread->rwlock);
     if (_thread->file) {
         // Store the record
-        if (_thread->m_calg == calg::GZIP) {
+        if (_thread->compressor) {
+            _thread->compressor->write((FILE *)_thread->file, str, len);
+        } else if (_thread->m_calg == calg::GZIP) {
             gzwrite((gzFile)_thread->file, str, len);
         } else {
             fwrite(str, len, 1, (FILE *)_thread->file);
@@ -249,12 +250,28 @@ File::process(const char *str, size_t len)
     return IPX_OK;
 }
 
+/**
+ * \brief Store a batch of records to a file (by a single write)
+ * \param[in] str  JSON records
+ * \param[in] offs Offsets of the records
+ * \param[in] cnt  Number of the records
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
+ */
+int
+File::process_batch(const char *str, const size_t *offs, size_t cnt)
+{
+    return process(str + offs[0], offs[cnt] - offs[0]);
+}
+
 void
 File::flush()
 {
     pthread_rwlock_rdlock(&_thread->rwlock);
     if (_thread->file) {
-        if (_thread->m_calg == calg::GZIP) {
+        if (_thread->compressor) {
+            _thread->compressor->flush((FILE *)_thread->file);
+        } else if (_thread->m_calg == calg::GZIP) {
             gzflush((gzFile)_thread->file, Z_SYNC_FLUSH);
         } else {
             fflush((FILE *)_thread->file);
@@ -374,15 +391,18 @@ File::dir_create(ipx_ctx_t *ctx, const std::string &path)
  * \brief Create a file for a time window
  *
  * Check/create a directory hierarchy and create a new file for time window.
- * \param[in] ctx    Instance context - only for logging
- * \param[in] tmplt  Output path template
- * \param[in] prefix File prefix
- * \param[in] tm     Timestamp
+ * \param[in] ctx      Instance context - only for logging
+ * \param[in] tmplt    Output path template
+ * \param[in] prefix   File prefix
+ * \param[in] tm       Timestamp
+ * \param[in] m_calg   Compression algorithm
+ * \param[in] parallel Data are compressed by the parallel compressor (i.e. the file is opened
+ *   as a plain file)
  * \return On success returns pointer to the file, Otherwise returns NULL.
  */
 void *
 File::file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &prefix,
-    const time_t &tm, calg m_calg)
+    const time_t &tm, calg m_calg, bool parallel)
 {
     char file_fmt[20];
 
@@ -412,9 +432,13 @@ File::file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &p
 
     std::string file_name;
     void *file;
-    if (m_calg == calg::GZIP) {
+    if (m_calg == calg::GZIP && parallel) {
+        // GZIP members are prepared by the parallel compressor
+        file_name = directory + prefix + file_fmt + ".gz";
+        file = fopen(file_name.c_str(), "a");
+    } else if (m_calg == calg::GZIP) {
         file_name = directory + prefix + file_fmt + ".gz";
-        file = gzopen(file_name.c_str(), "a9");
+        file = gzopen(file_name.c_str(), GZIP_MODE);
     } else {
         file_name = directory + prefix + file_fmt;
         file = fopen(file_name.c_str(), "a");
@@ -429,3 +453,28 @@ File::file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &p
 
     return file;
 }
+
+/**
+ * \brief Close a file of the current time window
+ *
+ * If the parallel compressor is used, all remaining data are compressed and written first.
+ * \param[in] data Thread configuration
+ */
+void
+File::file_close(thread_ctx_t *data)
+{
+    if (!data->file) {
+        return;
+    }
+
+    if (data->compressor) {
+        data->compressor->finish((FILE *)data->file);
+        fclose((FILE *)data->file);
+    } else if (data->m_calg == calg::GZIP) {
+        gzclose((gzFile)data->file);
+    } else {
+        fclose((FILE *)data->file);
+    }
+
+    data->file = nullptr;
+}
@@ -43,12 +43,14 @@
 #define JSON_FILE_H
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <ctime>
 
 #include <pthread.h>
 #include "Storage.hpp"
 #include "Config.hpp"
+#include "Compressor.hpp"
 
 /**
  * \brief The class for file output interface
@@ -61,6 +63,8 @@ public:
 
     // Store a record to the file
     int process(const char *str, size_t len);
+    // Store a batch of records to the file
+    int process_batch(const char *str, const size_t *offs, size_t cnt);
 
     void flush();
 private:
@@ -79,6 +83,8 @@ private:
         std::string storage_path;    /**< Storage path (template)    */
         std::string file_prefix;     /**< File prefix                */
         calg m_calg;                 /**< Compression                */
+        /** Parallel compressor (only if compression threads are enabled)     */
+        std::unique_ptr<Compressor> compressor;
 
         void *file;                  /**< File descriptor            */
     } thread_ctx_t;
@@ -93,7 +99,9 @@ private:
     static int dir_create(ipx_ctx_t *ctx, const std::string &path);
     // Create a file for a time window
     static void *file_create(ipx_ctx_t *ctx, const std::string &tmplt, const std::string &prefix,
-        const time_t &tm, calg m_calg);
+        const time_t &tm, calg m_calg, bool parallel);
+    // Close a file of the current time window
+    static void file_close(thread_ctx_t *data);
     // Window changer
     static void *thread_window(void *context);
 };
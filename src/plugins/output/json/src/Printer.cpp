@@ -55,3 +55,10 @@ Printer::process(const char *str, size_t len)
     printf("%s", temp.c_str());
     return IPX_OK;
 }
+
+int
+Printer::process_batch(const char *str, const size_t *offs, size_t cnt)
+{
+    fwrite(str + offs[0], offs[cnt] - offs[0], 1, stdout);
+    return IPX_OK;
+}
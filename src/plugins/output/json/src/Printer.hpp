@@ -63,6 +63,16 @@ public:
      * \return #IPX_ERR_DENIED in case of fatal failure
      */
     int process(const char *str, size_t len);
+
+    /**
+     * \brief Print a batch of records on standard output (by a single write)
+     * \param[in] str  JSON strings to print
+     * \param[in] offs Offsets of the strings
+     * \param[in] cnt  Number of the strings
+     * \return #IPX_OK on success
+     * \return #IPX_ERR_DENIED in case of fatal failure
+     */
+    int process_batch(const char *str, const size_t *offs, size_t cnt);
 };
 
 #endif // JSON_PRINTER_H
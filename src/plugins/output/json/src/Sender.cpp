@@ -55,6 +55,8 @@
 #define INVALID_FD (-1)
 /** Delay between reconnection attempts (seconds)  */
 #define RECONN_DELAY (5)
+/** Maximal number of datagrams per system call    */
+#define DGRAM_BATCH  (64)
 
 /**
  * \brief Class constructor
@@ -79,6 +81,38 @@ Sender::~Sender()
     }
 }
 
+/**
+ * \brief Check the connection and try to reconnect, if necessary
+ * \return True if connected
+ */
+bool
+Sender::ready()
+{
+    if (sd != INVALID_FD) {
+        return true;
+    }
+
+    // Not connected -> try to reconnect
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // Try only one reconnection per second
+    if (connection_time.tv_sec + RECONN_DELAY > now.tv_sec) {
+        return false;
+    }
+
+    connection_time = now;
+    if (connect() != IPX_OK) {
+        IPX_CTX_WARNING(_ctx, "(Send output) Reconnection to '%s:%" PRIu16 "' failed! "
+            "Trying again in %d seconds.", params.addr.c_str(), params.port, int(RECONN_DELAY));
+        return false;
+    }
+
+    IPX_CTX_INFO(_ctx, "(Send output) Successfully connected to '%s:%" PRIu16 "'.",
+        params.addr.c_str(), params.port);
+    return true;
+}
+
 /**
  * \brief Send a JSON record
  * \param[in] str JSON Record to send
@@ -88,25 +122,8 @@ Sender::~Sender()
 int
 Sender::process(const char *str, size_t len)
 {
-    if (sd == INVALID_FD) {
-        // Not connected -> try to reconnect
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-
-        // Try only one reconnection per second
-        if (connection_time.tv_sec + RECONN_DELAY > now.tv_sec) {
-            return IPX_OK;
-        }
-
-        connection_time = now;
-        if (connect() != IPX_OK) {
-            IPX_CTX_WARNING(_ctx, "(Send output) Reconnection to '%s:%" PRIu16 "' failed! "
-                "Trying again in %d seconds.", params.addr.c_str(), params.port, int(RECONN_DELAY));
-            return IPX_OK;
-        } else {
-            IPX_CTX_INFO(_ctx, "(Send output) Successfully connected to '%s:%" PRIu16 "'.",
-                params.addr.c_str(), params.port);
-        }
+    if (!ready()) {
+        return IPX_OK;
     }
 
     // Send not previously send data (only for non-blocking mode)
@@ -143,6 +160,36 @@ Sender::process(const char *str, size_t len)
     return IPX_OK;
 }
 
+/**
+ * \brief Send a batch of JSON records
+ *
+ * Over TCP, all records are sent at once as a single part of the stream. Over UDP, each
+ * record is sent as a separate datagram, however, multiple datagrams are passed to the kernel
+ * by a single system call.
+ * \param[in] str  JSON Records to send
+ * \param[in] offs Offsets of the records
+ * \param[in] cnt  Number of the records
+ * \return Always #IPX_OK
+ */
+int
+Sender::process_batch(const char *str, const size_t *offs, size_t cnt)
+{
+    if (params.proto == cfg_send::SEND_PROTO_TCP) {
+        return process(str + offs[0], offs[cnt] - offs[0]);
+    }
+
+    if (!ready()) {
+        return IPX_OK;
+    }
+
+    if (send_datagrams(str, offs, cnt) == SEND_FAILED) {
+        close(sd);
+        sd = INVALID_FD;
+    }
+
+    return IPX_OK;
+}
+
 /**
  * \brief Create a new connection to the destination
  * \return #IPX_OK on success
@@ -259,4 +306,58 @@ Sender::send(const char *str, size_t len)
     std::string tmp(ptr, todo);
     msg_rest.assign(tmp);
     return SEND_WOULDBLOCK;
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Send JSON records as separate datagrams
+ *
+ * In non-blocking mode, records that cannot be sent immediately are dropped.
+ * \param[in] str  Records to send
+ * \param[in] offs Offsets of the records
+ * \param[in] cnt  Number of the records
+ * \return #SEND_OK on success
+ * \return #SEND_WOULDBLOCK if some records were not sent
+ * \return #SEND_FAILED in case of broken connection
+ */
+enum Sender::Send_status
+Sender::send_datagrams(const char *str, const size_t *offs, size_t cnt)
+{
+    struct mmsghdr msgs[DGRAM_BATCH];
+    struct iovec iovs[DGRAM_BATCH];
+
+    int flags = MSG_NOSIGNAL;
+    if (!params.blocking) {
+        flags |= MSG_DONTWAIT;
+    }
+
+    size_t idx = 0;
+    while (idx < cnt) {
+        const unsigned int batch = (cnt - idx < DGRAM_BATCH) ? (cnt - idx) : DGRAM_BATCH;
+        memset(msgs, 0, batch * sizeof(msgs[0]));
+        for (unsigned int i = 0; i < batch; ++i) {
+            iovs[i].iov_base = (void *) (str + offs[idx + i]);
+            iovs[i].iov_len = offs[idx + i + 1] - offs[idx + i];
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int now = sendmmsg(sd, msgs, batch, flags);
+        if (now == -1) {
+            if (!params.blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Non-blocking mode - drop the rest
+                return SEND_WOULDBLOCK;
+            }
+
+            // Connection failed
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_INFO(_ctx, "(Send output) Destination '%s:%" PRIu16 "' disconnected: %s",
+                params.addr.c_str(), params.port, err_str);
+            return SEND_FAILED;
+        }
+
+        idx += unsigned(now);
+    }
+
+    return SEND_OK;
+}
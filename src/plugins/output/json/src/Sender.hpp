@@ -54,6 +54,8 @@ public:
 
     // Processing records
     int process(const char *str, size_t len);
+    // Processing a batch of records
+    int process_batch(const char *str, const size_t *offs, size_t cnt);
 
 private:
     /** Transmission status */
@@ -72,8 +74,10 @@ private:
     /** Time of the last connection attempt                                       */
     struct timespec connection_time;
 
+    bool ready();
     int connect();
     enum Send_status send(const char *str, size_t len);
+    enum Send_status send_datagrams(const char *str, const size_t *offs, size_t cnt);
 };
 
 #endif // JSON_SENDER_H
@@ -0,0 +1,872 @@
+/**
+ * \file src/plugins/output/json/src/Serializer.cpp
+ * \brief Template-specialized JSON serializer (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#include <cstdlib>
+#include <cstring>
+#include <arpa/inet.h>
+#include <ipfixcol2.h>
+#include "Serializer.hpp"
+
+/** Offset between NTP (1900) and UNIX (1970) epochs in seconds                             */
+#define NTP_EPOCH_DIFF  2208988800ULL
+/** First millisecond after the year 9999 (i.e. timestamps that have 4 digit years only)     */
+#define ISO_MSEC_MAX    253402300800000ULL
+/** Beginning of a converted (Options) Data Record                                          */
+#define PREFIX_DATA     "{\"@type\":\"ipfix.entry\""
+#define PREFIX_OPTS     "{\"@type\":\"ipfix.optionsEntry\""
+/** Information Element ID of paddingOctets (always hidden by the record iterator)           */
+#define IE_PADDING      210U
+/** Information Element ID of protocolIdentifier (see ::FDS_CD2J_FORMAT_PROTO)              */
+#define IE_PROTO        4U
+/** Information Element ID of tcpControlBits (see ::FDS_CD2J_FORMAT_TCPFLAGS)               */
+#define IE_TCPFLAGS     6U
+
+namespace {
+
+/** Value formatters                                                                       */
+enum class fmt_type : uint8_t {
+    UINT,      ///< Unsigned integer (1 - 8 bytes)
+    INT,       ///< Signed integer (1 - 8 bytes)
+    OCTETS,    ///< Octet array and fields of unknown type
+    IPV4,      ///< IPv4 address
+    IPV6,      ///< IPv6 address
+    MAC,       ///< MAC address
+    BOOL,      ///< Boolean
+    TS_SEC,    ///< dateTimeSeconds
+    TS_MSEC,   ///< dateTimeMilliseconds
+    TS_USEC,   ///< dateTimeMicroseconds
+    TS_NSEC,   ///< dateTimeNanoseconds
+    MEMO,      ///< Lookup table of values generated by the libfds converter
+    REF        ///< libfds converter applied to the single field
+};
+
+/** Pairs of decimal digits                                                                */
+const char digits[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+/** Hexadecimal digits                                                                     */
+const char hex_upper[] = "0123456789ABCDEF";
+
+/**
+ * \brief Write an unsigned integer as a decimal number
+ * \param[in] value Value to write
+ * \param[in] out   Output buffer (at least 20 bytes)
+ * \return Pointer behind the last written character
+ */
+inline char *
+write_u64(uint64_t value, char *out)
+{
+    char tmp[20];
+    char *pos = tmp + sizeof(tmp);
+    while (value >= 100) {
+        const unsigned idx = unsigned(value % 100) * 2;
+        value /= 100;
+        *--pos = digits[idx + 1];
+        *--pos = digits[idx];
+    }
+    if (value >= 10) {
+        const unsigned idx = unsigned(value) * 2;
+        *--pos = digits[idx + 1];
+        *--pos = digits[idx];
+    } else {
+        *--pos = char('0' + value);
+    }
+
+    const size_t len = size_t(tmp + sizeof(tmp) - pos);
+    memcpy(out, pos, len);
+    return out + len;
+}
+
+/**
+ * \brief Write a fixed number of decimal digits (with leading zeros)
+ * \param[in] value  Value to write
+ * \param[in] digits Number of digits
+ * \param[in] out    Output buffer
+ * \return Pointer behind the last written character
+ */
+inline char *
+write_fixed(unsigned value, unsigned cnt, char *out)
+{
+    for (unsigned i = cnt; i > 0; --i) {
+        out[i - 1] = char('0' + value % 10);
+        value /= 10;
+    }
+    return out + cnt;
+}
+
+/**
+ * \brief Read an unsigned integer in network byte order
+ * \param[in] data Pointer to the value
+ * \param[in] size Size of the value (1 - 8 bytes)
+ */
+inline uint64_t
+read_u64(const uint8_t *data, uint16_t size)
+{
+    uint64_t value = 0;
+    for (uint16_t i = 0; i < size; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * \brief Write a timestamp (milliseconds since UNIX epoch) in ISO 8601 format
+ *
+ * The format is "YYYY-MM-DDThh:mm:ss.sssZ" (including the quotation marks).
+ * \param[in] msec Timestamp (must be less than ::ISO_MSEC_MAX)
+ * \param[in] out  Output buffer (at least 26 bytes)
+ * \return Pointer behind the last written character
+ */
+char *
+write_iso(uint64_t msec, char *out)
+{
+    const uint64_t days = msec / 86400000U;
+    uint32_t rem = uint32_t(msec % 86400000U);
+
+    // Conversion of days to a civil date (proleptic Gregorian calendar)
+    const uint64_t z = days + 719468U;
+    const uint64_t era = z / 146097U;
+    const unsigned doe = unsigned(z - era * 146097U);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = (mp < 10) ? (mp + 3) : (mp - 9);
+    const unsigned year = unsigned(yoe + era * 400U) + (month <= 2);
+
+    *out++ = '"';
+    out = write_fixed(year, 4, out);
+    *out++ = '-';
+    out = write_fixed(month, 2, out);
+    *out++ = '-';
+    out = write_fixed(day, 2, out);
+    *out++ = 'T';
+    out = write_fixed(rem / 3600000U, 2, out);
+    rem %= 3600000U;
+    *out++ = ':';
+    out = write_fixed(rem / 60000U, 2, out);
+    rem %= 60000U;
+    *out++ = ':';
+    out = write_fixed(rem / 1000U, 2, out);
+    *out++ = '.';
+    out = write_fixed(rem % 1000U, 3, out);
+    *out++ = 'Z';
+    *out++ = '"';
+    return out;
+}
+
+/**
+ * \brief Get the native formatter of a field
+ * \param[in] def    Definition of the field (can be NULL)
+ * \param[in] length Length of the field in the template
+ * \param[in] flags  Conversion flags
+ */
+fmt_type
+fmt_select(const struct fds_iemgr_elem *def, uint16_t length, uint32_t flags)
+{
+    if (!def) {
+        return fmt_type::OCTETS;
+    }
+
+    // Fields with special formatting (e.g. "TCP" instead of 6)
+    if (def->scope->pen == 0) {
+        if ((def->id == IE_PROTO && (flags & FDS_CD2J_FORMAT_PROTO) != 0)
+                || (def->id == IE_TCPFLAGS && (flags & FDS_CD2J_FORMAT_TCPFLAGS) != 0)) {
+            return fmt_type::REF;
+        }
+    }
+
+    const bool var = (length == FDS_IPFIX_VAR_IE_LEN);
+    switch (def->data_type) {
+    case FDS_ET_UNSIGNED_8:
+    case FDS_ET_UNSIGNED_16:
+    case FDS_ET_UNSIGNED_32:
+    case FDS_ET_UNSIGNED_64:
+        return (!var && length >= 1 && length <= 8) ? fmt_type::UINT : fmt_type::REF;
+    case FDS_ET_SIGNED_8:
+    case FDS_ET_SIGNED_16:
+    case FDS_ET_SIGNED_32:
+    case FDS_ET_SIGNED_64:
+        return (!var && length >= 1 && length <= 8) ? fmt_type::INT : fmt_type::REF;
+    case FDS_ET_OCTET_ARRAY:
+        return fmt_type::OCTETS;
+    case FDS_ET_IPV4_ADDRESS:
+        return (length == 4) ? fmt_type::IPV4 : fmt_type::REF;
+    case FDS_ET_IPV6_ADDRESS:
+        return (length == 16) ? fmt_type::IPV6 : fmt_type::REF;
+    case FDS_ET_MAC_ADDRESS:
+        return (length == 6) ? fmt_type::MAC : fmt_type::REF;
+    case FDS_ET_BOOLEAN:
+        return (length == 1) ? fmt_type::BOOL : fmt_type::REF;
+    case FDS_ET_DATE_TIME_SECONDS:
+        return (length == 4) ? fmt_type::TS_SEC : fmt_type::REF;
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+        return (length == 8) ? fmt_type::TS_MSEC : fmt_type::REF;
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+        return (length == 8) ? fmt_type::TS_USEC : fmt_type::REF;
+    case FDS_ET_DATE_TIME_NANOSECONDS:
+        return (length == 8) ? fmt_type::TS_NSEC : fmt_type::REF;
+    default:
+        return fmt_type::REF;
+    }
+}
+
+/**
+ * \brief Get the maximal length of a value written by a native formatter
+ * \param[in] type Formatter
+ * \param[in] size Size of the field value
+ */
+inline size_t
+fmt_max(fmt_type type, uint16_t size)
+{
+    switch (type) {
+    case fmt_type::OCTETS: return 2U * size + 32U; // "\"0x" + hex digits + "\"" or integer
+    case fmt_type::IPV6:   return INET6_ADDRSTRLEN + 2U;
+    default:               return 32U;
+    }
+}
+
+/**
+ * \brief Convert a value by a native formatter
+ * \param[in] type  Formatter
+ * \param[in] data  Field value
+ * \param[in] size  Size of the field value
+ * \param[in] flags Conversion flags
+ * \param[in] out   Output buffer (at least fmt_max() bytes)
+ * \return Pointer behind the last written character
+ * \return NULL if the value is not supported by the formatter
+ */
+char *
+fmt_native(fmt_type type, const uint8_t *data, uint16_t size, uint32_t flags, char *out)
+{
+    uint64_t msec;
+
+    switch (type) {
+    case fmt_type::UINT:
+        return write_u64(read_u64(data, size), out);
+    case fmt_type::INT: {
+        uint64_t value = read_u64(data, size);
+        const unsigned shift = 64U - 8U * size;
+        const int64_t svalue = int64_t(value << shift) >> shift;
+        if (svalue >= 0) {
+            return write_u64(uint64_t(svalue), out);
+        }
+        *out++ = '-';
+        return write_u64(uint64_t(0) - uint64_t(svalue), out);
+        }
+    case fmt_type::OCTETS:
+        if (size == 0) {
+            return nullptr;
+        }
+        if (size <= 8 && (flags & FDS_CD2J_OCTETS_NOINT) == 0) {
+            return write_u64(read_u64(data, size), out);
+        }
+        *out++ = '"';
+        *out++ = '0';
+        *out++ = 'x';
+        for (uint16_t i = 0; i < size; ++i) {
+            *out++ = hex_upper[data[i] >> 4];
+            *out++ = hex_upper[data[i] & 0xF];
+        }
+        *out++ = '"';
+        return out;
+    case fmt_type::IPV4:
+        *out++ = '"';
+        for (unsigned i = 0; i < 4; ++i) {
+            if (i != 0) {
+                *out++ = '.';
+            }
+            out = write_u64(data[i], out);
+        }
+        *out++ = '"';
+        return out;
+    case fmt_type::IPV6:
+        *out++ = '"';
+        if (!inet_ntop(AF_INET6, data, out, INET6_ADDRSTRLEN)) {
+            return nullptr;
+        }
+        out += strlen(out);
+        *out++ = '"';
+        return out;
+    case fmt_type::MAC:
+        *out++ = '"';
+        for (unsigned i = 0; i < 6; ++i) {
+            if (i != 0) {
+                *out++ = ':';
+            }
+            *out++ = hex_upper[data[i] >> 4];
+            *out++ = hex_upper[data[i] & 0xF];
+        }
+        *out++ = '"';
+        return out;
+    case fmt_type::BOOL:
+        // Only values defined by RFC 7011 (1 == true, 2 == false)
+        if (data[0] == 1) {
+            memcpy(out, "true", 4);
+            return out + 4;
+        }
+        if (data[0] == 2) {
+            memcpy(out, "false", 5);
+            return out + 5;
+        }
+        return nullptr;
+    case fmt_type::TS_SEC:
+        msec = read_u64(data, 4) * 1000U;
+        break;
+    case fmt_type::TS_MSEC:
+        msec = read_u64(data, 8);
+        break;
+    case fmt_type::TS_USEC:
+    case fmt_type::TS_NSEC: {
+        // NTP timestamp (the lowest 11 bits of the fraction are unused for microseconds)
+        const uint64_t sec = read_u64(data, 4);
+        uint64_t frac = read_u64(data + 4, 4);
+        if (sec < NTP_EPOCH_DIFF) {
+            return nullptr;
+        }
+        if (type == fmt_type::TS_USEC) {
+            frac &= 0xFFFFF800U;
+        }
+        msec = (sec - NTP_EPOCH_DIFF) * 1000U + ((frac * 1000U) >> 32);
+        break;
+        }
+    default:
+        return nullptr;
+    }
+
+    // Timestamps
+    if ((flags & FDS_CD2J_TS_FORMAT_MSEC) == 0) {
+        return write_u64(msec, out);
+    }
+    if (msec >= ISO_MSEC_MAX) {
+        return nullptr;
+    }
+    return write_iso(msec, out);
+}
+
+/**
+ * \brief Check if a field has a structured data type
+ * \param[in] def Definition of the field (can be NULL)
+ */
+inline bool
+is_structured(const struct fds_iemgr_elem *def)
+{
+    if (!def) {
+        return false;
+    }
+
+    switch (def->data_type) {
+    case FDS_ET_BASIC_LIST:
+    case FDS_ET_SUB_TEMPLATE_LIST:
+    case FDS_ET_SUB_TEMPLATE_MULTILIST:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+/** Information Element described by a single field template                              */
+struct Serializer::element {
+    /** Single field template                                                             */
+    struct fds_template *tmplt = nullptr;
+    /** JSON key (e.g. ",\"iana:octetDeltaCount\":")                                      */
+    std::string key;
+    /** Formatter of values                                                               */
+    fmt_type fmt = fmt_type::REF;
+    /** Converted values 0 - 255 (only for fmt_type::MEMO)                                */
+    std::vector<std::string> memo;
+
+    ~element() {
+        if (tmplt) {
+            fds_template_destroy(tmplt);
+        }
+    }
+};
+
+/** Conversion plan of a (Options) Template                                                */
+struct Serializer::plan {
+    /** Field of the template                                                             */
+    struct field {
+        /** Information Element (NULL, if the field is not converted)                     */
+        const element *elem;
+        /** Length of the field in the template                                           */
+        uint16_t length;
+    };
+
+    /** Identification of the template of the plan                                        */
+    struct ipx_tmplt_id id = {nullptr, nullptr, nullptr, 0};
+    /** Conversion flags of the plan                                                      */
+    uint32_t flags = 0;
+    /** The plan cannot be used (records are converted by the libfds converter)           */
+    bool generic = false;
+    /** Beginning of converted records                                                    */
+    const char *prefix = nullptr;
+    /** Length of the beginning                                                           */
+    size_t prefix_len = 0;
+    /** Fields in the order of the template                                               */
+    std::vector<field> fields;
+
+    ~plan() {
+        ipx_tmplt_id_clear(&id);
+    }
+};
+
+/** Output buffer (compatible with the libfds converter)                                   */
+struct Serializer::writer {
+    /** Pointer to the buffer                                                             */
+    char **buffer;
+    /** Size of the buffer                                                                */
+    size_t *size_alloc;
+    /** Used size                                                                         */
+    size_t size_used;
+
+    /**
+     * \brief Reserve space at the end of the buffer
+     * \param[in] n Required space (excluding the terminating null byte)
+     * \return Pointer to the end of the buffer or NULL (memory allocation error)
+     */
+    char *
+    reserve(size_t n)
+    {
+        const size_t required = size_used + n + 1;
+        if (required > *size_alloc) {
+            size_t new_size = (*size_alloc > 0) ? (2 * *size_alloc) : 1024U;
+            while (new_size < required) {
+                new_size *= 2;
+            }
+            char *new_buffer = static_cast<char *>(realloc(*buffer, new_size));
+            if (!new_buffer) {
+                return nullptr;
+            }
+            *buffer = new_buffer;
+            *size_alloc = new_size;
+        }
+        return *buffer + size_used;
+    }
+
+    /**
+     * \brief Update the used size after writing to reserved space
+     * \param[in] end Pointer behind the last written character
+     */
+    void
+    commit(char *end)
+    {
+        size_used = size_t(end - *buffer);
+    }
+
+    /**
+     * \brief Append a string
+     * \return False on memory allocation error
+     */
+    bool
+    append(const char *str, size_t len)
+    {
+        char *pos = reserve(len);
+        if (!pos) {
+            return false;
+        }
+        memcpy(pos, str, len);
+        size_used += len;
+        return true;
+    }
+};
+
+Serializer::Serializer() : m_plans(PLAN_CNT)
+{
+}
+
+Serializer::~Serializer()
+{
+    free(m_aux);
+}
+
+/**
+ * \brief Drop cached plans and elements if the Information Element manager or flags changed
+ * \param[in] flags Conversion flags
+ * \param[in] iemgr Manager of Information Elements
+ */
+void
+Serializer::cache_check(uint32_t flags, const fds_iemgr_t *iemgr)
+{
+    // Flags that affect only selection of fields are not relevant to single fields
+    const uint32_t elem_flags = flags & ~(FDS_CD2J_BIFLOW_REVERSE | FDS_CD2J_REVERSE_SKIP);
+    if (iemgr == m_iemgr && elem_flags == m_elem_flags) {
+        return;
+    }
+
+    for (auto &plan : m_plans) {
+        plan.reset();
+    }
+    m_elems.clear();
+    m_iemgr = iemgr;
+    m_elem_flags = elem_flags;
+}
+
+/**
+ * \brief Convert a single field value by the libfds converter
+ *
+ * Used for values without a native formatter and to generate lookup tables of values.
+ * \param[in]  elem  Information Element
+ * \param[in]  data  Encoded field value (including the length prefix of variable length fields)
+ * \param[in]  size  Size of the encoded field value
+ * \param[out] value Converted value (valid until the next conversion)
+ * \return Length of the converted value
+ * \return Negative value (FDS_ERR_*) on failure
+ */
+int
+Serializer::elem_reference(const element &elem, const uint8_t *data, uint16_t size,
+    const char **value)
+{
+    struct fds_drec rec;
+    rec.data = const_cast<uint8_t *>(data);
+    rec.size = size;
+    rec.tmplt = elem.tmplt;
+    rec.snap = nullptr;
+
+    const uint32_t flags = m_elem_flags | FDS_CD2J_ALLOW_REALLOC;
+    int rc = fds_drec2json(&rec, flags, m_iemgr, &m_aux, &m_aux_size);
+    if (rc < 0) {
+        return rc;
+    }
+
+    // Expected format: <prefix><key><value>}
+    const size_t prefix_len = sizeof(PREFIX_DATA) - 1;
+    const size_t head_len = prefix_len + elem.key.size();
+    const size_t len = size_t(rc);
+    if (len <= head_len || m_aux[len - 1] != '}'
+            || memcmp(m_aux, PREFIX_DATA, prefix_len) != 0
+            || memcmp(m_aux + prefix_len, elem.key.data(), elem.key.size()) != 0) {
+        return FDS_ERR_FORMAT;
+    }
+
+    *value = m_aux + head_len;
+    return int(len - head_len - 1);
+}
+
+/**
+ * \brief Get an Information Element described by a single field template
+ *
+ * The element is created if it doesn't exist yet. Its formatter is selected and, if possible,
+ * a lookup table of its values is generated.
+ * \param[in] field Field of a template (as seen in the view of the plan)
+ * \param[in] flags Conversion flags
+ * \return Pointer to the element or NULL (the element cannot be converted separately)
+ */
+Serializer::element *
+Serializer::elem_get(const struct fds_tfield &field, uint32_t flags)
+{
+    const struct fds_iemgr_elem *def = field.def;
+    const bool numeric = (!def || (flags & FDS_CD2J_NUMERIC_ID) != 0);
+    const uint32_t en = numeric ? field.en : def->scope->pen;
+    const uint16_t id = numeric ? field.id : uint16_t(def->id);
+    const uint64_t key = (uint64_t(en) << 32) | (uint64_t(id) << 16) | field.length;
+
+    auto it = m_elems.find(key);
+    if (it != m_elems.end()) {
+        return it->second.get();
+    }
+
+    std::unique_ptr<element> elem(new element);
+    m_elems[key] = nullptr; // Unless successfully created, the element cannot be used
+
+    // Create a single field template
+    uint8_t raw[12];
+    uint16_t raw_size = (en == 0) ? 8 : 12;
+    const uint16_t raw_hdr[] = {htons(256), htons(1), htons(id | ((en != 0) ? 0x8000 : 0)),
+        htons(field.length)};
+    const uint32_t raw_en = htonl(en);
+    memcpy(raw, raw_hdr, sizeof(raw_hdr));
+    memcpy(raw + sizeof(raw_hdr), &raw_en, sizeof(raw_en));
+    if (fds_template_parse(FDS_TYPE_TEMPLATE, raw, &raw_size, &elem->tmplt) != FDS_OK) {
+        elem->tmplt = nullptr;
+        return nullptr;
+    }
+    if (m_iemgr && fds_template_ies_define(elem->tmplt, m_iemgr, false) != FDS_OK) {
+        return nullptr;
+    }
+    if (elem->tmplt->fields_cnt_total != 1 || elem->tmplt->fields[0].def != def) {
+        // The element is interpreted differently out of the original template
+        return nullptr;
+    }
+
+    // Expected JSON key
+    if (numeric) {
+        elem->key = ",\"en" + std::to_string(field.en) + ":id" + std::to_string(field.id)
+            + "\":";
+    } else {
+        elem->key = ",\"" + std::string(def->scope->name) + ":" + def->name + "\":";
+    }
+
+    // Select the formatter
+    elem->fmt = fmt_select(def, field.length, flags);
+    if (elem->fmt != fmt_type::REF && field.length != 1) {
+        m_elems[key] = std::move(elem);
+        return m_elems[key].get();
+    }
+
+    if (field.length == 1 || field.length == 2) {
+        // Lookup table of values 0 - 255 (e.g. protocols, TCP flags)
+        const char *value;
+        elem->memo.resize(256);
+        for (unsigned i = 0; i < 256; ++i) {
+            const uint8_t data[2] = {uint8_t(field.length == 1 ? i : 0), uint8_t(i)};
+            const uint8_t *ptr = (field.length == 1) ? data + 1 : data;
+            int rc = elem_reference(*elem, ptr, field.length, &value);
+            if (rc < 0) {
+                return nullptr;
+            }
+            elem->memo[i].assign(value, size_t(rc));
+        }
+        elem->fmt = fmt_type::MEMO;
+    } else {
+        elem->fmt = fmt_type::REF;
+    }
+
+    m_elems[key] = std::move(elem);
+    return m_elems[key].get();
+}
+
+/**
+ * \brief Prepare a conversion plan of a template
+ * \param[out] plan  Plan to fill
+ * \param[in]  tmplt Template
+ * \param[in]  flags Conversion flags
+ */
+void
+Serializer::plan_build(plan &plan, const struct fds_template *tmplt, uint32_t flags)
+{
+    plan.flags = flags;
+    plan.generic = false;
+    plan.fields.clear();
+
+    if (tmplt->type == FDS_TYPE_TEMPLATE_OPTS) {
+        plan.prefix = PREFIX_OPTS;
+        plan.prefix_len = sizeof(PREFIX_OPTS) - 1;
+    } else {
+        plan.prefix = PREFIX_DATA;
+        plan.prefix_len = sizeof(PREFIX_DATA) - 1;
+    }
+
+    if ((tmplt->flags & FDS_TEMPLATE_MULTI_IE) != 0) {
+        // Multiple occurrences of the same IE are converted to JSON arrays
+        plan.generic = true;
+        return;
+    }
+
+    // Fields as seen by the record iterator
+    const bool reverse = (flags & FDS_CD2J_BIFLOW_REVERSE) != 0 && tmplt->fields_rev;
+    const struct fds_tfield *view = reverse ? tmplt->fields_rev : tmplt->fields;
+
+    plan.fields.reserve(tmplt->fields_cnt_total);
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &tfield = view[i];
+        struct plan::field field = {nullptr, tfield.length};
+
+        const bool hidden = (tfield.en == 0 && tfield.id == IE_PADDING)
+            || ((flags & FDS_CD2J_REVERSE_SKIP) != 0 && (tfield.flags & FDS_TFIELD_REVERSE) != 0)
+            || ((flags & FDS_CD2J_IGNORE_UNKNOWN) != 0 && !tfield.def);
+        if (!hidden) {
+            if (is_structured(tfield.def)) {
+                plan.generic = true;
+                return;
+            }
+
+            field.elem = elem_get(tfield, flags);
+            if (!field.elem) {
+                plan.generic = true;
+                return;
+            }
+        }
+
+        plan.fields.push_back(field);
+    }
+}
+
+/**
+ * \brief Get a conversion plan of a record
+ * \param[in] rec   Data Record
+ * \param[in] flags Conversion flags
+ * \return Pointer to the plan
+ * \throws bad_alloc in case of a memory allocation error
+ */
+Serializer::plan *
+Serializer::plan_get(const struct fds_drec *rec, uint32_t flags)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    const uint64_t hash = ipx_tmplt_id_hash(tmplt) ^ (flags & FDS_CD2J_BIFLOW_REVERSE);
+
+    std::unique_ptr<plan> &entry = m_plans[hash & (PLAN_CNT - 1)];
+    if (!entry) {
+        entry.reset(new plan);
+    } else if (entry->flags == flags && ipx_tmplt_id_match(&entry->id, tmplt, rec->snap)) {
+        return entry.get();
+    }
+
+    plan_build(*entry, tmplt, flags);
+    if (ipx_tmplt_id_set(&entry->id, tmplt, rec->snap) != IPX_OK) {
+        throw std::bad_alloc();
+    }
+    return entry.get();
+}
+
+/**
+ * \brief Convert a record by a plan
+ * \param[in]  plan Conversion plan
+ * \param[in]  rec  Data Record
+ * \param[out] out  Output buffer
+ * \return Length of the JSON string on success
+ * \return Negative value (FDS_ERR_*) on failure
+ */
+int
+Serializer::execute(const plan &plan, const struct fds_drec *rec, writer &out)
+{
+    const uint8_t *pos = rec->data;
+    const uint8_t *rec_end = rec->data + rec->size;
+
+    if (!out.append(plan.prefix, plan.prefix_len)) {
+        return FDS_ERR_NOMEM;
+    }
+
+    for (const auto &field : plan.fields) {
+        // Locate the field value
+        const uint8_t *start = pos;
+        uint16_t size = field.length;
+        if (size == FDS_IPFIX_VAR_IE_LEN) {
+            if (pos + 1 > rec_end) {
+                return FDS_ERR_FORMAT;
+            }
+            size = *(pos++);
+            if (size == 255) {
+                if (pos + 2 > rec_end) {
+                    return FDS_ERR_FORMAT;
+                }
+                size = uint16_t((pos[0] << 8) | pos[1]);
+                pos += 2;
+            }
+        }
+        if (pos + size > rec_end) {
+            return FDS_ERR_FORMAT;
+        }
+
+        const uint8_t *data = pos;
+        pos += size;
+        const element *elem = field.elem;
+        if (!elem) {
+            continue;
+        }
+
+        // Key and value
+        const size_t key_len = elem->key.size();
+        const std::string *memo = nullptr;
+        if (elem->fmt == fmt_type::MEMO && (size == 1 || data[0] == 0)) {
+            memo = &elem->memo[data[size - 1]];
+        }
+
+        if (memo) {
+            char *ptr = out.reserve(key_len + memo->size());
+            if (!ptr) {
+                return FDS_ERR_NOMEM;
+            }
+            memcpy(ptr, elem->key.data(), key_len);
+            memcpy(ptr + key_len, memo->data(), memo->size());
+            out.commit(ptr + key_len + memo->size());
+            continue;
+        }
+
+        if (elem->fmt != fmt_type::MEMO && elem->fmt != fmt_type::REF) {
+            char *ptr = out.reserve(key_len + fmt_max(elem->fmt, size));
+            if (!ptr) {
+                return FDS_ERR_NOMEM;
+            }
+            memcpy(ptr, elem->key.data(), key_len);
+            char *end = fmt_native(elem->fmt, data, size, m_elem_flags, ptr + key_len);
+            if (end) {
+                out.commit(end);
+                continue;
+            }
+        }
+
+        // Conversion by the libfds converter
+        const char *value;
+        int rc = elem_reference(*elem, start, uint16_t(pos - start), &value);
+        if (rc < 0) {
+            return rc;
+        }
+        if (!out.append(elem->key.data(), key_len) || !out.append(value, size_t(rc))) {
+            return FDS_ERR_NOMEM;
+        }
+    }
+
+    char *ptr = out.reserve(1);
+    if (!ptr) {
+        return FDS_ERR_NOMEM;
+    }
+    ptr[0] = '}';
+    ptr[1] = '\0';
+    out.commit(ptr + 1);
+    return int(out.size_used);
+}
+
+int
+Serializer::convert(const struct fds_drec *rec, uint32_t flags, const fds_iemgr_t *iemgr,
+    char **str, size_t *str_size)
+{
+    flags |= FDS_CD2J_ALLOW_REALLOC;
+    cache_check(flags, iemgr);
+
+    const plan *plan = plan_get(rec, flags);
+    if (!plan->generic) {
+        writer out = {str, str_size, 0};
+        int rc = execute(*plan, rec, out);
+        if (rc >= 0) {
+            m_stats.planned++;
+            return rc;
+        }
+    }
+
+    // Unexpected values are converted by the libfds converter as a whole
+    struct fds_drec drec = *rec;
+    m_stats.generic++;
+    return fds_drec2json(&drec, flags, iemgr, str, str_size);
+}
@@ -0,0 +1,152 @@
+/**
+ * \file src/plugins/output/json/src/Serializer.hpp
+ * \brief Template-specialized JSON serializer (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef JSON_SERIALIZER_H
+#define JSON_SERIALIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <libfds.h>
+
+/**
+ * \brief Template-specialized converter of IPFIX Data Records to JSON
+ *
+ * The converter is a drop-in replacement of fds_drec2json(). For each (Options) Template it
+ * prepares a plan, i.e. a list of fields with precomputed JSON keys (e.g.
+ * ",\"iana:octetDeltaCount\":") and formatters of their values. Records are then converted
+ * just by walking through the plan.
+ *
+ * The output is always identical to the output of fds_drec2json() with the same flags:
+ * - Values of common types (integers, addresses, timestamps, etc.) are formatted natively.
+ *   Fields with special formatting (see ::FDS_CD2J_FORMAT_PROTO and
+ *   ::FDS_CD2J_FORMAT_TCPFLAGS) are left to the libfds converter.
+ * - One byte fields (and small values of two bytes fields with special formatting such as TCP
+ *   flags) are converted by lookup tables generated by the libfds converter.
+ * - Other types (strings, floats, etc.) are converted field by field by the libfds converter.
+ * - Records of templates with structured data types or multiple occurrences of the same
+ *   Information Element, and records with unexpected values are converted by the libfds
+ *   converter as a whole.
+ *
+ * Equivalence of native formatters and the libfds converter is covered by unit tests
+ * (tests/unit/plugins/output/json).
+ */
+class Serializer {
+public:
+    /** \brief Constructor                                                                     */
+    Serializer();
+    /** \brief Destructor                                                                      */
+    ~Serializer();
+
+    // Disable copy constructors
+    Serializer(const Serializer &) = delete;
+    Serializer &operator=(const Serializer &) = delete;
+
+    /**
+     * \brief Convert a Data Record to JSON
+     *
+     * The interface is the same as the interface of fds_drec2json(), however, the buffer is
+     * always automatically reallocated (i.e. as if ::FDS_CD2J_ALLOW_REALLOC is set).
+     * \param[in]     rec      Data Record to convert
+     * \param[in]     flags    Conversion flags (FDS_CD2J_*)
+     * \param[in]     iemgr    Manager of Information Elements (can be NULL)
+     * \param[in,out] str      Pointer to the output buffer (can point to NULL)
+     * \param[in,out] str_size Size of the output buffer
+     * \return Length of the JSON string (excluding the terminating null byte) on success
+     * \return Negative value (FDS_ERR_*) on failure
+     */
+    int
+    convert(const struct fds_drec *rec, uint32_t flags, const fds_iemgr_t *iemgr, char **str,
+        size_t *str_size);
+
+    /** \brief Statistics of the converter                                                    */
+    struct stats {
+        /** Records converted by plans                                                        */
+        uint64_t planned;
+        /** Records converted by the libfds converter as a whole                              */
+        uint64_t generic;
+    };
+
+    /** \brief Get statistics of the converter                                                */
+    const struct stats &
+    get_stats() const {return m_stats;};
+
+private:
+    struct element;
+    struct plan;
+    struct writer;
+
+    /** Number of cached plans (must be a power of two)                                       */
+    static constexpr size_t PLAN_CNT = 256;
+
+    /** Manager of Information Elements of cached plans and elements                          */
+    const fds_iemgr_t *m_iemgr = nullptr;
+    /** Conversion flags of cached elements                                                   */
+    uint32_t m_elem_flags = 0;
+    /** Single field templates of Information Elements (key: see elem_key())                  */
+    std::unordered_map<uint64_t, std::unique_ptr<element>> m_elems;
+    /** Direct-mapped cache of plans                                                          */
+    std::vector<std::unique_ptr<plan>> m_plans;
+    /** Auxiliary buffer for the libfds converter                                             */
+    char *m_aux = nullptr;
+    /** Size of the auxiliary buffer                                                          */
+    size_t m_aux_size = 0;
+    /** Statistics                                                                            */
+    struct stats m_stats = {0, 0};
+
+    void
+    cache_check(uint32_t flags, const fds_iemgr_t *iemgr);
+    plan *
+    plan_get(const struct fds_drec *rec, uint32_t flags);
+    void
+    plan_build(plan &plan, const struct fds_template *tmplt, uint32_t flags);
+    element *
+    elem_get(const struct fds_tfield &field, uint32_t flags);
+    int
+    elem_reference(const element &elem, const uint8_t *data, uint16_t size, const char **value);
+    int
+    execute(const plan &plan, const struct fds_drec *rec, writer &out);
+};
+
+#endif // JSON_SERIALIZER_H
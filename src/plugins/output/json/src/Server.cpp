@@ -375,6 +375,20 @@ int Server::process(const char *str, size_t len)
     return IPX_OK;
 }
 
+/**
+ * \brief Send a batch of records to all connected clients
+ *
+ * The records are sent to each client at once as a single part of the stream.
+ * \param[in] str  JSON Records
+ * \param[in] offs Offsets of the records
+ * \param[in] cnt  Number of the records
+ * \return Always #IPX_OK
+ */
+int Server::process_batch(const char *str, const size_t *offs, size_t cnt)
+{
+    return process(str + offs[0], offs[cnt] - offs[0]);
+}
+
 /**
  * \brief Get a brief description about connected client
  * \param[in] client Client network info
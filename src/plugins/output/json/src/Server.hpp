@@ -59,6 +59,8 @@ public:
 
     // Send a record to connected clients
     int process(const char *str, size_t len);
+    // Send a batch of records to connected clients
+    int process_batch(const char *str, const size_t *offs, size_t cnt);
 private:
     /** Transmission status */
     enum Send_status {
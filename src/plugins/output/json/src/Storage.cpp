@@ -51,6 +51,8 @@ using namespace std;
 #define BUFFER_BASE   4096
 /** Size of local conversion buffers (for snprintf)    */
 #define LOCAL_BSIZE   64
+/** Size of the batch of records after which the batch is delivered to outputs */
+#define BATCH_SIZE    (256 * 1024)
 
 Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     : m_ctx(ctx), m_format(fmt)
@@ -90,6 +92,10 @@ Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
 
 Storage::~Storage()
 {
+    const struct Serializer::stats &stats = m_serializer.get_stats();
+    IPX_CTX_DEBUG(m_ctx, "JSON serializer: %" PRIu64 " records converted by template plans, "
+        "%" PRIu64 " records converted by the generic converter.", stats.planned, stats.generic);
+
     // Destroy all outputs
     for (Output *output : m_outputs) {
         delete output;
@@ -142,6 +148,54 @@ Storage::buffer_append(const char *str)
     m_record.size_used += len - 1;
 }
 
+/**
+ * \brief Add the converted record to the batch
+ *
+ * If the size of the batch exceeds the limit, the batch is delivered to all outputs.
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the records
+ */
+int
+Storage::batch_add()
+{
+    m_batch_offs.push_back(m_batch.size());
+    m_batch.append(m_record.buffer, m_record.size_used);
+    if (m_batch.size() < BATCH_SIZE) {
+        return IPX_OK;
+    }
+
+    return batch_flush();
+}
+
+/**
+ * \brief Deliver the batch of records to all outputs
+ *
+ * The batch is always emptied.
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the records
+ */
+int
+Storage::batch_flush()
+{
+    const size_t cnt = m_batch_offs.size();
+    if (cnt == 0) {
+        return IPX_OK;
+    }
+
+    int ret = IPX_OK;
+    m_batch_offs.push_back(m_batch.size());
+    for (Output *output : m_outputs) {
+        if (output->process_batch(m_batch.data(), m_batch_offs.data(), cnt) != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            break;
+        }
+    }
+
+    m_batch.clear();
+    m_batch_offs.clear();
+    return ret;
+}
+
 void
 Storage::output_add(Output *output)
 {
@@ -283,10 +337,8 @@ Storage::convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr
         convert_tmplt_rec(&tset_iter, set_id, hdr);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                return IPX_ERR_DENIED;
-            }
+        if (batch_add() != IPX_OK) {
+            return IPX_ERR_DENIED;
         }
     }
 
@@ -347,11 +399,9 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         convert(ipfix_rec->rec, iemgr, hdr, false);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        if (batch_add() != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
         }
 
         if (!m_format.split_biflow || (ipfix_rec->rec.tmplt->flags & FDS_TEMPLATE_BIFLOW) == 0) {
@@ -363,15 +413,21 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         convert(ipfix_rec->rec, iemgr, hdr, true);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        if (batch_add() != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
         }
     }
 
 endloop:
+    // Deliver the rest of records (or drop them on failure)
+    if (ret == IPX_OK) {
+        ret = batch_flush();
+    } else {
+        m_batch.clear();
+        m_batch_offs.clear();
+    }
+
     if (flush) {
         for (Output *output : m_outputs) {
             output->flush();
@@ -428,7 +484,7 @@ Storage::convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, fds_ipfix_msg_h
     uint32_t flags = m_flags;
     flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
 
-    int rc = fds_drec2json(&rec, flags, iemgr, &m_record.buffer, &m_record.size_alloc);
+    int rc = m_serializer.convert(&rec, flags, iemgr, &m_record.buffer, &m_record.size_alloc);
     if (rc < 0) {
         throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
     }
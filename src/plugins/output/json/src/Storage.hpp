@@ -47,6 +47,7 @@
 #include <arpa/inet.h>
 #include <ipfixcol2.h>
 #include "Config.hpp"
+#include "Serializer.hpp"
 
 /** Base class                                                                                   */
 class Output {
@@ -76,6 +77,32 @@ public:
     virtual int
     process(const char *str, size_t len) = 0;
 
+    /**
+     * \brief Process a batch of converted JSONs
+     *
+     * Records are stored one after another and each of them ends with a new line character.
+     * The i-th record starts at \p offs[i] and ends at \p offs[i+1]. By default, records are
+     * passed one by one to process(), however, outputs should override it to deliver the whole
+     * batch at once (e.g. by a single system call).
+     * \param[in] str  JSON Records
+     * \param[in] offs Offsets of the records (\p cnt + 1 values)
+     * \param[in] cnt  Number of the records
+     * \return #IPX_OK on success
+     * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
+     */
+    virtual int
+    process_batch(const char *str, const size_t *offs, size_t cnt)
+    {
+        for (size_t i = 0; i < cnt; ++i) {
+            int ret = process(str + offs[i], offs[i + 1] - offs[i]);
+            if (ret != IPX_OK) {
+                return ret;
+            }
+        }
+
+        return IPX_OK;
+    }
+
     /**
      * \brief Flush buffered records
      */
@@ -94,6 +121,8 @@ private:
     struct cfg_format m_format;
     /** Conversion flags for libfds converter                                                    */
     uint32_t m_flags;
+    /** Template-specialized converter of records                                               */
+    Serializer m_serializer;
     /** IPv4/IPv6 exporter address of the current message (can be nullptr)                       */
     const char *m_src_addr = nullptr;
 
@@ -103,6 +132,11 @@ private:
         size_t size_used;
     } m_record; /**< Converted JSON record                                                       */
 
+    /** Converted JSON records waiting for delivery to the outputs                               */
+    std::string m_batch;
+    /** Offsets of the records in the batch                                                      */
+    std::vector<size_t> m_batch_offs;
+
     // Convert an IPFIX record to a JSON string
     void convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, struct fds_ipfix_msg_hdr *hdr, bool reverse = false);
 
@@ -116,6 +150,10 @@ private:
     void buffer_append(const char *str);
     // Reserve memory for a JSON string
     void buffer_reserve(size_t n);
+    // Add the converted record to the batch
+    int batch_add();
+    // Deliver the batch to all outputs
+    int batch_flush();
     // Convert set to JSON string
     int convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr *hdr);
     // Convert template record to a JSON string
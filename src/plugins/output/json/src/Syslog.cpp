@@ -57,6 +57,12 @@
 #define RECONN_DELAY (5)
 /** How ofter to report statistics (seconds) */
 #define STATS_DELAY   (1)
+/** Maximal number of parts of a syslog message */
+#define MSG_PARTS     (5)
+/** Maximal number of syslog messages per system call */
+#define SEND_BATCH    (64)
+/** Size of a buffer for the syslog message length */
+#define LENGTH_SIZE   (32)
 
 static void
 get_time(timespec &ts)
@@ -196,6 +202,52 @@ Syslog::process(const char *str, size_t len)
     return IPX_OK;
 }
 
+int
+Syslog::process_batch(const char *str, const size_t *offs, size_t cnt)
+{
+    timespec now;
+    int ret;
+
+    get_time(now);
+    report_stats(now);
+
+    if (!m_socket->is_ready()) {
+        // Not connected -> try to reconnect
+        ret = connect(now);
+        if (ret != IPX_READY) {
+            // Just ignore the records and reconnect later
+            m_cnt_dropped += cnt;
+            return IPX_OK;
+        }
+    }
+
+    for (size_t idx = 0; idx < cnt; ) {
+        const size_t batch = (cnt - idx < SEND_BATCH) ? (cnt - idx) : SEND_BATCH;
+
+        ret = send_batch(now, str, offs + idx, batch);
+        if (ret < 0) {
+            std::string description = m_socket->description();
+            const char *err_str;
+            ipx_strerror(-ret, err_str);
+
+            IPX_CTX_ERROR(
+                _ctx,
+                "Connection to '%s' has failed: %s (%d)",
+                description.c_str(),
+                err_str,
+                -ret);
+            m_cnt_dropped += cnt - idx;
+            break;
+        }
+
+        m_cnt_sent += static_cast<size_t>(ret);
+        m_cnt_dropped += batch - static_cast<size_t>(ret);
+        idx += batch;
+    }
+
+    return IPX_OK;
+}
+
 void
 Syslog::prepare_hdr(const struct cfg_syslog &cfg)
 {
@@ -247,18 +299,21 @@ Syslog::connect(const timespec &now)
     return IPX_READY;
 }
 
+/**
+ * \brief Prepare parts of a syslog message
+ * \param[in]  timestamp Timestamp of the message
+ * \param[in]  str       JSON record
+ * \param[in]  len       Length of the record
+ * \param[in]  length    Buffer for the message length (#LENGTH_SIZE bytes, stream only)
+ * \param[out] iovec     Parts of the message (at least #MSG_PARTS)
+ * \return Number of the parts
+ */
 int
-Syslog::send(const timespec &now, const char *str, size_t len)
+Syslog::prepare_msg(const char *timestamp, const char *str, size_t len, char *length,
+    struct iovec *iovec)
 {
-    char timestamp[128];
-    char length[32];
-    struct msghdr msg;
-    struct iovec iovec[8];
     int iovec_idx = 0;
 
-    memset(&msg, 0, sizeof(msg));
-    get_timestamp(now, timestamp, sizeof(timestamp));
-
     if (m_is_stream) {
         // Add syslog message length before syslog header (will be filled later)
         iovec[iovec_idx].iov_base = length;
@@ -269,7 +324,7 @@ Syslog::send(const timespec &now, const char *str, size_t len)
     iovec[iovec_idx].iov_len = m_hdr_prio.size();
     iovec_idx++;
 
-    iovec[iovec_idx].iov_base = timestamp;
+    iovec[iovec_idx].iov_base = (void *) timestamp;
     iovec[iovec_idx].iov_len = strlen(timestamp);
     iovec_idx++;
 
@@ -292,7 +347,7 @@ Syslog::send(const timespec &now, const char *str, size_t len)
 
         // Convert number to string using very fast libfds function
         sum = htonl(sum);
-        if (fds_uint2str_be(&sum, sizeof(sum), length, sizeof(length)) < 0) {
+        if (fds_uint2str_be(&sum, sizeof(sum), length, LENGTH_SIZE) < 0) {
             throw "fds_uint2str_be() has failed";
         }
 
@@ -301,12 +356,73 @@ Syslog::send(const timespec &now, const char *str, size_t len)
         iovec[0].iov_len = length_size;
     }
 
+    return iovec_idx;
+}
+
+int
+Syslog::send(const timespec &now, const char *str, size_t len)
+{
+    char timestamp[128];
+    char length[LENGTH_SIZE];
+    struct msghdr msg;
+    struct iovec iovec[MSG_PARTS];
+
+    memset(&msg, 0, sizeof(msg));
+    get_timestamp(now, timestamp, sizeof(timestamp));
+
     msg.msg_iov = iovec;
-    msg.msg_iovlen = iovec_idx;
+    msg.msg_iovlen = prepare_msg(timestamp, str, len, length, iovec);
 
     return m_socket->write(&msg);
 }
 
+/**
+ * \brief Send a batch of syslog messages
+ *
+ * Over a stream connection, all messages are written at once as a single part of the stream.
+ * Otherwise, each message is sent as a separate datagram, however, all of them are passed to
+ * the kernel by a single system call.
+ * \param[in] now  Current time
+ * \param[in] str  JSON records
+ * \param[in] offs Offsets of the records
+ * \param[in] cnt  Number of the records (at most #SEND_BATCH)
+ * \return Number of sent messages
+ * \return a negative errno-like code if the connection is broken
+ */
+int
+Syslog::send_batch(const timespec &now, const char *str, const size_t *offs, size_t cnt)
+{
+    char timestamp[128];
+    char lengths[SEND_BATCH][LENGTH_SIZE];
+    struct iovec iovec[SEND_BATCH * MSG_PARTS];
+    struct mmsghdr msgs[SEND_BATCH];
+    size_t iovec_idx = 0;
+
+    assert(cnt <= SEND_BATCH);
+    memset(msgs, 0, sizeof(msgs));
+    get_timestamp(now, timestamp, sizeof(timestamp));
+
+    for (size_t i = 0; i < cnt; ++i) {
+        struct iovec *parts = &iovec[iovec_idx];
+        const size_t len = offs[i + 1] - offs[i];
+
+        msgs[i].msg_hdr.msg_iov = parts;
+        msgs[i].msg_hdr.msg_iovlen = prepare_msg(timestamp, str + offs[i], len, lengths[i], parts);
+        iovec_idx += msgs[i].msg_hdr.msg_iovlen;
+    }
+
+    if (!m_is_stream) {
+        return m_socket->write_batch(msgs, static_cast<unsigned int>(cnt));
+    }
+
+    // Stream -> all messages are parts of a single write
+    msgs[0].msg_hdr.msg_iov = iovec;
+    msgs[0].msg_hdr.msg_iovlen = iovec_idx;
+
+    int ret = m_socket->write(&msgs[0].msg_hdr);
+    return (ret > 0) ? static_cast<int>(cnt) : ret;
+}
+
 void
 Syslog::report_stats(const timespec &now)
 {
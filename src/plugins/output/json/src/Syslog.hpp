@@ -55,6 +55,8 @@ public:
 
     // Processing records
     int process(const char *str, size_t len);
+    // Processing a batch of records
+    int process_batch(const char *str, const size_t *offs, size_t cnt);
 
 private:
     /** Syslog socket                                                             */
@@ -77,7 +79,10 @@ private:
 
     void prepare_hdr(const struct cfg_syslog &cfg);
     int connect(const timespec &now);
+    int prepare_msg(const char *timestamp, const char *str, size_t len, char *length,
+        struct iovec *iovec);
     int send(const timespec &now, const char *str, size_t len);
+    int send_batch(const timespec &now, const char *str, const size_t *offs, size_t cnt);
     void report_stats(const timespec &now);
 };
 
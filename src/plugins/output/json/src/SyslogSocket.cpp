@@ -294,11 +294,43 @@ send_datagram_nonblocking(int fd, struct msghdr *msg)
     return 1;
 }
 
+static int
+send_datagrams_nonblocking(int fd, struct mmsghdr *msgs, unsigned int cnt)
+{
+    int ret = sendmmsg(fd, msgs, cnt, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (ret < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN) {
+            return 0;
+        }
+
+        return -errno;
+    }
+
+    return ret;
+}
+
 SyslogSocket::~SyslogSocket()
 {
     close();
 }
 
+int
+SyslogSocket::write_batch(struct mmsghdr *msgs, unsigned int cnt)
+{
+    for (unsigned int i = 0; i < cnt; ++i) {
+        int ret = write(&msgs[i].msg_hdr);
+        if (ret < 0) {
+            return ret;
+        }
+
+        if (ret == 0) {
+            return static_cast<int>(i);
+        }
+    }
+
+    return static_cast<int>(cnt);
+}
+
 void SyslogSocket::close() noexcept
 {
     if (m_fd < 0) {
@@ -402,6 +434,23 @@ UdpSyslogSocket::write(struct msghdr *msg)
     return ret;
 }
 
+int
+UdpSyslogSocket::write_batch(struct mmsghdr *msgs, unsigned int cnt)
+{
+    int ret = -EINVAL;
+
+    if (!is_ready()) {
+        return ret;
+    }
+
+    ret = send_datagrams_nonblocking(m_fd, msgs, cnt);
+    if (ret < 0) {
+        close();
+    }
+
+    return ret;
+}
+
 std::string
 UdpSyslogSocket::description()
 {
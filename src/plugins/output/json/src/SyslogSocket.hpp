@@ -94,6 +94,17 @@ public:
      * \return a negative errno-like code if the connection is broken.
      */
     virtual int write(struct msghdr *msg) = 0;
+    /**
+     * \brief Write multiple messages to the syslog socket.
+     *
+     * By default, messages are written one by one using write().
+     *
+     * \param[in] msgs Messages to send.
+     * \param[in] cnt  Number of messages.
+     * \return number of sent messages (the rest would block and cannot be sent);
+     * \return a negative errno-like code if the connection is broken.
+     */
+    virtual int write_batch(struct mmsghdr *msgs, unsigned int cnt);
     /**
      * \brief Get connection description (for logging)
      */
@@ -130,6 +141,7 @@ public:
     SyslogType type() const noexcept override { return SyslogType::DATAGRAM; };
     int open() override;
     int write(struct msghdr *msg) override;
+    int write_batch(struct mmsghdr *msgs, unsigned int cnt) override;
     std::string description() override;
 
 private:
@@ -0,0 +1,216 @@
+/**
+ * \file tests/benchmark/json.cpp
+ * \brief Micro-benchmark of the JSON serializer of the JSON output plugin
+ *
+ * Synthetic flow records (based on a typical template of a flow exporter) are converted to
+ * JSON by the generic libfds converter (i.e. fds_drec2json()) and by the template-specialized
+ * serializer of the JSON output plugin. Throughput is measured for the default and the raw
+ * formatting of the plugin. Results of both converters are compared and the benchmark fails
+ * if they differ.
+ *
+ * Usage: ipx_bench_json [records] [directory with definitions of Information Elements]
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libfds.h>
+#include "Serializer.hpp"
+
+/** Number of distinct records                                                                */
+#define REC_CNT 1024
+
+/** Fields of the template (Enterprise Number, Information Element ID, length)                */
+static const struct {
+    uint32_t en;
+    uint16_t id;
+    uint16_t length;
+} fields[] = {
+    {0,   1, 8},   // octetDeltaCount
+    {0,   2, 8},   // packetDeltaCount
+    {0, 152, 8},   // flowStartMilliseconds
+    {0, 153, 8},   // flowEndMilliseconds
+    {0,  10, 4},   // ingressInterface
+    {0,  60, 1},   // ipVersion
+    {0,   8, 4},   // sourceIPv4Address
+    {0,  12, 4},   // destinationIPv4Address
+    {0,   5, 1},   // ipClassOfService
+    {0, 192, 1},   // ipTTL
+    {0,   4, 1},   // protocolIdentifier
+    {0,   6, 2},   // tcpControlBits
+    {0,   7, 2},   // sourceTransportPort
+    {0,  11, 2},   // destinationTransportPort
+    {0,  14, 4},   // egressInterface
+    {0,  56, 6},   // sourceMacAddress
+    {0,  80, 6},   // destinationMacAddress
+};
+
+/**
+ * \brief Create the template
+ * \param[in] iemgr Manager of Information Elements
+ */
+static struct fds_template *
+template_create(const fds_iemgr_t *iemgr)
+{
+    std::vector<uint8_t> raw = {1, 0, 0, uint8_t(sizeof(fields) / sizeof(fields[0]))};
+    for (const auto &field : fields) {
+        raw.insert(raw.end(), {uint8_t(field.id >> 8), uint8_t(field.id),
+            uint8_t(field.length >> 8), uint8_t(field.length)});
+    }
+
+    struct fds_template *tmplt;
+    uint16_t size = uint16_t(raw.size());
+    if (fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &size, &tmplt) != FDS_OK
+            || fds_template_ies_define(tmplt, iemgr, false) != FDS_OK) {
+        fprintf(stderr, "Failed to create a template!\n");
+        exit(EXIT_FAILURE);
+    }
+    return tmplt;
+}
+
+/**
+ * \brief Generate records with pseudo-random content
+ * \param[in] tmplt Template
+ */
+static std::vector<uint8_t>
+records_generate(const struct fds_template *tmplt)
+{
+    std::vector<uint8_t> data(size_t(tmplt->data_length) * REC_CNT);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (auto &byte : data) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        byte = uint8_t(state);
+    }
+
+    // Realistic timestamps and protocols
+    for (size_t i = 0; i < REC_CNT; ++i) {
+        uint8_t *rec = data.data() + i * tmplt->data_length;
+        for (uint16_t f = 0; f < tmplt->fields_cnt_total; ++f) {
+            const struct fds_tfield &field = tmplt->fields[f];
+            if (field.id == 152 || field.id == 153) {
+                const uint64_t ts = 1526067869006ULL + i * 1000U + field.id;
+                for (unsigned b = 0; b < 8; ++b) {
+                    rec[field.offset + b] = uint8_t(ts >> (56 - 8 * b));
+                }
+            } else if (field.id == 4) {
+                rec[field.offset] = (i % 3 == 0) ? 17 : 6;
+            } else if (field.id == 6) {
+                rec[field.offset] = 0;
+            }
+        }
+    }
+    return data;
+}
+
+/**
+ * \brief Convert all records repeatedly by a converter
+ * \return Number of records per second
+ */
+template <typename Conv>
+static double
+measure(const struct fds_template *tmplt, std::vector<uint8_t> &data, uint64_t cnt,
+    Conv conv)
+{
+    char *buffer = nullptr;
+    size_t buffer_size = 0;
+    uint64_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < cnt; ++i) {
+        struct fds_drec rec;
+        rec.data = data.data() + (i % REC_CNT) * tmplt->data_length;
+        rec.size = tmplt->data_length;
+        rec.tmplt = tmplt;
+        rec.snap = nullptr;
+
+        int rc = conv(&rec, &buffer, &buffer_size);
+        if (rc < 0) {
+            fprintf(stderr, "Conversion failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        total += uint64_t(rc);
+    }
+
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    free(buffer);
+    return (total > 0) ? cnt / duration.count() : 0.0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    uint64_t cnt = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 2000000ULL;
+    const char *dir = (argc > 2) ? argv[2] : fds_api_cfg_dir();
+    if (cnt == 0) {
+        fprintf(stderr, "Usage: %s [records] [directory of IE definitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)> iemgr(fds_iemgr_create(),
+        &fds_iemgr_destroy);
+    if (!iemgr || fds_iemgr_read_dir(iemgr.get(), dir) != FDS_OK) {
+        fprintf(stderr, "Failed to load definitions of Information Elements from '%s'!\n", dir);
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)> tmplt(
+        template_create(iemgr.get()), &fds_template_destroy);
+    std::vector<uint8_t> data = records_generate(tmplt.get());
+
+    const struct {
+        const char *name;
+        uint32_t flags;
+    } formats[] = {
+        {"default", FDS_CD2J_FORMAT_TCPFLAGS | FDS_CD2J_FORMAT_PROTO | FDS_CD2J_TS_FORMAT_MSEC
+            | FDS_CD2J_IGNORE_UNKNOWN | FDS_CD2J_NON_PRINTABLE},
+        {"raw", FDS_CD2J_IGNORE_UNKNOWN | FDS_CD2J_NON_PRINTABLE | FDS_CD2J_NUMERIC_ID},
+    };
+
+    printf("Records: %" PRIu64 "\n", cnt);
+    printf("%-10s %16s %16s %8s\n", "format", "libfds rec/s", "plan rec/s", "speedup");
+    for (const auto &format : formats) {
+        const uint32_t flags = format.flags | FDS_CD2J_ALLOW_REALLOC;
+        Serializer serializer;
+
+        // Compare results
+        char *ref = nullptr, *res = nullptr;
+        size_t ref_size = 0, res_size = 0;
+        for (size_t i = 0; i < REC_CNT; ++i) {
+            struct fds_drec rec;
+            rec.data = data.data() + i * tmplt->data_length;
+            rec.size = tmplt->data_length;
+            rec.tmplt = tmplt.get();
+            rec.snap = nullptr;
+
+            int rc_ref = fds_drec2json(&rec, flags, iemgr.get(), &ref, &ref_size);
+            int rc_res = serializer.convert(&rec, flags, iemgr.get(), &res, &res_size);
+            if (rc_ref != rc_res || (rc_ref > 0 && memcmp(ref, res, size_t(rc_ref)) != 0)) {
+                fprintf(stderr, "Results differ!\nlibfds: %s\nplan:   %s\n", ref, res);
+                return EXIT_FAILURE;
+            }
+        }
+        free(ref);
+        free(res);
+
+        double r_ref = measure(tmplt.get(), data, cnt,
+            [&](struct fds_drec *rec, char **buffer, size_t *size) {
+                return fds_drec2json(rec, flags, iemgr.get(), buffer, size);
+            });
+        double r_res = measure(tmplt.get(), data, cnt,
+            [&](struct fds_drec *rec, char **buffer, size_t *size) {
+                return serializer.convert(rec, flags, iemgr.get(), buffer, size);
+            });
+        printf("%-10s %16.0f %16.0f %7.2fx\n", format.name, r_ref, r_res, r_res / r_ref);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,604 @@
+/**
+ * \file tests/benchmark/pipeline.cpp
+ * \brief End-to-end benchmark of the collector pipeline
+ *
+ * A corpus of IPFIX Messages is replayed (from memory, without any sockets) through the real
+ * collector core, i.e. the IPFIX parser, optional intermediate plugins, the output manager and
+ * an output plugin. The corpus is either an IPFIX File or, if not specified, a synthetic file
+ * generated from a typical template of a flow exporter.
+ *
+ * When the collector terminates, throughput (records/s, messages/s), CPU time of the process,
+ * CPU time of each stage (i.e. of the thread of each instance, excluding threads created by
+ * the plugin such as parser threads), wall-clock time spent in the processing function of each
+ * instance (both based on runtime statistics of the pipeline) and the number of memory
+ * allocations per Data Record are reported as a JSON document suitable for regression tracking.
+ *
+ * Usage: ipfixcol2-bench [-i file] [-m messages] [-n repeat] [-I plugin[:params]]...
+ *   [-o plugin[:params]] [-t parser threads] [-p plugin dir]... [-e elements dir] [-r result file] [-v]
+ *
+ * Parameters of intermediate and output plugins are paths to files with the XML \<params\>
+ * node. By default, the "dummy" output plugin (without any delay) is used.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <libfds.h>
+#include <build_config.h>
+#include <core/configurator/configurator.hpp>
+#include <core/configurator/controller.hpp>
+#include "MsgGen.h"
+
+extern "C" {
+#include <core/plugin_parser.h>
+#include <core/verbose.h>
+}
+
+// -------------------------------------------------------------------------------------------
+// Counting of memory allocations
+
+/** Number of memory allocations (malloc, calloc, realloc and aligned allocations)          */
+static std::atomic<uint64_t> alloc_cnt(0);
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+/*
+ * The allocator functions of the C library are interposed by the executable, therefore,
+ * allocations of the core as well as of all (dynamically loaded) plugins are counted.
+ */
+void *
+malloc(size_t size)
+{
+    alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+    alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+/*
+ * Aligned allocations (e.g. aligned operator new of C++17) would bypass the functions above,
+ * therefore, they are counted too.
+ */
+int
+posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    // The alignment must be a power of two multiple of sizeof(void *)
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+
+    alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+    int errno_saved = errno;
+    void *ptr = __libc_memalign(alignment, size);
+    errno = errno_saved;
+    if (!ptr) {
+        return ENOMEM;
+    }
+
+    *memptr = ptr;
+    return 0;
+}
+
+void *
+aligned_alloc(size_t alignment, size_t size)
+{
+    alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void *
+memalign(size_t alignment, size_t size)
+{
+    alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+}
+#define ALLOC_COUNTING 1
+#else
+#define ALLOC_COUNTING 0
+#endif
+
+// -------------------------------------------------------------------------------------------
+// Synthetic corpus
+
+/** Fields of the template (Information Element ID, length)                                 */
+static const struct {
+    uint16_t id;
+    uint16_t length;
+} fields[] = {
+    {  1, 8},   // octetDeltaCount
+    {  2, 8},   // packetDeltaCount
+    {152, 8},   // flowStartMilliseconds
+    {153, 8},   // flowEndMilliseconds
+    { 10, 4},   // ingressInterface
+    { 14, 4},   // egressInterface
+    {  8, 4},   // sourceIPv4Address
+    { 12, 4},   // destinationIPv4Address
+    {  7, 2},   // sourceTransportPort
+    { 11, 2},   // destinationTransportPort
+    {  4, 1},   // protocolIdentifier
+    {  6, 1},   // tcpControlBits
+    {  5, 1},   // ipClassOfService
+};
+
+/** Template ID of the synthetic records                                                     */
+#define CORPUS_TID 256
+/** Data Records per IPFIX Message of the synthetic corpus                                   */
+#define CORPUS_RECS 30
+
+/**
+ * \brief Generate a synthetic IPFIX File
+ *
+ * The template is defined only in the first message, i.e. the file must be replayed within
+ * a single Transport Session.
+ * \param[in] path Output file
+ * \param[in] msgs Number of IPFIX Messages
+ * \throw runtime_error on failure
+ */
+static void
+corpus_generate(const std::string &path, uint64_t msgs)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create '" + path + "'");
+    }
+
+    const uint32_t exp_time = 1700000000U;
+    uint32_t seq_num = 0;
+    for (uint64_t i = 0; i < msgs; ++i) {
+        ipfix_msg msg;
+        msg.set_odid(1);
+        msg.set_seq(seq_num);
+        msg.set_exp(exp_time + i / 1000);
+
+        if (i == 0) {
+            ipfix_trec trec(CORPUS_TID);
+            for (const auto &field : fields) {
+                trec.add_field(field.id, field.length);
+            }
+            ipfix_set tset(FDS_IPFIX_SET_TMPLT);
+            tset.add_rec(trec);
+            msg.add_set(tset);
+        }
+
+        ipfix_set dset(CORPUS_TID);
+        for (unsigned r = 0; r < CORPUS_RECS; ++r) {
+            const uint64_t n = i * CORPUS_RECS + r;
+            const uint64_t ts = uint64_t(exp_time) * 1000U - 60000U + (n % 60000U);
+            ipfix_drec drec;
+            drec.append_uint(1500U * (n % 17U + 1U), 8);
+            drec.append_uint(n % 17U + 1U, 8);
+            drec.append_uint(ts, 8);
+            drec.append_uint(ts + n % 1000U, 8);
+            drec.append_uint(n % 4U, 4);
+            drec.append_uint(n % 8U, 4);
+            drec.append_uint(0x0A000000U | (n % 65536U), 4);
+            drec.append_uint(0xC0A80000U | (n % 256U), 4);
+            drec.append_uint(1024U + n % 60000U, 2);
+            drec.append_uint((n % 3U == 0) ? 53U : 443U, 2);
+            drec.append_uint((n % 3U == 0) ? 17U : 6U, 1);
+            drec.append_uint((n % 3U == 0) ? 0U : 0x1BU, 1);
+            drec.append_uint(0, 1);
+            dset.add_rec(drec);
+        }
+        msg.add_set(dset);
+        seq_num += CORPUS_RECS;
+
+        const ipfix_msg &data = msg;
+        out.write(reinterpret_cast<const char *>(data.front()), data.size());
+    }
+
+    if (!out.flush()) {
+        throw std::runtime_error("Failed to write '" + path + "'");
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+// Configuration of the collector
+
+/** Configuration of the benchmark                                                           */
+struct bench_cfg {
+    /** IPFIX File to replay (if empty, a synthetic corpus is used)                          */
+    std::string corpus;
+    /** Number of IPFIX Messages of the synthetic corpus                                     */
+    uint64_t corpus_msgs = 100000;
+    /** Number of replays of the corpus                                                      */
+    uint64_t repeat = 1;
+    /** Intermediate plugins (name and path to parameters)                                   */
+    std::vector<std::pair<std::string, std::string>> inters;
+    /** Output plugin (name and path to parameters)                                          */
+    std::pair<std::string, std::string> output = {"dummy", ""};
+    /** Number of parser threads                                                             */
+    unsigned int parser_threads = 1;
+    /** Additional plugin directories                                                        */
+    std::vector<std::string> plugin_dirs;
+    /** Directory with definitions of Information Elements (if empty, use default)           */
+    std::string elements_dir;
+    /** Output file with results (if empty, use standard output)                             */
+    std::string result;
+    /** Statistics file of the pipeline                                                      */
+    std::string stats;
+};
+
+/**
+ * \brief Load XML parameters of a plugin
+ * \param[in] path Path to the file (if empty, \p def is returned)
+ * \param[in] def  Default parameters
+ * \throw runtime_error if the file cannot be read
+ */
+static std::string
+params_load(const std::string &path, const std::string &def)
+{
+    if (path.empty()) {
+        return def;
+    }
+
+    std::ifstream in(path);
+    std::stringstream buffer;
+    if (!in || !(buffer << in.rdbuf())) {
+        throw std::runtime_error("Failed to read parameters from '" + path + "'");
+    }
+    return buffer.str();
+}
+
+/**
+ * \brief Split a plugin specification "plugin[:params]"
+ */
+static std::pair<std::string, std::string>
+plugin_spec(const char *spec)
+{
+    const char *delim = strchr(spec, ':');
+    if (!delim) {
+        return {spec, ""};
+    }
+    return {std::string(spec, delim), std::string(delim + 1)};
+}
+
+/** Controller that provides the configuration of the benchmark                              */
+class bench_controller : public ipx_controller {
+public:
+    /**
+     * \brief Create the controller
+     * \param[in] cfg    Configuration of the benchmark
+     * \param[in] corpus IPFIX File to replay
+     */
+    bench_controller(const struct bench_cfg &cfg, const std::string &corpus)
+        : m_cfg(cfg), m_corpus(corpus) {}
+
+    ipx_config_model
+    model_get() override
+    {
+        ipx_config_model model;
+
+        struct ipx_plugin_input input;
+        input.plugin = "bench-replay";
+        input.name = "replay";
+        input.params = "<params><path>" + m_corpus + "</path><repeat>"
+            + std::to_string(m_cfg.repeat) + "</repeat></params>";
+        model.add_instance(input);
+
+        unsigned int idx = 0;
+        for (const auto &spec : m_cfg.inters) {
+            struct ipx_plugin_inter inter;
+            inter.plugin = spec.first;
+            inter.name = spec.first + "-" + std::to_string(idx++);
+            inter.params = params_load(spec.second, "<params/>");
+            model.add_instance(inter);
+        }
+
+        struct ipx_plugin_output output;
+        output.plugin = m_cfg.output.first;
+        output.name = m_cfg.output.first;
+        output.params = params_load(m_cfg.output.second, "<params><delay>0</delay></params>");
+        output.odid_type = IPX_ODID_FILTER_NONE;
+        model.add_instance(output);
+
+        struct ipx_pipeline_cfg pipeline;
+        pipeline.parser_threads = m_cfg.parser_threads;
+        pipeline.stats.enabled = true;
+        pipeline.stats.file = m_cfg.stats;
+        pipeline.stats.interval = ipx_stats_cfg::INTERVAL_MAX;
+        model.set_pipeline(pipeline);
+        return model;
+    }
+
+private:
+    const struct bench_cfg &m_cfg;
+    std::string m_corpus;
+};
+
+// -------------------------------------------------------------------------------------------
+// Results
+
+/** Statistics of a pipeline stage (i.e. an instance)                                        */
+struct stage_stats {
+    std::string name;
+    std::string plugin;
+    std::string type;
+    uint64_t msg_in = 0;
+    uint64_t rec_in = 0;
+    uint64_t rec_out = 0;
+    uint64_t cb_wall = 0;
+    uint64_t cpu_time = 0;
+};
+
+/**
+ * \brief Get a value of a field of an instance in the statistics document
+ * \param[in] doc   Document
+ * \param[in] start Start of the instance object
+ * \param[in] end   End of the instance object
+ * \param[in] name  Name of the field
+ * \return String representation of the value (without quotes) or empty string
+ */
+static std::string
+json_field(const std::string &doc, size_t start, size_t end, const std::string &name)
+{
+    const std::string key = "\"" + name + "\":";
+    size_t pos = doc.find(key, start);
+    if (pos == std::string::npos || pos >= end) {
+        return "";
+    }
+
+    pos += key.size();
+    if (doc[pos] == '"') {
+        size_t str_end = doc.find('"', pos + 1);
+        return doc.substr(pos + 1, str_end - pos - 1);
+    }
+    return doc.substr(pos, doc.find_first_of(",}", pos) - pos);
+}
+
+/**
+ * \brief Parse the final statistics document of the pipeline
+ * \param[in] path Path to the document
+ * \return Statistics of all instances in the order of the pipeline
+ * \throw runtime_error if the document cannot be read
+ */
+static std::vector<struct stage_stats>
+stats_parse(const std::string &path)
+{
+    const std::string doc = params_load(path, "");
+    const std::string key = "{\"name\":";
+    std::vector<struct stage_stats> result;
+
+    size_t pos = doc.find(key);
+    while (pos != std::string::npos) {
+        size_t next = doc.find(key, pos + 1);
+        size_t end = (next == std::string::npos) ? doc.size() : next;
+
+        struct stage_stats stage;
+        stage.name = json_field(doc, pos, end, "name");
+        stage.plugin = json_field(doc, pos, end, "plugin");
+        stage.type = json_field(doc, pos, end, "type");
+        stage.msg_in = strtoull(json_field(doc, pos, end, "msg_in").c_str(), nullptr, 10);
+        stage.rec_in = strtoull(json_field(doc, pos, end, "rec_in").c_str(), nullptr, 10);
+        stage.rec_out = strtoull(json_field(doc, pos, end, "rec_out").c_str(), nullptr, 10);
+        stage.cb_wall = strtoull(json_field(doc, pos, end, "cb_wall").c_str(), nullptr, 10);
+        stage.cpu_time = strtoull(json_field(doc, pos, end, "cpu_time").c_str(), nullptr, 10);
+        result.push_back(stage);
+        pos = next;
+    }
+
+    if (result.empty()) {
+        throw std::runtime_error("No statistics found in '" + path + "'");
+    }
+    return result;
+}
+
+/** Get CPU time of the process (user and system) in seconds                                 */
+static void
+cpu_time(double &user, double &sys)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    user = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    sys = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/** Append a JSON string (names of plugins and instances don't need escaping)               */
+static std::string
+json_str(const std::string &str)
+{
+    return "\"" + str + "\"";
+}
+
+/** Print usage                                                                              */
+static void
+usage(const char *name)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -i FILE   IPFIX File to replay (default: synthetic corpus)\n"
+        "  -m N      Number of IPFIX Messages of the synthetic corpus (default: 100000)\n"
+        "  -n N      Number of replays of the corpus (default: 1)\n"
+        "  -I P[:F]  Add an intermediate plugin P with parameters in file F\n"
+        "  -o P[:F]  Output plugin P with parameters in file F (default: dummy)\n"
+        "  -t N      Number of IPFIX parser threads (default: 1)\n"
+        "  -p DIR    Add a plugin directory\n"
+        "  -e DIR    Directory with definitions of Information Elements\n"
+        "  -r FILE   Output file with results (default: standard output)\n"
+        "  -v        Increase verbosity level\n", name);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct bench_cfg cfg;
+    int opt;
+
+    ipx_verb_level_set(IPX_VERB_ERROR);
+    while ((opt = getopt(argc, argv, "i:m:n:I:o:t:p:e:r:vh")) != -1) {
+        switch (opt) {
+        case 'i': cfg.corpus = optarg; break;
+        case 'm': cfg.corpus_msgs = strtoull(optarg, nullptr, 10); break;
+        case 'n': cfg.repeat = strtoull(optarg, nullptr, 10); break;
+        case 'I': cfg.inters.push_back(plugin_spec(optarg)); break;
+        case 'o': cfg.output = plugin_spec(optarg); break;
+        case 't': cfg.parser_threads = strtoul(optarg, nullptr, 10); break;
+        case 'p': cfg.plugin_dirs.emplace_back(optarg); break;
+        case 'e': cfg.elements_dir = optarg; break;
+        case 'r': cfg.result = optarg; break;
+        case 'v':
+            if (ipx_verb_level_get() < IPX_VERB_DEBUG) {
+                ipx_verb_level_set(static_cast<enum ipx_verb_level>(ipx_verb_level_get() + 1));
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (cfg.corpus_msgs == 0 || cfg.repeat == 0 || cfg.parser_threads == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Temporary directory for the synthetic corpus and statistics
+    char tmp_dir[] = "/tmp/ipfixcol2-bench-XXXXXX";
+    if (!mkdtemp(tmp_dir)) {
+        fprintf(stderr, "Failed to create a temporary directory!\n");
+        return EXIT_FAILURE;
+    }
+
+    const std::string corpus = cfg.corpus.empty()
+        ? std::string(tmp_dir) + "/corpus.ipfix" : cfg.corpus;
+    cfg.stats = std::string(tmp_dir) + "/stats.json";
+    int rc = EXIT_FAILURE;
+
+    try {
+        if (cfg.corpus.empty()) {
+            corpus_generate(corpus, cfg.corpus_msgs);
+        }
+
+        bench_controller ctrl(cfg, corpus);
+        ipx_configurator configurator;
+        configurator.plugins.path_add(IPX_BENCH_REPLAY_DIR);
+        for (const auto &dir : cfg.plugin_dirs) {
+            configurator.plugins.path_add(dir);
+        }
+        configurator.plugins.path_add(IPX_DEFAULT_PLUGINS_DIR);
+        configurator.iemgr_set_dir(cfg.elements_dir.empty()
+            ? std::string(fds_api_cfg_dir()) : cfg.elements_dir);
+
+        // Measurement (includes initialization and termination of the pipeline)
+        double user_start, sys_start, user_end, sys_end;
+        cpu_time(user_start, sys_start);
+        const uint64_t alloc_start = alloc_cnt.load();
+        const auto time_start = std::chrono::steady_clock::now();
+
+        if (configurator.run(&ctrl) != EXIT_SUCCESS) {
+            throw std::runtime_error("The collector failed (use -v for details)");
+        }
+
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - time_start;
+        const uint64_t allocs = alloc_cnt.load() - alloc_start;
+        cpu_time(user_end, sys_end);
+
+        // Records and messages are counted by the IPFIX parser
+        const std::vector<struct stage_stats> stages = stats_parse(cfg.stats);
+        uint64_t records = 0;
+        uint64_t messages = 0;
+        for (const auto &stage : stages) {
+            if (stage.plugin == ipx_plugin_parser_info.name) {
+                records += stage.rec_out;
+                messages += stage.msg_in;
+            }
+        }
+
+        char buffer[64];
+        std::string out = "{\n  \"corpus\": " + json_str(cfg.corpus.empty() ? "synthetic" : corpus);
+        out += ",\n  \"repeat\": " + std::to_string(cfg.repeat);
+        out += ",\n  \"parser_threads\": " + std::to_string(cfg.parser_threads);
+        out += ",\n  \"messages\": " + std::to_string(messages);
+        out += ",\n  \"records\": " + std::to_string(records);
+        snprintf(buffer, sizeof(buffer), "%.6f", wall.count());
+        out += ",\n  \"wall_time\": " + std::string(buffer);
+        snprintf(buffer, sizeof(buffer), "%.6f", user_end - user_start);
+        out += ",\n  \"cpu_user\": " + std::string(buffer);
+        snprintf(buffer, sizeof(buffer), "%.6f", sys_end - sys_start);
+        out += ",\n  \"cpu_system\": " + std::string(buffer);
+        snprintf(buffer, sizeof(buffer), "%.0f", records / wall.count());
+        out += ",\n  \"records_per_sec\": " + std::string(buffer);
+        snprintf(buffer, sizeof(buffer), "%.0f", messages / wall.count());
+        out += ",\n  \"messages_per_sec\": " + std::string(buffer);
+        if (ALLOC_COUNTING) {
+            snprintf(buffer, sizeof(buffer), "%.3f", records ? double(allocs) / records : 0.0);
+            out += ",\n  \"allocs\": " + std::to_string(allocs);
+            out += ",\n  \"allocs_per_record\": " + std::string(buffer);
+        } else {
+            out += ",\n  \"allocs\": null,\n  \"allocs_per_record\": null";
+        }
+
+        out += ",\n  \"stages\": [";
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const struct stage_stats &stage = stages[i];
+            out += (i == 0) ? "\n" : ",\n";
+            out += "    {\"name\": " + json_str(stage.name);
+            out += ", \"plugin\": " + json_str(stage.plugin);
+            out += ", \"type\": " + json_str(stage.type);
+            out += ", \"msg_in\": " + std::to_string(stage.msg_in);
+            out += ", \"rec_in\": " + std::to_string(stage.rec_in);
+            out += ", \"cpu_ns\": " + std::to_string(stage.cpu_time);
+            double per_rec = records ? double(stage.cpu_time) / records : 0.0;
+            snprintf(buffer, sizeof(buffer), "%.1f", per_rec);
+            out += ", \"cpu_ns_per_record\": " + std::string(buffer);
+            out += ", \"wall_ns\": " + std::to_string(stage.cb_wall);
+            per_rec = records ? double(stage.cb_wall) / records : 0.0;
+            snprintf(buffer, sizeof(buffer), "%.1f", per_rec);
+            out += ", \"wall_ns_per_record\": " + std::string(buffer) + "}";
+        }
+        out += "\n  ]\n}\n";
+
+        if (cfg.result.empty()) {
+            fputs(out.c_str(), stdout);
+        } else {
+            std::ofstream result(cfg.result, std::ios::trunc);
+            if (!(result << out)) {
+                throw std::runtime_error("Failed to write results to '" + cfg.result + "'");
+            }
+        }
+
+        rc = EXIT_SUCCESS;
+    } catch (const std::exception &ex) {
+        fprintf(stderr, "Benchmark failed: %s\n", ex.what());
+    }
+
+    if (cfg.corpus.empty()) {
+        unlink(corpus.c_str());
+    }
+    unlink(cfg.stats.c_str());
+    rmdir(tmp_dir);
+    return rc;
+}
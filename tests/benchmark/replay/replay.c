@@ -0,0 +1,331 @@
+/**
+ * \file tests/benchmark/replay/replay.c
+ * \brief Input plugin that replays IPFIX Messages from memory (for benchmarking)
+ *
+ * All IPFIX Messages of a file are loaded into memory during initialization. Each call of
+ * the getter passes a copy of the next message to the pipeline, i.e. no file or socket
+ * operations are performed during the measurement. The whole file can be replayed multiple
+ * times. Each replay uses its own Transport Session, therefore, (Options) Templates and
+ * sequence numbers of the file are always valid. After the last replay, the plugin returns
+ * #IPX_ERR_EOF and the collector terminates.
+ *
+ * \verbatim
+ * <params>
+ *   <path>...</path>      <!-- IPFIX File to replay      -->
+ *   <repeat>...</repeat>  <!-- optional, default: 1     -->
+ * </params>
+ * \endverbatim
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include <ipfixcol2.h>
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "bench-replay",
+    // Brief description of plugin
+    .dsc = "Replay IPFIX Messages of a file from memory (benchmark only).",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.0.0"
+};
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_PATH = 1,
+    NODE_REPEAT
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_PATH,   "path",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_REPEAT, "repeat", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Instance */
+struct instance_data {
+    /** Path to the file (also description of Transport Sessions) */
+    char *path;
+    /** Number of replays of the file                              */
+    uint64_t repeat;
+
+    /** Content of the file                                        */
+    uint8_t *file_data;
+    /** Offsets of IPFIX Messages in the file                      */
+    size_t *msg_offsets;
+    /** Number of IPFIX Messages in the file                       */
+    size_t msg_cnt;
+
+    /** Transport Session of the current replay (NULL == none)     */
+    struct ipx_session *session;
+    /** Index of the next message to replay                        */
+    size_t msg_next;
+    /** Number of finished replays                                 */
+    uint64_t repeat_done;
+};
+
+/**
+ * \brief Parse parameters of the instance
+ * \param[in] ctx    Plugin context
+ * \param[in] params XML parameters
+ * \param[in] data   Instance data to fill
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM on failure
+ */
+static int
+config_parse(ipx_ctx_t *ctx, const char *params, struct instance_data *data)
+{
+    int rc = IPX_OK;
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != FDS_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        return IPX_ERR_FORMAT;
+    }
+
+    fds_xml_ctx_t *root = fds_xml_parse_mem(parser, params, true);
+    if (!root) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        return IPX_ERR_FORMAT;
+    }
+
+    data->repeat = 1;
+    const struct fds_xml_cont *content;
+    while (rc == IPX_OK && fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_PATH:
+            assert(content->type == FDS_OPTS_T_STRING);
+            data->path = strdup(content->ptr_string);
+            if (!data->path) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                rc = IPX_ERR_NOMEM;
+            }
+            break;
+        case NODE_REPEAT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0) {
+                IPX_CTX_ERROR(ctx, "Number of replays must be greater than zero!", '\0');
+                rc = IPX_ERR_FORMAT;
+            }
+            data->repeat = content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    fds_xml_destroy(parser);
+    return rc;
+}
+
+/**
+ * \brief Load the file into memory and find boundaries of IPFIX Messages
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT or #IPX_ERR_NOMEM on failure
+ */
+static int
+file_load(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    const char *err_str;
+    FILE *file = fopen(data->path, "rb");
+    if (!file) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to open '%s': %s", data->path, err_str);
+        return IPX_ERR_FORMAT;
+    }
+
+    size_t size = 0;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long pos = ftell(file);
+        size = (pos > 0) ? (size_t) pos : 0;
+        rewind(file);
+    }
+
+    data->file_data = malloc(size + 1U);
+    data->msg_offsets = malloc((size / FDS_IPFIX_MSG_HDR_LEN + 1U) * sizeof(size_t));
+    if (!data->file_data || !data->msg_offsets) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        fclose(file);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (fread(data->file_data, 1, size, file) != size) {
+        IPX_CTX_ERROR(ctx, "Failed to read '%s'", data->path);
+        fclose(file);
+        return IPX_ERR_FORMAT;
+    }
+    fclose(file);
+
+    size_t offset = 0;
+    while (offset < size) {
+        const struct fds_ipfix_msg_hdr *hdr;
+        hdr = (const struct fds_ipfix_msg_hdr *) (data->file_data + offset);
+        uint16_t msg_size = (size - offset >= FDS_IPFIX_MSG_HDR_LEN) ? ntohs(hdr->length) : 0;
+        if (ntohs(hdr->version) != FDS_IPFIX_VERSION || msg_size < FDS_IPFIX_MSG_HDR_LEN
+                || msg_size > size - offset) {
+            IPX_CTX_ERROR(ctx, "Invalid IPFIX Message at offset %zu of '%s'", offset, data->path);
+            return IPX_ERR_FORMAT;
+        }
+
+        data->msg_offsets[data->msg_cnt++] = offset;
+        offset += msg_size;
+    }
+
+    if (data->msg_cnt == 0) {
+        IPX_CTX_ERROR(ctx, "The file '%s' is empty!", data->path);
+        return IPX_ERR_FORMAT;
+    }
+
+    IPX_CTX_INFO(ctx, "Loaded %zu IPFIX Messages (%zu bytes) from '%s'", data->msg_cnt,
+        size, data->path);
+    return IPX_OK;
+}
+
+/**
+ * \brief Release all resources of the instance
+ * \param[in] data Instance data
+ */
+static void
+instance_free(struct instance_data *data)
+{
+    free(data->msg_offsets);
+    free(data->file_data);
+    free(data->path);
+    free(data);
+}
+
+/**
+ * \brief Close the Transport Session of the current replay (if any)
+ *
+ * Other plugins are informed about the closed session and the session is destroyed later
+ * by a garbage message.
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ */
+static void
+session_close(ipx_ctx_t *ctx, struct instance_data *data)
+{
+    if (!data->session) {
+        return;
+    }
+
+    ipx_msg_session_t *msg_session = ipx_msg_session_create(data->session, IPX_MSG_SESSION_CLOSE);
+    ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+    ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(data->session, cb);
+    if (!msg_session || !msg_garbage) {
+        // The session cannot be safely destroyed as other plugins can still refer to it
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    } else {
+        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg_session));
+        ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(msg_garbage));
+    }
+
+    data->session = NULL;
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if (config_parse(ctx, params, data) != IPX_OK || file_load(ctx, data) != IPX_OK) {
+        instance_free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    session_close(ctx, data);
+    instance_free(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    if (data->repeat_done == data->repeat) {
+        return IPX_ERR_EOF;
+    }
+
+    if (!data->session) {
+        // Start a new replay
+        data->session = ipx_session_new_file(data->path);
+        ipx_msg_session_t *msg = (data->session)
+            ? ipx_msg_session_create(data->session, IPX_MSG_SESSION_OPEN) : NULL;
+        if (!msg) {
+            IPX_CTX_ERROR(ctx, "Failed to create a Transport Session!", '\0');
+            if (data->session) {
+                ipx_session_destroy(data->session);
+                data->session = NULL;
+            }
+            return IPX_ERR_DENIED;
+        }
+
+        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg));
+        data->msg_next = 0;
+    }
+
+    // Pass a copy of the next message (the buffer is freed by the pipeline)
+    const uint8_t *msg_data = data->file_data + data->msg_offsets[data->msg_next];
+    const struct fds_ipfix_msg_hdr *hdr = (const struct fds_ipfix_msg_hdr *) msg_data;
+    uint16_t msg_size = ntohs(hdr->length);
+
+    struct ipx_msg_ctx msg_ctx = {
+        .session = data->session,
+        .odid = ntohl(hdr->odid),
+        .stream = 0
+    };
+
+    uint8_t *msg_copy = malloc(msg_size);
+    ipx_msg_ipfix_t *msg = (msg_copy) ? ipx_msg_ipfix_create(ctx, &msg_ctx, msg_copy, msg_size)
+        : NULL;
+    if (!msg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        free(msg_copy);
+        return IPX_ERR_DENIED;
+    }
+
+    memcpy(msg_copy, msg_data, msg_size);
+    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
+
+    if (++data->msg_next == data->msg_cnt) {
+        // End of the replay
+        session_close(ctx, data);
+        data->repeat_done++;
+    }
+
+    return IPX_OK;
+}
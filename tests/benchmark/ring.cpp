@@ -0,0 +1,104 @@
+/**
+ * \file tests/benchmark/ring.cpp
+ * \brief Micro-benchmark of ring buffer implementations
+ *
+ * Multiple writers push messages (in batches) into a ring buffer and a single reader pops them
+ * as fast as possible. Throughput is measured for all ring buffer types and 1, 2, 4 and 8
+ * writers. Ring buffers never access content of the messages, therefore, only fake pointers
+ * are passed.
+ *
+ * Usage: ipx_bench_ring [messages per writer] [ring size] [batch size]
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include <core/ring.h>
+}
+
+/**
+ * \brief Run a single measurement
+ * \return Number of messages per second
+ */
+static double
+measure(enum ipx_ring_type type, unsigned writers, uint64_t cnt, uint32_t size, uint32_t batch)
+{
+    ipx_ring_t *ring = ipx_ring_init(size, writers > 1, type);
+    if (!ring) {
+        fprintf(stderr, "Failed to create a ring buffer!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < writers; ++w) {
+        threads.emplace_back([ring, cnt, batch]() {
+            std::vector<ipx_msg_t *> msgs(batch, reinterpret_cast<ipx_msg_t *>(1));
+            for (uint64_t i = 0; i < cnt; i += batch) {
+                if (batch == 1) {
+                    ipx_ring_push(ring, msgs[0]);
+                } else {
+                    ipx_ring_push_n(ring, msgs.data(), batch);
+                }
+            }
+        });
+    }
+
+    const uint64_t total = writers * ((cnt + batch - 1) / batch) * batch;
+    std::vector<ipx_msg_t *> msgs(batch);
+    uint64_t received = 0;
+    while (received < total) {
+        if (batch == 1) {
+            ipx_ring_pop(ring);
+            received++;
+        } else {
+            received += ipx_ring_pop_n(ring, msgs.data(), batch);
+        }
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    ipx_ring_destroy(ring);
+    return total / duration.count();
+}
+
+int
+main(int argc, char *argv[])
+{
+    uint64_t cnt = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 10000000ULL;
+    uint32_t size = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 8192U;
+    uint32_t batch = (argc > 3) ? strtoul(argv[3], nullptr, 10) : 1U;
+    if (cnt == 0 || size == 0 || batch == 0) {
+        fprintf(stderr, "Usage: %s [messages per writer] [ring size] [batch size]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const struct {
+        enum ipx_ring_type type;
+        const char *name;
+    } types[] = {
+        {IPX_RING_TYPE_LOCKED,   "locked"},
+        {IPX_RING_TYPE_LOCKFREE, "lockfree"},
+    };
+
+    printf("Messages per writer: %" PRIu64 ", ring size: %" PRIu32 ", batch size: %" PRIu32 "\n",
+        cnt, size, batch);
+    printf("%-10s %8s %16s\n", "type", "writers", "msgs/s");
+    for (const auto &type : types) {
+        for (unsigned writers : {1U, 2U, 4U, 8U}) {
+            double result = measure(type.type, writers, cnt, size, batch);
+            printf("%-10s %8u %16.0f\n", type.name, writers, result);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
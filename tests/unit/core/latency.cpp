@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <cstdint>
+
+extern "C" {
+    #include <core/latency.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using hist_uniq = std::unique_ptr<struct ipx_latency_hist>;
+
+/** Create a new empty histogram */
+static hist_uniq
+hist_create()
+{
+    hist_uniq hist(new struct ipx_latency_hist);
+    ipx_latency_hist_clear(hist.get());
+    return hist;
+}
+
+// Empty histogram
+TEST(Latency, empty)
+{
+    hist_uniq hist = hist_create();
+    EXPECT_EQ(hist->cnt, 0U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 50.0), 0U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 99.9), 0U);
+}
+
+// Small values are stored exactly
+TEST(Latency, exactValues)
+{
+    hist_uniq hist = hist_create();
+    for (uint64_t i = 1; i <= 100; ++i) {
+        ipx_latency_hist_add(hist.get(), i);
+    }
+
+    EXPECT_EQ(hist->cnt, 100U);
+    EXPECT_EQ(hist->max, 100U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 0.0), 1U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 50.0), 50U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 99.0), 99U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 100.0), 100U);
+}
+
+// Relative error of large values is bounded
+TEST(Latency, relativeError)
+{
+    for (uint64_t value = 100; value < (UINT64_C(1) << 39); value = value * 3 + 7) {
+        hist_uniq hist = hist_create();
+        ipx_latency_hist_add(hist.get(), value);
+        ipx_latency_hist_add(hist.get(), value * 2);
+
+        uint64_t result = ipx_latency_hist_perc(hist.get(), 50.0);
+        EXPECT_GE(result, value);
+        EXPECT_LE(result - value, value / 64) << "Value: " << value;
+        EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 100.0), value * 2);
+    }
+}
+
+// Too large values are clamped
+TEST(Latency, overflow)
+{
+    hist_uniq hist = hist_create();
+    ipx_latency_hist_add(hist.get(), UINT64_MAX);
+    EXPECT_EQ(hist->cnt, 1U);
+    EXPECT_EQ(ipx_latency_hist_perc(hist.get(), 50.0), (UINT64_C(1) << 40) - 1);
+}
+
+// Difference of snapshots
+TEST(Latency, snapshotDifference)
+{
+    hist_uniq hist = hist_create();
+    hist_uniq old_snap = hist_create();
+    hist_uniq new_snap = hist_create();
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        ipx_latency_hist_add(hist.get(), 1000000); // 1 ms
+    }
+    ipx_latency_hist_snapshot(hist.get(), old_snap.get());
+    EXPECT_EQ(old_snap->cnt, 1000U);
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        ipx_latency_hist_add(hist.get(), (i < 990) ? 10 : 5000000);
+    }
+    ipx_latency_hist_snapshot(hist.get(), new_snap.get());
+    EXPECT_EQ(new_snap->cnt, 2000U);
+
+    ipx_latency_hist_sub(new_snap.get(), old_snap.get());
+    EXPECT_EQ(new_snap->cnt, 1000U);
+    EXPECT_EQ(ipx_latency_hist_perc(new_snap.get(), 50.0), 10U);
+    uint64_t p999 = ipx_latency_hist_perc(new_snap.get(), 99.9);
+    EXPECT_GE(p999, 5000000U);
+    EXPECT_LE(p999, 5000000U + 5000000U / 64);
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+extern "C" {
+    #include <core/ring.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/*
+ * Note: Ring buffers never access content of stored messages, therefore, the tests only use
+ * encoded numbers (writer ID + sequence number) instead of real messages.
+ */
+
+/** Number of bits of a message sequence number */
+static const unsigned SEQ_BITS = 40;
+
+static inline ipx_msg_t *
+msg_encode(uint64_t writer, uint64_t seq)
+{
+    return reinterpret_cast<ipx_msg_t *>((writer << SEQ_BITS) | seq);
+}
+
+static inline uint64_t
+msg_writer(const ipx_msg_t *msg)
+{
+    return reinterpret_cast<uintptr_t>(msg) >> SEQ_BITS;
+}
+
+static inline uint64_t
+msg_seq(const ipx_msg_t *msg)
+{
+    return reinterpret_cast<uintptr_t>(msg) & ((uint64_t(1) << SEQ_BITS) - 1);
+}
+
+// Create main class for parameterized test
+class Ring : public ::testing::TestWithParam<enum ipx_ring_type> {
+protected:
+    using ring_uniq = std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)>;
+
+    /**
+     * @brief Push messages from multiple writers and check that the reader receives all of them
+     *   in the order of each writer.
+     * @param[in] size    Size of the ring buffer
+     * @param[in] writers Number of writers
+     * @param[in] cnt     Number of messages per writer
+     * @param[in] batch   Maximum size of a batch (push and pop)
+     */
+    void
+    transfer(uint32_t size, unsigned writers, uint64_t cnt, uint32_t batch)
+    {
+        ring_uniq ring(ipx_ring_init(size, writers > 1, GetParam()), &ipx_ring_destroy);
+        ASSERT_NE(ring, nullptr);
+
+        std::vector<std::thread> threads;
+        for (unsigned w = 1; w <= writers; ++w) {
+            threads.emplace_back([&ring, w, cnt, batch]() {
+                std::vector<ipx_msg_t *> msgs;
+                for (uint64_t seq = 1; seq <= cnt; ++seq) {
+                    msgs.push_back(msg_encode(w, seq));
+                    // Variable size of batches
+                    if (msgs.size() < 1 + (seq % batch) && seq != cnt) {
+                        continue;
+                    }
+
+                    if (msgs.size() == 1) {
+                        ipx_ring_push(ring.get(), msgs[0]);
+                    } else {
+                        ipx_ring_push_n(ring.get(), msgs.data(), msgs.size());
+                    }
+                    msgs.clear();
+                }
+            });
+        }
+
+        std::vector<uint64_t> last(writers + 1, 0);
+        std::vector<ipx_msg_t *> msgs(batch);
+        uint64_t total = 0;
+        while (total < writers * cnt) {
+            uint32_t ret = ipx_ring_pop_n(ring.get(), msgs.data(), batch);
+            ASSERT_GE(ret, 1U);
+            ASSERT_LE(ret, batch);
+            for (uint32_t i = 0; i < ret; ++i) {
+                uint64_t w = msg_writer(msgs[i]);
+                ASSERT_GE(w, 1U);
+                ASSERT_LE(w, writers);
+                ASSERT_EQ(msg_seq(msgs[i]), last[w] + 1);
+                last[w]++;
+            }
+            total += ret;
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+// Define parameters of parametrized test
+INSTANTIATE_TEST_CASE_P(Type, Ring, ::testing::Values(IPX_RING_TYPE_LOCKED,
+    IPX_RING_TYPE_LOCKFREE));
+
+// Create and destroy empty ring buffers
+TEST_P(Ring, createAndDestroy)
+{
+    for (uint32_t size : {128U, 1000U, 8192U}) {
+        ipx_ring_t *ring = ipx_ring_init(size, false, GetParam());
+        ASSERT_NE(ring, nullptr);
+        ipx_ring_destroy(ring);
+    }
+}
+
+// Single thread, the buffer is never full
+TEST_P(Ring, singleThread)
+{
+    ring_uniq ring(ipx_ring_init(256, false, GetParam()), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+
+    for (unsigned round = 0; round < 100; ++round) {
+        for (uint64_t i = 1; i <= 100; ++i) {
+            ipx_ring_push(ring.get(), msg_encode(1, i));
+        }
+        for (uint64_t i = 1; i <= 100; ++i) {
+            ipx_msg_t *msg = ipx_ring_pop(ring.get());
+            EXPECT_EQ(msg_seq(msg), i);
+        }
+    }
+}
+
+// Batch operations in a single thread
+TEST_P(Ring, singleThreadBatch)
+{
+    ring_uniq ring(ipx_ring_init(256, false, GetParam()), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+
+    ipx_msg_t *msgs[64];
+    uint64_t seq_in = 1;
+    uint64_t seq_out = 1;
+    for (unsigned round = 0; round < 100; ++round) {
+        for (unsigned i = 0; i < 64; ++i) {
+            msgs[i] = msg_encode(1, seq_in++);
+        }
+        ipx_ring_push_n(ring.get(), msgs, 64);
+
+        // Read everything that is ready
+        while (seq_out < seq_in) {
+            uint32_t ret = ipx_ring_pop_n(ring.get(), msgs, 64);
+            ASSERT_GE(ret, 1U);
+            for (uint32_t i = 0; i < ret; ++i) {
+                EXPECT_EQ(msg_seq(msgs[i]), seq_out++);
+            }
+        }
+    }
+}
+
+// One writer, one reader, small buffer (i.e. frequently full)
+TEST_P(Ring, oneWriter)
+{
+    transfer(128, 1, 200000, 1);
+    transfer(128, 1, 200000, 32);
+}
+
+// Multiple writers (multi-writer mode)
+TEST_P(Ring, multipleWriters)
+{
+    for (unsigned writers : {2U, 4U, 8U}) {
+        SCOPED_TRACE("Writers: " + std::to_string(writers));
+        transfer(128, writers, 50000, 1);
+        transfer(1024, writers, 50000, 16);
+    }
+}
+
+// Statistics of the ring buffer
+TEST_P(Ring, stats)
+{
+    ring_uniq ring(ipx_ring_init(256, false, GetParam()), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+
+    struct ipx_ring_stats stats;
+    ipx_ring_stats_get(ring.get(), &stats);
+    EXPECT_EQ(stats.size, 256U);
+    EXPECT_EQ(stats.fill, 0U);
+    EXPECT_EQ(stats.stall_cnt, 0U);
+    EXPECT_EQ(stats.stall_time, 0U);
+
+    for (uint64_t i = 1; i <= 100; ++i) {
+        ipx_ring_push(ring.get(), msg_encode(1, i));
+    }
+    ipx_ring_stats_get(ring.get(), &stats);
+    EXPECT_EQ(stats.fill, 100U);
+
+    for (uint64_t i = 1; i <= 100; ++i) {
+        ipx_ring_pop(ring.get());
+    }
+    // The last message can be still considered as unprocessed
+    ipx_ring_stats_get(ring.get(), &stats);
+    EXPECT_LE(stats.fill, 1U);
+    EXPECT_EQ(stats.stall_cnt, 0U);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <libfds.h>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <IpfixDecoder.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using namespace tcp_in;
+using bytes = std::vector<uint8_t>;
+
+/** Create an IPFIX Message of the given length (the content depends on the sequence number) */
+static bytes
+message(uint32_t seq_num, uint16_t length)
+{
+    bytes msg(length);
+    for (size_t i = sizeof(fds_ipfix_msg_hdr); i < length; ++i) {
+        msg[i] = uint8_t(seq_num + i);
+    }
+
+    fds_ipfix_msg_hdr hdr;
+    hdr.version = htons(FDS_IPFIX_VERSION);
+    hdr.length = htons(length);
+    hdr.export_time = htonl(0);
+    hdr.seq_num = htonl(seq_num);
+    hdr.odid = htonl(1);
+    std::memcpy(msg.data(), &hdr, sizeof(hdr));
+    return msg;
+}
+
+class TcpDecoder : public ::testing::Test {
+protected:
+    int fds[2] = {-1, -1};
+
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        ASSERT_EQ(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+    }
+
+    void TearDown() override {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    /**
+     * Send the messages from another thread and decode them
+     * @param[in] msgs Messages to send
+     * @param[in] keep Keep references to decoded messages (i.e. slabs cannot be reused)
+     */
+    void run(const std::vector<bytes> &msgs, bool keep) {
+        int wfd = fds[1];
+        std::thread writer([&msgs, wfd]() {
+            for (const bytes &msg : msgs) {
+                size_t done = 0;
+                while (done < msg.size()) {
+                    ssize_t ret = write(wfd, msg.data() + done, msg.size() - done);
+                    if (ret <= 0) {
+                        return;
+                    }
+                    done += ret;
+                }
+            }
+            shutdown(wfd, SHUT_WR);
+        });
+
+        IpfixDecoder decoder(fds[0]);
+        std::vector<DecodedMsg> kept;
+        size_t idx = 0;
+
+        while (true) {
+            DecodeBuffer &buffer = decoder.decode();
+            buffer.process_decoded([&](DecodedMsg &&msg) {
+                ASSERT_LT(idx, msgs.size());
+                const bytes &exp = msgs[idx++];
+                // Consumers access the header directly
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(msg.data()) % alignof(fds_ipfix_msg_hdr), 0U);
+                ASSERT_EQ(msg.size(), exp.size());
+                EXPECT_EQ(std::memcmp(msg.data(), exp.data(), exp.size()), 0) << "message " << idx;
+                if (keep) {
+                    kept.push_back(std::move(msg));
+                }
+            });
+
+            if (buffer.is_eof_reached()) {
+                break;
+            }
+
+            struct pollfd pfd = {fds[0], POLLIN, 0};
+            ASSERT_GE(poll(&pfd, 1, 5000), 1);
+        }
+
+        writer.join();
+        EXPECT_EQ(idx, msgs.size());
+    }
+};
+
+// Messages of aligned lengths, some of them straddle slab boundaries
+TEST_F(TcpDecoder, alignedLengths)
+{
+    std::vector<bytes> msgs;
+    size_t total = 0;
+    for (uint32_t i = 0; total < 3 * Slab::DEFAULT_CAPACITY; ++i) {
+        msgs.push_back(message(i, uint16_t(16 + 4 * ((i * 37) % 350))));
+        total += msgs.back().size();
+    }
+
+    run(msgs, true);
+}
+
+// Messages of arbitrary lengths (i.e. also unaligned ones) straddling slab boundaries
+TEST_F(TcpDecoder, unalignedLengths)
+{
+    std::vector<bytes> msgs;
+    size_t total = 0;
+    for (uint32_t i = 0; total < 3 * Slab::DEFAULT_CAPACITY; ++i) {
+        msgs.push_back(message(i, uint16_t(16 + (i * 37) % 1400)));
+        total += msgs.back().size();
+    }
+
+    run(msgs, true);
+}
+
+// The same as above, but decoded messages are released immediately (i.e. slabs are reused)
+TEST_F(TcpDecoder, unalignedLengthsReused)
+{
+    std::vector<bytes> msgs;
+    size_t total = 0;
+    for (uint32_t i = 0; total < 3 * Slab::DEFAULT_CAPACITY; ++i) {
+        msgs.push_back(message(i, uint16_t(16 + (i * 37) % 1400)));
+        total += msgs.back().size();
+    }
+
+    run(msgs, false);
+}
+
+// Messages of maximal length
+TEST_F(TcpDecoder, maximalLengths)
+{
+    std::vector<bytes> msgs;
+    for (uint32_t i = 0; i < 16; ++i) {
+        msgs.push_back(message(i, uint16_t(UINT16_MAX - (i % 3))));
+    }
+
+    run(msgs, true);
+}
@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <ipfixcol2.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+    #include <core/context.h>
+    #include <anonymizer.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using iemgr_uniq = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using tmplt_uniq = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using ctx_uniq = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using anon_uniq = std::unique_ptr<anonymizer_t, decltype(&anonymizer_destroy)>;
+using bytes = std::vector<uint8_t>;
+
+/** Length of variable-length fields */
+const uint16_t SIZE_VAR = ipfix_trec::SIZE_VAR;
+/** Number of records of each template in a message */
+const unsigned REC_CNT = 3;
+
+/** Get content of a record */
+bytes
+content(const ipfix_drec &rec)
+{
+    return bytes(rec.front(), rec.front() + rec.size());
+}
+
+class Anonymizer : public ::testing::Test {
+protected:
+    iemgr_uniq iemgr {nullptr, &fds_iemgr_destroy};
+    ctx_uniq ctx {nullptr, &ipx_ctx_destroy};
+    anon_uniq anon {nullptr, &anonymizer_destroy};
+
+    void SetUp() override {
+        // Default definitions of IEs (the same as used by the collector)
+        iemgr.reset(fds_iemgr_create());
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr.get(), fds_api_cfg_dir()), FDS_OK)
+            << fds_iemgr_last_err(iemgr.get());
+
+        ctx.reset(ipx_ctx_create("anonymization", nullptr));
+        ASSERT_NE(ctx, nullptr);
+        anon.reset(anonymizer_create(ctx.get(), AN_TRUNC, nullptr));
+        ASSERT_NE(anon, nullptr);
+    }
+
+    /** Parse a template and define its IEs */
+    tmplt_uniq tmplt(const ipfix_trec &rec) {
+        struct fds_template *result = nullptr;
+        uint16_t len = rec.size();
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, rec.front(), &len, &result), FDS_OK);
+        EXPECT_EQ(fds_template_ies_define(result, iemgr.get(), false), FDS_OK);
+        return tmplt_uniq(result, &fds_template_destroy);
+    }
+
+    /**
+     * Anonymize records in one IPFIX Message and return their new content
+     * \param[in] recs Records and their templates
+     */
+    std::vector<bytes> process(const std::vector<std::pair<const fds_template *, bytes>> &recs) {
+        // The raw message is owned (and freed) by the wrapper
+        size_t size = 0;
+        for (const auto &rec : recs) {
+            size += rec.second.size();
+        }
+        uint8_t *raw = static_cast<uint8_t *>(malloc(size));
+        EXPECT_NE(raw, nullptr);
+
+        struct ipx_msg_ctx msg_ctx = {nullptr, 0, 0};
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx.get(), &msg_ctx, raw, uint16_t(size));
+        EXPECT_NE(msg, nullptr);
+
+        size_t offset = 0;
+        for (const auto &rec : recs) {
+            memcpy(&raw[offset], rec.second.data(), rec.second.size());
+            struct ipx_ipfix_record *ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            EXPECT_NE(ref, nullptr);
+            ref->rec.data = &raw[offset];
+            ref->rec.size = uint16_t(rec.second.size());
+            ref->rec.tmplt = rec.first;
+            ref->rec.snap = nullptr;
+            offset += rec.second.size();
+        }
+
+        anonymizer_process(anon.get(), msg);
+
+        std::vector<bytes> result;
+        for (uint32_t i = 0; i < ipx_msg_ipfix_get_drec_cnt(msg); ++i) {
+            const struct fds_drec *rec = &ipx_msg_ipfix_get_drec(msg, i)->rec;
+            result.emplace_back(rec->data, rec->data + rec->size);
+        }
+        ipx_msg_ipfix_destroy(msg);
+        return result;
+    }
+
+    /**
+     * Anonymize records of a template and compare them with the expected content
+     * \note The records are processed twice to use the cached plan of the template.
+     */
+    void check(const fds_template *tmplt, const std::vector<bytes> &in, const std::vector<bytes> &out) {
+        std::vector<std::pair<const fds_template *, bytes>> recs;
+        for (const auto &rec : in) {
+            recs.emplace_back(tmplt, rec);
+        }
+
+        for (unsigned i = 0; i < 2; ++i) {
+            SCOPED_TRACE("round " + std::to_string(i));
+            EXPECT_EQ(process(recs), out);
+        }
+    }
+};
+
+// Addresses with fixed offsets only
+TEST_F(Anonymizer, fixedAddresses)
+{
+    ipfix_trec trec(256);
+    trec.add_field(8, 4);      // sourceIPv4Address
+    trec.add_field(1, 8);      // octetDeltaCount
+    trec.add_field(27, 16);    // sourceIPv6Address
+    trec.add_field(12, 4);     // destinationIPv4Address
+    tmplt_uniq tmplt_ptr = tmplt(trec);
+    ASSERT_NE(tmplt_ptr, nullptr);
+
+    const std::vector<std::pair<const char *, const char *>> ipv4 = {
+        {"192.168.10.20", "192.168.0.0"}, {"10.255.255.255", "10.255.0.0"}, {"1.2.3.4", "1.2.0.0"}};
+    std::vector<bytes> in, out;
+    for (const auto &addr : ipv4) {
+        ipfix_drec rec_in;
+        rec_in.append_ip(addr.first);
+        rec_in.append_uint(1234, 8);
+        rec_in.append_ip("2001:db8:1:2:3:4:5:6");
+        rec_in.append_ip(addr.first);
+        in.push_back(content(rec_in));
+
+        ipfix_drec rec_out;
+        rec_out.append_ip(addr.second);
+        rec_out.append_uint(1234, 8);
+        rec_out.append_ip("2001:db8:1:2::");
+        rec_out.append_ip(addr.second);
+        out.push_back(content(rec_out));
+    }
+
+    check(tmplt_ptr.get(), in, out);
+}
+
+// Addresses after a variable-length field
+TEST_F(Anonymizer, addressAfterVarField)
+{
+    ipfix_trec trec(257);
+    trec.add_field(8, 4);          // sourceIPv4Address
+    trec.add_field(82, SIZE_VAR);  // interfaceName
+    trec.add_field(12, 4);         // destinationIPv4Address
+    trec.add_field(28, 16);        // destinationIPv6Address
+    tmplt_uniq tmplt_ptr = tmplt(trec);
+    ASSERT_NE(tmplt_ptr, nullptr);
+
+    // Each record has a different position of the addresses after the variable-length field
+    const std::vector<std::string> names = {"eth0", "", std::string(300, 'x')};
+    std::vector<bytes> in, out;
+    for (const auto &name : names) {
+        ipfix_drec rec_in;
+        rec_in.append_ip("10.1.2.3");
+        rec_in.append_string(name);
+        rec_in.append_ip("10.4.5.6");
+        rec_in.append_ip("fe80::1:2:3:4");
+        in.push_back(content(rec_in));
+
+        ipfix_drec rec_out;
+        rec_out.append_ip("10.1.0.0");
+        rec_out.append_string(name);
+        rec_out.append_ip("10.4.0.0");
+        rec_out.append_ip("fe80::");
+        out.push_back(content(rec_out));
+    }
+
+    check(tmplt_ptr.get(), in, out);
+}
+
+// Variable-length addresses
+TEST_F(Anonymizer, varAddresses)
+{
+    ipfix_trec trec(258);
+    trec.add_field(8, 4);          // sourceIPv4Address
+    trec.add_field(27, SIZE_VAR);  // sourceIPv6Address
+    trec.add_field(12, SIZE_VAR);  // destinationIPv4Address
+    tmplt_uniq tmplt_ptr = tmplt(trec);
+    ASSERT_NE(tmplt_ptr, nullptr);
+
+    std::vector<bytes> in, out;
+    for (bool force_long : {false, true}) {
+        ipfix_drec rec_in;
+        rec_in.append_ip("172.16.32.64");
+        rec_in.var_header(16, force_long);
+        rec_in.append_ip("2001:db8:a:b:c:d:e:f");
+        rec_in.var_header(4, force_long);
+        rec_in.append_ip("192.0.2.33");
+        in.push_back(content(rec_in));
+
+        ipfix_drec rec_out;
+        rec_out.append_ip("172.16.0.0");
+        rec_out.var_header(16, force_long);
+        rec_out.append_ip("2001:db8:a:b::");
+        rec_out.var_header(4, force_long);
+        rec_out.append_ip("192.0.0.0");
+        out.push_back(content(rec_out));
+    }
+
+    check(tmplt_ptr.get(), in, out);
+}
+
+// Records of different templates in one message
+TEST_F(Anonymizer, mixedTemplates)
+{
+    ipfix_trec trec_fixed(259);
+    trec_fixed.add_field(8, 4);        // sourceIPv4Address
+    ipfix_trec trec_var(260);
+    trec_var.add_field(12, SIZE_VAR);  // destinationIPv4Address
+    tmplt_uniq fixed = tmplt(trec_fixed);
+    tmplt_uniq var = tmplt(trec_var);
+    ASSERT_NE(fixed, nullptr);
+    ASSERT_NE(var, nullptr);
+
+    ipfix_drec fixed_in, fixed_out, var_in, var_out;
+    fixed_in.append_ip("10.20.30.40");
+    fixed_out.append_ip("10.20.0.0");
+    var_in.var_header(4);
+    var_in.append_ip("10.50.60.70");
+    var_out.var_header(4);
+    var_out.append_ip("10.50.0.0");
+
+    std::vector<std::pair<const fds_template *, bytes>> recs;
+    std::vector<bytes> expected;
+    for (unsigned i = 0; i < REC_CNT; ++i) {
+        recs.emplace_back(fixed.get(), content(fixed_in));
+        recs.emplace_back(var.get(), content(var_in));
+        expected.push_back(content(fixed_out));
+        expected.push_back(content(var_out));
+    }
+
+    EXPECT_EQ(process(recs), expected);
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+extern "C" {
+    #include <cryptopan.h>
+    #include <Crypto-PAn/panonymizer.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using cpan_uniq = std::unique_ptr<cpan_t, decltype(&cpan_destroy)>;
+using ipv6 = std::array<uint8_t, 16>;
+
+/** Keys of the tested contexts */
+const char *KEY_A = "boojahyoo3vaeToong0Eijee7Ahz3yee";
+const char *KEY_B = "0123456789abcdefFEDCBA9876543210";
+/** Number of addresses of each test (more than records of the caches) */
+const unsigned ADDR_CNT = 10000;
+/** Number of prefixes shared by the addresses (i.e. the prefix cache is mostly hit) */
+const unsigned PREFIX_CNT = 64;
+
+/** Anonymize an IPv4 address by the original implementation */
+uint32_t
+ref_v4(const char *key, uint32_t addr)
+{
+    PAnonymizer_Init((uint8_t *) key);
+    return anonymize(addr);
+}
+
+/** Anonymize an IPv6 address by the original implementation */
+ipv6
+ref_v6(const char *key, const ipv6 &addr)
+{
+    uint64_t in[2];
+    uint64_t out[2];
+    memcpy(in, addr.data(), 16);
+    PAnonymizer_Init((uint8_t *) key);
+    anonymize_v6(in, out);
+
+    ipv6 result;
+    memcpy(result.data(), out, 16);
+    return result;
+}
+
+/** Anonymize an IPv6 address by the context */
+ipv6
+anon_v6(cpan_t *cpan, const ipv6 &addr)
+{
+    ipv6 result;
+    cpan_anon_v6(cpan, addr.data(), result.data());
+    return result;
+}
+
+/** The parameter selects the backend (true == the bundled Rijndael implementation only) */
+class Cryptopan : public ::testing::TestWithParam<bool> {
+protected:
+    std::mt19937 rng {42};
+
+    cpan_uniq create(const char *key) {
+        cpan_uniq result(cpan_create((const uint8_t *) key, GetParam()), &cpan_destroy);
+        EXPECT_NE(result, nullptr);
+        return result;
+    }
+
+    /** Random IPv4 addresses, each shares its /24 prefix with some of the others */
+    std::vector<uint32_t> addrs_v4(unsigned cnt) {
+        std::vector<uint32_t> prefixes(PREFIX_CNT);
+        for (auto &prefix : prefixes) {
+            prefix = rng() & 0xFFFFFF00U;
+        }
+
+        std::vector<uint32_t> result(cnt);
+        for (auto &addr : result) {
+            addr = prefixes[rng() % PREFIX_CNT] | (rng() & 0xFFU);
+        }
+        // Corner cases
+        result.push_back(0);
+        result.push_back(UINT32_MAX);
+        return result;
+    }
+
+    /** Random IPv6 addresses, each shares its /48 prefix with some of the others */
+    std::vector<ipv6> addrs_v6(unsigned cnt) {
+        std::vector<ipv6> prefixes(PREFIX_CNT);
+        for (auto &prefix : prefixes) {
+            for (unsigned i = 0; i < 6; ++i) {
+                prefix[i] = uint8_t(rng());
+            }
+        }
+
+        std::vector<ipv6> result(cnt);
+        for (auto &addr : result) {
+            addr = prefixes[rng() % PREFIX_CNT];
+            for (unsigned i = 6; i < 16; ++i) {
+                addr[i] = uint8_t(rng());
+            }
+        }
+        // Corner cases
+        result.push_back(ipv6 {});
+        ipv6 ones;
+        ones.fill(0xFF);
+        result.push_back(ones);
+        return result;
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Backends, Cryptopan, ::testing::Values(false, true));
+
+// The backend is selected as requested
+TEST_P(Cryptopan, backend)
+{
+    cpan_uniq cpan = create(KEY_A);
+    if (GetParam()) {
+        EXPECT_FALSE(cpan_aesni(cpan.get()));
+    }
+}
+
+// IPv4 addresses are mapped the same as by the original implementation
+TEST_P(Cryptopan, ipv4)
+{
+    cpan_uniq cpan = create(KEY_A);
+    const std::vector<uint32_t> addrs = addrs_v4(ADDR_CNT);
+    std::vector<uint32_t> expected;
+    for (uint32_t addr : addrs) {
+        expected.push_back(ref_v4(KEY_A, addr));
+    }
+
+    // Cache misses and hits of prefixes (the first pass), hits of full addresses (the second)
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            ASSERT_EQ(cpan_anon_v4(cpan.get(), addrs[i]), expected[i]) << "pass " << pass
+                << ", address " << std::hex << addrs[i];
+        }
+    }
+
+    // Hits of full addresses that have just been anonymized
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        for (unsigned rep = 0; rep < 2; ++rep) {
+            ASSERT_EQ(cpan_anon_v4(cpan.get(), addrs[i]), expected[i]) << std::hex << addrs[i];
+        }
+    }
+}
+
+// IPv6 addresses are mapped the same as by the original implementation
+TEST_P(Cryptopan, ipv6)
+{
+    cpan_uniq cpan = create(KEY_A);
+    const std::vector<ipv6> addrs = addrs_v6(ADDR_CNT / 4);
+    std::vector<ipv6> expected;
+    for (const ipv6 &addr : addrs) {
+        expected.push_back(ref_v6(KEY_A, addr));
+    }
+
+    // Cache misses and hits of prefixes (the first pass), hits of full addresses (the second)
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            ASSERT_EQ(anon_v6(cpan.get(), addrs[i]), expected[i]) << "pass " << pass << ", address " << i;
+        }
+    }
+
+    // Hits of full addresses that have just been anonymized
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        for (unsigned rep = 0; rep < 2; ++rep) {
+            ASSERT_EQ(anon_v6(cpan.get(), addrs[i]), expected[i]) << "address " << i;
+        }
+    }
+}
+
+// Contexts with different keys are independent
+TEST_P(Cryptopan, multipleKeys)
+{
+    const std::vector<uint32_t> addrs = addrs_v4(ADDR_CNT / 10);
+    const std::vector<ipv6> addrs6 = addrs_v6(ADDR_CNT / 40);
+    std::vector<uint32_t> expected_a, expected_b;
+    std::vector<ipv6> expected6_a, expected6_b;
+    for (uint32_t addr : addrs) {
+        expected_a.push_back(ref_v4(KEY_A, addr));
+        expected_b.push_back(ref_v4(KEY_B, addr));
+    }
+    for (const ipv6 &addr : addrs6) {
+        expected6_a.push_back(ref_v6(KEY_A, addr));
+        expected6_b.push_back(ref_v6(KEY_B, addr));
+    }
+
+    // The original implementation has a global state, which must not be used by the contexts
+    cpan_uniq cpan_a = create(KEY_A);
+    PAnonymizer_Init((uint8_t *) KEY_B);
+    cpan_uniq cpan_b = create(KEY_B);
+    PAnonymizer_Init((uint8_t *) KEY_A);
+
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        ASSERT_EQ(cpan_anon_v4(cpan_a.get(), addrs[i]), expected_a[i]) << std::hex << addrs[i];
+        ASSERT_EQ(cpan_anon_v4(cpan_b.get(), addrs[i]), expected_b[i]) << std::hex << addrs[i];
+    }
+    for (size_t i = 0; i < addrs6.size(); ++i) {
+        ASSERT_EQ(anon_v6(cpan_a.get(), addrs6[i]), expected6_a[i]) << "address " << i;
+        ASSERT_EQ(anon_v6(cpan_b.get(), addrs6[i]), expected6_b[i]) << "address " << i;
+    }
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <ipfixcol2.h>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+extern "C" {
+    #include <refs.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using iemgr_uniq = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using tmplt_uniq = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using field_set = std::set<std::pair<uint32_t, uint16_t>>;
+
+class Refs : public ::testing::Test {
+protected:
+    iemgr_uniq iemgr {nullptr, &fds_iemgr_destroy};
+    struct filter_refs refs = {nullptr, 0};
+
+    void SetUp() override {
+        // Default definitions of IEs, aliases and mappings (the same as used by the collector)
+        iemgr.reset(fds_iemgr_create());
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr.get(), fds_api_cfg_dir()), FDS_OK)
+            << fds_iemgr_last_err(iemgr.get());
+    }
+
+    void TearDown() override {
+        filter_refs_clear(&refs);
+    }
+
+    /** Parse an expression and return the referenced fields */
+    field_set parse(const std::string &expr) {
+        EXPECT_EQ(filter_refs_parse(&refs, iemgr.get(), expr.c_str()), IPX_OK) << expr;
+        field_set result;
+        for (size_t i = 0; i < refs.cnt; ++i) {
+            result.emplace(refs.fields[i].en, refs.fields[i].id);
+        }
+        EXPECT_EQ(result.size(), refs.cnt) << "duplicate fields in " << expr;
+        return result;
+    }
+
+    /** Get all fields an alias refers to */
+    field_set alias(const char *name) {
+        const struct fds_iemgr_alias *alias = fds_iemgr_alias_find(iemgr.get(), name);
+        EXPECT_NE(alias, nullptr) << name;
+        field_set result;
+        for (size_t i = 0; alias && i < alias->sources_cnt; ++i) {
+            result.emplace(alias->sources[i]->scope->pen, alias->sources[i]->id);
+        }
+        return result;
+    }
+
+    /** Parse a template and define its IEs (reverse fields of biflow templates) */
+    tmplt_uniq tmplt(const ipfix_trec &rec) {
+        struct fds_template *result = nullptr;
+        uint16_t len = rec.size();
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, rec.front(), &len, &result), FDS_OK);
+        EXPECT_EQ(fds_template_ies_define(result, iemgr.get(), false), FDS_OK);
+        return tmplt_uniq(result, &fds_template_destroy);
+    }
+};
+
+// Names of Information Elements with and without the scope prefix
+TEST_F(Refs, elementNames)
+{
+    EXPECT_EQ(parse("octetDeltaCount > 100"), (field_set {{0, 1}}));
+    EXPECT_EQ(parse("iana:packetDeltaCount > 5"), (field_set {{0, 2}}));
+    EXPECT_EQ(parse("octetDeltaCount > 1 and iana:octetDeltaCount < 5"), (field_set {{0, 1}}));
+    EXPECT_EQ(parse("iana@reverse:octetDeltaCount > 1"), (field_set {{29305, 1}}));
+    EXPECT_EQ(parse("(octetDeltaCount>1)and(packetDeltaCount<2)"), (field_set {{0, 1}, {0, 2}}));
+}
+
+// Names containing digits and numeric values of all kinds
+TEST_F(Refs, numeric)
+{
+    EXPECT_EQ(parse("sourceIPv4Address 10.0.0.0/8"), (field_set {{0, 8}}));
+    EXPECT_EQ(parse("sourceIPv6Address ::ff or destinationIPv6Address fe80::1/64"),
+        (field_set {{0, 27}, {0, 28}}));
+    EXPECT_EQ(parse("sourceTransportPort in [80, 0x50, 0b1010, 1.5e+2, 10u, 10k, 5ms]"),
+        (field_set {{0, 7}}));
+    EXPECT_EQ(parse("flowStartMilliseconds > 2020-04-05T24:00Z"), (field_set {{0, 152}}));
+    EXPECT_EQ(parse("sourceMacAddress 12:34:56:78:9a:bc or destinationMacAddress ab:cd:ef:01:23:45"),
+        (field_set {{0, 56}, {0, 80}}));
+    EXPECT_EQ(parse("octetDeltaCount + 1 > packetDeltaCount * 2"), (field_set {{0, 1}, {0, 2}}));
+}
+
+// String literals are never identifiers (including escaped quotes)
+TEST_F(Refs, quotedStrings)
+{
+    EXPECT_EQ(parse("interfaceName contains \"octetDeltaCount\""), (field_set {{0, 82}}));
+    EXPECT_EQ(parse("interfaceName \"a \\\" packetDeltaCount \\\"\" or octetDeltaCount 1"),
+        (field_set {{0, 82}, {0, 1}}));
+    EXPECT_EQ(parse("interfaceName \"\\\\\" and packetDeltaCount 1"), (field_set {{0, 82}, {0, 2}}));
+}
+
+// Aliases refer to all their sources
+TEST_F(Refs, aliases)
+{
+    EXPECT_EQ(parse("srcip 10.0.0.0/16"), alias("srcip"));
+
+    field_set expected = alias("srcip");
+    field_set dst = alias("dstport");
+    expected.insert(dst.begin(), dst.end());
+    EXPECT_EQ(parse("srcip in [1.0.0.0/8, 2.2.0.0/16] or dstport in [80, 443]"), expected);
+}
+
+// Keywords and value mappings are not fields
+TEST_F(Refs, keywords)
+{
+    EXPECT_EQ(parse("not (protocolIdentifier tcp) and interfaceName contains \"x\""),
+        (field_set {{0, 4}, {0, 82}}));
+    EXPECT_EQ(parse("true"), field_set {});
+    EXPECT_EQ(parse(""), field_set {});
+}
+
+// Identifiers that cannot be resolved disable the analysis
+TEST_F(Refs, tooLong)
+{
+    const std::string expr = std::string(300, 'a') + " 1";
+    EXPECT_EQ(filter_refs_parse(&refs, iemgr.get(), expr.c_str()), IPX_ERR_FORMAT);
+    EXPECT_EQ(refs.cnt, 0U);
+}
+
+// Previous content is replaced
+TEST_F(Refs, reparse)
+{
+    EXPECT_EQ(parse("octetDeltaCount 1"), (field_set {{0, 1}}));
+    EXPECT_EQ(parse("packetDeltaCount 1"), (field_set {{0, 2}}));
+}
+
+// Templates with and without referenced fields
+TEST_F(Refs, templates)
+{
+    ipfix_trec rec(256);
+    rec.add_field(8, 4);   // sourceIPv4Address
+    rec.add_field(1, 8);   // octetDeltaCount
+    tmplt_uniq tmplt_ptr = tmplt(rec);
+    ASSERT_NE(tmplt_ptr, nullptr);
+
+    parse("sourceIPv4Address 10.0.0.1");
+    EXPECT_TRUE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+    parse("srcip 10.0.0.1");
+    EXPECT_TRUE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+    parse("packetDeltaCount > 1 or dstip 10.0.0.1");
+    EXPECT_FALSE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+    parse("true");
+    EXPECT_FALSE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+}
+
+// Reverse fields of biflow templates
+TEST_F(Refs, biflowTemplates)
+{
+    ipfix_trec rec(256);
+    rec.add_field(8, 4);            // sourceIPv4Address
+    rec.add_field(1, 8);            // octetDeltaCount
+    rec.add_field(2, 8, 29305);     // packetDeltaCount (reverse)
+    tmplt_uniq tmplt_ptr = tmplt(rec);
+    ASSERT_NE(tmplt_ptr, nullptr);
+    ASSERT_NE(tmplt_ptr->fields_rev, nullptr);
+
+    parse("packetDeltaCount > 1");
+    EXPECT_TRUE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+    parse("iana@reverse:octetDeltaCount > 1");
+    EXPECT_TRUE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+    parse("sourceTransportPort 80");
+    EXPECT_FALSE(filter_refs_in_tmplt(&refs, tmplt_ptr.get()));
+}
@@ -0,0 +1,383 @@
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <libfds.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Storage.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using tmplt_uniq = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using bytes = std::vector<uint8_t>;
+using selection = std::vector<Config::element>;
+
+/** Length of variable-length fields */
+const uint16_t SIZE_VAR = ipfix_trec::SIZE_VAR;
+
+/** Get content of a record */
+template <typename T>
+bytes
+content(const T &rec)
+{
+    return bytes(rec.front(), rec.front() + rec.size());
+}
+
+class Projection : public ::testing::Test {
+protected:
+    /** Parse a template */
+    tmplt_uniq tmplt(const bytes &raw) {
+        struct fds_template *result = nullptr;
+        uint16_t len = uint16_t(raw.size());
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &len, &result), FDS_OK);
+        return tmplt_uniq(result, &fds_template_destroy);
+    }
+
+    /**
+     * Project a record and check that the result matches the expected record and that
+     * the modified template matches the expected template
+     */
+    void check(const ipfix_trec &trec, const ipfix_drec &drec, const selection &sel,
+        const ipfix_trec &exp_trec, const ipfix_drec &exp_drec) {
+        tmplt_uniq tmplt_ptr = tmplt(content(trec));
+        ASSERT_NE(tmplt_ptr, nullptr);
+
+        std::vector<uint8_t> raw;
+        create_modified_template(tmplt_ptr.get(), sel, raw);
+        EXPECT_EQ(raw, content(exp_trec));
+
+        bytes rec = content(drec);
+        proj_plan plan;
+        create_projection(tmplt_ptr.get(), sel, plan);
+        ASSERT_EQ(project(plan, tmplt_ptr.get(), rec), content(exp_drec));
+    }
+
+    /** Project a record (empty on failure) */
+    bytes project(const proj_plan &plan, const struct fds_template *tmplt_ptr, bytes &rec) {
+        struct fds_drec drec;
+        drec.data = rec.data();
+        drec.size = uint16_t(rec.size());
+        drec.tmplt = tmplt_ptr;
+        drec.snap = nullptr;
+
+        // The buffer is deliberately dirty and too short
+        std::vector<uint8_t> buffer(1, 0xFF);
+        int size = project_record(plan, drec, buffer);
+        EXPECT_GE(size, 0);
+        if (size < 0) {
+            return {};
+        }
+        EXPECT_LE(size_t(size), buffer.size());
+        return bytes(buffer.begin(), buffer.begin() + size);
+    }
+};
+
+// Drop fields from the beginning, middle and end of a record
+TEST_F(Projection, dropFields)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);   // octetDeltaCount
+    trec.add_field(2, 8);   // packetDeltaCount
+    trec.add_field(4, 1);   // protocolIdentifier
+    trec.add_field(7, 2);   // sourceTransportPort
+    trec.add_field(11, 2);  // destinationTransportPort
+    trec.add_field(8, 4);   // sourceIPv4Address
+    trec.add_field(12, 4);  // destinationIPv4Address
+
+    ipfix_drec drec;
+    drec.append_uint(1000, 8);
+    drec.append_uint(10, 8);
+    drec.append_uint(6, 1);
+    drec.append_uint(12345, 2);
+    drec.append_uint(80, 2);
+    drec.append_ip("10.0.0.1");
+    drec.append_ip("192.168.0.1");
+
+    ipfix_trec exp_trec(256);
+    exp_trec.add_field(2, 8);
+    exp_trec.add_field(7, 2);
+    exp_trec.add_field(11, 2);
+    exp_trec.add_field(8, 4);
+
+    ipfix_drec exp_drec;
+    exp_drec.append_uint(10, 8);
+    exp_drec.append_uint(12345, 2);
+    exp_drec.append_uint(80, 2);
+    exp_drec.append_ip("10.0.0.1");
+
+    check(trec, drec, {{0, 2}, {0, 7}, {0, 11}, {0, 8}}, exp_trec, exp_drec);
+
+    // Adjacent fields are copied by a single operation
+    tmplt_uniq tmplt_ptr = tmplt(content(trec));
+    proj_plan plan;
+    create_projection(tmplt_ptr.get(), {{0, 2}, {0, 7}, {0, 11}, {0, 8}}, plan);
+    ASSERT_EQ(plan.ops.size(), 2U);
+    EXPECT_EQ(plan.ops[0].type, proj_op::type::COPY);
+    EXPECT_EQ(plan.ops[0].offset, 8U);
+    EXPECT_EQ(plan.ops[0].length, 8U);
+    EXPECT_EQ(plan.ops[1].type, proj_op::type::COPY);
+    EXPECT_EQ(plan.ops[1].offset, 17U);
+    EXPECT_EQ(plan.ops[1].length, 8U);
+}
+
+// Order of selected elements doesn't matter, fields keep the order of the template
+TEST_F(Projection, reorderSelection)
+{
+    ipfix_trec trec(300);
+    trec.add_field(8, 4);
+    trec.add_field(12, 4);
+    trec.add_field(1, 8);
+    trec.add_field(5, 4, 8057);
+
+    ipfix_drec drec;
+    drec.append_ip("10.0.0.1");
+    drec.append_ip("10.0.0.2");
+    drec.append_uint(1234, 8);
+    drec.append_uint(42, 4);
+
+    ipfix_trec exp_trec(300);
+    exp_trec.add_field(8, 4);
+    exp_trec.add_field(1, 8);
+    exp_trec.add_field(5, 4, 8057);
+
+    ipfix_drec exp_drec;
+    exp_drec.append_ip("10.0.0.1");
+    exp_drec.append_uint(1234, 8);
+    exp_drec.append_uint(42, 4);
+
+    check(trec, drec, {{0, 8}, {0, 1}, {8057, 5}}, exp_trec, exp_drec);
+    check(trec, drec, {{8057, 5}, {0, 1}, {0, 8}}, exp_trec, exp_drec);
+    check(trec, drec, {{0, 1}, {8057, 5}, {0, 8}, {0, 9999}}, exp_trec, exp_drec);
+}
+
+// Fields are identified by both Enterprise Number and ID
+TEST_F(Projection, enterpriseFields)
+{
+    ipfix_trec trec(256);
+    trec.add_field(5, 4);
+    trec.add_field(5, 4, 8057);
+    trec.add_field(5, 4, 29305);
+
+    ipfix_drec drec;
+    drec.append_uint(1, 4);
+    drec.append_uint(2, 4);
+    drec.append_uint(3, 4);
+
+    ipfix_trec exp_trec(256);
+    exp_trec.add_field(5, 4, 8057);
+
+    ipfix_drec exp_drec;
+    exp_drec.append_uint(2, 4);
+
+    check(trec, drec, {{8057, 5}}, exp_trec, exp_drec);
+}
+
+// All fields selected (the record is copied as a whole)
+TEST_F(Projection, allFields)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);
+    trec.add_field(4, 1);
+    trec.add_field(8, 4);
+
+    ipfix_drec drec;
+    drec.append_uint(1000, 8);
+    drec.append_uint(17, 1);
+    drec.append_ip("10.0.0.1");
+
+    check(trec, drec, {{0, 1}, {0, 4}, {0, 8}}, trec, drec);
+
+    tmplt_uniq tmplt_ptr = tmplt(content(trec));
+    proj_plan plan;
+    create_projection(tmplt_ptr.get(), {{0, 1}, {0, 4}, {0, 8}}, plan);
+    ASSERT_EQ(plan.ops.size(), 1U);
+    EXPECT_EQ(plan.ops[0].offset, 0U);
+    EXPECT_EQ(plan.ops[0].length, 13U);
+}
+
+// No field selected (the template is not stored)
+TEST_F(Projection, noFields)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);
+    trec.add_field(82, SIZE_VAR);
+
+    tmplt_uniq tmplt_ptr = tmplt(content(trec));
+    std::vector<uint8_t> raw;
+    create_modified_template(tmplt_ptr.get(), {{0, 2}}, raw);
+    EXPECT_TRUE(raw.empty());
+
+    proj_plan plan;
+    create_projection(tmplt_ptr.get(), {{0, 2}}, plan);
+    EXPECT_TRUE(plan.ops.empty());
+}
+
+// Variable-length fields (selected and skipped) in between fixed-length fields
+TEST_F(Projection, variableLength)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);
+    trec.add_field(82, SIZE_VAR);   // interfaceName
+    trec.add_field(8, 4);
+    trec.add_field(83, SIZE_VAR);   // interfaceDescription
+    trec.add_field(12, 4);
+    trec.add_field(96, SIZE_VAR);   // applicationName
+
+    ipfix_drec drec;
+    drec.append_uint(1000, 8);
+    drec.append_string("eth0");
+    drec.append_ip("10.0.0.1");
+    drec.append_string("uplink");
+    drec.append_ip("10.0.0.2");
+    drec.append_string("http");
+
+    {
+        // Selected variable-length field and a fixed field behind a skipped one
+        ipfix_trec exp_trec(256);
+        exp_trec.add_field(82, SIZE_VAR);
+        exp_trec.add_field(12, 4);
+
+        ipfix_drec exp_drec;
+        exp_drec.append_string("eth0");
+        exp_drec.append_ip("10.0.0.2");
+
+        check(trec, drec, {{0, 12}, {0, 82}}, exp_trec, exp_drec);
+    }
+    {
+        // Fixed-length fields only (trailing variable-length field is irrelevant)
+        ipfix_trec exp_trec(256);
+        exp_trec.add_field(1, 8);
+        exp_trec.add_field(8, 4);
+        exp_trec.add_field(12, 4);
+
+        ipfix_drec exp_drec;
+        exp_drec.append_uint(1000, 8);
+        exp_drec.append_ip("10.0.0.1");
+        exp_drec.append_ip("10.0.0.2");
+
+        check(trec, drec, {{0, 1}, {0, 8}, {0, 12}}, exp_trec, exp_drec);
+
+        tmplt_uniq tmplt_ptr = tmplt(content(trec));
+        proj_plan plan;
+        create_projection(tmplt_ptr.get(), {{0, 1}, {0, 8}, {0, 12}}, plan);
+        ASSERT_FALSE(plan.ops.empty());
+        EXPECT_NE(plan.ops.back().type, proj_op::type::VAR_SKIP);
+    }
+    {
+        // Variable-length fields only
+        ipfix_trec exp_trec(256);
+        exp_trec.add_field(83, SIZE_VAR);
+        exp_trec.add_field(96, SIZE_VAR);
+
+        ipfix_drec exp_drec;
+        exp_drec.append_string("uplink");
+        exp_drec.append_string("http");
+
+        check(trec, drec, {{0, 96}, {0, 83}}, exp_trec, exp_drec);
+    }
+}
+
+// Empty variable-length fields and fields with the long length prefix
+TEST_F(Projection, variableLengthPrefix)
+{
+    ipfix_trec trec(256);
+    trec.add_field(82, SIZE_VAR);
+    trec.add_field(83, SIZE_VAR);
+    trec.add_field(96, SIZE_VAR);
+    trec.add_field(4, 1);
+
+    const std::string long_str(300, 'x');
+    ipfix_drec drec;
+    drec.append_string("");
+    drec.var_header(5, true);   // needlessly long prefix
+    drec.append_octets("short", 5, false);
+    drec.append_string(long_str);
+    drec.append_uint(6, 1);
+
+    ipfix_trec exp_trec(256);
+    exp_trec.add_field(82, SIZE_VAR);
+    exp_trec.add_field(83, SIZE_VAR);
+    exp_trec.add_field(96, SIZE_VAR);
+    exp_trec.add_field(4, 1);
+
+    // The long prefix is shortened, the prefix of the long string is kept
+    ipfix_drec exp_drec;
+    exp_drec.append_string("");
+    exp_drec.append_string("short");
+    exp_drec.append_string(long_str);
+    exp_drec.append_uint(6, 1);
+
+    check(trec, drec, {{0, 82}, {0, 83}, {0, 96}, {0, 4}}, exp_trec, exp_drec);
+}
+
+// Multiple occurrences of the same Information Element
+TEST_F(Projection, multipleOccurrences)
+{
+    ipfix_trec trec(256);
+    trec.add_field(82, SIZE_VAR);
+    trec.add_field(1, 8);
+    trec.add_field(82, SIZE_VAR);
+    trec.add_field(2, 8);
+
+    ipfix_drec drec;
+    drec.append_string("first");
+    drec.append_uint(1, 8);
+    drec.append_string("second");
+    drec.append_uint(2, 8);
+
+    ipfix_trec exp_trec(256);
+    exp_trec.add_field(82, SIZE_VAR);
+    exp_trec.add_field(82, SIZE_VAR);
+    exp_trec.add_field(2, 8);
+
+    ipfix_drec exp_drec;
+    exp_drec.append_string("first");
+    exp_drec.append_string("second");
+    exp_drec.append_uint(2, 8);
+
+    check(trec, drec, {{0, 2}, {0, 82}}, exp_trec, exp_drec);
+}
+
+// Malformed records are detected
+TEST_F(Projection, malformedRecord)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);
+    trec.add_field(82, SIZE_VAR);
+    trec.add_field(8, 4);
+
+    tmplt_uniq tmplt_ptr = tmplt(content(trec));
+    proj_plan plan;
+    create_projection(tmplt_ptr.get(), {{0, 82}, {0, 8}}, plan);
+
+    // Variable-length field exceeds the record
+    ipfix_drec drec;
+    drec.append_uint(1, 8);
+    drec.var_header(10);
+    drec.append_octets("abc", 3, false);
+    bytes rec = content(drec);
+
+    struct fds_drec rec_view;
+    rec_view.data = rec.data();
+    rec_view.size = uint16_t(rec.size());
+    rec_view.tmplt = tmplt_ptr.get();
+    rec_view.snap = nullptr;
+
+    std::vector<uint8_t> buffer;
+    EXPECT_EQ(project_record(plan, rec_view, buffer), -1);
+
+    // Fixed-length field exceeds the record
+    ipfix_drec drec_short;
+    drec_short.append_uint(1, 8);
+    drec_short.append_string("abc");
+    drec_short.append_uint(1, 2);
+    rec = content(drec_short);
+    rec_view.data = rec.data();
+    rec_view.size = uint16_t(rec.size());
+    EXPECT_EQ(project_record(plan, rec_view, buffer), -1);
+}
@@ -0,0 +1,489 @@
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <libfds.h>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Serializer.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using iemgr_uniq = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using tmplt_uniq = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using bytes = std::vector<uint8_t>;
+
+/** Length of variable-length fields */
+const uint16_t SIZE_VAR = ipfix_trec::SIZE_VAR;
+/** Private Enterprise Number of IEs of all data types (see data/types.xml) */
+const uint32_t EN_TYPES = 10000;
+/** Private Enterprise Number of reverse IEs of all data types */
+const uint32_t EN_TYPES_REV = 10001;
+/** Private Enterprise Number of reverse IANA elements */
+const uint32_t EN_IANA_REV = 29305;
+/** Private Enterprise Number of an undefined scope */
+const uint32_t EN_UNKNOWN = 12345;
+
+// IDs of IEs in data/types.xml
+enum type_id : uint16_t {
+    ID_U8 = 1, ID_U16, ID_U32, ID_U64,
+    ID_S8, ID_S16, ID_S32, ID_S64,
+    ID_F32, ID_F64, ID_BOOL, ID_MAC, ID_OCTETS, ID_STRING,
+    ID_TS_SEC, ID_TS_MSEC, ID_TS_USEC, ID_TS_NSEC,
+    ID_IPV4, ID_IPV6, ID_BLIST
+};
+
+/** Conversion flags (all their combinations are tested) */
+const uint32_t FLAGS[] = {
+    FDS_CD2J_FORMAT_TCPFLAGS, FDS_CD2J_FORMAT_PROTO, FDS_CD2J_TS_FORMAT_MSEC,
+    FDS_CD2J_IGNORE_UNKNOWN, FDS_CD2J_NON_PRINTABLE, FDS_CD2J_NUMERIC_ID,
+    FDS_CD2J_OCTETS_NOINT, FDS_CD2J_REVERSE_SKIP, FDS_CD2J_BIFLOW_REVERSE
+};
+const unsigned FLAGS_CNT = sizeof(FLAGS) / sizeof(FLAGS[0]);
+
+/** Get content of a record */
+bytes
+content(const ipfix_drec &rec)
+{
+    return bytes(rec.front(), rec.front() + rec.size());
+}
+
+/** Encode an unsigned integer in network byte order */
+bytes
+be(uint64_t value, uint16_t size)
+{
+    bytes result(size);
+    for (uint16_t i = 0; i < size; ++i) {
+        result[i] = uint8_t(value >> (8U * (size - 1U - i)));
+    }
+    return result;
+}
+
+/** Generic patterns of a value: zeros, ones, the most significant bit, max. signed, sequence */
+std::vector<bytes>
+patterns(uint16_t size)
+{
+    bytes zeros(size, 0x00);
+    bytes ones(size, 0xFF);
+    bytes msb(size, 0x00);
+    bytes max(size, 0xFF);
+    bytes seq(size);
+    msb[0] = 0x80;
+    max[0] = 0x7F;
+    for (uint16_t i = 0; i < size; ++i) {
+        seq[i] = uint8_t(0x01 + 0x22 * i);
+    }
+    return {zeros, ones, msb, max, seq};
+}
+
+/** Encode an NTP timestamp (seconds since the UNIX epoch and a fraction of a second) */
+bytes
+ntp(uint64_t sec, uint32_t frac)
+{
+    return be(((sec + 2208988800ULL) << 32) | frac, 8);
+}
+
+class JsonSerializer : public ::testing::Test {
+protected:
+    iemgr_uniq iemgr {nullptr, &fds_iemgr_destroy};
+    Serializer serializer;
+    char *str = nullptr;
+    size_t str_size = 0;
+    char *ref = nullptr;
+    size_t ref_size = 0;
+
+    void SetUp() override {
+        iemgr.reset(fds_iemgr_create());
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_EQ(fds_iemgr_read_file(iemgr.get(), "data/iana_part.xml", false), FDS_OK)
+            << fds_iemgr_last_err(iemgr.get());
+        ASSERT_EQ(fds_iemgr_read_file(iemgr.get(), "data/types.xml", false), FDS_OK)
+            << fds_iemgr_last_err(iemgr.get());
+    }
+
+    void TearDown() override {
+        free(str);
+        free(ref);
+    }
+
+    /** Parse a template and define its IEs */
+    tmplt_uniq tmplt(const ipfix_trec &rec, enum fds_template_type type = FDS_TYPE_TEMPLATE,
+        bool define = true) {
+        struct fds_template *result = nullptr;
+        uint16_t len = rec.size();
+        EXPECT_EQ(fds_template_parse(type, rec.front(), &len, &result), FDS_OK);
+        if (result && define) {
+            EXPECT_EQ(fds_template_ies_define(result, iemgr.get(), false), FDS_OK);
+        }
+        return tmplt_uniq(result, &fds_template_destroy);
+    }
+
+    /**
+     * Convert records by the serializer and by the libfds converter with all combinations of
+     * conversion flags and compare the results
+     */
+    void compare(const struct fds_template *tmplt, const std::vector<bytes> &recs,
+        const fds_iemgr_t *mgr) {
+        ASSERT_NE(tmplt, nullptr);
+
+        for (uint32_t mask = 0; mask < (1U << FLAGS_CNT); ++mask) {
+            uint32_t flags = 0;
+            for (unsigned i = 0; i < FLAGS_CNT; ++i) {
+                flags |= ((mask & (1U << i)) != 0) ? FLAGS[i] : 0;
+            }
+
+            for (const auto &rec : recs) {
+                struct fds_drec drec;
+                drec.data = const_cast<uint8_t *>(rec.data());
+                drec.size = uint16_t(rec.size());
+                drec.tmplt = tmplt;
+                drec.snap = nullptr;
+
+                int rc_ref = fds_drec2json(&drec, flags | FDS_CD2J_ALLOW_REALLOC, mgr, &ref,
+                    &ref_size);
+                int rc = serializer.convert(&drec, flags, mgr, &str, &str_size);
+                ASSERT_EQ(rc, rc_ref) << "flags: " << flags;
+                if (rc >= 0) {
+                    ASSERT_EQ(std::string(str, size_t(rc)), std::string(ref, size_t(rc_ref)))
+                        << "flags: " << flags;
+                }
+            }
+        }
+    }
+
+    void compare(const struct fds_template *tmplt, const std::vector<bytes> &recs) {
+        compare(tmplt, recs, iemgr.get());
+    }
+
+    /**
+     * Convert values of a field (preceded by a fixed-length field) and check that records
+     * are converted by plans (unless \p planned is false)
+     */
+    void field(uint32_t en, uint16_t id, uint16_t len, const std::vector<bytes> &values,
+        bool planned = true) {
+        ipfix_trec trec(256);
+        trec.add_field(1, 8); // octetDeltaCount
+        trec.add_field(id, len, en);
+        tmplt_uniq tmplt_ptr = tmplt(trec);
+
+        std::vector<bytes> recs;
+        for (const auto &value : values) {
+            ipfix_drec drec;
+            drec.append_uint(1234567890, 8);
+            drec.append_octets(value.data(), uint16_t(value.size()), len == SIZE_VAR);
+            recs.push_back(content(drec));
+        }
+
+        const uint64_t planned_before = serializer.get_stats().planned;
+        compare(tmplt_ptr.get(), recs);
+        if (planned) {
+            EXPECT_GT(serializer.get_stats().planned, planned_before)
+                << "en: " << en << ", id: " << id;
+        }
+    }
+
+    /** Convert values of a field of all possible sizes (1 - max) */
+    void field_sizes(uint32_t en, uint16_t id, uint16_t max) {
+        for (uint16_t size = 1; size <= max; ++size) {
+            field(en, id, size, patterns(size));
+        }
+    }
+};
+
+// Unsigned integers (including reduced-size encoding)
+TEST_F(JsonSerializer, unsignedIntegers)
+{
+    field_sizes(EN_TYPES, ID_U8, 1);
+    field_sizes(EN_TYPES, ID_U16, 2);
+    field_sizes(EN_TYPES, ID_U32, 4);
+    field_sizes(EN_TYPES, ID_U64, 8);
+    field(0, 2, 8, {be(0, 8), be(1, 8), be(std::numeric_limits<uint64_t>::max(), 8)});
+}
+
+// Signed integers (including reduced-size encoding)
+TEST_F(JsonSerializer, signedIntegers)
+{
+    field_sizes(EN_TYPES, ID_S8, 1);
+    field_sizes(EN_TYPES, ID_S16, 2);
+    field_sizes(EN_TYPES, ID_S32, 4);
+    field_sizes(EN_TYPES, ID_S64, 8);
+    field(EN_TYPES, ID_S64, 8, {be(uint64_t(-1), 8), be(uint64_t(INT64_MIN), 8)});
+}
+
+// Floats are converted by the libfds converter field by field
+TEST_F(JsonSerializer, floats)
+{
+    std::vector<bytes> values32;
+    std::vector<bytes> values64;
+    for (double value : {0.0, -1.5, 3.14159, 1e30, -1e-30, std::numeric_limits<double>::max(),
+            std::nan(""), std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity()}) {
+        ipfix_drec rec32;
+        ipfix_drec rec64;
+        rec32.append_float(value, 4);
+        rec64.append_float(value, 8);
+        values32.push_back(content(rec32));
+        values64.push_back(content(rec64));
+    }
+
+    field(EN_TYPES, ID_F32, 4, values32);
+    field(EN_TYPES, ID_F64, 4, values32);
+    field(EN_TYPES, ID_F64, 8, values64);
+}
+
+// Booleans (including values not defined by RFC 7011)
+TEST_F(JsonSerializer, booleans)
+{
+    field(EN_TYPES, ID_BOOL, 1, {{1}, {2}});
+    field(EN_TYPES, ID_BOOL, 1, {{0}, {3}, {255}}, false);
+}
+
+// MAC addresses
+TEST_F(JsonSerializer, macAddresses)
+{
+    std::vector<bytes> values = patterns(6);
+    values.push_back({0x00, 0x1A, 0x2B, 0x3C, 0x4D, 0x5E});
+    field(EN_TYPES, ID_MAC, 6, values);
+    field(0, 56, 6, values);
+}
+
+// Octet arrays of fixed and variable length (integers up to 8 bytes, hex strings otherwise)
+TEST_F(JsonSerializer, octetArrays)
+{
+    for (uint16_t size : {1, 2, 3, 4, 7, 8, 9, 16, 32}) {
+        field(EN_TYPES, ID_OCTETS, size, patterns(size));
+    }
+
+    std::vector<bytes> values = {{}};
+    for (uint16_t size : {1, 2, 8, 9, 16, 254, 255, 300}) {
+        for (const auto &value : patterns(size)) {
+            values.push_back(value);
+        }
+    }
+    field(EN_TYPES, ID_OCTETS, SIZE_VAR, values);
+}
+
+// Strings are converted by the libfds converter field by field
+TEST_F(JsonSerializer, strings)
+{
+    std::vector<bytes> values;
+    for (const std::string &value : {std::string(""), std::string("eth0"),
+            std::string("quote \" and backslash \\"), std::string("tab\tnew line\n"),
+            std::string("control \x01\x1F\x7F"), std::string("UTF-8 \xC5\xBE\x6C\x75\xC5\xA5"),
+            std::string("invalid UTF-8 \xFF\xC5"), std::string(400, 'x')}) {
+        values.push_back(bytes(value.begin(), value.end()));
+    }
+
+    field(EN_TYPES, ID_STRING, SIZE_VAR, values);
+    field(0, 82, SIZE_VAR, values);
+    field(EN_TYPES, ID_STRING, 8, {bytes(8, 'a'), {'a', 'b', 0, 0, 0, 0, 0, 0}, bytes(8, 0)});
+}
+
+// Timestamps (as numbers and as ISO 8601 strings)
+TEST_F(JsonSerializer, timestamps)
+{
+    std::vector<bytes> sec = patterns(4);
+    sec.push_back(be(1526067869, 4));  // 2018-05-11T19:44:29Z
+    field(EN_TYPES, ID_TS_SEC, 4, sec);
+    field(0, 150, 4, sec);
+
+    std::vector<bytes> msec = patterns(8);
+    msec.push_back(be(1526067869006ULL, 8));     // 2018-05-11T19:44:29.006Z
+    msec.push_back(be(253402300799999ULL, 8));   // 9999-12-31T23:59:59.999Z
+    msec.push_back(be(253402300800000ULL, 8));   // year 10000
+    field(EN_TYPES, ID_TS_MSEC, 8, msec);
+    field(0, 152, 8, msec);
+
+    std::vector<bytes> ntps = patterns(8);
+    ntps.push_back(ntp(0, 0));
+    ntps.push_back(ntp(1526067869, 0x00418937)); // just below 1 ms
+    ntps.push_back(ntp(1526067869, 0x00418938)); // just above 1 ms
+    ntps.push_back(ntp(1526067869, 0x80000000));
+    ntps.push_back(ntp(1526067869, 0xFFFFFFFF));
+    ntps.push_back(ntp(1526067869, 0x000007FF)); // unused bits of microseconds
+    field(EN_TYPES, ID_TS_USEC, 8, ntps);
+    field(EN_TYPES, ID_TS_NSEC, 8, ntps);
+    field(0, 154, 8, ntps);
+    field(0, 156, 8, ntps);
+}
+
+// IPv4 and IPv6 addresses
+TEST_F(JsonSerializer, addresses)
+{
+    std::vector<bytes> ipv4 = patterns(4);
+    ipv4.push_back({10, 0, 0, 1});
+    ipv4.push_back({192, 168, 100, 255});
+    field(EN_TYPES, ID_IPV4, 4, ipv4);
+    field(0, 8, 4, ipv4);
+
+    std::vector<bytes> ipv6 = patterns(16);
+    ipv6.push_back({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1});
+    ipv6.push_back({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 10, 0, 0, 1});
+    ipv6.push_back({0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1});
+    ipv6.push_back({0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x1A, 0x2B, 0xFF, 0xFE, 0, 0, 0});
+    field(EN_TYPES, ID_IPV6, 16, ipv6);
+    field(0, 27, 16, ipv6);
+}
+
+// Fields with special formatting (protocols and TCP flags)
+TEST_F(JsonSerializer, specialFields)
+{
+    std::vector<bytes> u8;
+    for (unsigned i = 0; i < 256; ++i) {
+        u8.push_back({uint8_t(i)});
+    }
+    field(0, 4, 1, u8);
+    field(0, 6, 1, u8);
+
+    std::vector<bytes> u16 = patterns(2);
+    for (unsigned value : {0x0000U, 0x0002U, 0x0012U, 0x003FU, 0x00FFU, 0x0100U, 0x01FFU}) {
+        u16.push_back(be(value, 2));
+    }
+    field(0, 6, 2, u16);
+}
+
+// Fields of unknown definitions (converted as octet arrays or hidden)
+TEST_F(JsonSerializer, unknownFields)
+{
+    for (uint16_t size : {1, 2, 4, 8, 9}) {
+        field(EN_UNKNOWN, 100, size, patterns(size));
+    }
+    field(EN_UNKNOWN, 100, SIZE_VAR, {{}, {1}, bytes(9, 0xAB)});
+    field(0, 32767, 4, patterns(4));
+}
+
+// Template without definitions of fields and without a manager of IEs
+TEST_F(JsonSerializer, noDefinitions)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);
+    trec.add_field(8, 4);
+    trec.add_field(82, SIZE_VAR);
+    tmplt_uniq tmplt_ptr = tmplt(trec, FDS_TYPE_TEMPLATE, false);
+
+    ipfix_drec drec;
+    drec.append_uint(1234, 8);
+    drec.append_ip("10.0.0.1");
+    drec.append_string("eth0");
+    compare(tmplt_ptr.get(), {content(drec)}, nullptr);
+    compare(tmplt_ptr.get(), {content(drec)});
+}
+
+// Padding is always hidden
+TEST_F(JsonSerializer, padding)
+{
+    ipfix_trec trec(256);
+    trec.add_field(1, 8);
+    trec.add_field(210, 3);
+    trec.add_field(2, 8);
+    tmplt_uniq tmplt_ptr = tmplt(trec);
+
+    ipfix_drec drec;
+    drec.append_uint(1234, 8);
+    drec.append_octets("\0\0\0", 3, false);
+    drec.append_uint(5, 8);
+    compare(tmplt_ptr.get(), {content(drec)});
+}
+
+// Biflow records (forward and reverse view, skipped reverse fields)
+TEST_F(JsonSerializer, biflow)
+{
+    ipfix_trec trec(256);
+    trec.add_field(8, 4);                       // sourceIPv4Address
+    trec.add_field(12, 4);                      // destinationIPv4Address
+    trec.add_field(4, 1);                       // protocolIdentifier
+    trec.add_field(1, 8);                       // octetDeltaCount
+    trec.add_field(1, 8, EN_IANA_REV);          // reverse octetDeltaCount
+    trec.add_field(6, 2);                       // tcpControlBits
+    trec.add_field(6, 2, EN_IANA_REV);          // reverse tcpControlBits
+    trec.add_field(ID_U32, 4, EN_TYPES);
+    trec.add_field(ID_U32, 4, EN_TYPES_REV);
+    trec.add_field(ID_STRING, SIZE_VAR, EN_TYPES_REV);
+    tmplt_uniq tmplt_ptr = tmplt(trec);
+
+    ipfix_drec drec;
+    drec.append_ip("10.0.0.1");
+    drec.append_ip("192.168.0.1");
+    drec.append_uint(6, 1);
+    drec.append_uint(1234, 8);
+    drec.append_uint(5678, 8);
+    drec.append_uint(0x12, 2);
+    drec.append_uint(0x1B, 2);
+    drec.append_uint(1, 4);
+    drec.append_uint(2, 4);
+    drec.append_string("reverse");
+
+    const uint64_t planned = serializer.get_stats().planned;
+    compare(tmplt_ptr.get(), {content(drec)});
+    EXPECT_GT(serializer.get_stats().planned, planned);
+}
+
+// Options Template records
+TEST_F(JsonSerializer, optionsTemplate)
+{
+    ipfix_trec trec(256, 1);
+    trec.add_field(149, 4);                     // observationDomainId
+    trec.add_field(ID_U64, 8, EN_TYPES);
+    trec.add_field(ID_STRING, SIZE_VAR, EN_TYPES);
+    tmplt_uniq tmplt_ptr = tmplt(trec, FDS_TYPE_TEMPLATE_OPTS);
+
+    ipfix_drec drec;
+    drec.append_uint(1, 4);
+    drec.append_uint(123456, 8);
+    drec.append_string("options");
+    compare(tmplt_ptr.get(), {content(drec)});
+}
+
+// Variable-length fields with the long length header
+TEST_F(JsonSerializer, longHeader)
+{
+    ipfix_trec trec(256);
+    trec.add_field(ID_OCTETS, SIZE_VAR, EN_TYPES);
+    trec.add_field(ID_STRING, SIZE_VAR, EN_TYPES);
+    trec.add_field(ID_U16, 2, EN_TYPES);
+    tmplt_uniq tmplt_ptr = tmplt(trec);
+
+    ipfix_drec drec;
+    drec.var_header(4, true);
+    drec.append_octets("\x01\x02\x03\x04", 4, false);
+    drec.var_header(3, true);
+    drec.append_octets("abc", 3, false);
+    drec.append_uint(443, 2);
+    compare(tmplt_ptr.get(), {content(drec)});
+}
+
+// Multiple occurrences of the same IE and structured types are converted as a whole
+TEST_F(JsonSerializer, genericRecords)
+{
+    ipfix_trec trec_multi(256);
+    trec_multi.add_field(1, 8);
+    trec_multi.add_field(1, 8);
+    tmplt_uniq multi = tmplt(trec_multi);
+
+    ipfix_drec drec_multi;
+    drec_multi.append_uint(1, 8);
+    drec_multi.append_uint(2, 8);
+    compare(multi.get(), {content(drec_multi)});
+
+    ipfix_trec trec_list(257);
+    trec_list.add_field(1, 8);
+    trec_list.add_field(ID_BLIST, SIZE_VAR, EN_TYPES);
+    tmplt_uniq list = tmplt(trec_list);
+
+    // basicList of two IPv4 addresses (semantic "allOf")
+    const uint8_t blist[] = {0x03, 0x00, 0x08, 0x00, 0x04, 10, 0, 0, 1, 10, 0, 0, 2};
+    ipfix_drec drec_list;
+    drec_list.append_uint(1, 8);
+    drec_list.append_octets(blist, sizeof(blist), true);
+
+    const uint64_t planned = serializer.get_stats().planned;
+    compare(list.get(), {content(drec_list)});
+    EXPECT_EQ(serializer.get_stats().planned, planned);
+}